@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/bufferedstream.h"
 #include "common/debug.h"
 #include "common/file.h"
 #include "common/mutex.h"
@@ -71,8 +72,9 @@ SeekableAudioStream *SeekableAudioStream::openStreamFile(const Common::String &b
 		Common::String filename = basename + STREAM_FILEFORMATS[i].fileExtension;
 		fileHandle->open(filename);
 		if (fileHandle->isOpen()) {
-			// Create the stream object
-			stream = STREAM_FILEFORMATS[i].openStreamFile(fileHandle, DisposeAfterUse::YES);
+			// Create the stream object, reading the file ahead on the I/O
+			// thread, as the stream is decoded on the mixer thread
+			stream = STREAM_FILEFORMATS[i].openStreamFile(Common::wrapPrefetchingReadStream(fileHandle, 32 * 1024, DisposeAfterUse::YES), DisposeAfterUse::YES);
 			fileHandle = 0;
 			break;
 		}
@@ -22,6 +22,7 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -44,19 +45,24 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+	        RateConverterQuality quality);
 	~Channel();
 
 	/**
 	 * Mixes the channel's samples into the given buffer.
 	 *
-	 * @param data buffer where to mix the data
+	 * @param data buffer where to mix the data, holding either 16-bit
+	 *             samples or wide samples (see RateConverter::flow)
 	 * @param len  number of sample *pairs*. So a value of
 	 *             10 means that the buffer contains twice 10 sample, each
 	 *             16 bits, for a total of 40 bytes.
+	 * @param volL left volume to mix with
+	 * @param volR right volume to mix with
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	template<typename T>
+	int mix(T *data, uint len, st_volume_t volL, st_volume_t volR);
 
 	/**
 	 * Queries whether the channel is still playing or not.
@@ -144,6 +150,25 @@ public:
 	 */
 	SoundHandle getHandle() const { return _handle; }
 
+	/**
+	 * Gets the effective left and right volumes, as computed from
+	 * the channel's volume, balance and the global volume settings.
+	 */
+	void getChannelVolumes(st_volume_t &volL, st_volume_t &volR) const { volL = _volL; volR = _volR; }
+
+	/**
+	 * Marks the channel as finished and no longer in use by the mixer
+	 * callback. Used in lock-free mode, where the channel is deleted by
+	 * the engine side afterwards.
+	 */
+	void setRetired() { Common::atomicStore(_retired, 1); }
+
+	/**
+	 * Queries whether the channel has been marked as finished by the
+	 * mixer callback.
+	 */
+	bool isRetired() const { return Common::atomicLoad(_retired) != 0; }
+
 private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
@@ -157,13 +182,18 @@ private:
 	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
 
+	volatile uint32 _retired;
+
 	Mixer *_mixer;
 
-	uint32 _samplesConsumed;
+	// Updated by mix(), which in lock-free mode runs concurrently with
+	// getElapsedTime() and pause() on the engine side.
+	volatile uint32 _samplesConsumed;
+	volatile uint32 _mixerTimeStamp;
+	volatile uint32 _pauseTime;
+
 	uint32 _samplesDecoded;
-	uint32 _mixerTimeStamp;
 	uint32 _pauseStartTime;
-	uint32 _pauseTime;
 
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
@@ -175,12 +205,23 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _rateConverterQuality(kRateConverterFast), _lockFree(false), _commandWrite(0), _commandRead(0), _mixEpoch(0),
+	  _outputFormat(kOutputFormatS16), _wideMixBus(false), _ditherSeed(1) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	if (ConfMan.hasKey("resampling_quality") && ConfMan.get("resampling_quality") == "high")
+		_rateConverterQuality = kRateConverterHighQuality;
+
+	if (ConfMan.hasKey("mixer_wide_bus"))
+		_wideMixBus = ConfMan.getBool("mixer_wide_bus");
+
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_mixSlots[i].channel = 0;
+		_stoppedChannels[i] = 0;
+	}
 }
 
 MixerImpl::~MixerImpl() {
@@ -192,6 +233,153 @@ void MixerImpl::setReady(bool ready) {
 	_mixerReady = ready;
 }
 
+void MixerImpl::setLockFree(bool lockFree) {
+	Common::StackLock lock(_mutex);
+
+#ifndef SCUMMVM_HAVE_ATOMICS
+	if (lockFree) {
+		warning("MixerImpl: lock-free mixing is not supported on this platform");
+		return;
+	}
+#endif
+
+	for (int i = 0; i != NUM_CHANNELS; i++)
+		assert(!_channels[i]);
+
+	_lockFree = lockFree;
+}
+
+void MixerImpl::postCommand(MixCommand::Type type, Channel *chan) {
+	// Only called with _mutex locked, so there is a single producer
+	const uint32 write = _commandWrite;
+
+	// The callback drains the queue on each invocation, so normally it
+	// never fills up. If it does, the callback is not being invoked, e.g.
+	// because the audio device is closed, so drain the queue here.
+	if (write - Common::atomicLoad(_commandRead) >= COMMAND_QUEUE_SIZE) {
+		const uint32 epoch = lockMixState();
+		processCommands();
+		unlockMixState(epoch);
+	}
+
+	MixCommand &cmd = _commands[write & (COMMAND_QUEUE_SIZE - 1)];
+	cmd.type = type;
+	cmd.index = chan->getHandle()._val % NUM_CHANNELS;
+	cmd.handle = chan->getHandle()._val;
+	cmd.channel = (type == MixCommand::kStartChannel) ? chan : 0;
+	chan->getChannelVolumes(cmd.volL, cmd.volR);
+	cmd.paused = chan->isPaused();
+
+	Common::atomicStore(_commandWrite, write + 1);
+}
+
+void MixerImpl::processCommands() {
+	const uint32 write = Common::atomicLoad(_commandWrite);
+	uint32 read = _commandRead;
+
+	for (; read != write; read++) {
+		const MixCommand &cmd = _commands[read & (COMMAND_QUEUE_SIZE - 1)];
+		MixSlot &slot = _mixSlots[cmd.index];
+
+		if (cmd.type == MixCommand::kStartChannel) {
+			slot.channel = cmd.channel;
+			slot.handle = cmd.handle;
+		} else if (!slot.channel || slot.handle != cmd.handle) {
+			// The channel might have finished playing already. In that
+			// case the slot is either empty or has been reused.
+			continue;
+		} else if (cmd.type == MixCommand::kStopChannel) {
+			slot.channel = 0;
+			continue;
+		}
+
+		slot.volL = cmd.volL;
+		slot.volR = cmd.volR;
+		slot.paused = cmd.paused;
+	}
+
+	Common::atomicStore(_commandRead, read);
+}
+
+uint32 MixerImpl::lockMixState() {
+	// Only done when the callback is not being invoked, so this does not
+	// wait for long
+	for (;;) {
+		const uint32 epoch = Common::atomicLoad(_mixEpoch);
+		if (!(epoch & 1) && Common::atomicCompareAndSwap(_mixEpoch, epoch, epoch + 1))
+			return epoch + 1;
+		g_system->delayMillis(1);
+	}
+}
+
+void MixerImpl::unlockMixState(uint32 epoch) {
+	Common::atomicStore(_mixEpoch, epoch + 1);
+}
+
+void MixerImpl::waitForMixCallback() {
+	// The queued commands have been published with a full barrier, and a
+	// callback takes ownership with one. So either the callback started
+	// already and is seen here, or it sees the commands.
+	const uint32 epoch = Common::atomicLoad(_mixEpoch);
+	if (!(epoch & 1))
+		return;
+
+	while (Common::atomicLoad(_mixEpoch) == epoch)
+		g_system->delayMillis(1);
+}
+
+void MixerImpl::reclaimFinishedChannels() {
+	if (!_lockFree)
+		return;
+
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i] && _channels[i]->isRetired()) {
+			delete _channels[i];
+			_channels[i] = 0;
+		}
+	}
+}
+
+void MixerImpl::stopChannel(int index) {
+	assert(_channels[index]);
+
+	if (_lockFree) {
+		postCommand(MixCommand::kStopChannel, _channels[index]);
+		_stoppedChannels[index] = _channels[index];
+	} else {
+		delete _channels[index];
+	}
+
+	_channels[index] = 0;
+}
+
+void MixerImpl::freeStoppedChannels() {
+	if (!_lockFree)
+		return;
+
+	bool stopped = false;
+	for (int i = 0; i != NUM_CHANNELS; i++)
+		stopped |= (_stoppedChannels[i] != 0);
+	if (!stopped)
+		return;
+
+	// The stop commands are queued. Once a callback in progress is done,
+	// no callback touches the channels anymore: the next one processes the
+	// stop commands before mixing, without dereferencing the channels.
+	waitForMixCallback();
+
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		delete _stoppedChannels[i];
+		_stoppedChannels[i] = 0;
+	}
+}
+
+void MixerImpl::notifyChannelChange(Channel *chan) {
+	// Otherwise the callback reads the settings from the channel itself
+	if (_lockFree)
+		postCommand(MixCommand::kUpdateChannel, chan);
+}
+
 uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
@@ -219,6 +407,9 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	if (_lockFree)
+		postCommand(MixCommand::kStartChannel, chan);
 }
 
 void MixerImpl::playStream(
@@ -239,6 +430,8 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
+	reclaimFinishedChannels();
+
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
@@ -260,7 +453,7 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _rateConverterQuality);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -269,55 +462,174 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
-
-	int16 *buf = (int16 *)samples;
-	// we store stereo, 16-bit samples
-	assert(len % 4 == 0);
-	len >>= 2;
+	// we store stereo, 16-bit or float samples
+	const uint frameSize = (_outputFormat == kOutputFormatFloat) ? 2 * sizeof(float) : 2 * sizeof(int16);
+	assert(len % frameSize == 0);
+	len /= frameSize;
 
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
-	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
+	if (_lockFree)
+		return mixCallbackLockFree(samples, len);
 
-	// mix all channels
-	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	Common::StackLock lock(_mutex);
+
+	MixSlot slots[NUM_CHANNELS];
+
+	// remove finished channels
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i] && _channels[i]->isFinished()) {
+			delete _channels[i];
+			_channels[i] = 0;
+		}
+
+		slots[i].channel = _channels[i];
 		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+			_channels[i]->getChannelVolumes(slots[i].volL, slots[i].volR);
+			slots[i].paused = _channels[i]->isPaused();
+		}
+	}
+
+	return mixChannels(slots, samples, len);
+}
+
+int MixerImpl::mixCallbackLockFree(byte *samples, uint len) {
+	// The engine side only holds the state when the callback has not been
+	// invoked for a long time, see postCommand(). Output silence then.
+	const uint32 epoch = Common::atomicLoad(_mixEpoch);
+	if ((epoch & 1) || !Common::atomicCompareAndSwap(_mixEpoch, epoch, epoch + 1)) {
+		static const MixSlot noSlots[NUM_CHANNELS] = {};
+		return mixChannels(noSlots, samples, len);
+	}
+
+	processCommands();
+
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		Channel *chan = _mixSlots[i].channel;
+		if (chan && chan->isFinished()) {
+			// The channel is deleted by the engine side, we must not
+			// touch it anymore after retiring it.
+			_mixSlots[i].channel = 0;
+			chan->setRetired();
+		}
+	}
+
+	const int res = mixChannels(_mixSlots, samples, len);
+
+	unlockMixState(epoch + 1);
+
+	return res;
+}
+
+int MixerImpl::mixChannels(const MixSlot *slots, byte *samples, uint len) {
+	int res = 0, tmp;
+
+	if (!isWideMixBus()) {
+		int16 *buf = (int16 *)samples;
+
+		//  zero the buf
+		memset(buf, 0, 2 * len * sizeof(int16));
+
+		// mix all channels
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (slots[i].channel && !slots[i].paused) {
+				tmp = slots[i].channel->mix(buf, len, slots[i].volL, slots[i].volR);
 
 				if (tmp > res)
 					res = tmp;
 			}
 		}
 
+		return res;
+	}
+
+	// Sum up the channels in chunks which fit into the mix bus, and convert
+	// each chunk to the output format.
+	while (len > 0) {
+		const uint frames = MIN<uint>(len, MIX_BUS_FRAMES);
+		int mixed = 0;
+
+		memset(_mixBus, 0, 2 * frames * sizeof(st_wide_sample_t));
+
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (slots[i].channel && !slots[i].paused) {
+				tmp = slots[i].channel->mix(_mixBus, frames, slots[i].volL, slots[i].volR);
+
+				if (tmp > mixed)
+					mixed = tmp;
+			}
+		}
+
+		if (_outputFormat == kOutputFormatFloat) {
+			convertToFloat((float *)samples, _mixBus, 2 * frames);
+			samples += 2 * frames * sizeof(float);
+		} else {
+			convertToS16((int16 *)samples, _mixBus, 2 * frames);
+			samples += 2 * frames * sizeof(int16);
+		}
+
+		res += mixed;
+		len -= frames;
+	}
+
 	return res;
 }
 
+void MixerImpl::convertToS16(int16 *out, const st_wide_sample_t *in, uint samples) {
+	uint32 seed = _ditherSeed;
+
+	for (uint i = 0; i < samples; i++) {
+		// Triangular dither spanning +-1 output LSB, made up of two uniform
+		// random values from a linear congruential generator.
+		seed = seed * 1664525 + 1013904223;
+		const int dither = (int)((seed >> 24) + ((seed >> 16) & 0xFF)) - 255;
+
+		// The wide samples have 8 fractional bits
+		int val = (in[i] + dither + (1 << 7)) >> 8;
+		val = CLIP<int>(val, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		out[i] = ((int16)val) ^ 0x8000;
+#else
+		out[i] = val;
+#endif
+	}
+
+	_ditherSeed = seed;
+}
+
+void MixerImpl::convertToFloat(float *out, const st_wide_sample_t *in, uint samples) {
+	const float scale = 1.0f / (32768 * kMaxMixerVolume);
+
+	for (uint i = 0; i < samples; i++) {
+		const float val = in[i] * scale;
+
+		if (val > 1.0f)
+			out[i] = 1.0f;
+		else if (val < -1.0f)
+			out[i] = -1.0f;
+		else
+			out[i] = val;
+	}
+}
+
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && !_channels[i]->isPermanent())
+			stopChannel(i);
 	}
+	freeStoppedChannels();
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && _channels[i]->getId() == id)
+			stopChannel(i);
 	}
+	freeStoppedChannels();
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
@@ -328,17 +640,21 @@ void MixerImpl::stopHandle(SoundHandle handle) {
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	stopChannel(index);
+	freeStoppedChannels();
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].mute = mute;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_channels[i] && _channels[i]->getType() == type) {
 			_channels[i]->notifyGlobalVolChange();
+			notifyChannelChange(_channels[i]);
+		}
 	}
 }
 
@@ -355,6 +671,7 @@ void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 		return;
 
 	_channels[index]->setVolume(volume);
+	notifyChannelChange(_channels[index]);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
@@ -373,6 +690,7 @@ void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 		return;
 
 	_channels[index]->setBalance(balance);
+	notifyChannelChange(_channels[index]);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
@@ -402,6 +720,7 @@ void MixerImpl::pauseAll(bool paused) {
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0) {
 			_channels[i]->pause(paused);
+			notifyChannelChange(_channels[i]);
 		}
 	}
 }
@@ -411,6 +730,7 @@ void MixerImpl::pauseID(int id, bool paused) {
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
+			notifyChannelChange(_channels[i]);
 			return;
 		}
 	}
@@ -425,6 +745,7 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 		return;
 
 	_channels[index]->pause(paused);
+	notifyChannelChange(_channels[index]);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
@@ -434,6 +755,8 @@ bool MixerImpl::isSoundIDActive(int id) {
 	g_eventRec.updateSubsystems();
 #endif
 
+	reclaimFinishedChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getId() == id)
 			return true;
@@ -442,6 +765,7 @@ bool MixerImpl::isSoundIDActive(int id) {
 
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	reclaimFinishedChannels();
 	const int index = handle._val % NUM_CHANNELS;
 	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
 		return _channels[index]->getId();
@@ -455,12 +779,15 @@ bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 	g_eventRec.updateSubsystems();
 #endif
 
+	reclaimFinishedChannels();
+
 	const int index = handle._val % NUM_CHANNELS;
 	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
 	Common::StackLock lock(_mutex);
+	reclaimFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getType() == type)
 			return true;
@@ -483,8 +810,10 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	_soundTypeSettings[type].volume = volume;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_channels[i] && _channels[i]->getType() == type) {
 			_channels[i]->notifyGlobalVolChange();
+			notifyChannelChange(_channels[i]);
+		}
 	}
 }
 
@@ -500,16 +829,18 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+                 RateConverterQuality quality)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
+      _retired(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, quality);
 }
 
 Channel::~Channel() {
@@ -573,7 +904,7 @@ void Channel::pause(bool paused) {
 		_pauseLevel--;
 
 		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis(true) - _pauseStartTime);
+			Common::atomicStore(_pauseTime, g_system->getMillis(true) - _pauseStartTime);
 			_pauseStartTime = 0;
 		}
 	}
@@ -585,17 +916,18 @@ Timestamp Channel::getElapsedTime() {
 
 	Audio::Timestamp ts(0, rate);
 
-	if (_mixerTimeStamp == 0)
+	const uint32 mixerTimeStamp = Common::atomicLoad(_mixerTimeStamp);
+	if (mixerTimeStamp == 0)
 		return ts;
 
 	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
+		delta = _pauseStartTime - mixerTimeStamp;
 	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
+		delta = g_system->getMillis(true) - mixerTimeStamp - Common::atomicLoad(_pauseTime);
 
 	// Convert the number of samples into a time duration.
 
-	ts = ts.addFrames(_samplesConsumed);
+	ts = ts.addFrames(Common::atomicLoad(_samplesConsumed));
 	ts = ts.addMsecs(delta);
 
 	// In theory it would seem like a good idea to limit the approximation
@@ -607,7 +939,8 @@ Timestamp Channel::getElapsedTime() {
 	return ts;
 }
 
-int Channel::mix(int16 *data, uint len) {
+template<typename T>
+int Channel::mix(T *data, uint len, st_volume_t volL, st_volume_t volR) {
 	assert(_stream);
 
 	int res = 0;
@@ -615,10 +948,10 @@ int Channel::mix(int16 *data, uint len) {
 		// TODO: call drain method
 	} else {
 		assert(_converter);
-		_samplesConsumed = _samplesDecoded;
-		_mixerTimeStamp = g_system->getMillis(true);
-		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
+		Common::atomicStore(_samplesConsumed, _samplesDecoded);
+		Common::atomicStore(_mixerTimeStamp, g_system->getMillis(true));
+		Common::atomicStore(_pauseTime, 0);
+		res = _converter->flow(*_stream, data, len, volL, volR);
 		_samplesDecoded += res;
 	}
 
@@ -25,7 +25,9 @@
 
 #include "common/scummsys.h"
 #include "common/mutex.h"
+#include "common/atomic.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -42,6 +44,11 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * By default, the mixer callback and all engine facing methods are
+ * serialized through a mutex. Backends which run the callback on a realtime
+ * audio thread can switch the mixer into lock-free mode via setLockFree()
+ * before any sound is played; see there for details.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -49,6 +56,18 @@ namespace Audio {
  * @see OSystem::getMixer()
  */
 class MixerImpl : public Mixer {
+public:
+	/**
+	 * The sample formats mixCallback() can produce. Samples are always
+	 * interleaved stereo and in native byte order.
+	 */
+	enum OutputFormat {
+		/** Signed 16-bit samples (unsigned with OUTPUT_UNSIGNED_AUDIO) */
+		kOutputFormatS16,
+		/** 32-bit float samples in the range [-1.0, 1.0] */
+		kOutputFormatFloat
+	};
+
 private:
 	enum {
 		NUM_CHANNELS = 16
@@ -70,6 +89,90 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * A request from the engine side to the mixer callback, used in
+	 * lock-free mode. The volume and pause state are snapshots of the
+	 * channel's settings at the time the command was queued.
+	 *
+	 * The channel is addressed by its slot and handle. Only a start command
+	 * carries a pointer to the channel, which the callback adopts; other
+	 * commands only affect the channel adopted for the slot, provided its
+	 * handle matches. Processing a command never dereferences the channel,
+	 * so a stopped channel may be deleted while commands referring to it
+	 * are still queued.
+	 */
+	struct MixCommand {
+		enum Type {
+			kStartChannel,
+			kStopChannel,
+			kUpdateChannel
+		};
+
+		Type type;
+		int index;
+		uint32 handle;
+		Channel *channel;
+		st_volume_t volL, volR;
+		bool paused;
+	};
+
+	/** A channel as seen by the mixing code, along with its mix settings */
+	struct MixSlot {
+		Channel *channel;
+		uint32 handle;
+		st_volume_t volL, volR;
+		bool paused;
+	};
+
+	enum {
+		/** Size of the command queue, must be a power of two */
+		COMMAND_QUEUE_SIZE = 1024
+	};
+
+	enum {
+		/** Number of sample pairs mixed at once when using the wide mix bus */
+		MIX_BUS_FRAMES = 512
+	};
+
+	RateConverterQuality _rateConverterQuality;
+
+	bool _lockFree;
+
+	/**
+	 * Single-producer/single-consumer queue of commands. It is written by
+	 * engine code (serialized through _mutex) and drained at the start of
+	 * each mixCallback() invocation.
+	 */
+	MixCommand _commands[COMMAND_QUEUE_SIZE];
+	volatile uint32 _commandWrite;
+	volatile uint32 _commandRead;
+
+	/** Channels currently mixed by the callback, only touched by it */
+	MixSlot _mixSlots[NUM_CHANNELS];
+
+	/** Channels which have been stopped but may still be in use by the callback */
+	Channel *_stoppedChannels[NUM_CHANNELS];
+
+	/**
+	 * Incremented when a mixer callback starts and again when it ends, so
+	 * it is odd while a callback owns _mixSlots and the read end of the
+	 * command queue. The engine side only takes ownership itself, in the
+	 * same way, when the callback is not being invoked at all.
+	 */
+	volatile uint32 _mixEpoch;
+
+	OutputFormat _outputFormat;
+	bool _wideMixBus;
+
+	/**
+	 * Buffer in which the channels are summed up, when not mixing directly
+	 * into the 16-bit output. Only touched by the callback.
+	 */
+	st_wide_sample_t _mixBus[MIX_BUS_FRAMES * 2];
+
+	/** State of the random number generator used for dithering */
+	uint32 _ditherSeed;
+
 
 public:
 
@@ -121,14 +224,74 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/**
+	 * Removes the channel in the given slot. In lock-free mode the channel
+	 * is only queued for deletion, freeStoppedChannels() has to be called
+	 * afterwards.
+	 */
+	void stopChannel(int index);
+	void freeStoppedChannels();
+
+	/**
+	 * Propagates changed volume or pause settings of a channel to the
+	 * mixer callback.
+	 */
+	void notifyChannelChange(Channel *chan);
+
+	void postCommand(MixCommand::Type type, Channel *chan);
+	void processCommands();
+
+	/**
+	 * Takes ownership of the callback's state from the engine side,
+	 * waiting for a mixer callback in progress to finish.
+	 *
+	 * @return the epoch to pass to unlockMixState()
+	 */
+	uint32 lockMixState();
+	void unlockMixState(uint32 epoch);
+
+	/**
+	 * Waits for a mixer callback in progress to finish. Any callback
+	 * invoked afterwards sees all commands queued so far.
+	 */
+	void waitForMixCallback();
+	void reclaimFinishedChannels();
+
+	int mixCallbackLockFree(byte *samples, uint len);
+
+	/**
+	 * Mixes the given channels into the output buffer, in the current
+	 * output format.
+	 *
+	 * @param slots    the NUM_CHANNELS channel slots to mix
+	 * @param samples  output buffer
+	 * @param len      number of sample pairs to produce
+	 * @return number of sample pairs processed
+	 */
+	int mixChannels(const MixSlot *slots, byte *samples, uint len);
+
+	/**
+	 * Rounds wide samples to 16 bits with triangular dither, and clamps
+	 * them to the 16-bit range.
+	 */
+	void convertToS16(int16 *out, const st_wide_sample_t *in, uint samples);
+
+	/**
+	 * Converts wide samples to float, clamped to [-1.0, 1.0].
+	 */
+	void convertToFloat(float *out, const st_wide_sample_t *in, uint samples);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
 	 * the backend (e.g. from an audio mixing thread). All the actual mixing
 	 * work is done from here.
 	 *
-	 * @param samples Sample buffer, in which stereo 16-bit samples will be stored.
-	 * @param len Length of the provided buffer to fill (in bytes, should be divisible by 4).
+	 * @param samples Sample buffer, in which stereo samples in the format set
+	 *                by setOutputFormat() (16-bit by default) will be stored.
+	 * @param len Length of the provided buffer to fill (in bytes, should be
+	 *            divisible by the size of a sample pair, i.e. 4 for 16-bit
+	 *            samples and 8 for float samples).
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
 	int mixCallback(byte *samples, uint len);
@@ -139,6 +302,69 @@ public:
 	 * their audio system has been completed.
 	 */
 	void setReady(bool ready);
+
+	/**
+	 * Switch the mixer into (or out of) lock-free mode. This has to be done
+	 * before any sound is played.
+	 *
+	 * In lock-free mode, mixCallback() never locks the mixer mutex, never
+	 * waits for the engine side and never frees memory. Channel starts,
+	 * stops and volume changes are passed to it through a lock-free command
+	 * queue instead, and channels which finished playing are deleted on the
+	 * engine side the next time the mixer is accessed from there. Stopping
+	 * a channel waits for a mixer callback which is in progress at that
+	 * time to finish, so that the stream is not in use anymore when the
+	 * call returns.
+	 *
+	 * Backends enabling this mode should keep invoking mixCallback() at
+	 * regular intervals. If they stop doing so, e.g. while the audio device
+	 * is closed, the command queue is drained on the engine side once it
+	 * is full; a callback invoked during that short time produces silence.
+	 * On platforms without atomic operations the request is ignored.
+	 */
+	void setLockFree(bool lockFree);
+
+	/**
+	 * Query whether the mixer operates in lock-free mode.
+	 */
+	bool isLockFree() const { return _lockFree; }
+
+	/**
+	 * Set the resampling method used for sounds started afterwards.
+	 * Initially this is taken from the "resampling_quality" config key,
+	 * which may be "fast" (the default) or "high".
+	 */
+	void setRateConverterQuality(RateConverterQuality quality) { _rateConverterQuality = quality; }
+
+	/**
+	 * Set the sample format produced by mixCallback(). Backends have to
+	 * do this before they start invoking mixCallback().
+	 *
+	 * Float output is always mixed on the wide mix bus, see setWideMixBus().
+	 */
+	void setOutputFormat(OutputFormat format) { _outputFormat = format; }
+
+	/**
+	 * Query the sample format produced by mixCallback().
+	 */
+	OutputFormat getOutputFormat() const { return _outputFormat; }
+
+	/**
+	 * Choose whether the channels are summed up with 32-bit precision. By
+	 * default every channel is added with saturation directly to the 16-bit
+	 * output, so several loud channels playing at once get clipped one after
+	 * another. With the wide mix bus, clipping (and dithering) only happens
+	 * once when converting the sum to the output format.
+	 *
+	 * Initially this is taken from the "mixer_wide_bus" config key.
+	 */
+	void setWideMixBus(bool wide) { _wideMixBus = wide; }
+
+	/**
+	 * Query whether the channels are summed up with 32-bit precision.
+	 */
+	bool isWideMixBus() const { return _wideMixBus || _outputFormat == kOutputFormatFloat; }
+
 };
 
 
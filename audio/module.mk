@@ -57,7 +57,14 @@ MODULE_OBJS := \
 
 ifndef USE_ARM_SOUND_ASM
 MODULE_OBJS += \
-	rate.o
+	rate.o \
+	rate_avx2.o \
+	rate_sse2.o
+
+ifdef USE_NEON
+MODULE_OBJS += \
+	rate_neon.o
+endif
 else
 MODULE_OBJS += \
 	rate_arm.o \
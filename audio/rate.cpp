@@ -30,8 +30,10 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_intern.h"
 #include "audio/mixer.h"
 #include "common/frac.h"
+#include "common/math.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
@@ -46,6 +48,112 @@ namespace Audio {
  */
 #define INTERMEDIATE_BUFFER_SIZE 512
 
+/**
+ * The number of output sample pairs gathered by the rate converters before
+ * they are handed to the mixing kernels in one go.
+ */
+#define INTERMEDIATE_FRAMES (INTERMEDIATE_BUFFER_SIZE / 2)
+
+
+#pragma mark -
+
+
+/** Scale a sample by the volume and add it with saturation to the output. */
+static inline void mixSample(st_sample_t &out, int sample, st_volume_t vol) {
+	clampedAdd(out, (sample * (int)vol) / Audio::Mixer::kMaxMixerVolume);
+}
+
+/** Scale a sample by the volume and add it to the wide output. */
+static inline void mixSample(st_wide_sample_t &out, int sample, st_volume_t vol) {
+	out += sample * (int)vol;
+}
+
+template<typename T>
+static void mixStereoScalar(T *obuf, const st_sample_t *ibuf, st_size_t frames,
+                            st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const int left = reverseStereo ? 1 : 0;
+
+	for (; frames > 0; frames--) {
+		// output left channel
+		mixSample(obuf[left    ], ibuf[0], vol_l);
+
+		// output right channel
+		mixSample(obuf[left ^ 1], ibuf[1], vol_r);
+
+		obuf += 2;
+		ibuf += 2;
+	}
+}
+
+template<typename T>
+static void mixMonoScalar(T *obuf, const st_sample_t *ibuf, st_size_t frames,
+                          st_volume_t vol_l, st_volume_t vol_r) {
+	for (; frames > 0; frames--) {
+		mixSample(obuf[0], *ibuf, vol_l);
+		mixSample(obuf[1], *ibuf, vol_r);
+
+		obuf += 2;
+		ibuf++;
+	}
+}
+
+template<typename T>
+static void mixInterpolatedScalar(T *obuf, const st_sample_t *last, const st_sample_t *cur,
+                                  const frac_t *pos, st_size_t frames,
+                                  st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const int left = reverseStereo ? 1 : 0;
+
+	for (; frames > 0; frames--) {
+		// interpolate
+		st_sample_t out0, out1;
+		out0 = (st_sample_t)(last[0] + (((cur[0] - last[0]) * *pos + FRAC_HALF) >> FRAC_BITS));
+		out1 = (st_sample_t)(last[1] + (((cur[1] - last[1]) * *pos + FRAC_HALF) >> FRAC_BITS));
+
+		// output left channel
+		mixSample(obuf[left    ], out0, vol_l);
+
+		// output right channel
+		mixSample(obuf[left ^ 1], out1, vol_r);
+
+		obuf += 2;
+		last += 2;
+		cur += 2;
+		pos++;
+	}
+}
+
+const RateKernels g_rateKernelsScalar = {
+	"scalar",
+	mixStereoScalar<st_sample_t>,
+	mixMonoScalar<st_sample_t>,
+	mixInterpolatedScalar<st_sample_t>,
+	mixStereoScalar<st_wide_sample_t>,
+	mixMonoScalar<st_wide_sample_t>,
+	mixInterpolatedScalar<st_wide_sample_t>
+};
+
+const RateKernels &getRateKernels() {
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+#ifdef SCUMMVM_AVX2
+	if (Common::hasCpuFeature(Common::kCpuFeatureAVX2))
+		return g_rateKernelsAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCpuFeature(Common::kCpuFeatureSSE2))
+		return g_rateKernelsSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (Common::hasCpuFeature(Common::kCpuFeatureNEON))
+		return g_rateKernelsNEON;
+#endif
+#endif
+
+	return g_rateKernelsScalar;
+}
+
+
+#pragma mark -
+
 
 /**
  * Audio rate converter based on simple resampling. Used when no
@@ -56,10 +164,15 @@ namespace Audio {
 template<bool stereo, bool reverseStereo>
 class SimpleRateConverter : public RateConverter {
 protected:
+	const RateKernels &_kernels;
+
 	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** samples picked from the input, waiting to be mixed */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -67,9 +180,17 @@ protected:
 	/** fractional position increment in the output stream */
 	long opos_inc;
 
+	template<typename T>
+	int flowInto(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
 public:
-	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate, const RateKernels &kernels);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowInto(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, st_wide_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowInto(input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -80,7 +201,8 @@ public:
  * Prepare processing.
  */
 template<bool stereo, bool reverseStereo>
-SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate, st_rate_t outrate) {
+SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate, st_rate_t outrate, const RateKernels &kernels)
+	: _kernels(kernels) {
 	if ((inrate % outrate) != 0) {
 		error("Input rate must be a multiple of output rate to use rate effect");
 	}
@@ -102,44 +224,56 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
+template<typename T>
+int SimpleRateConverter<stereo, reverseStereo>::flowInto(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		const st_size_t maxFrames = MIN<st_size_t>((oend - obuf) / 2, INTERMEDIATE_FRAMES);
+		st_sample_t *out = outBuf;
+		st_size_t frames = 0;
+
+		while (frames < maxFrames) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (endOfInput)
+				break;
+
+			*out++ = *inPtr++;
+			if (stereo)
+				*out++ = *inPtr++;
 
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
-
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
+			frames++;
+		}
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		if (stereo)
+			mixStereo(_kernels, obuf, outBuf, frames, vol_l, vol_r, reverseStereo);
+		else
+			mixMono(_kernels, obuf, outBuf, frames, vol_l, vol_r);
 
-		obuf += 2;
+		obuf += frames * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -158,6 +292,8 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 template<bool stereo, bool reverseStereo>
 class LinearRateConverter : public RateConverter {
 protected:
+	const RateKernels &_kernels;
+
 	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
 	const st_sample_t *inPtr;
 	int inLen;
@@ -173,9 +309,22 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolation inputs for each output sample pair, waiting to be mixed */
+	st_sample_t lastBuf[INTERMEDIATE_BUFFER_SIZE];
+	st_sample_t curBuf[INTERMEDIATE_BUFFER_SIZE];
+	frac_t posBuf[INTERMEDIATE_FRAMES];
+
+	template<typename T>
+	int flowInto(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
 public:
-	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	LinearRateConverter(st_rate_t inrate, st_rate_t outrate, const RateKernels &kernels);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowInto(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, st_wide_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowInto(input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -186,7 +335,8 @@ public:
  * Prepare processing.
  */
 template<bool stereo, bool reverseStereo>
-LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate, st_rate_t outrate) {
+LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate, st_rate_t outrate, const RateKernels &kernels)
+	: _kernels(kernels) {
 	if (inrate >= 65536 || outrate >= 65536) {
 		error("rate effect can only handle rates < 65536");
 	}
@@ -211,54 +361,333 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
+template<typename T>
+int LinearRateConverter<stereo, reverseStereo>::flowInto(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		const st_size_t maxFrames = MIN<st_size_t>((oend - obuf) / 2, INTERMEDIATE_FRAMES);
+		st_size_t frames = 0;
+
+		while (frames < maxFrames) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+
+			if (endOfInput)
+				break;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the output buffer. The actual interpolation is
+			// done by the mixing kernel.
+			while (opos < (frac_t)FRAC_ONE && frames < maxFrames) {
+				lastBuf[frames * 2    ] = ilast0;
+				lastBuf[frames * 2 + 1] = (stereo ? ilast1 : ilast0);
+				curBuf[frames * 2    ] = icur0;
+				curBuf[frames * 2 + 1] = (stereo ? icur1 : icur0);
+				posBuf[frames] = opos;
+				frames++;
+
+				// Increment output position
+				opos += opos_inc;
 			}
-			opos -= FRAC_ONE;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF) >> FRAC_BITS));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF) >> FRAC_BITS)) :
-						  out0);
+		mixInterpolated(_kernels, obuf, lastBuf, curBuf, posBuf, frames, vol_l, vol_r, reverseStereo);
+		obuf += frames * 2;
+	}
+	return (obuf - ostart) / 2;
+}
+
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+#pragma mark -
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
 
-			obuf += 2;
+/**
+ * The number of input samples each output sample of the SincRateConverter
+ * is computed from.
+ */
+#define SINC_TAPS 32
 
-			// Increment output position
-			opos += opos_inc;
+/**
+ * The number of fractional positions between two input samples for which
+ * the SincRateConverter filter is precomputed. Output positions are rounded
+ * to the nearest of them.
+ */
+#define SINC_PHASES 256
+
+/** The fixed point precision of the SincRateConverter filter coefficients. */
+#define SINC_COEF_BITS 14
+
+/**
+ * The cutoff frequency of the SincRateConverter filter, relative to the
+ * lower one of the input and output sampling frequency. Set somewhat below
+ * the Nyquist frequency (0.5) to leave room for the transition band.
+ */
+#define SINC_CUTOFF 0.43
+
+/** The Kaiser window shape parameter, trading transition width for stopband attenuation. */
+#define SINC_KAISER_BETA 7.0
+
+/**
+ * A bank of windowed sinc filters, one for each of the SINC_PHASES (+1 for
+ * the position right on the next input sample) fractional output positions.
+ * The coefficients of each filter add up to 1 << SINC_COEF_BITS.
+ */
+struct SincFilterBank {
+	int16 coefs[SINC_PHASES + 1][SINC_TAPS];
+
+	explicit SincFilterBank(double cutoff);
+};
+
+/** Zeroth order modified Bessel function of the first kind, used for the Kaiser window. */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+SincFilterBank::SincFilterBank(double cutoff) {
+	const double halfWidth = SINC_TAPS / 2;
+	const double norm = besselI0(SINC_KAISER_BETA);
+	double filter[SINC_TAPS];
+
+	for (int phase = 0; phase <= SINC_PHASES; phase++) {
+		double sum = 0.0;
+		for (int tap = 0; tap < SINC_TAPS; tap++) {
+			// Distance from the output position, which lies between tap
+			// SINC_TAPS / 2 - 1 and the following one.
+			const double x = tap - (SINC_TAPS / 2 - 1) - (double)phase / SINC_PHASES;
+			const double t = 2 * cutoff * x;
+			const double sinc = (t == 0.0) ? 1.0 : sin(M_PI * t) / (M_PI * t);
+			const double w = x / halfWidth;
+			const double window = (w * w >= 1.0) ? 0.0 : besselI0(SINC_KAISER_BETA * sqrt(1.0 - w * w)) / norm;
+
+			filter[tap] = sinc * window;
+			sum += filter[tap];
 		}
+
+		// Normalize to unity gain, and assign the rounding error to the
+		// center tap so that DC is passed through unchanged.
+		int total = 0, center = (phase * 2 < SINC_PHASES) ? SINC_TAPS / 2 - 1 : SINC_TAPS / 2;
+		for (int tap = 0; tap < SINC_TAPS; tap++) {
+			coefs[phase][tap] = (int16)floor(filter[tap] / sum * (1 << SINC_COEF_BITS) + 0.5);
+			total += coefs[phase][tap];
+		}
+		coefs[phase][center] += (1 << SINC_COEF_BITS) - total;
+	}
+}
+
+/**
+ * Get the filter bank for converting from inrate to outrate. The banks for
+ * upsampling and for halving the rate do not depend on the actual rates,
+ * and are shared by all converters. Any other bank is created for the
+ * converter and returned in ownBank as well, so it can free it.
+ */
+static const SincFilterBank *getSincFilterBank(st_rate_t inrate, st_rate_t outrate, SincFilterBank *&ownBank) {
+	ownBank = 0;
+
+	if (outrate >= inrate) {
+		static const SincFilterBank upsampling(SINC_CUTOFF);
+		return &upsampling;
+	} else if (outrate * 2 == inrate) {
+		static const SincFilterBank halving(SINC_CUTOFF / 2);
+		return &halving;
+	}
+
+	ownBank = new SincFilterBank(SINC_CUTOFF * outrate / inrate);
+	return ownBank;
+}
+
+/**
+ * Audio rate converter based on a polyphase windowed sinc filter. Slower
+ * than LinearRateConverter, but without its audible aliasing when upsampling
+ * low rate samples.
+ *
+ * Limited to sampling frequency <= 65535 Hz.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	const RateKernels &_kernels;
+	const SincFilterBank *_bank;
+	SincFilterBank *_ownBank;
+
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+	const st_sample_t *inPtr;
+	int inLen;
+
+	/** fractional position of the output stream in input stream unit */
+	frac_t opos;
+
+	/** fractional position increment in the output stream */
+	frac_t opos_inc;
+
+	/**
+	 * The last SINC_TAPS input samples of each channel. Every sample is
+	 * stored twice, SINC_TAPS entries apart, so the filter window can
+	 * always be read contiguously starting at histPos.
+	 */
+	st_sample_t history[2][SINC_TAPS * 2];
+	int histPos;
+
+	/**
+	 * The number of silent samples still to be fed into the filter after
+	 * the input stream ended, so its last samples leave the filter delay
+	 * line. Negative as long as the input has not ended.
+	 */
+	int flushLen;
+
+	/** filtered samples, waiting to be mixed */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	st_sample_t filter(const st_sample_t *window, const int16 *coefs) const {
+		int32 acc = 1 << (SINC_COEF_BITS - 1);
+		for (int i = 0; i < SINC_TAPS; i++)
+			acc += window[i] * coefs[i];
+		acc >>= SINC_COEF_BITS;
+		return (st_sample_t)CLIP<int32>(acc, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+
+	template<typename T>
+	int flowInto(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate, const RateKernels &kernels);
+	~SincRateConverter() { delete _ownBank; }
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowInto(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, st_wide_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowInto(input, obuf, osamp, vol_l, vol_r);
+	}
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+/*
+ * Prepare processing.
+ */
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate, const RateKernels &kernels)
+	: _kernels(kernels) {
+	if (inrate >= 65536 || outrate >= 65536) {
+		error("rate effect can only handle rates < 65536");
+	}
+
+	_bank = getSincFilterBank(inrate, outrate, _ownBank);
+
+	opos = FRAC_ONE;
+	opos_inc = (inrate << FRAC_BITS) / outrate;
+
+	memset(history, 0, sizeof(history));
+	histPos = 0;
+	flushLen = -1;
+
+	inLen = 0;
+}
+
+/*
+ * Processed signed long samples from ibuf to obuf.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+template<typename T>
+int SincRateConverter<stereo, reverseStereo>::flowInto(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		const st_size_t maxFrames = MIN<st_size_t>((oend - obuf) / 2, INTERMEDIATE_FRAMES);
+		st_sample_t *out = outBuf;
+		st_size_t frames = 0;
+
+		while (frames < maxFrames) {
+			// read enough input samples so that opos < FRAC_ONE
+			while ((frac_t)FRAC_ONE <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0 && flushLen < 0) {
+					inPtr = inBuf;
+					inLen = MAX(input.readBuffer(inBuf, ARRAYSIZE(inBuf)), 0);
+
+					// Once the stream ended, its last samples are still
+					// in the delay line, so push them out with silence
+					if (inLen == 0 && input.endOfStream())
+						flushLen = SINC_TAPS / 2;
+				}
+
+				st_sample_t left = 0, right = 0;
+				if (inLen > 0) {
+					inLen -= (stereo ? 2 : 1);
+					left = *inPtr++;
+					if (stereo)
+						right = *inPtr++;
+				} else if (flushLen > 0) {
+					flushLen--;
+				} else {
+					endOfInput = true;
+					break;
+				}
+
+				history[0][histPos] = history[0][histPos + SINC_TAPS] = left;
+				if (stereo)
+					history[1][histPos] = history[1][histPos + SINC_TAPS] = right;
+				histPos = (histPos + 1) % SINC_TAPS;
+				opos -= FRAC_ONE;
+			}
+
+			if (endOfInput)
+				break;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the output buffer.
+			while (opos < (frac_t)FRAC_ONE && frames < maxFrames) {
+				const int16 *coefs = _bank->coefs[(opos * SINC_PHASES + FRAC_HALF) >> FRAC_BITS];
+
+				*out++ = filter(&history[0][histPos], coefs);
+				if (stereo)
+					*out++ = filter(&history[1][histPos], coefs);
+				frames++;
+
+				// Increment output position
+				opos += opos_inc;
+			}
+		}
+
+		if (stereo)
+			mixStereo(_kernels, obuf, outBuf, frames, vol_l, vol_r, reverseStereo);
+		else
+			mixMono(_kernels, obuf, outBuf, frames, vol_l, vol_r);
+
+		obuf += frames * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -272,22 +701,16 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
  */
 template<bool stereo, bool reverseStereo>
 class CopyRateConverter : public RateConverter {
+	const RateKernels &_kernels;
 	st_sample_t *_buffer;
 	st_size_t _bufferSize;
-public:
-	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
-	~CopyRateConverter() {
-		free(_buffer);
-	}
 
-	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	template<typename T>
+	int flowInto(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -305,21 +728,27 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
+		if (stereo) {
+			len /= 2;
+			mixStereo(_kernels, obuf, _buffer, len, vol_l, vol_r, reverseStereo);
+		} else {
+			mixMono(_kernels, obuf, _buffer, len, vol_l, vol_r);
+		}
+		return len;
+	}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+public:
+	CopyRateConverter(const RateKernels &kernels) : _kernels(kernels), _buffer(0), _bufferSize(0) {}
+	~CopyRateConverter() {
+		free(_buffer);
+	}
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowInto(input, obuf, osamp, vol_l, vol_r);
+	}
 
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+	virtual int flow(AudioStream &input, st_wide_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowInto(input, obuf, osamp, vol_l, vol_r);
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -331,29 +760,35 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, RateConverterQuality quality, const RateKernels &kernels) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0) {
-			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
+		if (quality == kRateConverterHighQuality) {
+			return new SincRateConverter<stereo, reverseStereo>(inrate, outrate, kernels);
+		} else if ((inrate % outrate) == 0) {
+			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate, kernels);
 		} else {
-			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
+			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate, kernels);
 		}
 	} else {
-		return new CopyRateConverter<stereo, reverseStereo>();
+		return new CopyRateConverter<stereo, reverseStereo>(kernels);
 	}
 }
 
-/**
- * Create and return a RateConverter object for the specified input and output rates.
- */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality, const RateKernels &kernels) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, quality, kernels);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, quality, kernels);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, quality, kernels);
+}
+
+/**
+ * Create and return a RateConverter object for the specified input and output rates.
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
+	return makeRateConverter(inrate, outrate, stereo, reverseStereo, quality, getRateKernels());
 }
 
 } // End of namespace Audio
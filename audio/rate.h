@@ -30,6 +30,7 @@ namespace Audio {
 class AudioStream;
 
 typedef int16 st_sample_t;
+typedef int32 st_wide_sample_t;
 typedef uint16 st_volume_t;
 typedef uint32 st_size_t;
 typedef uint32 st_rate_t;
@@ -75,10 +76,31 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Like the above, but adds to a buffer of wide samples without any
+	 * saturation. The samples are scaled by the volume without dividing
+	 * by Mixer::kMaxMixerVolume afterwards, so they have 8 more bits of
+	 * precision than st_sample_t.
+	 *
+	 * @return Number of sample pairs written into the buffer.
+	 */
+	virtual int flow(AudioStream &input, st_wide_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * The resampling method used by a RateConverter.
+ */
+enum RateConverterQuality {
+	/** Nearest neighbour or linear interpolation, depending on the rates */
+	kRateConverterFast,
+	/** Polyphase windowed sinc filter, avoids aliasing at a higher CPU cost */
+	kRateConverterHighQuality
+};
+
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false,
+                                 RateConverterQuality quality = kRateConverterFast);
 
 } // End of namespace Audio
 
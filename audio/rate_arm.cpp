@@ -68,6 +68,42 @@ namespace Audio {
  */
 #define INTERMEDIATE_BUFFER_SIZE 512
 
+/**
+ * Implementation of RateConverter::flow for wide samples. The assembler
+ * routines only handle 16-bit output, so convert into a temporary buffer
+ * and widen the result.
+ */
+static int flowWidened(RateConverter &converter, AudioStream &input, st_wide_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t buffer[INTERMEDIATE_BUFFER_SIZE];
+	int written = 0;
+
+	while (osamp > 0) {
+		const st_size_t frames = MIN<st_size_t>(osamp, INTERMEDIATE_BUFFER_SIZE / 2);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		for (st_size_t i = 0; i < frames * 2; i++)
+			buffer[i] = (st_sample_t)0x8000;
+#else
+		memset(buffer, 0, frames * 2 * sizeof(st_sample_t));
+#endif
+
+		const int len = converter.flow(input, buffer, frames, vol_l, vol_r);
+		for (int i = 0; i < len * 2; i++) {
+#ifdef OUTPUT_UNSIGNED_AUDIO
+			*obuf++ += (st_wide_sample_t)(st_sample_t)(buffer[i] ^ 0x8000) << 8;
+#else
+			*obuf++ += (st_wide_sample_t)buffer[i] << 8;
+#endif
+		}
+
+		written += len;
+		if ((st_size_t)len < frames)
+			break;
+		osamp -= frames;
+	}
+
+	return written;
+}
+
 
 /**
  * Audio rate converter based on simple resampling. Used when no
@@ -96,6 +132,9 @@ protected:
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, st_wide_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowWidened(*this, input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
@@ -270,6 +309,9 @@ protected:
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, st_wide_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowWidened(*this, input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
@@ -389,6 +431,10 @@ public:
 		free(_buffer);
 	}
 
+	virtual int flow(AudioStream &input, st_wide_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowWidened(*this, input, obuf, osamp, vol_l, vol_r);
+	}
+
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
@@ -436,7 +482,9 @@ public:
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
+	// There is no ARM version of the windowed sinc converter, so the quality
+	// setting is ignored.
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0) {
 			if (stereo) {
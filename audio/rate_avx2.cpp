@@ -0,0 +1,169 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_intern.h"
+
+#if defined(SCUMMVM_AVX2) && !defined(OUTPUT_UNSIGNED_AUDIO)
+
+#include <immintrin.h>
+
+namespace Audio {
+
+/**
+ * Divide 32-bit products by Mixer::kMaxMixerVolume (256), rounding towards
+ * zero like the C++ division operator does.
+ */
+SCUMMVM_TARGET_AVX2 static inline __m256i divideByMaxVolume(__m256i v) {
+	const __m256i bias = _mm256_and_si256(_mm256_srai_epi32(v, 31), _mm256_set1_epi32(255));
+	return _mm256_srai_epi32(_mm256_add_epi32(v, bias), 8);
+}
+
+/**
+ * Scale 16 samples by the volumes in vol and add them with saturation to
+ * the 16 samples at obuf.
+ */
+SCUMMVM_TARGET_AVX2 static inline void mixVolume(st_sample_t *obuf, __m256i in, __m256i vol) {
+	const __m256i lo = _mm256_mullo_epi16(in, vol);
+	const __m256i hi = _mm256_mulhi_epi16(in, vol);
+
+	// Unpacking and packing both work within 128-bit lanes, so the sample
+	// order is preserved.
+	const __m256i prod0 = divideByMaxVolume(_mm256_unpacklo_epi16(lo, hi));
+	const __m256i prod1 = divideByMaxVolume(_mm256_unpackhi_epi16(lo, hi));
+
+	const __m256i out = _mm256_loadu_si256((const __m256i *)obuf);
+	_mm256_storeu_si256((__m256i *)obuf, _mm256_adds_epi16(out, _mm256_packs_epi32(prod0, prod1)));
+}
+
+/**
+ * Scale 16 samples by the volumes in vol and add them to the 16 wide
+ * samples at obuf.
+ */
+SCUMMVM_TARGET_AVX2 static inline void mixVolume(st_wide_sample_t *obuf, __m256i in, __m256i vol) {
+	const __m256i lo = _mm256_mullo_epi16(in, vol);
+	const __m256i hi = _mm256_mulhi_epi16(in, vol);
+
+	// Unpacking works within 128-bit lanes, so prod0 holds samples 0-3 and
+	// 8-11, prod1 samples 4-7 and 12-15.
+	const __m256i prod0 = _mm256_unpacklo_epi16(lo, hi);
+	const __m256i prod1 = _mm256_unpackhi_epi16(lo, hi);
+
+	const __m256i out0 = _mm256_loadu_si256((const __m256i *)obuf);
+	const __m256i out1 = _mm256_loadu_si256((const __m256i *)(obuf + 8));
+	_mm256_storeu_si256((__m256i *)obuf, _mm256_add_epi32(out0, _mm256_permute2x128_si256(prod0, prod1, 0x20)));
+	_mm256_storeu_si256((__m256i *)(obuf + 8), _mm256_add_epi32(out1, _mm256_permute2x128_si256(prod0, prod1, 0x31)));
+}
+
+SCUMMVM_TARGET_AVX2 static inline __m256i swapStereo(__m256i v) {
+	return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+SCUMMVM_TARGET_AVX2 static inline __m256i stereoVolume(st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	if (reverseStereo)
+		return _mm256_set1_epi32((vol_l << 16) | vol_r);
+	else
+		return _mm256_set1_epi32((vol_r << 16) | vol_l);
+}
+
+/**
+ * Interpolate 8 samples (4 frames) and return them as 32-bit integers,
+ * truncated to 16 bits like a cast to st_sample_t does.
+ */
+SCUMMVM_TARGET_AVX2 static inline __m256i interpolate(const st_sample_t *last, const st_sample_t *cur, const frac_t *pos) {
+	const __m256i l = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)last));
+	const __m256i c = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)cur));
+	__m256i p = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)pos));
+	p = _mm256_or_si256(p, _mm256_slli_epi64(p, 32));
+
+	__m256i v = _mm256_mullo_epi32(_mm256_sub_epi32(c, l), p);
+	v = _mm256_srai_epi32(_mm256_add_epi32(v, _mm256_set1_epi32(FRAC_HALF)), FRAC_BITS);
+	v = _mm256_add_epi32(l, v);
+	return _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+}
+
+template<typename T>
+SCUMMVM_TARGET_AVX2 static void mixStereoAVX2(T *obuf, const st_sample_t *ibuf, st_size_t frames,
+                                              st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const st_size_t simdFrames = frames & ~7;
+	const __m256i vol = stereoVolume(vol_l, vol_r, reverseStereo);
+
+	for (st_size_t i = 0; i < simdFrames; i += 8) {
+		__m256i in = _mm256_loadu_si256((const __m256i *)(ibuf + i * 2));
+		if (reverseStereo)
+			in = swapStereo(in);
+		mixVolume(obuf + i * 2, in, vol);
+	}
+
+	mixStereo(g_rateKernelsScalar, obuf + simdFrames * 2, ibuf + simdFrames * 2, frames - simdFrames, vol_l, vol_r, reverseStereo);
+}
+
+template<typename T>
+SCUMMVM_TARGET_AVX2 static void mixMonoAVX2(T *obuf, const st_sample_t *ibuf, st_size_t frames,
+                                            st_volume_t vol_l, st_volume_t vol_r) {
+	const st_size_t simdFrames = frames & ~7;
+	const __m256i vol = stereoVolume(vol_l, vol_r, false);
+
+	for (st_size_t i = 0; i < simdFrames; i += 8) {
+		// Duplicate each sample into both halves of a 32-bit lane
+		const __m256i in = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(ibuf + i)));
+		mixVolume(obuf + i * 2, _mm256_or_si256(in, _mm256_slli_epi32(in, 16)), vol);
+	}
+
+	mixMono(g_rateKernelsScalar, obuf + simdFrames * 2, ibuf + simdFrames, frames - simdFrames, vol_l, vol_r);
+}
+
+template<typename T>
+SCUMMVM_TARGET_AVX2 static void mixInterpolatedAVX2(T *obuf, const st_sample_t *last, const st_sample_t *cur,
+                                                    const frac_t *pos, st_size_t frames,
+                                                    st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const st_size_t simdFrames = frames & ~7;
+	const __m256i vol = stereoVolume(vol_l, vol_r, reverseStereo);
+
+	for (st_size_t i = 0; i < simdFrames; i += 8) {
+		const __m256i v0 = interpolate(last + i * 2, cur + i * 2, pos + i);
+		const __m256i v1 = interpolate(last + i * 2 + 8, cur + i * 2 + 8, pos + i + 4);
+
+		// Packing interleaves the 128-bit lanes of both vectors, restore
+		// the sample order.
+		__m256i in = _mm256_permute4x64_epi64(_mm256_packs_epi32(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+		if (reverseStereo)
+			in = swapStereo(in);
+		mixVolume(obuf + i * 2, in, vol);
+	}
+
+	mixInterpolated(g_rateKernelsScalar, obuf + simdFrames * 2, last + simdFrames * 2, cur + simdFrames * 2, pos + simdFrames,
+	                frames - simdFrames, vol_l, vol_r, reverseStereo);
+}
+
+const RateKernels g_rateKernelsAVX2 = {
+	"avx2",
+	mixStereoAVX2<st_sample_t>,
+	mixMonoAVX2<st_sample_t>,
+	mixInterpolatedAVX2<st_sample_t>,
+	mixStereoAVX2<st_wide_sample_t>,
+	mixMonoAVX2<st_wide_sample_t>,
+	mixInterpolatedAVX2<st_wide_sample_t>
+};
+
+} // End of namespace Audio
+
+#endif
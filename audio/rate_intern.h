@@ -0,0 +1,167 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_RATE_INTERN_H
+#define AUDIO_RATE_INTERN_H
+
+#include "common/scummsys.h"
+#include "common/cpudetect.h"
+#include "common/frac.h"
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * The inner loops of the rate converters, which scale samples by the channel
+ * volume and add them with saturation to the mixer output buffer.
+ *
+ * Each kernel also comes in a wide variant, which adds into a buffer of
+ * 32-bit samples without saturation. Those samples are not divided by
+ * Mixer::kMaxMixerVolume, i.e. they carry 8 additional fractional bits.
+ *
+ * Besides the plain C++ implementation, there are SIMD implementations for
+ * the instruction set extensions supported by the compiler. All of them
+ * produce bit-identical output; getRateKernels() selects the fastest one the
+ * CPU supports at run time.
+ */
+struct RateKernels {
+	const char *name;
+
+	/**
+	 * Mix interleaved stereo frames into the output buffer.
+	 *
+	 * @param obuf          output buffer, receiving 2 * frames samples
+	 * @param ibuf          input buffer, holding 2 * frames samples
+	 * @param frames        number of sample pairs to mix
+	 * @param vol_l         volume for the left channel
+	 * @param vol_r         volume for the right channel
+	 * @param reverseStereo whether left and right channels are swapped
+	 */
+	void (*mixStereo)(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames,
+	                  st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo);
+
+	/**
+	 * Mix mono samples into both channels of the output buffer.
+	 *
+	 * @param obuf   output buffer, receiving 2 * frames samples
+	 * @param ibuf   input buffer, holding frames samples
+	 * @param frames number of samples to mix
+	 * @param vol_l  volume for the left channel
+	 * @param vol_r  volume for the right channel
+	 */
+	void (*mixMono)(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames,
+	                st_volume_t vol_l, st_volume_t vol_r);
+
+	/**
+	 * Linearly interpolate between two sets of interleaved stereo frames
+	 * and mix the result into the output buffer.
+	 *
+	 * @param obuf          output buffer, receiving 2 * frames samples
+	 * @param last          samples preceding the output positions
+	 * @param cur           samples following the output positions
+	 * @param pos           fractional output position for each frame,
+	 *                      in the range [0, FRAC_ONE)
+	 * @param frames        number of sample pairs to mix
+	 * @param vol_l         volume for the left channel
+	 * @param vol_r         volume for the right channel
+	 * @param reverseStereo whether left and right channels are swapped
+	 */
+	void (*mixInterpolated)(st_sample_t *obuf, const st_sample_t *last, const st_sample_t *cur,
+	                        const frac_t *pos, st_size_t frames,
+	                        st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo);
+
+	/** Wide variant of mixStereo(). */
+	void (*mixStereoWide)(st_wide_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames,
+	                      st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo);
+
+	/** Wide variant of mixMono(). */
+	void (*mixMonoWide)(st_wide_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames,
+	                    st_volume_t vol_l, st_volume_t vol_r);
+
+	/** Wide variant of mixInterpolated(). */
+	void (*mixInterpolatedWide)(st_wide_sample_t *obuf, const st_sample_t *last, const st_sample_t *cur,
+	                            const frac_t *pos, st_size_t frames,
+	                            st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo);
+};
+
+/*
+ * Overloads selecting the narrow or wide kernel by the output buffer type,
+ * for code which is templated on it.
+ */
+
+inline void mixStereo(const RateKernels &kernels, st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames,
+                      st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	kernels.mixStereo(obuf, ibuf, frames, vol_l, vol_r, reverseStereo);
+}
+
+inline void mixStereo(const RateKernels &kernels, st_wide_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames,
+                      st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	kernels.mixStereoWide(obuf, ibuf, frames, vol_l, vol_r, reverseStereo);
+}
+
+inline void mixMono(const RateKernels &kernels, st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames,
+                    st_volume_t vol_l, st_volume_t vol_r) {
+	kernels.mixMono(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+inline void mixMono(const RateKernels &kernels, st_wide_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames,
+                    st_volume_t vol_l, st_volume_t vol_r) {
+	kernels.mixMonoWide(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+inline void mixInterpolated(const RateKernels &kernels, st_sample_t *obuf, const st_sample_t *last, const st_sample_t *cur,
+                            const frac_t *pos, st_size_t frames,
+                            st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	kernels.mixInterpolated(obuf, last, cur, pos, frames, vol_l, vol_r, reverseStereo);
+}
+
+inline void mixInterpolated(const RateKernels &kernels, st_wide_sample_t *obuf, const st_sample_t *last, const st_sample_t *cur,
+                            const frac_t *pos, st_size_t frames,
+                            st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	kernels.mixInterpolatedWide(obuf, last, cur, pos, frames, vol_l, vol_r, reverseStereo);
+}
+
+extern const RateKernels g_rateKernelsScalar;
+#if defined(SCUMMVM_SSE2) && !defined(OUTPUT_UNSIGNED_AUDIO)
+extern const RateKernels g_rateKernelsSSE2;
+#endif
+#if defined(SCUMMVM_AVX2) && !defined(OUTPUT_UNSIGNED_AUDIO)
+extern const RateKernels g_rateKernelsAVX2;
+#endif
+#if defined(SCUMMVM_NEON) && !defined(OUTPUT_UNSIGNED_AUDIO)
+extern const RateKernels g_rateKernelsNEON;
+#endif
+
+/**
+ * Returns the fastest set of kernels supported by the CPU.
+ */
+const RateKernels &getRateKernels();
+
+/**
+ * Create a RateConverter using the given set of kernels.
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo,
+                                 RateConverterQuality quality, const RateKernels &kernels);
+
+} // End of namespace Audio
+
+#endif
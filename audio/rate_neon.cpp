@@ -0,0 +1,145 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_intern.h"
+
+#if defined(SCUMMVM_NEON) && !defined(OUTPUT_UNSIGNED_AUDIO)
+
+#include <arm_neon.h>
+
+namespace Audio {
+
+/**
+ * Divide 32-bit products by Mixer::kMaxMixerVolume (256), rounding towards
+ * zero like the C++ division operator does.
+ */
+static inline int32x4_t divideByMaxVolume(int32x4_t v) {
+	const int32x4_t bias = vandq_s32(vshrq_n_s32(v, 31), vdupq_n_s32(255));
+	return vshrq_n_s32(vaddq_s32(v, bias), 8);
+}
+
+/**
+ * Scale 8 samples by the volumes in vol and add them with saturation to the
+ * 8 samples at obuf.
+ */
+static inline void mixVolume(st_sample_t *obuf, int16x8_t in, int16x4_t vol) {
+	const int32x4_t prod0 = divideByMaxVolume(vmull_s16(vget_low_s16(in), vol));
+	const int32x4_t prod1 = divideByMaxVolume(vmull_s16(vget_high_s16(in), vol));
+
+	// The quotients always fit into 16 bits, the saturation happens when
+	// adding them to the output.
+	const int16x8_t out = vld1q_s16(obuf);
+	vst1q_s16(obuf, vqaddq_s16(out, vcombine_s16(vmovn_s32(prod0), vmovn_s32(prod1))));
+}
+
+/**
+ * Scale 8 samples by the volumes in vol and add them to the 8 wide samples
+ * at obuf.
+ */
+static inline void mixVolume(st_wide_sample_t *obuf, int16x8_t in, int16x4_t vol) {
+	vst1q_s32(obuf, vmlal_s16(vld1q_s32(obuf), vget_low_s16(in), vol));
+	vst1q_s32(obuf + 4, vmlal_s16(vld1q_s32(obuf + 4), vget_high_s16(in), vol));
+}
+
+static inline int16x4_t stereoVolume(st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const int16x4_t l = vdup_n_s16(vol_l);
+	const int16x4_t r = vdup_n_s16(vol_r);
+	return reverseStereo ? vzip_s16(r, l).val[0] : vzip_s16(l, r).val[0];
+}
+
+/**
+ * Interpolate 4 samples (2 frames), truncated to 16 bits like a cast to
+ * st_sample_t does.
+ */
+static inline int16x4_t interpolate(const st_sample_t *last, const st_sample_t *cur, const frac_t *pos) {
+	const int32x4_t l = vmovl_s16(vld1_s16(last));
+	const int32x4_t c = vmovl_s16(vld1_s16(cur));
+	const int32x2_t p = vld1_s32(pos);
+
+	int32x4_t v = vmulq_s32(vsubq_s32(c, l), vcombine_s32(vdup_lane_s32(p, 0), vdup_lane_s32(p, 1)));
+	v = vshrq_n_s32(vaddq_s32(v, vdupq_n_s32(FRAC_HALF)), FRAC_BITS);
+	return vmovn_s32(vaddq_s32(l, v));
+}
+
+template<typename T>
+static void mixStereoNEON(T *obuf, const st_sample_t *ibuf, st_size_t frames,
+                          st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const st_size_t simdFrames = frames & ~3;
+	const int16x4_t vol = stereoVolume(vol_l, vol_r, reverseStereo);
+
+	for (st_size_t i = 0; i < simdFrames; i += 4) {
+		int16x8_t in = vld1q_s16(ibuf + i * 2);
+		if (reverseStereo)
+			in = vrev32q_s16(in);
+		mixVolume(obuf + i * 2, in, vol);
+	}
+
+	mixStereo(g_rateKernelsScalar, obuf + simdFrames * 2, ibuf + simdFrames * 2, frames - simdFrames, vol_l, vol_r, reverseStereo);
+}
+
+template<typename T>
+static void mixMonoNEON(T *obuf, const st_sample_t *ibuf, st_size_t frames,
+                        st_volume_t vol_l, st_volume_t vol_r) {
+	const st_size_t simdFrames = frames & ~3;
+	const int16x4_t vol = stereoVolume(vol_l, vol_r, false);
+
+	for (st_size_t i = 0; i < simdFrames; i += 4) {
+		const int16x4_t in = vld1_s16(ibuf + i);
+		const int16x4x2_t dup = vzip_s16(in, in);
+		mixVolume(obuf + i * 2, vcombine_s16(dup.val[0], dup.val[1]), vol);
+	}
+
+	mixMono(g_rateKernelsScalar, obuf + simdFrames * 2, ibuf + simdFrames, frames - simdFrames, vol_l, vol_r);
+}
+
+template<typename T>
+static void mixInterpolatedNEON(T *obuf, const st_sample_t *last, const st_sample_t *cur,
+                                const frac_t *pos, st_size_t frames,
+                                st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const st_size_t simdFrames = frames & ~3;
+	const int16x4_t vol = stereoVolume(vol_l, vol_r, reverseStereo);
+
+	for (st_size_t i = 0; i < simdFrames; i += 4) {
+		int16x8_t in = vcombine_s16(interpolate(last + i * 2, cur + i * 2, pos + i),
+		                            interpolate(last + i * 2 + 4, cur + i * 2 + 4, pos + i + 2));
+		if (reverseStereo)
+			in = vrev32q_s16(in);
+		mixVolume(obuf + i * 2, in, vol);
+	}
+
+	mixInterpolated(g_rateKernelsScalar, obuf + simdFrames * 2, last + simdFrames * 2, cur + simdFrames * 2, pos + simdFrames,
+	                frames - simdFrames, vol_l, vol_r, reverseStereo);
+}
+
+const RateKernels g_rateKernelsNEON = {
+	"neon",
+	mixStereoNEON<st_sample_t>,
+	mixMonoNEON<st_sample_t>,
+	mixInterpolatedNEON<st_sample_t>,
+	mixStereoNEON<st_wide_sample_t>,
+	mixMonoNEON<st_wide_sample_t>,
+	mixInterpolatedNEON<st_wide_sample_t>
+};
+
+} // End of namespace Audio
+
+#endif
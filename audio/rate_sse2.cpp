@@ -0,0 +1,169 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_intern.h"
+
+#if defined(SCUMMVM_SSE2) && !defined(OUTPUT_UNSIGNED_AUDIO)
+
+#include <emmintrin.h>
+
+namespace Audio {
+
+/**
+ * Emulate _mm_mullo_epi32 (SSE4.1): multiply packed 32-bit integers,
+ * keeping the low 32 bits of each product.
+ */
+SCUMMVM_TARGET_SSE2 static inline __m128i mullo32(__m128i a, __m128i b) {
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+	                          _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/**
+ * Divide 32-bit products by Mixer::kMaxMixerVolume (256), rounding towards
+ * zero like the C++ division operator does.
+ */
+SCUMMVM_TARGET_SSE2 static inline __m128i divideByMaxVolume(__m128i v) {
+	const __m128i bias = _mm_and_si128(_mm_srai_epi32(v, 31), _mm_set1_epi32(255));
+	return _mm_srai_epi32(_mm_add_epi32(v, bias), 8);
+}
+
+/**
+ * Scale 8 samples by the volumes in vol and add them with saturation to the
+ * 8 samples at obuf.
+ */
+SCUMMVM_TARGET_SSE2 static inline void mixVolume(st_sample_t *obuf, __m128i in, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(in, vol);
+	const __m128i hi = _mm_mulhi_epi16(in, vol);
+	const __m128i prod0 = divideByMaxVolume(_mm_unpacklo_epi16(lo, hi));
+	const __m128i prod1 = divideByMaxVolume(_mm_unpackhi_epi16(lo, hi));
+
+	// The quotients always fit into 16 bits, the saturation happens when
+	// adding them to the output.
+	const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+	_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(out, _mm_packs_epi32(prod0, prod1)));
+}
+
+/**
+ * Scale 8 samples by the volumes in vol and add them to the 8 wide samples
+ * at obuf.
+ */
+SCUMMVM_TARGET_SSE2 static inline void mixVolume(st_wide_sample_t *obuf, __m128i in, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(in, vol);
+	const __m128i hi = _mm_mulhi_epi16(in, vol);
+
+	const __m128i out0 = _mm_loadu_si128((const __m128i *)obuf);
+	const __m128i out1 = _mm_loadu_si128((const __m128i *)(obuf + 4));
+	_mm_storeu_si128((__m128i *)obuf, _mm_add_epi32(out0, _mm_unpacklo_epi16(lo, hi)));
+	_mm_storeu_si128((__m128i *)(obuf + 4), _mm_add_epi32(out1, _mm_unpackhi_epi16(lo, hi)));
+}
+
+SCUMMVM_TARGET_SSE2 static inline __m128i swapStereo(__m128i v) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+/**
+ * Interpolate 4 samples (2 frames) and return them as 32-bit integers,
+ * truncated to 16 bits like a cast to st_sample_t does.
+ */
+SCUMMVM_TARGET_SSE2 static inline __m128i interpolate(const st_sample_t *last, const st_sample_t *cur, const frac_t *pos) {
+	const __m128i l = _mm_loadl_epi64((const __m128i *)last);
+	const __m128i c = _mm_loadl_epi64((const __m128i *)cur);
+	const __m128i p = _mm_loadl_epi64((const __m128i *)pos);
+
+	const __m128i l32 = _mm_srai_epi32(_mm_unpacklo_epi16(l, l), 16);
+	const __m128i c32 = _mm_srai_epi32(_mm_unpacklo_epi16(c, c), 16);
+	const __m128i p32 = _mm_unpacklo_epi32(p, p);
+
+	__m128i v = mullo32(_mm_sub_epi32(c32, l32), p32);
+	v = _mm_srai_epi32(_mm_add_epi32(v, _mm_set1_epi32(FRAC_HALF)), FRAC_BITS);
+	v = _mm_add_epi32(l32, v);
+	return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+}
+
+template<typename T>
+SCUMMVM_TARGET_SSE2 static void mixStereoSSE2(T *obuf, const st_sample_t *ibuf, st_size_t frames,
+                                              st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const st_size_t simdFrames = frames & ~3;
+	const __m128i vol = reverseStereo ? _mm_set_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r)
+	                                  : _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	for (st_size_t i = 0; i < simdFrames; i += 4) {
+		__m128i in = _mm_loadu_si128((const __m128i *)(ibuf + i * 2));
+		if (reverseStereo)
+			in = swapStereo(in);
+		mixVolume(obuf + i * 2, in, vol);
+	}
+
+	mixStereo(g_rateKernelsScalar, obuf + simdFrames * 2, ibuf + simdFrames * 2, frames - simdFrames, vol_l, vol_r, reverseStereo);
+}
+
+template<typename T>
+SCUMMVM_TARGET_SSE2 static void mixMonoSSE2(T *obuf, const st_sample_t *ibuf, st_size_t frames,
+                                            st_volume_t vol_l, st_volume_t vol_r) {
+	const st_size_t simdFrames = frames & ~7;
+	const __m128i vol = _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	for (st_size_t i = 0; i < simdFrames; i += 8) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)(ibuf + i));
+		mixVolume(obuf + i * 2, _mm_unpacklo_epi16(in, in), vol);
+		mixVolume(obuf + i * 2 + 8, _mm_unpackhi_epi16(in, in), vol);
+	}
+
+	mixMono(g_rateKernelsScalar, obuf + simdFrames * 2, ibuf + simdFrames, frames - simdFrames, vol_l, vol_r);
+}
+
+template<typename T>
+SCUMMVM_TARGET_SSE2 static void mixInterpolatedSSE2(T *obuf, const st_sample_t *last, const st_sample_t *cur,
+                                                    const frac_t *pos, st_size_t frames,
+                                                    st_volume_t vol_l, st_volume_t vol_r, bool reverseStereo) {
+	const st_size_t simdFrames = frames & ~3;
+	const __m128i vol = reverseStereo ? _mm_set_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r)
+	                                  : _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	for (st_size_t i = 0; i < simdFrames; i += 4) {
+		const __m128i v0 = interpolate(last + i * 2, cur + i * 2, pos + i);
+		const __m128i v1 = interpolate(last + i * 2 + 4, cur + i * 2 + 4, pos + i + 2);
+		__m128i in = _mm_packs_epi32(v0, v1);
+		if (reverseStereo)
+			in = swapStereo(in);
+		mixVolume(obuf + i * 2, in, vol);
+	}
+
+	mixInterpolated(g_rateKernelsScalar, obuf + simdFrames * 2, last + simdFrames * 2, cur + simdFrames * 2, pos + simdFrames,
+	                frames - simdFrames, vol_l, vol_r, reverseStereo);
+}
+
+const RateKernels g_rateKernelsSSE2 = {
+	"sse2",
+	mixStereoSSE2<st_sample_t>,
+	mixMonoSSE2<st_sample_t>,
+	mixInterpolatedSSE2<st_sample_t>,
+	mixStereoSSE2<st_wide_sample_t>,
+	mixMonoSSE2<st_wide_sample_t>,
+	mixInterpolatedSSE2<st_wide_sample_t>
+};
+
+} // End of namespace Audio
+
+#endif
@@ -159,6 +159,21 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Query the size and the time of the last modification of the file
+	 * referred by this node, e.g. for validating cached information about
+	 * its contents.
+	 *
+	 * The default implementation reports that this information is not
+	 * available.
+	 *
+	 * @param size				set to the size of the file in bytes
+	 * @param modificationTime	set to the modification time, in an
+	 *							unspecified but monotonic unit
+	 * @return true if the information was retrieved, false otherwise
+	 */
+	virtual bool getFileStats(uint32 &size, uint32 &modificationTime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -169,6 +184,16 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStream() = 0;
 
+	/**
+	 * Creates a SeekableReadStream instance for a file holding game data,
+	 * which is only read while the game runs. Backends may thus serve it
+	 * from memory, e.g. by mapping the file. The default implementation
+	 * uses createReadStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createGameDataReadStream() { return createReadStream(); }
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -31,6 +31,7 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
 
 #include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/posix-mmapstream.h"
 #include "backends/fs/stdiostream.h"
 #include "common/algorithm.h"
 
@@ -243,11 +244,36 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const {
 	return makeNode(Common::String(start, end));
 }
 
+bool POSIXFilesystemNode::getFileStats(uint32 &size, uint32 &modificationTime) const {
+	struct stat st;
+
+	if (stat(_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+
+	size = (uint32)st.st_size;
+	modificationTime = (uint32)st.st_mtime;
+	return true;
+}
+
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return StdioStream::makeFromPath(getPath(), false);
 }
 
+Common::SeekableReadStream *POSIXFilesystemNode::createGameDataReadStream() {
+#if defined(POSIX) && !defined(__OS2__) && !defined(DISABLE_MMAP_FILESTREAM)
+	// Map large game data files into memory if possible, so they can be
+	// read without any copying. Files this process writes are left out.
+	Common::SeekableReadStream *stream = PosixMmapStream::makeFromPath(getPath());
+	if (stream)
+		return stream;
+#endif
+	return createReadStream();
+}
+
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
+#if defined(POSIX) && !defined(__OS2__) && !defined(DISABLE_MMAP_FILESTREAM)
+	PosixMmapStream::excludeWrittenFile(getPath());
+#endif
 	return StdioStream::makeFromPath(getPath(), true);
 }
 
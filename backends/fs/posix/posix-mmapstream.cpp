@@ -0,0 +1,152 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(POSIX) && !defined(__OS2__) && !defined(DISABLE_MMAP_FILESTREAM)
+
+// Disable symbol overrides so that we can use open, close etc.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "backends/fs/posix/posix-mmapstream.h"
+#include "common/array.h"
+#include "common/atomic.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/** Identifies a file independently of the path it is opened by. */
+struct FileId {
+	dev_t dev;
+	ino_t ino;
+};
+
+} // End of anonymous namespace
+
+/**
+ * Files which were opened for writing. It is only allocated once a file
+ * is written, and never freed, like the other tables of the process.
+ */
+static Common::Array<FileId> *s_writtenFiles = 0;
+static Common::SpinLock s_writtenFilesLock;
+
+/** Returns whether the file is in s_writtenFiles. Needs the lock held. */
+static bool findWrittenFile(const struct stat &st) {
+	if (!s_writtenFiles)
+		return false;
+
+	for (uint i = 0; i < s_writtenFiles->size(); ++i) {
+		if ((*s_writtenFiles)[i].dev == st.st_dev && (*s_writtenFiles)[i].ino == st.st_ino)
+			return true;
+	}
+	return false;
+}
+
+static bool isWrittenFile(const struct stat &st) {
+	s_writtenFilesLock.lock();
+	const bool found = findWrittenFile(st);
+	s_writtenFilesLock.unlock();
+	return found;
+}
+
+PosixMmapStream::PosixMmapStream(const byte *data, uint32 size)
+	: _data(data), _size(size), _pos(0), _eos(false) {
+	assert(data);
+}
+
+PosixMmapStream::~PosixMmapStream() {
+	munmap(const_cast<byte *>(_data), _size);
+}
+
+bool PosixMmapStream::seek(int32 offs, int whence) {
+	int32 newPos = offs;
+	if (whence == SEEK_CUR)
+		newPos += _pos;
+	else if (whence == SEEK_END)
+		newPos += _size;
+
+	// Like fseek(), allow seeking past the end, but not before the start
+	if (newPos < 0)
+		return false;
+
+	_pos = newPos;
+	_eos = false;
+	return true;
+}
+
+uint32 PosixMmapStream::read(void *dataPtr, uint32 dataSize) {
+	const uint32 available = _pos < _size ? _size - _pos : 0;
+	if (dataSize > available) {
+		dataSize = available;
+		_eos = true;
+	}
+
+	memcpy(dataPtr, _data + _pos, dataSize);
+	_pos += dataSize;
+	return dataSize;
+}
+
+PosixMmapStream *PosixMmapStream::makeFromPath(const Common::String &path) {
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	struct stat st;
+	void *data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= kMinMappedSize && st.st_size <= 0x7FFFFFFF && !isWrittenFile(st))
+		data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping stays valid after closing the file
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return 0;
+
+	return new PosixMmapStream((const byte *)data, st.st_size);
+}
+
+void PosixMmapStream::excludeWrittenFile(const Common::String &path) {
+	// Create the file if needed, so that it has an inode to remember
+	const int fd = open(path.c_str(), O_WRONLY | O_CREAT, 0666);
+	if (fd < 0)
+		return;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+		s_writtenFilesLock.lock();
+		if (!findWrittenFile(st)) {
+			FileId id;
+			id.dev = st.st_dev;
+			id.ino = st.st_ino;
+
+			if (!s_writtenFiles)
+				s_writtenFiles = new Common::Array<FileId>();
+			s_writtenFiles->push_back(id);
+		}
+		s_writtenFilesLock.unlock();
+	}
+	close(fd);
+}
+
+#endif
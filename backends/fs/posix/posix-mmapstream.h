@@ -0,0 +1,84 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MMAPSTREAM_H
+#define BACKENDS_FS_POSIX_MMAPSTREAM_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+/**
+ * Read stream for a file which is mapped into memory in its entirety.
+ * Reading from it is a plain memory copy, and getData() gives direct
+ * access to the file contents.
+ *
+ * The file must not be truncated while it is mapped, as accessing the
+ * missing pages raises SIGBUS. It is thus only used for game data in
+ * directories which opted in, and never for files this process writes.
+ */
+class PosixMmapStream : public Common::SeekableReadStream, public Common::NonCopyable {
+public:
+	enum {
+		/** Smaller files are cheaper to read than to map. */
+		kMinMappedSize = 64 * 1024
+	};
+
+protected:
+	const byte *_data;
+	uint32 _size;
+	uint32 _pos;
+	bool _eos;
+
+public:
+	/**
+	 * Given a path, maps the file at that path into memory and wraps it
+	 * in a PosixMmapStream instance. Returns 0 if the file cannot be
+	 * mapped, e.g. because it is not a regular file, or is smaller than
+	 * kMinMappedSize, in which case the caller should fall back to a
+	 * StdioStream.
+	 */
+	static PosixMmapStream *makeFromPath(const Common::String &path);
+
+	/**
+	 * Never map the file at the given path during this session, because
+	 * it is about to be written. Has to be called before the file is
+	 * opened for writing.
+	 */
+	static void excludeWrittenFile(const Common::String &path);
+
+	PosixMmapStream(const byte *data, uint32 size);
+	virtual ~PosixMmapStream();
+
+	virtual bool eos() const { return _eos; }
+	virtual void clearErr() { _eos = false; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offs, int whence = SEEK_SET);
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual const byte *getData() const { return _data; }
+};
+
+#endif
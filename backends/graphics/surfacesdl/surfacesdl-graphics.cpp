@@ -32,6 +32,7 @@
 #include "common/textconsole.h"
 #include "common/translation.h"
 #include "common/util.h"
+#include "common/workerpool.h"
 #ifdef USE_RGB_COLOR
 #include "common/list.h"
 #endif
@@ -84,6 +85,11 @@ static const int s_gfxModeSwitchTable[][4] = {
 		{ GFX_NORMAL, GFX_DOTMATRIX, -1, -1 }
 	};
 
+// Ports which set up and update the screen themselves only handle 16 bit
+#if defined(USE_RGB_COLOR) && !defined(DINGUX) && !defined(GPH_DEVICE) && !defined(LINUXMOTO) && !defined(_WIN32_WCE)
+#define SURFACESDL_32BPP_SCREEN
+#endif
+
 #ifdef USE_SCALERS
 static int cursorStretch200To240(uint8 *buf, uint32 pitch, int width, int height, int srcX, int srcY, int origSrcY);
 #endif
@@ -129,7 +135,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_overlayVisible(false),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _scalerPool(0), _screenChangeCount(0),
 	_mouseVisible(false), _mouseNeedsRedraw(false), _mouseData(0), _mouseSurface(0),
 	_mouseOrigSurface(0), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakePos(0), _newShakePos(0),
@@ -175,6 +181,9 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_scalerType = 0;
 
+	if (ConfMan.hasKey("scaler_threads") && ConfMan.getInt("scaler_threads") > 1)
+		_scalerPool = new Common::WorkerPool(ConfMan.getInt("scaler_threads"));
+
 #if !defined(_WIN32_WCE) && !defined(__SYMBIAN32__)
 	_videoMode.fullscreen = ConfMan.getBool("fullscreen");
 #else
@@ -195,6 +204,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 	free(_currentPalette);
 	free(_cursorPalette);
 	free(_mouseData);
+	delete _scalerPool;
 }
 
 void SurfaceSdlGraphicsManager::activateManager() {
@@ -460,12 +470,19 @@ void SurfaceSdlGraphicsManager::detectSupportedFormats() {
 		_supportedFormats.push_back(format);
 	}
 
+	// The screen is switched to 32 bit for games with 32 bit pixels, so those
+	// are supported even while it is 16 bit
+	int maxBytesPerPixel = format.bytesPerPixel;
+#ifdef SURFACESDL_32BPP_SCREEN
+	maxBytesPerPixel = 4;
+#endif
+
 	// TODO: prioritize matching alpha masks
 	int i;
 
 	// Push some RGB formats
 	for (i = 0; i < ARRAYSIZE(RGBList); i++) {
-		if (_hwscreen && (RGBList[i].bytesPerPixel > format.bytesPerPixel))
+		if (_hwscreen && (RGBList[i].bytesPerPixel > maxBytesPerPixel))
 			continue;
 		if (RGBList[i] != format)
 			_supportedFormats.push_back(RGBList[i]);
@@ -473,7 +490,7 @@ void SurfaceSdlGraphicsManager::detectSupportedFormats() {
 
 	// Push some BGR formats
 	for (i = 0; i < ARRAYSIZE(BGRList); i++) {
-		if (_hwscreen && (BGRList[i].bytesPerPixel > format.bytesPerPixel))
+		if (_hwscreen && (BGRList[i].bytesPerPixel > maxBytesPerPixel))
 			continue;
 		if (BGRList[i] != format)
 			_supportedFormats.push_back(BGRList[i]);
@@ -546,6 +563,10 @@ bool SurfaceSdlGraphicsManager::setGraphicsMode(int mode) {
 	if (_oldVideoMode.setup && _oldVideoMode.scaleFactor != newScaleFactor)
 		_transactionDetails.needHotswap = true;
 
+	// Switching between a 16 and a 32 bit scaler changes the screen depth
+	if (_oldVideoMode.setup && (getScalerProc32(_oldVideoMode.mode) != 0) != (getScalerProc32(mode) != 0))
+		_transactionDetails.needHotswap = true;
+
 	_transactionDetails.needUpdatescreen = true;
 
 	_videoMode.mode = mode;
@@ -605,6 +626,9 @@ void SurfaceSdlGraphicsManager::setGraphicsModeIntern() {
 		error("Unknown gfx mode %d", _videoMode.mode);
 	}
 
+	if (ScalerProc *scalerProc32 = getScalerProc32(_videoMode.mode))
+		newScalerProc = scalerProc32;
+
 	_scalerProc = newScalerProc;
 
 	if (_videoMode.mode != GFX_NORMAL) {
@@ -627,6 +651,38 @@ void SurfaceSdlGraphicsManager::setGraphicsModeIntern() {
 	blitCursor();
 }
 
+ScalerProc *SurfaceSdlGraphicsManager::getScalerProc32(int mode) const {
+#ifdef SURFACESDL_32BPP_SCREEN
+	if (_screenFormat.bytesPerPixel != 4)
+		return 0;
+
+	switch (mode) {
+	case GFX_NORMAL:
+		return Normal1x_32;
+#ifdef USE_SCALERS
+	case GFX_DOUBLESIZE:
+		return Normal2x_32;
+	case GFX_TRIPLESIZE:
+		return Normal3x_32;
+	case GFX_ADVMAME2X:
+		return AdvMame2x_32;
+	case GFX_ADVMAME3X:
+		return AdvMame3x_32;
+#ifdef USE_HQ_SCALERS
+	case GFX_HQ2X:
+		return HQ2x_32;
+	case GFX_HQ3X:
+		return HQ3x_32;
+#endif
+#endif // USE_SCALERS
+	default:
+		break;
+	}
+#endif
+
+	return 0;
+}
+
 int SurfaceSdlGraphicsManager::getGraphicsMode() const {
 	assert(_transactionMode == kTransactionNone);
 	return _videoMode.mode;
@@ -759,9 +815,13 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	SDL_SetColors(_screen, _currentPalette, 0, 256);
 
 	//
-	// Create the surface that contains the scaled graphics in 16 bit mode
+	// Create the surface that contains the scaled graphics, in 32 bit mode
+	// if there is a 32 bit scaler for the game screen and in 16 bit mode
+	// otherwise
 	//
 
+	const int hwDepth = getScalerProc32(_videoMode.mode) ? 32 : 16;
+
 	if (_videoMode.fullscreen) {
 		fixupResolutionForAspectRatio(_videoMode.desiredAspectRatio, _videoMode.hardwareWidth, _videoMode.hardwareHeight);
 	}
@@ -775,7 +835,7 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	} else
 #endif
 		{
-		_hwscreen = SDL_SetVideoMode(_videoMode.hardwareWidth, _videoMode.hardwareHeight, 16,
+		_hwscreen = SDL_SetVideoMode(_videoMode.hardwareWidth, _videoMode.hardwareHeight, hwDepth,
 			_videoMode.fullscreen ? (SDL_FULLSCREEN|SDL_SWSURFACE) : SDL_SWSURFACE
 			);
 	}
@@ -797,12 +857,13 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	}
 
 	//
-	// Create the surface used for the graphics in 16 bit before scaling, and also the overlay
+	// Create the surface used for the graphics before scaling, and also the
+	// overlay, in the depth of the hardware screen
 	//
 
 	// Need some extra bytes around when using 2xSaI
 	_tmpscreen = SDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.screenWidth + 3, _videoMode.screenHeight + 3,
-						16,
+						_hwscreen->format->BitsPerPixel,
 						_hwscreen->format->Rmask,
 						_hwscreen->format->Gmask,
 						_hwscreen->format->Bmask,
@@ -812,7 +873,7 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 		error("allocating _tmpscreen failed");
 
 	_overlayscreen = SDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.overlayWidth, _videoMode.overlayHeight,
-						16,
+						_hwscreen->format->BitsPerPixel,
 						_hwscreen->format->Rmask,
 						_hwscreen->format->Gmask,
 						_hwscreen->format->Bmask,
@@ -834,7 +895,7 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	_overlayFormat.aShift = _overlayscreen->format->Ashift;
 
 	_tmpscreen2 = SDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.overlayWidth + 3, _videoMode.overlayHeight + 3,
-						16,
+						_hwscreen->format->BitsPerPixel,
 						_hwscreen->format->Rmask,
 						_hwscreen->format->Gmask,
 						_hwscreen->format->Bmask,
@@ -847,7 +908,7 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	_osdSurface = SDL_CreateRGBSurface(SDL_SWSURFACE | SDL_RLEACCEL | SDL_SRCCOLORKEY | SDL_SRCALPHA,
 						_hwscreen->w,
 						_hwscreen->h,
-						16,
+						_hwscreen->format->BitsPerPixel,
 						_hwscreen->format->Rmask,
 						_hwscreen->format->Gmask,
 						_hwscreen->format->Bmask,
@@ -861,7 +922,8 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 		_videoMode.screenWidth * _videoMode.scaleFactor - 1,
 		effectiveScreenHeight() - 1);
 
-	// Distinguish 555 and 565 mode
+	// Distinguish 555 and 565 mode. The 16 bit scalers are still used for
+	// the cursor on a 32 bit screen, which is then drawn in 565 mode.
 	if (_hwscreen->format->Rmask == 0x7C00)
 		InitScalers(555);
 	else
@@ -977,6 +1039,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	assert(_hwscreen->map->sw_data != NULL);
 #endif
 
+	const int bytesPerPixel = _hwscreen->format->BytesPerPixel;
+
 	// If the shake position changed, fill the dirty area with blackness
 	if (_currentShakePos != _newShakePos ||
 		(_mouseNeedsRedraw && _mouseBackup.y <= _currentShakePos)) {
@@ -1036,7 +1100,7 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcSurf = _tmpscreen2;
 		width = _videoMode.overlayWidth;
 		height = _videoMode.overlayHeight;
-		scalerProc = Normal1x;
+		scalerProc = (bytesPerPixel == 4) ? Normal1x_32 : Normal1x;
 
 		scale1 = 1;
 	}
@@ -1099,8 +1163,12 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				if (_scalerPool)
+					scaleInBands(*_scalerPool, scalerProc, scale1, (byte *)srcSurf->pixels + (r->x + 1) * bytesPerPixel + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwscreen->pixels + rx1 * bytesPerPixel + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				else
+					scalerProc((byte *)srcSurf->pixels + (r->x + 1) * bytesPerPixel + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwscreen->pixels + rx1 * bytesPerPixel + dst_y * dstPitch, dstPitch, r->w, dst_h);
 			}
 
 			r->x = rx1;
@@ -1109,8 +1177,12 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 			r->h = dst_h * scale1;
 
 #ifdef USE_SCALERS
-			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible)
-				r->h = stretch200To240((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
+			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible) {
+				if (bytesPerPixel == 4)
+					r->h = stretch200To240_32((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
+				else
+					r->h = stretch200To240((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
+			}
 #endif
 		}
 		SDL_UnlockSurface(srcSurf);
@@ -1599,13 +1671,18 @@ void SurfaceSdlGraphicsManager::clearOverlay() {
 
 	SDL_LockSurface(_tmpscreen);
 	SDL_LockSurface(_overlayscreen);
-	_scalerProc((byte *)(_tmpscreen->pixels) + _tmpscreen->pitch + 2, _tmpscreen->pitch,
+	_scalerProc((byte *)(_tmpscreen->pixels) + _tmpscreen->pitch + _tmpscreen->format->BytesPerPixel, _tmpscreen->pitch,
 	(byte *)_overlayscreen->pixels, _overlayscreen->pitch, _videoMode.screenWidth, _videoMode.screenHeight);
 
 #ifdef USE_SCALERS
-	if (_videoMode.aspectRatioCorrection)
-		stretch200To240((uint8 *)_overlayscreen->pixels, _overlayscreen->pitch,
-						_videoMode.overlayWidth, _videoMode.screenHeight * _videoMode.scaleFactor, 0, 0, 0);
+	if (_videoMode.aspectRatioCorrection) {
+		if (_overlayscreen->format->BytesPerPixel == 4)
+			stretch200To240_32((uint8 *)_overlayscreen->pixels, _overlayscreen->pitch,
+							_videoMode.overlayWidth, _videoMode.screenHeight * _videoMode.scaleFactor, 0, 0, 0);
+		else
+			stretch200To240((uint8 *)_overlayscreen->pixels, _overlayscreen->pitch,
+							_videoMode.overlayWidth, _videoMode.screenHeight * _videoMode.scaleFactor, 0, 0, 0);
+	}
 #endif
 	SDL_UnlockSurface(_tmpscreen);
 	SDL_UnlockSurface(_overlayscreen);
@@ -1626,7 +1703,7 @@ void SurfaceSdlGraphicsManager::grabOverlay(void *buf, int pitch) {
 	byte *dst = (byte *)buf;
 	int h = _videoMode.overlayHeight;
 	do {
-		memcpy(dst, src, _videoMode.overlayWidth * 2);
+		memcpy(dst, src, _videoMode.overlayWidth * _overlayscreen->format->BytesPerPixel);
 		src += _overlayscreen->pitch;
 		dst += pitch;
 	} while (--h);
@@ -1641,11 +1718,12 @@ void SurfaceSdlGraphicsManager::copyRectToOverlay(const void *buf, int pitch, in
 		return;
 
 	const byte *src = (const byte *)buf;
+	const int bytesPerPixel = _overlayscreen->format->BytesPerPixel;
 
 	// Clip the coordinates
 	if (x < 0) {
 		w += x;
-		src -= x * 2;
+		src -= x * bytesPerPixel;
 		x = 0;
 	}
 
@@ -1672,9 +1750,9 @@ void SurfaceSdlGraphicsManager::copyRectToOverlay(const void *buf, int pitch, in
 	if (SDL_LockSurface(_overlayscreen) == -1)
 		error("SDL_LockSurface failed: %s", SDL_GetError());
 
-	byte *dst = (byte *)_overlayscreen->pixels + y * _overlayscreen->pitch + x * 2;
+	byte *dst = (byte *)_overlayscreen->pixels + y * _overlayscreen->pitch + x * bytesPerPixel;
 	do {
-		memcpy(dst, src, w * 2);
+		memcpy(dst, src, w * bytesPerPixel);
 		dst += _overlayscreen->pitch;
 		src += pitch;
 	} while (--h);
@@ -1766,14 +1844,7 @@ void SurfaceSdlGraphicsManager::setMouseCursor(const void *buf, uint w, uint h,
 			SDL_FreeSurface(_mouseOrigSurface);
 
 		// Allocate bigger surface because AdvMame2x adds black pixel at [0,0]
-		_mouseOrigSurface = SDL_CreateRGBSurface(SDL_SWSURFACE | SDL_RLEACCEL | SDL_SRCCOLORKEY | SDL_SRCALPHA,
-						_mouseCurState.w + 2,
-						_mouseCurState.h + 2,
-						16,
-						_hwscreen->format->Rmask,
-						_hwscreen->format->Gmask,
-						_hwscreen->format->Bmask,
-						_hwscreen->format->Amask);
+		_mouseOrigSurface = createCursorSurface(_mouseCurState.w + 2, _mouseCurState.h + 2);
 
 		if (_mouseOrigSurface == NULL)
 			error("allocating _mouseOrigSurface failed");
@@ -1792,6 +1863,22 @@ void SurfaceSdlGraphicsManager::setMouseCursor(const void *buf, uint w, uint h,
 	blitCursor();
 }
 
+SDL_Surface *SurfaceSdlGraphicsManager::createCursorSurface(int w, int h) {
+	// The cursor is drawn by SDL_BlitSurface(), which converts it to the
+	// hardware screen format. On a 32 bit screen it is kept in 565 mode, the
+	// format the cursor scalers are set up for.
+	const bool is16Bit = (_hwscreen->format->BytesPerPixel == 2);
+
+	return SDL_CreateRGBSurface(SDL_SWSURFACE | SDL_RLEACCEL | SDL_SRCCOLORKEY | SDL_SRCALPHA,
+						w,
+						h,
+						16,
+						is16Bit ? _hwscreen->format->Rmask : 0xF800,
+						is16Bit ? _hwscreen->format->Gmask : 0x07E0,
+						is16Bit ? _hwscreen->format->Bmask : 0x001F,
+						is16Bit ? _hwscreen->format->Amask : 0);
+}
+
 void SurfaceSdlGraphicsManager::blitCursor() {
 	byte *dstPtr;
 	const byte *srcPtr = _mouseData;
@@ -1903,14 +1990,7 @@ void SurfaceSdlGraphicsManager::blitCursor() {
 		if (_mouseSurface)
 			SDL_FreeSurface(_mouseSurface);
 
-		_mouseSurface = SDL_CreateRGBSurface(SDL_SWSURFACE | SDL_RLEACCEL | SDL_SRCCOLORKEY | SDL_SRCALPHA,
-						_mouseCurState.rW,
-						_mouseCurState.rH,
-						16,
-						_hwscreen->format->Rmask,
-						_hwscreen->format->Gmask,
-						_hwscreen->format->Bmask,
-						_hwscreen->format->Amask);
+		_mouseSurface = createCursorSurface(_mouseCurState.rW, _mouseCurState.rH);
 
 		if (_mouseSurface == NULL)
 			error("allocating _mouseSurface failed");
@@ -1926,10 +2006,15 @@ void SurfaceSdlGraphicsManager::blitCursor() {
 	if (!_cursorDontScale) {
 		// If possible, use the same scaler for the cursor as for the rest of
 		// the game. This only works well with the non-blurring scalers so we
-		// actually only use the 1x, 2x and AdvMame scalers.
-		if (_videoMode.mode == GFX_DOUBLESIZE || _videoMode.mode == GFX_TRIPLESIZE)
-			scalerProc = _scalerProc;
+		// actually only use the 1x, 2x and AdvMame scalers. The cursor is
+		// 16 bit even on a 32 bit screen, so these are the 16 bit versions.
+#ifdef USE_SCALERS
+		if (_videoMode.mode == GFX_DOUBLESIZE)
+			scalerProc = Normal2x;
+		else if (_videoMode.mode == GFX_TRIPLESIZE)
+			scalerProc = Normal3x;
 		else
+#endif
 			scalerProc = scalersMagn[_videoMode.scaleFactor - 1];
 	} else {
 		scalerProc = Normal1x;
@@ -230,6 +230,17 @@ protected:
 
 	ScalerProc *_scalerProc;
 	int _scalerType;
+
+	/**
+	 * Get the 32 bit scaler for the given graphics mode, or 0 if the game
+	 * screen is not 32 bit or the mode has no 32 bit scaler. The hardware
+	 * screen, overlay and scaler surfaces are 32 bit exactly when there is
+	 * one, and 16 bit otherwise.
+	 */
+	ScalerProc *getScalerProc32(int mode) const;
+
+	/** Threads for scaling large dirty rects in bands, or 0 if disabled */
+	Common::WorkerPool *_scalerPool;
 	int _transactionMode;
 
 	// Indicates whether it is needed to free _hwsurface in destructor
@@ -321,6 +332,9 @@ protected:
 	virtual void undrawMouse();
 	virtual void blitCursor();
 
+	/** Create a 16 bit surface for the cursor, which works with the cursor scalers */
+	SDL_Surface *createCursorSurface(int w, int h);
+
 	virtual void internUpdateScreen();
 
 	virtual bool loadGFXMode();
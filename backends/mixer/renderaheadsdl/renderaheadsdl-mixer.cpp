@@ -0,0 +1,151 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/mixer/renderaheadsdl/renderaheadsdl-mixer.h"
+#include "common/atomic.h"
+#include "common/debug.h"
+#include "common/util.h"
+
+RenderAheadSdlMixerManager::RenderAheadSdlMixerManager(uint latency)
+	:
+	_latency(latency), _buffer(0), _bufferTarget(0), _chunkSize(0), _renderDelay(1),
+	_renderThread(0), _renderThreadShouldQuit(0), _underrunCount(0), _underrunSamples(0) {
+
+}
+
+RenderAheadSdlMixerManager::~RenderAheadSdlMixerManager() {
+	// Neither the audio callback nor the render thread may access the
+	// buffer or the mixer anymore once we get destroyed.
+	SDL_CloseAudio();
+	stopRenderThread();
+
+	if (_buffer) {
+		debug(1, "Audio underruns: %u, %u samples", getUnderrunCount(), getUnderrunSamples());
+		delete _buffer;
+	}
+}
+
+uint32 RenderAheadSdlMixerManager::getUnderrunCount() const {
+	return Common::atomicLoad(_underrunCount);
+}
+
+uint32 RenderAheadSdlMixerManager::getUnderrunSamples() const {
+	return Common::atomicLoad(_underrunSamples);
+}
+
+void RenderAheadSdlMixerManager::startAudio() {
+	// The mixer produces stereo 16-bit samples
+	const uint32 frameSize = 4;
+
+	// Render in chunks of half an SDL buffer, and keep at least two SDL
+	// buffers worth of data around, so the callback can always be served
+	// in one go.
+	const uint32 chunkFrames = MAX<uint32>(_obtained.samples / 2, 1);
+	const uint32 targetFrames = MAX<uint32>(_latency * _obtained.freq / 1000, _obtained.samples * 2);
+
+	_chunkSize = chunkFrames * frameSize;
+	_bufferTarget = targetFrames * frameSize;
+	_renderDelay = MAX<uint32>(chunkFrames * 1000 / _obtained.freq / 2, 1);
+	_buffer = new Common::RingBuffer(_bufferTarget + _chunkSize);
+
+	debug(1, "Rendering audio %u ms ahead", targetFrames * 1000 / _obtained.freq);
+
+	// Prime the buffer with silence, so playback does not start with an
+	// underrun.
+	while (_buffer->getAvailable() < _bufferTarget) {
+		uint32 len;
+		byte *buf = _buffer->getWriteBuffer(len);
+		len = MIN(len, _bufferTarget - _buffer->getAvailable());
+		memset(buf, _obtained.silence, len);
+		_buffer->commitWrite(len);
+	}
+
+	_renderThreadShouldQuit = 0;
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	_renderThread = SDL_CreateThread(renderThreadEntry, "ScummVM audio renderer", this);
+#else
+	_renderThread = SDL_CreateThread(renderThreadEntry, this);
+#endif
+
+	SdlMixerManager::startAudio();
+}
+
+void RenderAheadSdlMixerManager::renderThread() {
+	uint32 reportedUnderruns = 0;
+
+	while (!Common::atomicLoad(_renderThreadShouldQuit)) {
+		if (_buffer->getAvailable() + _chunkSize > _bufferTarget) {
+			// Far enough ahead, wait for the callback to consume some data
+			SDL_Delay(_renderDelay);
+			continue;
+		}
+
+		// The free area always starts at a sample pair boundary, as the
+		// capacity and all writes are multiples of the sample pair size
+		uint32 len;
+		byte *buf = _buffer->getWriteBuffer(len);
+		len = MIN(len, _chunkSize);
+
+		_mixer->mixCallback(buf, len);
+		_buffer->commitWrite(len);
+
+		const uint32 underruns = getUnderrunCount();
+		if (underruns != reportedUnderruns) {
+			debug(2, "Audio underruns: %u, %u samples", underruns, getUnderrunSamples());
+			reportedUnderruns = underruns;
+		}
+	}
+}
+
+int SDLCALL RenderAheadSdlMixerManager::renderThreadEntry(void *arg) {
+	RenderAheadSdlMixerManager *mixer = (RenderAheadSdlMixerManager *)arg;
+	assert(mixer);
+	mixer->renderThread();
+	return 0;
+}
+
+void RenderAheadSdlMixerManager::stopRenderThread() {
+	if (_renderThread) {
+		Common::atomicStore(_renderThreadShouldQuit, 1);
+		SDL_WaitThread(_renderThread, NULL);
+		_renderThread = 0;
+	}
+}
+
+void RenderAheadSdlMixerManager::callbackHandler(byte *samples, int len) {
+	assert(_buffer);
+
+	// Never wait for the render thread, play silence if it fell behind
+	const uint32 read = _buffer->read(samples, len);
+	if (read < (uint32)len) {
+		memset(samples + read, _obtained.silence, len - read);
+
+		Common::atomicAdd(_underrunCount, 1);
+		Common::atomicAdd(_underrunSamples, (len - read) / 4);
+	}
+}
+
+#endif
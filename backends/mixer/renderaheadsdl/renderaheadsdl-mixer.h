@@ -0,0 +1,100 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_MIXER_RENDERAHEADSDL_H
+#define BACKENDS_MIXER_RENDERAHEADSDL_H
+
+#include "backends/mixer/sdl/sdl-mixer.h"
+#include "common/ringbuffer.h"
+
+/**
+ * SDL mixer manager which renders audio ahead of time. The mixer runs on
+ * a separate thread and fills a ring buffer, from which the SDL audio
+ * callback only copies. This keeps expensive sound sources, like MIDI
+ * emulators or audio decoders, out of the real-time audio thread, at the
+ * expense of additional latency.
+ *
+ * This requires the operations from common/atomic.h, so only use it if
+ * SCUMMVM_HAVE_ATOMICS is defined.
+ */
+class RenderAheadSdlMixerManager : public SdlMixerManager {
+public:
+	/**
+	 * @param latency how far ahead to render, in milliseconds
+	 */
+	RenderAheadSdlMixerManager(uint latency);
+	virtual ~RenderAheadSdlMixerManager();
+
+	/**
+	 * Returns how often the audio callback found the ring buffer empty
+	 * before it could fill the whole output buffer.
+	 */
+	uint32 getUnderrunCount() const;
+
+	/**
+	 * Returns the total number of sample pairs which were replaced by
+	 * silence because of underruns.
+	 */
+	uint32 getUnderrunSamples() const;
+
+protected:
+	/** The requested latency in milliseconds */
+	uint _latency;
+
+	/** Audio rendered ahead, in the format of the output device */
+	Common::RingBuffer *_buffer;
+
+	/** The amount of data to keep in _buffer, in bytes */
+	uint32 _bufferTarget;
+
+	/** The amount of data rendered at once, in bytes */
+	uint32 _chunkSize;
+
+	/** The time the render thread sleeps when _buffer is full enough, in milliseconds */
+	uint32 _renderDelay;
+
+	SDL_Thread *_renderThread;
+	volatile uint32 _renderThreadShouldQuit;
+
+	volatile uint32 _underrunCount;
+	volatile uint32 _underrunSamples;
+
+	/**
+	 * Keeps the ring buffer filled
+	 */
+	void renderThread();
+
+	/**
+	 * Stops the render thread and waits for it to finish
+	 */
+	void stopRenderThread();
+
+	/**
+	 * Callback entry point for the render thread
+	 */
+	static int SDLCALL renderThreadEntry(void *arg);
+
+	virtual void startAudio();
+	virtual void callbackHandler(byte *samples, int len);
+};
+
+#endif
@@ -98,6 +98,8 @@ void SdlMixerManager::init() {
 
 		_mixer = new Audio::MixerImpl(g_system, _obtained.freq);
 		assert(_mixer);
+		if (ConfMan.hasKey("mixer_lockfree"))
+			_mixer->setLockFree(ConfMan.getBool("mixer_lockfree"));
 		_mixer->setReady(true);
 
 		startAudio();
@@ -29,6 +29,7 @@
 #endif
 
 #include "backends/platform/sdl/sdl.h"
+#include "common/atomic.h"
 #include "common/config-manager.h"
 #include "gui/EventRecorder.h"
 #include "common/taskbar.h"
@@ -44,6 +45,7 @@
 #endif
 
 #include "backends/events/sdl/sdl-events.h"
+#include "backends/mixer/renderaheadsdl/renderaheadsdl-mixer.h"
 #include "backends/mutex/sdl/sdl-mutex.h"
 #include "backends/timer/sdl/sdl-timer.h"
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
@@ -213,7 +215,12 @@ void OSystem_SDL::initBackend() {
 		_savefileManager = new DefaultSaveFileManager();
 
 	if (_mixerManager == 0) {
-		_mixerManager = new SdlMixerManager();
+#ifdef SCUMMVM_HAVE_ATOMICS
+		if (ConfMan.hasKey("mixer_render_ahead") && ConfMan.getInt("mixer_render_ahead") > 0)
+			_mixerManager = new RenderAheadSdlMixerManager(ConfMan.getInt("mixer_render_ahead"));
+		else
+#endif
+			_mixerManager = new SdlMixerManager();
 		// Setup and start mixer
 		_mixerManager->init();
 	}
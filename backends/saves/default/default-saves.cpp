@@ -20,10 +20,19 @@
  *
  */
 
+// Disable symbol overrides so that we can use the pthread API
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
 #include "common/scummsys.h"
 
 #if !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
 
+#if defined(WIN32) && !defined(_WIN32_WCE)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#undef ARRAYSIZE // winnt.h defines ARRAYSIZE, but we want our own one...
+#endif
+
 #include "backends/saves/default/default-saves.h"
 
 #include "common/savefile.h"
@@ -31,19 +40,357 @@
 #include "common/fs.h"
 #include "common/archive.h"
 #include "common/config-manager.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/list.h"
+#include "common/memstream.h"
+#include "common/textconsole.h"
 #include "common/zlib.h"
 
 #ifndef _WIN32_WCE
 #include <errno.h>	// for removeSavefile()
 #endif
 
-DefaultSaveFileManager::DefaultSaveFileManager() {
+#if defined(USE_PTHREADS)
+#include <pthread.h>
+#endif
+
+namespace {
+
+/**
+ * A savefile whose contents have been serialized into memory and which is
+ * waiting to be written to disk.
+ */
+struct PendingSave {
+	/** The temporary file, already opened by the main thread. */
+	Common::WriteStream *file;
+	byte *data;
+	uint32 size;
+	bool compress;
+	bool failed;
+	/** Whether the new data was kept in the temporary file. */
+	bool keptTemp;
+
+	// String reference counting is not thread safe, so these are only
+	// copied and destroyed by the main thread. The writer thread merely
+	// uses their contents.
+	Common::String tempPath;
+	Common::String path;
+	/** The name of the savefile, not touched by the writer thread at all. */
+	Common::String name;
+};
+
+/**
+ * Replace a file by another one. Except on Windows CE, either the old or
+ * the new file remains at the destination path, even if the process dies
+ * in between.
+ *
+ * @return true on success
+ */
+bool replaceFile(const char *from, const char *to) {
+#if defined(WIN32) && !defined(_WIN32_WCE)
+	// rename() does not replace existing files on Windows
+	return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#elif defined(_WIN32_WCE)
+	// Windows CE has no way to atomically replace a file
+	remove(to);
+	return rename(from, to) == 0;
+#else
+	return rename(from, to) == 0;
+#endif
+}
+
+/**
+ * Compress and write a pending savefile to its temporary file, then
+ * replace the actual savefile with it. If only the replacement fails, the
+ * temporary file is kept, as it holds the only copy of the new data.
+ *
+ * @return true on success
+ */
+bool writePendingSave(PendingSave &save) {
+	Common::WriteStream *out = save.file;
+	if (save.compress)
+		out = Common::wrapCompressedWriteStream(out);
+
+	out->write(save.data, save.size);
+	out->finalize();
+	bool success = !out->err();
+	delete out;
+
+	free(save.data);
+	save.data = 0;
+
+	if (!success) {
+		remove(save.tempPath.c_str());
+		return false;
+	}
+
+	if (!replaceFile(save.tempPath.c_str(), save.path.c_str())) {
+		save.keptTemp = true;
+		return false;
+	}
+	return true;
+}
+
+} // End of anonymous namespace
+
+/**
+ * Writes savefiles in the order they were queued. With thread support, this
+ * happens on a background thread; otherwise they are written right away.
+ */
+class DefaultSaveFileWriter {
+public:
+	DefaultSaveFileWriter();
+	~DefaultSaveFileWriter();
+
+	/** Queue a savefile for writing, taking ownership of it. */
+	void queue(PendingSave *save);
+
+	/**
+	 * Wait until all queued savefiles have been written.
+	 *
+	 * @param errors	receives a message for each savefile which could not
+	 *					be written since the last call
+	 */
+	void flush(Common::StringArray &errors);
+
+	/**
+	 * Collect the results of the savefiles written so far, like flush(),
+	 * but without waiting for the others.
+	 */
+	void poll(Common::StringArray &errors);
+
+	/** Check whether the savefile with the given name is still being written. */
+	bool isPending(const Common::String &name);
+
+	/** Get the state of the savefile with the given name, as of the last poll() or flush(). */
+	Common::SaveFileManager::SaveStatus getStatus(const Common::String &name);
+
+private:
+	void write(PendingSave *save);
+
+	/** Take the written savefiles, optionally waiting for all queued ones. */
+	void collect(bool wait, Common::StringArray &errors);
+
+	/** Savefiles which have been written, to be deleted by collect() */
+	Common::List<PendingSave *> _finished;
+
+	/** Names of the savefiles which failed to be written, until queued again */
+	Common::HashMap<Common::String, bool> _failed;
+
+#if defined(USE_PTHREADS)
+	static void *threadMain(void *arg);
+
+	pthread_t _thread;
+	bool _threadRunning;
+	bool _quit;
+
+	pthread_mutex_t _mutex;
+	pthread_cond_t _queued;
+	pthread_cond_t _done;
+	Common::List<PendingSave *> _queue;
+	PendingSave *_active;
+#endif
+};
+
+DefaultSaveFileWriter::DefaultSaveFileWriter() {
+#if defined(USE_PTHREADS)
+	_quit = false;
+	_active = 0;
+	pthread_mutex_init(&_mutex, 0);
+	pthread_cond_init(&_queued, 0);
+	pthread_cond_init(&_done, 0);
+
+	// Without the thread, savefiles are written by queue()
+	_threadRunning = (pthread_create(&_thread, 0, threadMain, this) == 0);
+	if (!_threadRunning)
+		warning("Could not create savefile writer thread");
+#endif
+}
+
+DefaultSaveFileWriter::~DefaultSaveFileWriter() {
+#if defined(USE_PTHREADS)
+	if (_threadRunning) {
+		pthread_mutex_lock(&_mutex);
+		_quit = true;
+		pthread_cond_signal(&_queued);
+		pthread_mutex_unlock(&_mutex);
+		pthread_join(_thread, 0);
+	}
+
+	pthread_cond_destroy(&_done);
+	pthread_cond_destroy(&_queued);
+	pthread_mutex_destroy(&_mutex);
+#endif
+
+	for (Common::List<PendingSave *>::iterator i = _finished.begin(); i != _finished.end(); ++i)
+		delete *i;
+}
+
+void DefaultSaveFileWriter::queue(PendingSave *save) {
+	_failed.erase(save->name);
+
+#if defined(USE_PTHREADS)
+	if (_threadRunning) {
+		pthread_mutex_lock(&_mutex);
+		_queue.push_back(save);
+		pthread_cond_signal(&_queued);
+		pthread_mutex_unlock(&_mutex);
+		return;
+	}
+#endif
+	write(save);
+}
+
+void DefaultSaveFileWriter::flush(Common::StringArray &errors) {
+	collect(true, errors);
 }
 
-DefaultSaveFileManager::DefaultSaveFileManager(const Common::String &defaultSavepath) {
+void DefaultSaveFileWriter::poll(Common::StringArray &errors) {
+	collect(false, errors);
+}
+
+void DefaultSaveFileWriter::collect(bool wait, Common::StringArray &errors) {
+	Common::List<PendingSave *> finished;
+
+#if defined(USE_PTHREADS)
+	pthread_mutex_lock(&_mutex);
+	while (wait && (!_queue.empty() || _active))
+		pthread_cond_wait(&_done, &_mutex);
+	finished = _finished;
+	_finished.clear();
+	pthread_mutex_unlock(&_mutex);
+#else
+	finished = _finished;
+	_finished.clear();
+#endif
+
+	errors.clear();
+	for (Common::List<PendingSave *>::iterator i = finished.begin(); i != finished.end(); ++i) {
+		const PendingSave &save = **i;
+		if (save.keptTemp)
+			errors.push_back("Replacing the savefile '" + save.path + "' failed, the new data was kept in '" + save.tempPath + "'");
+		else if (save.failed)
+			errors.push_back("Writing the savefile '" + save.path + "' failed");
+		if (save.failed)
+			_failed[save.name] = true;
+		delete *i;
+	}
+}
+
+bool DefaultSaveFileWriter::isPending(const Common::String &name) {
+	bool pending = false;
+#if defined(USE_PTHREADS)
+	// The writer thread never touches the names
+	pthread_mutex_lock(&_mutex);
+	pending = (_active && _active->name == name);
+	for (Common::List<PendingSave *>::const_iterator i = _queue.begin(); i != _queue.end() && !pending; ++i)
+		pending = ((*i)->name == name);
+	pthread_mutex_unlock(&_mutex);
+#endif
+	return pending;
+}
+
+Common::SaveFileManager::SaveStatus DefaultSaveFileWriter::getStatus(const Common::String &name) {
+	if (isPending(name))
+		return Common::SaveFileManager::kSavePending;
+	if (_failed.contains(name))
+		return Common::SaveFileManager::kSaveFailed;
+	return Common::SaveFileManager::kSaveSucceeded;
+}
+
+void DefaultSaveFileWriter::write(PendingSave *save) {
+	save->failed = !writePendingSave(*save);
+	_finished.push_back(save);
+}
+
+#if defined(USE_PTHREADS)
+void *DefaultSaveFileWriter::threadMain(void *arg) {
+	DefaultSaveFileWriter *writer = (DefaultSaveFileWriter *)arg;
+
+	// The queue is drained before quitting, so no savefile gets lost
+	pthread_mutex_lock(&writer->_mutex);
+	for (;;) {
+		while (writer->_queue.empty() && !writer->_quit)
+			pthread_cond_wait(&writer->_queued, &writer->_mutex);
+		if (writer->_queue.empty())
+			break;
+
+		PendingSave *save = writer->_queue.front();
+		writer->_queue.pop_front();
+		writer->_active = save;
+		pthread_mutex_unlock(&writer->_mutex);
+
+		save->failed = !writePendingSave(*save);
+
+		pthread_mutex_lock(&writer->_mutex);
+		writer->_finished.push_back(save);
+		writer->_active = 0;
+		pthread_cond_broadcast(&writer->_done);
+	}
+	pthread_mutex_unlock(&writer->_mutex);
+	return 0;
+}
+#endif
+
+namespace {
+
+/**
+ * The stream returned by openForSavingAsync(). It collects the data in
+ * memory and hands it to the writer once it is finalized or deleted.
+ */
+class AsyncSaveFile : public Common::WriteStream {
+public:
+	AsyncSaveFile(DefaultSaveFileWriter *writer, PendingSave *save)
+		: _writer(writer), _save(save), _buffer(DisposeAfterUse::NO), _err(false) {}
+
+	virtual ~AsyncSaveFile() {
+		finalize();
+	}
+
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _err = false; }
+
+	virtual uint32 write(const void *dataPtr, uint32 dataSize) {
+		if (!_save) {
+			_err = true;
+			return 0;
+		}
+		return _buffer.write(dataPtr, dataSize);
+	}
+
+	virtual void finalize() {
+		if (!_save)
+			return;
+
+		// Hand the buffer over to the writer, which frees it
+		_save->data = _buffer.getData();
+		_save->size = _buffer.size();
+		_writer->queue(_save);
+		_save = 0;
+	}
+
+private:
+	DefaultSaveFileWriter *_writer;
+	PendingSave *_save;
+	Common::MemoryWriteStreamDynamic _buffer;
+	bool _err;
+};
+
+} // End of anonymous namespace
+
+DefaultSaveFileManager::DefaultSaveFileManager() : _writer(0) {
+}
+
+DefaultSaveFileManager::DefaultSaveFileManager(const Common::String &defaultSavepath) : _writer(0) {
 	ConfMan.registerDefault("savepath", defaultSavepath);
 }
 
+DefaultSaveFileManager::~DefaultSaveFileManager() {
+	flushPendingSaves();
+	delete _writer;
+}
+
 
 void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 	clearError();
@@ -55,6 +402,8 @@ void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 }
 
 Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &pattern) {
+	flushPendingSaves();
+
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
 	if (getError().getCode() != Common::kNoError)
@@ -78,6 +427,10 @@ Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &
 }
 
 Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String &filename) {
+	// Only wait for the writer if it still has to write this savefile
+	if (_writer && _writer->isPending(filename))
+		flushPendingSaves();
+
 	// Ensure that the savepath is valid. If not, generate an appropriate error.
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
@@ -98,6 +451,8 @@ Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String
 }
 
 Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String &filename, bool compress) {
+	flushPendingSaves();
+
 	// Ensure that the savepath is valid. If not, generate an appropriate error.
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
@@ -115,7 +470,78 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 	return compress ? Common::wrapCompressedWriteStream(sf) : sf;
 }
 
+Common::OutSaveFile *DefaultSaveFileManager::openForSavingAsync(const Common::String &filename, bool compress) {
+	// Ensure that the savepath is valid. If not, generate an appropriate error.
+	Common::String savePathName = getSavePath();
+	checkPath(Common::FSNode(savePathName));
+	if (getError().getCode() != Common::kNoError)
+		return 0;
+
+	// recreate FSNode since checkPath may have changed/created the directory
+	Common::FSNode savePath(savePathName);
+
+	// The savefile is written under a temporary name, so that the old one
+	// survives if the write fails. The name is chosen to not match the
+	// patterns engines use for listing their savefiles.
+	Common::FSNode file = savePath.getChild(filename);
+	Common::FSNode tempFile = savePath.getChild("." + filename + ".part");
+
+	// Two pending saves of the same file would share the temporary file
+	if (_writer && _writer->isPending(filename))
+		flushPendingSaves();
+
+	// Open the file right away, to report errors to the caller if possible
+	Common::WriteStream *sf = tempFile.createWriteStream();
+	if (!sf)
+		return 0;
+
+	if (!_writer)
+		_writer = new DefaultSaveFileWriter();
+
+	PendingSave *save = new PendingSave();
+	save->file = sf;
+	save->data = 0;
+	save->size = 0;
+	save->failed = false;
+	save->keptTemp = false;
+	save->compress = compress;
+	save->tempPath = Common::String(tempFile.getPath().c_str());
+	save->path = Common::String(file.getPath().c_str());
+	save->name = filename;
+
+	return new AsyncSaveFile(_writer, save);
+}
+
+bool DefaultSaveFileManager::flushPendingSaves() {
+	if (!_writer)
+		return true;
+
+	Common::StringArray errors;
+	_writer->flush(errors);
+	reportErrors(errors);
+	return errors.empty();
+}
+
+Common::SaveFileManager::SaveStatus DefaultSaveFileManager::getSaveStatus(const Common::String &filename) {
+	if (!_writer)
+		return kSaveSucceeded;
+
+	Common::StringArray errors;
+	_writer->poll(errors);
+	reportErrors(errors);
+	return _writer->getStatus(filename);
+}
+
+void DefaultSaveFileManager::reportErrors(const Common::StringArray &errors) {
+	for (Common::StringArray::const_iterator i = errors.begin(); i != errors.end(); ++i) {
+		warning("%s", i->c_str());
+		setError(Common::kWritingFailed, *i);
+	}
+}
+
 bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
+	flushPendingSaves();
+
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
 	if (getError().getCode() != Common::kNoError)
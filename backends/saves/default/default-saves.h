@@ -28,6 +28,8 @@
 #include "common/str.h"
 #include "common/fs.h"
 
+class DefaultSaveFileWriter;
+
 /**
  * Provides a default savefile manager implementation for common platforms.
  */
@@ -35,11 +37,15 @@ class DefaultSaveFileManager : public Common::SaveFileManager {
 public:
 	DefaultSaveFileManager();
 	DefaultSaveFileManager(const Common::String &defaultSavepath);
+	virtual ~DefaultSaveFileManager();
 
 	virtual Common::StringArray listSavefiles(const Common::String &pattern);
 	virtual Common::InSaveFile *openForLoading(const Common::String &filename);
 	virtual Common::OutSaveFile *openForSaving(const Common::String &filename, bool compress = true);
+	virtual Common::OutSaveFile *openForSavingAsync(const Common::String &filename, bool compress = true);
 	virtual bool removeSavefile(const Common::String &filename);
+	virtual bool flushPendingSaves();
+	virtual SaveStatus getSaveStatus(const Common::String &filename);
 
 protected:
 	/**
@@ -54,6 +60,13 @@ protected:
 	 * Sets the internal error and error message accordingly.
 	 */
 	virtual void checkPath(const Common::FSNode &dir);
+
+private:
+	/** Print the errors reported by the writer and remember the last one. */
+	void reportErrors(const Common::StringArray &errors);
+
+	/** Writes the savefiles opened by openForSavingAsync(), created on first use. */
+	DefaultSaveFileWriter *_writer;
 };
 
 #endif
@@ -252,6 +252,10 @@ static Common::Error runGame(const EnginePlugin *plugin, OSystem &system, const
 	// Free up memory
 	delete engine;
 
+	// Make sure savefiles written in the background are on disk before
+	// quitting or returning to the launcher
+	system.getSavefileManager()->flushPendingSaves();
+
 	// We clear all debug levels again even though the engine should do it
 	DebugMan.clearAllDebugChannels();
 
@@ -55,6 +55,40 @@ Out copy_backward(In first, In last, Out dst) {
 	return dst;
 }
 
+/**
+ * Moves data from the range [first, last) to [dst, dst + (last - first)).
+ * It requires the range [dst, dst + (last - first)) to be valid.
+ * It also requires dst not to be in the range [first, last).
+ *
+ * The source elements are left in a valid but unspecified state. Without
+ * C++11 this is the same as copy.
+ */
+template<class Type>
+Type *move(Type *first, Type *last, Type *dst) {
+	while (first != last)
+#if __cplusplus >= 201103L
+		*dst++ = static_cast<Type &&>(*first++);
+#else
+		*dst++ = *first++;
+#endif
+	return dst;
+}
+
+/**
+ * Moves data from the range [first, last) to [dst - (last - first), dst),
+ * starting at the end. Otherwise like move.
+ */
+template<class Type>
+Type *move_backward(Type *first, Type *last, Type *dst) {
+	while (first != last)
+#if __cplusplus >= 201103L
+		*--dst = static_cast<Type &&>(*--last);
+#else
+		*--dst = *--last;
+#endif
+	return dst;
+}
+
 /**
  * Copies data from the range [first, last) to [dst, dst + (last - first)).
  * It requires the range [dst, dst + (last - first)) to be valid.
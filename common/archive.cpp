@@ -98,6 +98,7 @@ void SearchSet::add(const String &name, Archive *archive, int priority, bool aut
 	if (find(name) == _list.end()) {
 		Node node(priority, name, archive, autoFree);
 		insert(node);
+		invalidateIndex();
 	} else {
 		if (autoFree)
 			delete archive;
@@ -174,6 +175,7 @@ void SearchSet::remove(const String &name) {
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		invalidateIndex();
 	}
 }
 
@@ -188,6 +190,7 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	invalidateIndex();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -204,19 +207,94 @@ void SearchSet::setPriority(const String &name, int priority) {
 	_list.erase(it);
 	node._priority = priority;
 	insert(node);
+	invalidateIndex();
 }
 
-bool SearchSet::hasFile(const String &name) const {
-	if (name.empty())
-		return false;
+void SearchSet::invalidateIndex() {
+	atomicAdd(_generation, 1);
+}
 
+uint32 SearchSet::updateGeneration() const {
+	// A set may be part of this one, which has no other way of noticing
+	// changes to it. Checking the generations of the archives also picks
+	// up changes to sets nested deeper.
+	bool changed = false;
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for ( ; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
-			return true;
+		const uint32 generation = it->_arc->getGeneration();
+		if (it->_generation != generation) {
+			it->_generation = generation;
+			changed = true;
+		}
 	}
 
-	return false;
+	if (changed)
+		atomicAdd(_generation, 1);
+	return atomicLoad(_generation);
+}
+
+uint32 SearchSet::getGeneration() const {
+	_indexLock.lock();
+	const uint32 generation = updateGeneration();
+	_indexLock.unlock();
+	return generation;
+}
+
+void SearchSet::getLookupStats(uint32 &lookups, uint32 &misses) const {
+	_indexLock.lock();
+	lookups = _numLookups;
+	misses = _numMisses;
+	_indexLock.unlock();
+}
+
+Archive *SearchSet::lookup(const String &name) const {
+	_indexLock.lock();
+	const uint32 generation = updateGeneration();
+	if (_indexGeneration != generation) {
+		_index.clear();
+		_indexGeneration = generation;
+	}
+
+	_numLookups++;
+	NameIndex::const_iterator i = _index.find(name);
+	if (i != _index.end()) {
+		Archive *archive = i->_value;
+		_indexLock.unlock();
+		return archive;
+	}
+	_numMisses++;
+	_indexLock.unlock();
+
+	// Ask the archives in order of priority. This is done without holding
+	// the lock, as archives may take a while to answer.
+	Archive *archive = 0;
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for ( ; it != _list.end(); ++it) {
+		if (it->_arc->hasFile(name)) {
+			archive = it->_arc;
+			break;
+		}
+	}
+
+	_indexLock.lock();
+	// The result is stale if a set changed in the meantime
+	if (_indexGeneration == generation && updateGeneration() == generation) {
+		// Keep the index from growing without bounds when many different
+		// names are looked up, e.g. during game detection.
+		if (_index.size() >= kMaxIndexSize)
+			_index.clear();
+		_index[name] = archive;
+	}
+	_indexLock.unlock();
+
+	return archive;
+}
+
+bool SearchSet::hasFile(const String &name) const {
+	if (name.empty())
+		return false;
+
+	return lookup(name) != 0;
 }
 
 int SearchSet::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
@@ -243,22 +321,33 @@ const ArchiveMemberPtr SearchSet::getMember(const String &name) const {
 	if (name.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for ( ; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
-			return it->_arc->getMember(name);
-	}
+	Archive *archive = lookup(name);
+	if (!archive)
+		return ArchiveMemberPtr();
 
-	return ArchiveMemberPtr();
+	return archive->getMember(name);
 }
 
 SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) const {
 	if (name.empty())
 		return 0;
 
+	Archive *archive = lookup(name);
+	if (!archive)
+		return 0;
+
+	SeekableReadStream *stream = archive->createReadStreamForMember(name);
+	if (stream)
+		return stream;
+
+	// The member could not be opened after all, so try whether any other
+	// archive can provide it.
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for ( ; it != _list.end(); ++it) {
-		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
+		if (it->_arc == archive)
+			continue;
+
+		stream = it->_arc->createReadStreamForMember(name);
 		if (stream)
 			return stream;
 	}
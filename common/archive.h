@@ -24,6 +24,9 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/atomic.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "common/list.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
@@ -117,6 +120,12 @@ public:
 	 * @return the newly created input stream
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const = 0;
+
+	/**
+	 * Get a number which changes whenever the members of the archive
+	 * change. Archives which do not keep track of this always return 0.
+	 */
+	virtual uint32 getGeneration() const { return 0; }
 };
 
 
@@ -126,6 +135,15 @@ public:
  * contained Archives, hence the simplistic policy of always looking for the first
  * match. SearchSet *DOES* guarantee that searches are performed in *DESCENDING*
  * priority order. In case of conflicting priorities, insertion order prevails.
+ *
+ * The archive each name resolves to, or the fact that no archive contains
+ * it, is remembered in an index, so repeated lookups of the same name do
+ * not have to ask every archive again. The index is discarded whenever
+ * the set of archives or their order changes, or the generation of one
+ * of the archives changes, so that changes to nested sets are taken into
+ * account as well. Changes to the contents of other archives are not
+ * noticed; call invalidateIndex() after modifying an archive which is
+ * part of a set.
  */
 class SearchSet : public Archive {
 	struct Node {
@@ -133,8 +151,11 @@ class SearchSet : public Archive {
 		String	_name;
 		Archive	*_arc;
 		bool	_autoFree;
+		// Generation of the archive when the index was last checked
+		mutable uint32 _generation;
 		Node(int priority, const String &name, Archive *arc, bool autoFree)
-			: _priority(priority), _name(name), _arc(arc), _autoFree(autoFree) {
+			: _priority(priority), _name(name), _arc(arc), _autoFree(autoFree),
+			  _generation(arc->getGeneration()) {
 		}
 	};
 	typedef List<Node> ArchiveNodeList;
@@ -146,7 +167,29 @@ class SearchSet : public Archive {
 	// Add an archive keeping the list sorted by descending priority.
 	void insert(const Node& node);
 
+	enum {
+		kMaxIndexSize = 8192
+	};
+
+	// Maps names to the archive they resolve to, or 0 if no archive
+	// contains them.
+	typedef HashMap<String, Archive *> NameIndex;
+	mutable NameIndex _index;
+	mutable uint32 _indexGeneration;
+	mutable volatile uint32 _generation;
+	mutable SpinLock _indexLock;
+	mutable uint32 _numLookups;
+	mutable uint32 _numMisses;
+
+	// Get the generation of the set, after taking changes to the generations
+	// of the archives into account. Must be called with the index locked.
+	uint32 updateGeneration() const;
+
+	// Find the archive containing the given name, using the index.
+	Archive *lookup(const String &name) const;
+
 public:
+	SearchSet() : _indexGeneration(0), _generation(0), _numLookups(0), _numMisses(0) {}
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -230,12 +273,28 @@ public:
 	 */
 	void setPriority(const String& name, int priority);
 
+	/**
+	 * Forget which archive each name resolves to. This needs to be called
+	 * when the members of an archive in the set change. Sets containing
+	 * this one notice it through getGeneration().
+	 */
+	void invalidateIndex();
+
+	/**
+	 * Get the number of name lookups performed through hasFile(),
+	 * getMember() and createReadStreamForMember(), and how many of them
+	 * could not be answered by the index and had to search the archives.
+	 */
+	void getLookupStats(uint32 &lookups, uint32 &misses) const;
+
 	virtual bool hasFile(const String &name) const;
 	virtual int listMatchingMembers(ArchiveMemberList &list, const String &pattern) const;
 	virtual int listMembers(ArchiveMemberList &list) const;
 
 	virtual const ArchiveMemberPtr getMember(const String &name) const;
 
+	virtual uint32 getGeneration() const;
+
 	/**
 	 * Implements createReadStreamForMember from Archive base class. The current policy is
 	 * opening the first file encountered that matches the name.
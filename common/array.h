@@ -66,6 +66,14 @@ public:
 		}
 	}
 
+#if __cplusplus >= 201103L
+	/** Construct an array taking over the storage of the given array, which is left empty. */
+	Array(Array<T> &&array) : _capacity(array._capacity), _size(array._size), _storage(array._storage) {
+		array._capacity = array._size = 0;
+		array._storage = 0;
+	}
+#endif
+
 	/**
 	 * Construct an array by copying data from a regular array.
 	 */
@@ -84,12 +92,61 @@ public:
 
 	/** Appends element to the end of the array. */
 	void push_back(const T &element) {
-		if (_size + 1 <= _capacity)
-			new ((void *)&_storage[_size++]) T(element);
-		else
-			insert_aux(end(), &element, &element + 1);
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(element);
+		finishEmplace(oldStorage);
+	}
+
+#if __cplusplus >= 201103L
+	/** Appends element to the end of the array, moving it there. */
+	void push_back(T &&element) {
+		emplace_back(static_cast<T &&>(element));
+	}
+
+	/** Constructs a new element at the end of the array from the given arguments. */
+	template<class... TArgs>
+	void emplace_back(TArgs &&...args) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(static_cast<TArgs &&>(args)...);
+		finishEmplace(oldStorage);
+	}
+#else
+	/** Constructs a new element at the end of the array from the given arguments. */
+	void emplace_back() {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T();
+		finishEmplace(oldStorage);
+	}
+
+	template<class A1>
+	void emplace_back(const A1 &a1) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(a1);
+		finishEmplace(oldStorage);
+	}
+
+	template<class A1, class A2>
+	void emplace_back(const A1 &a1, const A2 &a2) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(a1, a2);
+		finishEmplace(oldStorage);
+	}
+
+	template<class A1, class A2, class A3>
+	void emplace_back(const A1 &a1, const A2 &a2, const A3 &a3) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(a1, a2, a3);
+		finishEmplace(oldStorage);
 	}
 
+	template<class A1, class A2, class A3, class A4>
+	void emplace_back(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(a1, a2, a3, a4);
+		finishEmplace(oldStorage);
+	}
+#endif
+
 	void push_back(const Array<T> &array) {
 		if (_size + array.size() <= _capacity) {
 			uninitialized_copy(array.begin(), array.end(), end());
@@ -145,7 +202,7 @@ public:
 	T remove_at(size_type idx) {
 		assert(idx < _size);
 		T tmp = _storage[idx];
-		copy(_storage + idx + 1, _storage + _size, _storage + idx);
+		move(_storage + idx + 1, _storage + _size, _storage + idx);
 		_size--;
 		// We also need to destroy the last object properly here.
 		_storage[_size].~T();
@@ -176,6 +233,22 @@ public:
 		return *this;
 	}
 
+#if __cplusplus >= 201103L
+	Array<T> &operator=(Array<T> &&array) {
+		if (this == &array)
+			return *this;
+
+		freeStorage(_storage, _size);
+		_capacity = array._capacity;
+		_size = array._size;
+		_storage = array._storage;
+		array._capacity = array._size = 0;
+		array._storage = 0;
+
+		return *this;
+	}
+#endif
+
 	size_type size() const {
 		return _size;
 	}
@@ -231,8 +304,8 @@ public:
 		allocCapacity(newCapacity);
 
 		if (oldStorage) {
-			// Copy old data
-			uninitialized_copy(oldStorage, oldStorage + _size, _storage);
+			// Move old data
+			uninitialized_move(oldStorage, oldStorage + _size, _storage);
 			freeStorage(oldStorage, _size);
 		}
 	}
@@ -241,6 +314,8 @@ public:
 		reserve(newSize);
 		for (size_type i = _size; i < newSize; ++i)
 			new ((void *)&_storage[i]) T();
+		for (size_type i = newSize; i < _size; ++i)
+			_storage[i].~T();
 		_size = newSize;
 	}
 
@@ -278,6 +353,29 @@ protected:
 		free(storage);
 	}
 
+	/**
+	 * Make room for a new element at the end of the array. If the storage
+	 * has to grow, the old storage is returned and only released by
+	 * finishEmplace(), so the arguments for constructing the new element
+	 * may still refer to elements of this array.
+	 */
+	T *prepareEmplace() {
+		if (_size < _capacity)
+			return 0;
+
+		T *const oldStorage = _storage;
+		allocCapacity(roundUpCapacity(_size + 1));
+		return oldStorage;
+	}
+
+	void finishEmplace(T *oldStorage) {
+		if (oldStorage) {
+			uninitialized_move(oldStorage, oldStorage + _size, _storage);
+			freeStorage(oldStorage, _size);
+		}
+		_size++;
+	}
+
 	/**
 	 * Insert a range of elements coming from this or another array.
 	 * Unlike std::vector::insert, this method does not accept
@@ -302,33 +400,35 @@ protected:
 
 				// If there is not enough space, allocate more.
 				// Likewise, if this is a self-insert, we allocate new
-				// storage to avoid conflicts.
-				allocCapacity(roundUpCapacity(_size + n));
+				// storage to avoid conflicts. Never give up on capacity
+				// reserved before, though.
+				allocCapacity(MAX(_capacity, roundUpCapacity(_size + n)));
 
-				// Copy the data from the old storage till the position where
-				// we insert new data
-				uninitialized_copy(oldStorage, oldStorage + idx, _storage);
-				// Copy the data we insert
+				// Copy the data we insert first, as it may come from the
+				// old storage
 				uninitialized_copy(first, last, _storage + idx);
-				// Afterwards copy the old data from the position where we
+				// Move the data from the old storage till the position where
+				// we insert new data
+				uninitialized_move(oldStorage, oldStorage + idx, _storage);
+				// Afterwards move the old data from the position where we
 				// insert.
-				uninitialized_copy(oldStorage + idx, oldStorage + _size, _storage + idx + n);
+				uninitialized_move(oldStorage + idx, oldStorage + _size, _storage + idx + n);
 
 				freeStorage(oldStorage, _size);
 			} else if (idx + n <= _size) {
 				// Make room for the new elements by shifting back
 				// existing ones.
 				// 1. Move a part of the data to the uninitialized area
-				uninitialized_copy(_storage + _size - n, _storage + _size, _storage + _size);
+				uninitialized_move(_storage + _size - n, _storage + _size, _storage + _size);
 				// 2. Move a part of the data to the initialized area
-				copy_backward(pos, _storage + _size - n, _storage + _size);
+				move_backward(pos, _storage + _size - n, _storage + _size);
 
 				// Insert the new elements.
 				copy(first, last, pos);
 			} else {
-				// Copy the old data from the position till the end to the new
+				// Move the old data from the position till the end to the new
 				// place.
-				uninitialized_copy(pos, _storage + _size, _storage + idx + n);
+				uninitialized_move(pos, _storage + _size, _storage + idx + n);
 
 				// Copy a part of the new data to the position inside the
 				// initialized space.
@@ -347,6 +447,237 @@ protected:
 
 };
 
+/**
+ * A variant of Array with inline storage for the first N elements, for
+ * short lists which are built often, like dirty rectangles or arguments.
+ * As long as there are no more than N elements, no memory is allocated.
+ *
+ * Only the most common subset of the Array interface is provided.
+ */
+template<class T, uint N>
+class SmallArray {
+public:
+	typedef T *iterator;
+	typedef const T *const_iterator;
+
+	typedef T value_type;
+
+	typedef uint size_type;
+
+private:
+	size_type _capacity;
+	size_type _size;
+	T *_storage;
+
+	// Aligned like the most strictly aligned basic types
+	union {
+		byte _bytes[N * sizeof(T)];
+		void *_alignPointer;
+		uint64 _alignInt;
+		double _alignDouble;
+	} _inline;
+
+public:
+	SmallArray() : _capacity(N), _size(0), _storage((T *)_inline._bytes) {}
+
+	SmallArray(const SmallArray<T, N> &array) : _capacity(N), _size(0), _storage((T *)_inline._bytes) {
+		reserve(array._size);
+		uninitialized_copy(array.begin(), array.end(), _storage);
+		_size = array._size;
+	}
+
+	~SmallArray() {
+		freeStorage(_storage, _size);
+	}
+
+	SmallArray<T, N> &operator=(const SmallArray<T, N> &array) {
+		if (this == &array)
+			return *this;
+
+		clear();
+		reserve(array._size);
+		uninitialized_copy(array.begin(), array.end(), _storage);
+		_size = array._size;
+		return *this;
+	}
+
+	/** Whether the elements are stored inline, i.e. no memory has been allocated. */
+	bool isInline() const { return _storage == (const T *)_inline._bytes; }
+
+	void push_back(const T &element) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(element);
+		finishEmplace(oldStorage);
+	}
+
+#if __cplusplus >= 201103L
+	void push_back(T &&element) {
+		emplace_back(static_cast<T &&>(element));
+	}
+
+	template<class... TArgs>
+	void emplace_back(TArgs &&...args) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(static_cast<TArgs &&>(args)...);
+		finishEmplace(oldStorage);
+	}
+#else
+	void emplace_back() {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T();
+		finishEmplace(oldStorage);
+	}
+
+	template<class A1>
+	void emplace_back(const A1 &a1) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(a1);
+		finishEmplace(oldStorage);
+	}
+
+	template<class A1, class A2>
+	void emplace_back(const A1 &a1, const A2 &a2) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(a1, a2);
+		finishEmplace(oldStorage);
+	}
+
+	template<class A1, class A2, class A3>
+	void emplace_back(const A1 &a1, const A2 &a2, const A3 &a3) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(a1, a2, a3);
+		finishEmplace(oldStorage);
+	}
+
+	template<class A1, class A2, class A3, class A4>
+	void emplace_back(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4) {
+		T *const oldStorage = prepareEmplace();
+		new ((void *)(_storage + _size)) T(a1, a2, a3, a4);
+		finishEmplace(oldStorage);
+	}
+#endif
+
+	void pop_back() {
+		assert(_size > 0);
+		_size--;
+		_storage[_size].~T();
+	}
+
+	void insert_at(size_type idx, const T &element) {
+		assert(idx <= _size);
+		// Append a copy first, as element may be part of this array
+		push_back(element);
+		T tmp = _storage[_size - 1];
+		move_backward(_storage + idx, _storage + _size - 1, _storage + _size);
+		_storage[idx] = tmp;
+	}
+
+	T remove_at(size_type idx) {
+		assert(idx < _size);
+		T tmp = _storage[idx];
+		move(_storage + idx + 1, _storage + _size, _storage + idx);
+		pop_back();
+		return tmp;
+	}
+
+	T &front() {
+		assert(_size > 0);
+		return _storage[0];
+	}
+
+	const T &front() const {
+		assert(_size > 0);
+		return _storage[0];
+	}
+
+	T &back() {
+		assert(_size > 0);
+		return _storage[_size - 1];
+	}
+
+	const T &back() const {
+		assert(_size > 0);
+		return _storage[_size - 1];
+	}
+
+	T &operator[](size_type idx) {
+		assert(idx < _size);
+		return _storage[idx];
+	}
+
+	const T &operator[](size_type idx) const {
+		assert(idx < _size);
+		return _storage[idx];
+	}
+
+	size_type size() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	/** Remove all elements, returning to the inline storage. */
+	void clear() {
+		freeStorage(_storage, _size);
+		_storage = (T *)_inline._bytes;
+		_capacity = N;
+		_size = 0;
+	}
+
+	iterator begin() { return _storage; }
+	iterator end() { return _storage + _size; }
+	const_iterator begin() const { return _storage; }
+	const_iterator end() const { return _storage + _size; }
+
+	void reserve(size_type newCapacity) {
+		if (newCapacity <= _capacity)
+			return;
+
+		T *const oldStorage = _storage;
+		allocCapacity(newCapacity);
+		uninitialized_move(oldStorage, oldStorage + _size, _storage);
+		freeStorage(oldStorage, _size);
+	}
+
+	void resize(size_type newSize) {
+		reserve(newSize);
+		for (size_type i = _size; i < newSize; ++i)
+			new ((void *)&_storage[i]) T();
+		for (size_type i = newSize; i < _size; ++i)
+			_storage[i].~T();
+		_size = newSize;
+	}
+
+private:
+	void allocCapacity(size_type capacity) {
+		_storage = (T *)malloc(sizeof(T) * capacity);
+		if (!_storage)
+			::error("Common::SmallArray: failure to allocate %u bytes", capacity * (size_type)sizeof(T));
+		_capacity = capacity;
+	}
+
+	void freeStorage(T *storage, const size_type elements) {
+		for (size_type i = 0; i < elements; ++i)
+			storage[i].~T();
+		if (storage != (T *)_inline._bytes)
+			free(storage);
+	}
+
+	T *prepareEmplace() {
+		if (_size < _capacity)
+			return 0;
+
+		T *const oldStorage = _storage;
+		allocCapacity(_capacity * 2);
+		return oldStorage;
+	}
+
+	void finishEmplace(T *oldStorage) {
+		if (oldStorage) {
+			uninitialized_move(oldStorage, oldStorage + _size, _storage);
+			freeStorage(oldStorage, _size);
+		}
+		_size++;
+	}
+};
+
 } // End of namespace Common
 
 #endif
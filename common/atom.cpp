@@ -0,0 +1,184 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/atom.h"
+#include "common/atomic.h"
+#include "common/hash-str.h"
+
+namespace Common {
+
+typedef const void *volatile AtomSlot;
+
+/**
+ * Open addressing hash table of the atom entries, hashed ignoring case so
+ * that all case variants of a string share one probe sequence. Entries are
+ * only ever added, so lookups can probe the table without taking a lock.
+ */
+struct AtomTable {
+	uint size; ///< number of slots, a power of two
+	uint used;
+	AtomSlot *slots;
+};
+
+// Atoms refer to their entries without counting references, so entries
+// are kept for the lifetime of the program. So are replaced tables, since
+// lookups may still be probing them. Lookups of strings which may not be
+// keys use findIgnoreCase(), which does not add entries.
+static AtomTable *volatile s_atoms = 0;
+
+// Serializes adding entries
+static SpinLock s_atomsLock;
+
+static void insertIntoTable(AtomTable *table, const void *entry, uint hashLower) {
+	const uint mask = table->size - 1;
+	uint i = hashLower & mask;
+	while (table->slots[i])
+		i = (i + 1) & mask;
+
+	atomicStorePtr(table->slots[i], entry);
+	table->used++;
+}
+
+Atom::Atom(const char *str) : _entry(intern(String(str))) {
+}
+
+Atom::Atom(const String &str) : _entry(intern(str)) {
+}
+
+const Atom::Entry *Atom::lookup(const char *str, bool ignoreCase) {
+	const AtomTable *table = atomicLoadPtr(s_atoms);
+	if (!table)
+		return 0;
+
+	const uint mask = table->size - 1;
+	for (uint i = hashit_lower(str) & mask; ; i = (i + 1) & mask) {
+		const Entry *entry = (const Entry *)atomicLoadPtr(table->slots[i]);
+		if (!entry)
+			return 0;
+		if (ignoreCase ? entry->str.equalsIgnoreCase(str) : entry->str.equals(str))
+			return entry;
+	}
+}
+
+void Atom::insert(const Entry *entry) {
+	// Only called with s_atomsLock held, so the table does not change
+	AtomTable *table = s_atoms;
+
+	// Keep the table at most half full, so that probe sequences stay short
+	// and always end in an empty slot.
+	if (!table || (table->used + 1) * 2 > table->size) {
+		AtomTable *newTable = new AtomTable;
+		newTable->size = table ? table->size * 2 : 256;
+		newTable->used = 0;
+		newTable->slots = new AtomSlot[newTable->size]();
+
+		if (table) {
+			for (uint i = 0; i < table->size; i++) {
+				const Entry *oldEntry = (const Entry *)table->slots[i];
+				if (oldEntry)
+					insertIntoTable(newTable, oldEntry, oldEntry->hashLower);
+			}
+		}
+
+		atomicStorePtr(s_atoms, newTable);
+		table = newTable;
+	}
+
+	insertIntoTable(table, entry, entry->hashLower);
+}
+
+const Atom::Entry *Atom::intern(const String &str) {
+	// The empty string is represented by a null entry, so that default
+	// constructed atoms need no lookup.
+	if (str.empty())
+		return 0;
+
+	const Entry *entry = lookup(str.c_str(), false);
+	if (entry)
+		return entry;
+
+	// Intern the lowercase version first, so that the new entry is
+	// complete once other threads can see it.
+	String lower(str);
+	lower.toLowercase();
+	const Entry *lowercase = lower.equals(str) ? 0 : intern(lower);
+
+	s_atomsLock.lock();
+	// Another thread may have interned the string in the meantime
+	entry = lookup(str.c_str(), false);
+	if (!entry) {
+		Entry *newEntry = new Entry;
+		// Copy the characters rather than sharing the reference counted
+		// buffer of the caller's string, whose count is not atomic.
+		newEntry->str = String(str.c_str(), str.size());
+		newEntry->hash = hashit(str);
+		newEntry->hashLower = hashit_lower(str);
+		newEntry->lowercase = lowercase ? lowercase : newEntry;
+		insert(newEntry);
+		entry = newEntry;
+	}
+	s_atomsLock.unlock();
+
+	return entry;
+}
+
+bool Atom::findIgnoreCase(const String &str, Atom &atom) {
+	if (str.empty()) {
+		atom = Atom();
+		return true;
+	}
+
+	const Entry *entry = lookup(str.c_str(), true);
+	if (!entry)
+		return false;
+
+	atom = Atom(entry);
+	return true;
+}
+
+bool Atom::find(const String &str, Atom &atom) {
+	if (str.empty()) {
+		atom = Atom();
+		return true;
+	}
+
+	const Entry *entry = lookup(str.c_str(), false);
+	if (!entry)
+		return false;
+
+	atom = Atom(entry);
+	return true;
+}
+
+const String &Atom::emptyString() {
+	static const String empty;
+	return empty;
+}
+
+uint Atom::getNumAtoms() {
+	s_atomsLock.lock();
+	const uint num = s_atoms ? s_atoms->used : 0;
+	s_atomsLock.unlock();
+	return num;
+}
+
+} // End of namespace Common
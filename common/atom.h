@@ -0,0 +1,141 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOM_H
+#define COMMON_ATOM_H
+
+#include "common/scummsys.h"
+#include "common/str.h"
+#include "common/func.h"
+
+namespace Common {
+
+/**
+ * An interned string. All atoms created from equal strings share a single
+ * copy of the string, which lives until the end of the program, together
+ * with its precomputed hash.
+ *
+ * Creating an atom from a string costs one hash table lookup. Comparing
+ * atoms (also ignoring the case) and hashing them on the other hand is as
+ * cheap as for a pointer. This makes atoms suited as HashMap keys for
+ * identifiers which are looked up often, like configuration keys and
+ * theme variable names.
+ *
+ * Atoms can be created from and are convertible to strings, so they can
+ * be used in most places which expect strings.
+ */
+class Atom {
+public:
+	/** Create the atom of the empty string. */
+	Atom() : _entry(0) {}
+
+	Atom(const char *str);
+	Atom(const String &str);
+
+	const String &str() const { return _entry ? _entry->str : emptyString(); }
+	const char *c_str() const { return str().c_str(); }
+	uint size() const { return str().size(); }
+	bool empty() const { return _entry == 0; }
+
+	operator const String &() const { return str(); }
+
+	/** The hash of the string, as computed by hashit(). */
+	uint hash() const { return _entry ? _entry->hash : 0; }
+
+	/** The case insensitive hash of the string, as computed by hashit_lower(). */
+	uint hashIgnoreCase() const { return _entry ? _entry->lowercase->hash : 0; }
+
+	/** Return the atom of the lowercase version of the string. */
+	Atom toLowercase() const { return Atom(_entry ? _entry->lowercase : 0); }
+
+	bool operator==(const Atom &x) const { return _entry == x._entry; }
+	bool operator!=(const Atom &x) const { return _entry != x._entry; }
+
+	// Comparing against plain strings does not intern them
+	bool operator==(const String &x) const { return str().equals(x); }
+	bool operator!=(const String &x) const { return !str().equals(x); }
+	bool operator==(const char *x) const { return str().equals(x); }
+	bool operator!=(const char *x) const { return !str().equals(x); }
+
+	bool equalsIgnoreCase(const Atom &x) const {
+		return (_entry ? _entry->lowercase : 0) == (x._entry ? x._entry->lowercase : 0);
+	}
+
+	/**
+	 * Look up the atom of a string, ignoring case, without interning the
+	 * string. Strings which were never interned can not be keys of any
+	 * map, so lookups can use this to not grow the atom table.
+	 *
+	 * @param str	the string to look up
+	 * @param atom	set to an atom equal to the string ignoring case, to be
+	 *				used with Atom_IgnoreCase_Hash and Atom_IgnoreCase_EqualTo
+	 * @return true if such an atom exists, false otherwise
+	 */
+	static bool findIgnoreCase(const String &str, Atom &atom);
+
+	/**
+	 * Look up the atom of a string without interning the string, like
+	 * findIgnoreCase() but for maps which do not ignore case.
+	 *
+	 * @param str	the string to look up
+	 * @param atom	set to the atom of the string
+	 * @return true if the string was interned before, false otherwise
+	 */
+	static bool find(const String &str, Atom &atom);
+
+	/** Return the number of distinct strings interned so far. */
+	static uint getNumAtoms();
+
+private:
+	struct Entry {
+		String str;
+		uint hash;
+		uint hashLower; ///< hashit_lower() of the string, used by the atom table
+		const Entry *lowercase; ///< entry of the lowercase string, may be this entry
+	};
+
+	const Entry *_entry;
+
+	explicit Atom(const Entry *entry) : _entry(entry) {}
+
+	static const Entry *lookup(const char *str, bool ignoreCase);
+	static const Entry *intern(const String &str);
+	static void insert(const Entry *entry);
+	static const String &emptyString();
+};
+
+template<>
+struct Hash<Atom> {
+	uint operator()(const Atom &x) const { return x.hash(); }
+};
+
+struct Atom_IgnoreCase_Hash {
+	uint operator()(const Atom &x) const { return x.hashIgnoreCase(); }
+};
+
+struct Atom_IgnoreCase_EqualTo {
+	bool operator()(const Atom &x, const Atom &y) const { return x.equalsIgnoreCase(y); }
+};
+
+} // End of namespace Common
+
+#endif
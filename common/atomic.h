@@ -0,0 +1,207 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+// configure checks whether the GCC builtins can be linked. Projects built
+// without it are MSVC, Xcode and Code::Blocks, whose compilers have them.
+#if defined(_MSC_VER)
+#define SCUMMVM_HAVE_ATOMICS
+#elif defined(__GNUC__) && (defined(HAVE_SYNC_BUILTINS) || !defined(HAVE_CONFIG_H))
+#define SCUMMVM_HAVE_ATOMICS
+#endif
+
+#if defined(_MSC_VER)
+// For the _Interlocked* intrinsics. intrin.h is included through
+// common/math.h, which works around its clash with our forbidden symbols.
+#include "common/math.h"
+#endif
+
+/**
+ * @file
+ * Minimal set of atomic operations for sharing plain 32-bit words and
+ * pointers between threads without taking a mutex, e.g. between engine
+ * code and the audio callback.
+ *
+ * All operations act as full memory barriers. If the target offers no
+ * suitable intrinsics, SCUMMVM_HAVE_ATOMICS is left undefined and the
+ * operations degrade to plain volatile accesses. Such targets must run
+ * core code on a single thread: configure then disables pthreads, and
+ * backends must not enable lock-free or render-ahead mixing.
+ */
+
+namespace Common {
+
+/**
+ * Issue a full memory barrier: no load or store is reordered across it,
+ * neither by the compiler nor by the CPU.
+ */
+inline void memoryBarrier() {
+#if defined(SCUMMVM_HAVE_ATOMICS) && defined(__GNUC__)
+	__sync_synchronize();
+#elif defined(SCUMMVM_HAVE_ATOMICS)
+	long barrier = 0;
+	_InterlockedExchange(&barrier, 1);
+#elif defined(__GNUC__)
+	// Still keep the compiler from reordering memory accesses
+	__asm__ __volatile__("" : : : "memory");
+#endif
+}
+
+/**
+ * Read a value which is concurrently written by another thread. Memory
+ * accesses following the load are not reordered before it.
+ */
+inline uint32 atomicLoad(const volatile uint32 &var) {
+	uint32 val = var;
+	memoryBarrier();
+	return val;
+}
+
+/**
+ * Publish a value to another thread. Memory accesses preceding the store
+ * are visible to any thread which observes the new value.
+ */
+inline void atomicStore(volatile uint32 &var, uint32 val) {
+	memoryBarrier();
+	var = val;
+	memoryBarrier();
+}
+
+/**
+ * Read a pointer which is concurrently written by another thread, like
+ * atomicLoad().
+ */
+template<class T>
+inline T *atomicLoadPtr(T *const volatile &var) {
+	T *val = var;
+	memoryBarrier();
+	return val;
+}
+
+/**
+ * Publish a pointer to another thread, like atomicStore(). In particular,
+ * the object it points to is visible to any thread which observes it.
+ */
+template<class T>
+inline void atomicStorePtr(T *volatile &var, T *val) {
+	memoryBarrier();
+	var = val;
+	memoryBarrier();
+}
+
+/**
+ * Atomically add a delta to a value.
+ *
+ * @return the new value
+ */
+inline uint32 atomicAdd(volatile uint32 &var, uint32 delta) {
+#if defined(SCUMMVM_HAVE_ATOMICS) && defined(__GNUC__)
+	return __sync_add_and_fetch(&var, delta);
+#elif defined(SCUMMVM_HAVE_ATOMICS)
+	return (uint32)_InterlockedExchangeAdd((volatile long *)&var, (long)delta) + delta;
+#else
+	var += delta;
+	return var;
+#endif
+}
+
+/**
+ * Atomically replace a value, provided it still equals an expected value.
+ *
+ * @return true if the value was replaced
+ */
+inline bool atomicCompareAndSwap(volatile uint32 &var, uint32 expected, uint32 val) {
+#if defined(SCUMMVM_HAVE_ATOMICS) && defined(__GNUC__)
+	return __sync_bool_compare_and_swap(&var, expected, val);
+#elif defined(SCUMMVM_HAVE_ATOMICS)
+	return (uint32)_InterlockedCompareExchange((volatile long *)&var, (long)val, (long)expected) == expected;
+#else
+	if (var != expected)
+		return false;
+	var = val;
+	return true;
+#endif
+}
+
+/**
+ * Hint to the CPU that the caller is busy-waiting. This saves power and
+ * frees execution resources for another hardware thread on the same core.
+ */
+inline void cpuRelax() {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	_mm_pause();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	__builtin_ia32_pause();
+#elif defined(__GNUC__) && (defined(__aarch64__) || (defined(__ARM_ARCH) && __ARM_ARCH >= 7))
+	__asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * A lock for very short critical sections, which busy-waits instead of
+ * sleeping. Unlike Mutex it does not depend on OSystem, so it can also
+ * be used before the backend is set up, e.g. during static initialization.
+ *
+ * If the lock is held for longer, e.g. because its owner got preempted,
+ * waiting threads give up their time slice instead of spinning on.
+ */
+class SpinLock {
+public:
+	SpinLock() : _locked(0) {}
+
+	void lock() {
+		uint spins = 0;
+		while (!atomicCompareAndSwap(_locked, 0, 1)) {
+			while (_locked) {
+				if (spins < kMaxSpins) {
+					spins++;
+					cpuRelax();
+				} else {
+					yield();
+				}
+			}
+		}
+	}
+
+	void unlock() {
+		atomicStore(_locked, 0);
+	}
+
+private:
+	enum {
+		/** Number of times to spin before yielding */
+		kMaxSpins = 1000
+	};
+
+	volatile uint32 _locked;
+
+	/** Let other threads run, where the platform supports that. */
+	static void yield();
+};
+
+} // End of namespace Common
+
+#endif
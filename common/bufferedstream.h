@@ -50,6 +50,25 @@ ReadStream *wrapBufferedReadStream(ReadStream *parentStream, uint32 bufSize, Dis
  */
 SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream);
 
+/**
+ * Take an arbitrary SeekableReadStream and wrap it in a custom stream which
+ * reads ahead: while the data of one buffer is consumed, the next one is
+ * read on a background I/O thread. This keeps I/O stalls away from
+ * sequential consumers like video and audio decoders.
+ *
+ * The parent stream is accessed from the I/O thread, so it must not be
+ * used by anyone else as long as the wrapper exists. In particular, it
+ * must not share its underlying file with other streams, as e.g. a
+ * SeekableSubReadStream does. Streams whose data is in memory already are
+ * not read ahead.
+ *
+ * On platforms without thread support the data is read synchronously.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ */
+SeekableReadStream *wrapPrefetchingReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which
  * transparently provides buffering.
@@ -36,6 +36,12 @@ static bool isValidDomainName(const Common::String &domName) {
 
 namespace Common {
 
+/** The value of keys which are not set. */
+static const String &emptyValue() {
+	static const String empty;
+	return empty;
+}
+
 DECLARE_SINGLETON(ConfigManager);
 
 char const *const ConfigManager::kApplicationDomain = "scummvm";
@@ -265,19 +271,27 @@ void ConfigManager::flushToDisk() {
 		stream = dump;
 	}
 
+	saveToStream(*stream);
+
+	delete stream;
+
+#endif // !__DC__
+}
+
+void ConfigManager::saveToStream(WriteStream &stream) {
 	// Write the application domain
-	writeDomain(*stream, kApplicationDomain, _appDomain);
+	writeDomain(stream, kApplicationDomain, _appDomain);
 
 #ifdef ENABLE_KEYMAPPER
 	// Write the keymapper domain
-	writeDomain(*stream, kKeymapperDomain, _keymapperDomain);
+	writeDomain(stream, kKeymapperDomain, _keymapperDomain);
 #endif
 
 	DomainMap::const_iterator d;
 
 	// Write the miscellaneous domains next
 	for (d = _miscDomains.begin(); d != _miscDomains.end(); ++d) {
-		writeDomain(*stream, d->_key, d->_value);
+		writeDomain(stream, d->_key, d->_value);
 	}
 
 	// First write the domains in _domainSaveOrder, in that order.
@@ -286,19 +300,15 @@ void ConfigManager::flushToDisk() {
 	Array<String>::const_iterator i;
 	for (i = _domainSaveOrder.begin(); i != _domainSaveOrder.end(); ++i) {
 		if (_gameDomains.contains(*i)) {
-			writeDomain(*stream, *i, _gameDomains[*i]);
+			writeDomain(stream, *i, _gameDomains[*i]);
 		}
 	}
 
 	// Now write the domains which haven't been written yet
 	for (d = _gameDomains.begin(); d != _gameDomains.end(); ++d) {
 		if (find(_domainSaveOrder.begin(), _domainSaveOrder.end(), d->_key) == _domainSaveOrder.end())
-			writeDomain(*stream, d->_key, d->_value);
+			writeDomain(stream, d->_key, d->_value);
 	}
-
-	delete stream;
-
-#endif // !__DC__
 }
 
 void ConfigManager::writeDomain(WriteStream &stream, const String &name, const Domain &domain) {
@@ -398,13 +408,17 @@ bool ConfigManager::hasKey(const String &key) const {
 	// 3) the application domain.
 	// The defaults domain is explicitly *not* checked.
 
-	if (_transientDomain.contains(key))
+	Atom atom;
+	if (!Atom::findIgnoreCase(key, atom))
+		return false;
+
+	if (_transientDomain.find(atom))
 		return true;
 
-	if (_activeDomain && _activeDomain->contains(key))
+	if (_activeDomain && _activeDomain->find(atom))
 		return true;
 
-	if (_appDomain.contains(key))
+	if (_appDomain.find(atom))
 		return true;
 
 	return false;
@@ -439,14 +453,19 @@ void ConfigManager::removeKey(const String &key, const String &domName) {
 
 
 const String &ConfigManager::get(const String &key) const {
-	if (_transientDomain.contains(key))
-		return _transientDomain[key];
-	else if (_activeDomain && _activeDomain->contains(key))
-		return (*_activeDomain)[key];
-	else if (_appDomain.contains(key))
-		return _appDomain[key];
+	Atom atom;
+	if (!Atom::findIgnoreCase(key, atom))
+		return emptyValue();
 
-	return _defaultsDomain.getVal(key);
+	const String *value = _transientDomain.find(atom);
+	if (!value && _activeDomain)
+		value = _activeDomain->find(atom);
+	if (!value)
+		value = _appDomain.find(atom);
+	if (!value)
+		value = _defaultsDomain.find(atom);
+
+	return value ? *value : emptyValue();
 }
 
 const String &ConfigManager::get(const String &key, const String &domName) const {
@@ -462,10 +481,15 @@ const String &ConfigManager::get(const String &key, const String &domName) const
 		error("ConfigManager::get(%s,%s) called on non-existent domain",
 		      key.c_str(), domName.c_str());
 
-	if (domain->contains(key))
-		return (*domain)[key];
+	Atom atom;
+	if (!Atom::findIgnoreCase(key, atom))
+		return emptyValue();
+
+	const String *value = domain->find(atom);
+	if (!value)
+		value = _defaultsDomain.find(atom);
 
-	return _defaultsDomain.getVal(key);
+	return value ? *value : emptyValue();
 }
 
 int ConfigManager::getInt(const String &key, const String &domName) const {
@@ -503,19 +527,19 @@ bool ConfigManager::getBool(const String &key, const String &domName) const {
 #pragma mark -
 
 
-void ConfigManager::set(const String &key, const String &value) {
+void ConfigManager::set(const Atom &key, const String &value) {
 	// Remove the transient domain value, if any.
 	_transientDomain.erase(key);
 
 	// Write the new key/value pair into the active domain, resp. into
 	// the application domain if no game domain is active.
 	if (_activeDomain)
-		(*_activeDomain)[key] = value;
+		_activeDomain->setVal(key, value);
 	else
-		_appDomain[key] = value;
+		_appDomain.setVal(key, value);
 }
 
-void ConfigManager::set(const String &key, const String &value, const String &domName) {
+void ConfigManager::set(const Atom &key, const String &value, const String &domName) {
 	// FIXME: For now we continue to allow empty domName to indicate
 	// "use 'default' domain". This is mainly needed for the SCUMM ConfigDialog
 	// and should be removed ASAP.
@@ -530,7 +554,7 @@ void ConfigManager::set(const String &key, const String &value, const String &do
 		error("ConfigManager::set(%s,%s,%s) called on non-existent domain",
 		      key.c_str(), value.c_str(), domName.c_str());
 
-	(*domain)[key] = value;
+	domain->setVal(key, value);
 
 	// TODO/FIXME: We used to erase the given key from the transient domain
 	// here. Do we still want to do that?
@@ -560,11 +584,11 @@ void ConfigManager::set(const String &key, const String &value, const String &do
 #endif
 }
 
-void ConfigManager::setInt(const String &key, int value, const String &domName) {
+void ConfigManager::setInt(const Atom &key, int value, const String &domName) {
 	set(key, String::format("%i", value), domName);
 }
 
-void ConfigManager::setBool(const String &key, bool value, const String &domName) {
+void ConfigManager::setBool(const Atom &key, bool value, const String &domName) {
 	set(key, String(value ? "true" : "false"), domName);
 }
 
@@ -572,19 +596,19 @@ void ConfigManager::setBool(const String &key, bool value, const String &domName
 #pragma mark -
 
 
-void ConfigManager::registerDefault(const String &key, const String &value) {
-	_defaultsDomain[key] = value;
+void ConfigManager::registerDefault(const Atom &key, const String &value) {
+	_defaultsDomain.setVal(key, value);
 }
 
-void ConfigManager::registerDefault(const String &key, const char *value) {
+void ConfigManager::registerDefault(const Atom &key, const char *value) {
 	registerDefault(key, String(value));
 }
 
-void ConfigManager::registerDefault(const String &key, int value) {
+void ConfigManager::registerDefault(const Atom &key, int value) {
 	registerDefault(key, String::format("%i", value));
 }
 
-void ConfigManager::registerDefault(const String &key, bool value) {
+void ConfigManager::registerDefault(const Atom &key, bool value) {
 	registerDefault(key, value ? "true" : "false");
 }
 
@@ -685,14 +709,34 @@ const String &ConfigManager::Domain::getDomainComment() const {
 	return _domainComment;
 }
 
-void ConfigManager::Domain::setKVComment(const String &key, const String &comment) {
+const String &ConfigManager::Domain::getVal(const String &key) const {
+	const String *value = find(key);
+	return value ? *value : emptyValue();
+}
+
+const String *ConfigManager::Domain::find(const String &key) const {
+	Atom atom;
+	return Atom::findIgnoreCase(key, atom) ? find(atom) : 0;
+}
+
+void ConfigManager::Domain::erase(const String &key) {
+	Atom atom;
+	if (Atom::findIgnoreCase(key, atom))
+		_entries.erase(atom);
+}
+
+void ConfigManager::Domain::setKVComment(const Atom &key, const String &comment) {
 	_keyValueComments[key] = comment;
 }
 const String &ConfigManager::Domain::getKVComment(const String &key) const {
-	return _keyValueComments[key];
+	Atom atom;
+	if (!Atom::findIgnoreCase(key, atom))
+		return emptyValue();
+	return _keyValueComments[atom];
 }
 bool ConfigManager::Domain::hasKVComment(const String &key) const {
-	return _keyValueComments.contains(key);
+	Atom atom;
+	return Atom::findIgnoreCase(key, atom) && _keyValueComments.contains(atom);
 }
 
 } // End of namespace Common
@@ -24,6 +24,7 @@
 #define COMMON_CONFIG_MANAGER_H
 
 #include "common/array.h"
+#include "common/atom.h"
 #include "common/hashmap.h"
 #include "common/singleton.h"
 #include "common/str.h"
@@ -46,39 +47,62 @@ class ConfigManager : public Singleton<ConfigManager> {
 
 public:
 
+	/**
+	 * The keys of a domain are atoms, so that the repeated lookups of the
+	 * same key in the various domains only hash and compare pointers.
+	 * As before, keys are case insensitive.
+	 *
+	 * Keys are only interned when they are set. Looking up a key takes a
+	 * string and uses Atom::findIgnoreCase(), so probing for keys which
+	 * are not set does not grow the atom table.
+	 */
+	typedef HashMap<Atom, String, Atom_IgnoreCase_Hash, Atom_IgnoreCase_EqualTo> KeyValueMap;
+
 	class Domain {
 	private:
-		StringMap _entries;
-		StringMap _keyValueComments;
+		KeyValueMap _entries;
+		KeyValueMap _keyValueComments;
 		String _domainComment;
 
 	public:
-		typedef StringMap::const_iterator const_iterator;
+		typedef KeyValueMap::const_iterator const_iterator;
 		const_iterator begin() const { return _entries.begin(); }
 		const_iterator end()   const { return _entries.end(); }
 
 		bool empty() const { return _entries.empty(); }
 
-		bool contains(const String &key) const { return _entries.contains(key); }
+		bool contains(const String &key) const { return find(key) != 0; }
 
 		String &operator[](const String &key) { return _entries[key]; }
-		const String &operator[](const String &key) const { return _entries[key]; }
+		const String &operator[](const String &key) const { return getVal(key); }
 
-		void setVal(const String &key, const String &value) { _entries.setVal(key, value); }
+		void setVal(const Atom &key, const String &value) { _entries.setVal(key, value); }
 
 		String &getVal(const String &key) { return _entries.getVal(key); }
-		const String &getVal(const String &key) const { return _entries.getVal(key); }
+		const String &getVal(const String &key) const;
 
 		void clear() { _entries.clear(); }
 
-		void erase(const String &key) { _entries.erase(key); }
+		void erase(const String &key);
 
 		void setDomainComment(const String &comment);
 		const String &getDomainComment() const;
 
-		void setKVComment(const String &key, const String &comment);
+		void setKVComment(const Atom &key, const String &comment);
 		const String &getKVComment(const String &key) const;
 		bool hasKVComment(const String &key) const;
+
+	private:
+		friend class ConfigManager;
+
+		/** Return the value of the key, or 0 if it is not set. */
+		const String *find(const String &key) const;
+
+		/** Return the value of an atom found by Atom::findIgnoreCase(), or 0 if it is not set. */
+		const String *find(const Atom &key) const {
+			KeyValueMap::const_iterator i = _entries.find(key);
+			return i != _entries.end() ? &i->_value : 0;
+		}
 	};
 
 	typedef HashMap<String, Domain, IgnoreCase_Hash, IgnoreCase_EqualTo> DomainMap;
@@ -113,7 +137,7 @@ public:
 
 	bool				hasKey(const String &key) const;
 	const String &		get(const String &key) const;
-	void				set(const String &key, const String &value);
+	void				set(const Atom &key, const String &value);
 
 #if 1
 	//
@@ -125,7 +149,7 @@ public:
 
 	bool				hasKey(const String &key, const String &domName) const;
 	const String &		get(const String &key, const String &domName) const;
-	void				set(const String &key, const String &value, const String &domName);
+	void				set(const Atom &key, const String &value, const String &domName);
 
 	void				removeKey(const String &key, const String &domName);
 #endif
@@ -135,17 +159,22 @@ public:
 	//
 	int					getInt(const String &key, const String &domName = String()) const;
 	bool				getBool(const String &key, const String &domName = String()) const;
-	void				setInt(const String &key, int value, const String &domName = String());
-	void				setBool(const String &key, bool value, const String &domName = String());
+	void				setInt(const Atom &key, int value, const String &domName = String());
+	void				setBool(const Atom &key, bool value, const String &domName = String());
 
 
-	void				registerDefault(const String &key, const String &value);
-	void				registerDefault(const String &key, const char *value);
-	void				registerDefault(const String &key, int value);
-	void				registerDefault(const String &key, bool value);
+	void				registerDefault(const Atom &key, const String &value);
+	void				registerDefault(const Atom &key, const char *value);
+	void				registerDefault(const Atom &key, int value);
+	void				registerDefault(const Atom &key, bool value);
 
 	void				flushToDisk();
 
+	/** Replace all domains with the configuration read from the given stream. */
+	void				loadFromStream(SeekableReadStream &stream);
+	/** Write the configuration to the given stream, as flushToDisk() writes the configuration file. */
+	void				saveToStream(WriteStream &stream);
+
 	void				setActiveDomain(const String &domName);
 	Domain *			getActiveDomain() { return _activeDomain; }
 	const Domain *		getActiveDomain() const { return _activeDomain; }
@@ -173,7 +202,6 @@ private:
 	friend class Singleton<SingletonBaseType>;
 	ConfigManager();
 
-	void			loadFromStream(SeekableReadStream &stream);
 	void			addDomain(const String &domainName, const Domain &domain);
 	void			writeDomain(WriteStream &stream, const String &name, const Domain &domain);
 	void			renameDomain(const String &oldName, const String &newName, DomainMap &map);
@@ -0,0 +1,92 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/cpudetect.h"
+
+#if defined(SCUMMVM_SSE2) && defined(_MSC_VER)
+// For __cpuidex, see common/math.h on including intrin.h
+#include "common/math.h"
+#elif defined(SCUMMVM_SSE2)
+#include <cpuid.h>
+#endif
+
+namespace Common {
+
+#ifdef SCUMMVM_SSE2
+static void cpuid(uint32 leaf, uint32 regs[4]) {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuidex(info, leaf, 0);
+	for (int i = 0; i < 4; ++i)
+		regs[i] = info[i];
+#else
+	regs[0] = regs[1] = regs[2] = regs[3] = 0;
+	if ((uint32)__get_cpuid_max(leaf & 0x80000000, 0) < leaf)
+		return;
+	__cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint32 readXCR0() {
+#ifdef _MSC_VER
+	return (uint32)_xgetbv(0);
+#else
+	uint32 eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	return eax;
+#endif
+}
+#endif
+
+static uint32 detectCpuFeatures() {
+	uint32 features = 0;
+
+#ifdef SCUMMVM_SSE2
+	uint32 regs[4];
+
+	cpuid(1, regs);
+	if (regs[3] & (1 << 26))
+		features |= kCpuFeatureSSE2;
+
+	// AVX2 also needs the OS to save the YMM registers on context switches
+	const bool osxsave = (regs[2] & (1 << 27)) != 0;
+	const bool avx = (regs[2] & (1 << 28)) != 0;
+	if (osxsave && avx && (readXCR0() & 6) == 6) {
+		cpuid(7, regs);
+		if (regs[1] & (1 << 5))
+			features |= kCpuFeatureAVX2;
+	}
+#endif
+
+#ifdef SCUMMVM_NEON
+	features |= kCpuFeatureNEON;
+#endif
+
+	return features;
+}
+
+bool hasCpuFeature(CpuFeature feature) {
+	static const uint32 features = detectCpuFeatures();
+	return (features & feature) != 0;
+}
+
+} // End of namespace Common
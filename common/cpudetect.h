@@ -0,0 +1,74 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_CPUDETECT_H
+#define COMMON_CPUDETECT_H
+
+#include "common/scummsys.h"
+
+/**
+ * @file
+ * Compile time and run time detection of SIMD instruction set extensions.
+ *
+ * Code using the extensions has to be guarded by the respective
+ * SCUMMVM_SSE2, SCUMMVM_AVX2 or SCUMMVM_NEON define. Functions using
+ * SSE2 or AVX2 intrinsics additionally have to be marked with
+ * SCUMMVM_TARGET_SSE2 / SCUMMVM_TARGET_AVX2, so they can be compiled
+ * without enabling the extension for the whole file, and may only be
+ * called after Common::hasCpuFeature() confirmed the CPU supports them.
+ */
+
+#if (defined(__i386__) || defined(__x86_64__)) && (GCC_ATLEAST(4, 9) || defined(__clang__))
+	#define SCUMMVM_SSE2
+	#define SCUMMVM_AVX2
+	#define SCUMMVM_TARGET_SSE2 __attribute__((target("sse2")))
+	#define SCUMMVM_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)) && _MSC_VER >= 1700
+	#define SCUMMVM_SSE2
+	#define SCUMMVM_AVX2
+	#define SCUMMVM_TARGET_SSE2
+	#define SCUMMVM_TARGET_AVX2
+#endif
+
+// The NEON code paths are not tested on ARM hardware yet, so they are
+// only built when enabled through configure --enable-neon
+#if defined(USE_NEON) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+	#define SCUMMVM_NEON
+#endif
+
+namespace Common {
+
+enum CpuFeature {
+	kCpuFeatureSSE2 = 1 << 0,
+	kCpuFeatureAVX2 = 1 << 1,
+	kCpuFeatureNEON = 1 << 2
+};
+
+/**
+ * Check whether the CPU we are running on supports the given instruction
+ * set extension, and support for it has been compiled in.
+ */
+bool hasCpuFeature(CpuFeature feature);
+
+} // End of namespace Common
+
+#endif
@@ -0,0 +1,496 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/deltasave.h"
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/substream.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Common {
+
+namespace {
+
+enum {
+	kDeltaSaveVersion = 1,
+	/** The granularity in which changes are detected and stored. */
+	kBlockSize = 4096
+};
+
+enum SaveType {
+	kTypeDelta = 1
+};
+
+const uint32 kSaveMagic = MKTAG('D','S','A','V');
+const uint32 kBaseMagic = MKTAG('D','S','V','B');
+
+String getBaseName(const String &name) {
+	// Keep the snapshot out of the patterns engines list their saves with
+	return "." + name + ".base";
+}
+
+/** FNV-1a hash of the snapshot data, identifying it in the deltas. */
+uint32 hashData(const byte *data, uint32 size) {
+	uint32 hash = 2166136261u;
+	for (uint32 i = 0; i < size; ++i)
+		hash = (hash ^ data[i]) * 16777619u;
+	return hash;
+}
+
+/**
+ * The snapshot most recently read or written. Saving the same savefile
+ * repeatedly thus does not read and decompress its snapshot every time.
+ */
+struct BaseCache {
+	SaveFileManager *saveFileMan;
+	String name;
+	uint32 id;
+	byte *data;
+	uint32 size;
+
+	BaseCache() : saveFileMan(0), id(0), data(0), size(0) {}
+	~BaseCache() { clear(); }
+
+	void clear() {
+		free(data);
+		saveFileMan = 0;
+		name.clear();
+		data = 0;
+		size = 0;
+	}
+
+	bool matches(SaveFileManager *sfm, const String &n, uint32 i, uint32 s) const {
+		return data && saveFileMan == sfm && name == n && id == i && size == s;
+	}
+
+	void set(SaveFileManager *sfm, const String &n, uint32 i, byte *d, uint32 s) {
+		clear();
+		saveFileMan = sfm;
+		name = n;
+		id = i;
+		data = d;
+		size = s;
+	}
+};
+
+BaseCache g_baseCache;
+
+/**
+ * Open the snapshot of the given savefile and read its header. The stream
+ * is left at the start of the data.
+ */
+InSaveFile *openBase(SaveFileManager *saveFileMan, const String &name, uint32 &id, uint32 &size) {
+	InSaveFile *in = saveFileMan->openForLoading(getBaseName(name));
+	if (!in)
+		return 0;
+
+	if (in->readUint32BE() != kBaseMagic || in->readByte() > kDeltaSaveVersion) {
+		delete in;
+		return 0;
+	}
+
+	id = in->readUint32LE();
+	size = in->readUint32LE();
+	if (in->err() || in->eos()) {
+		warning("Failed to read the snapshot of savefile '%s'", name.c_str());
+		delete in;
+		return 0;
+	}
+
+	return in;
+}
+
+/**
+ * Load the snapshot of the given savefile, taking it from the cache if it
+ * is still up to date. The returned data is owned by the cache.
+ */
+const byte *loadBase(SaveFileManager *saveFileMan, const String &name, uint32 &id, uint32 &size) {
+	InSaveFile *in = openBase(saveFileMan, name, id, size);
+	if (!in)
+		return 0;
+
+	const byte *data = 0;
+	if (g_baseCache.matches(saveFileMan, name, id, size)) {
+		data = g_baseCache.data;
+	} else {
+		byte *buffer = (byte *)malloc(MAX<uint32>(size, 1));
+		if (buffer && in->read(buffer, size) == size) {
+			g_baseCache.set(saveFileMan, name, id, buffer, size);
+			data = buffer;
+		} else {
+			warning("Failed to read the snapshot of savefile '%s'", name.c_str());
+			free(buffer);
+		}
+	}
+
+	delete in;
+	return data;
+}
+
+bool writeFull(SaveFileManager *saveFileMan, const String &name, const byte *data, uint32 size) {
+	// Full savefiles are stored as they are, so that they do not depend on
+	// the snapshot and can also be loaded without this code.
+	OutSaveFile *out = saveFileMan->openForSavingAsync(name);
+	if (!out)
+		return false;
+
+	out->write(data, size);
+	out->finalize();
+
+	const bool success = !out->err();
+	delete out;
+	return success;
+}
+
+bool writeDelta(SaveFileManager *saveFileMan, const String &name, const byte *data, uint32 size,
+                uint32 baseId, uint32 baseSize, const Array<uint32> &changed) {
+	OutSaveFile *out = saveFileMan->openForSavingAsync(name);
+	if (!out)
+		return false;
+
+	out->writeUint32BE(kSaveMagic);
+	out->writeByte(kDeltaSaveVersion);
+	out->writeByte(kTypeDelta);
+	out->writeUint32LE(size);
+	out->writeUint32LE(baseId);
+	out->writeUint32LE(baseSize);
+	out->writeUint32LE(kBlockSize);
+	out->writeUint32LE(changed.size());
+	for (uint i = 0; i < changed.size(); ++i) {
+		const uint32 start = changed[i] * kBlockSize;
+		out->writeUint32LE(changed[i]);
+		out->write(data + start, MIN<uint32>(kBlockSize, size - start));
+	}
+	out->finalize();
+
+	const bool success = !out->err();
+	delete out;
+	return success;
+}
+
+bool writeBase(SaveFileManager *saveFileMan, const String &name, const byte *data, uint32 size, uint32 id) {
+	OutSaveFile *out = saveFileMan->openForSavingAsync(getBaseName(name));
+	if (!out)
+		return false;
+
+	out->writeUint32BE(kBaseMagic);
+	out->writeByte(kDeltaSaveVersion);
+	out->writeUint32LE(id);
+	out->writeUint32LE(size);
+	out->write(data, size);
+	out->finalize();
+
+	const bool success = !out->err();
+	delete out;
+	return success;
+}
+
+bool writeSave(SaveFileManager *saveFileMan, const String &name, const byte *data, uint32 size) {
+	// No delta may refer to a snapshot which is still being written, as
+	// it might never make it to disk. Reading its header would also wait
+	// for it.
+	if (saveFileMan->getSaveStatus(getBaseName(name)) == SaveFileManager::kSavePending)
+		return writeFull(saveFileMan, name, data, size);
+
+	uint32 baseId = 0, baseSize = 0;
+	const byte *base = loadBase(saveFileMan, name, baseId, baseSize);
+
+	if (base) {
+		// Blocks extending past the end of the snapshot count as changed
+		Array<uint32> changed;
+		uint32 changedSize = 0;
+		for (uint32 start = 0; start < size; start += kBlockSize) {
+			const uint32 length = MIN<uint32>(kBlockSize, size - start);
+			if (start + length > baseSize || memcmp(data + start, base + start, length)) {
+				changed.push_back(start / kBlockSize);
+				changedSize += length;
+			}
+		}
+
+		// Once the deltas grow large, renew the snapshot instead
+		if (changedSize <= size / 2)
+			return writeDelta(saveFileMan, name, data, size, baseId, baseSize, changed);
+	}
+
+	// The savefile is written in full first, so that it never refers to a
+	// snapshot which does not exist yet.
+	if (!writeFull(saveFileMan, name, data, size))
+		return false;
+
+	// The cached snapshot is checked against the header on disk before it
+	// is used, so it is never relied on if writing it fails.
+	uint32 id = hashData(data, size);
+	if (base && id == baseId)
+		id++;
+	if (!writeBase(saveFileMan, name, data, size, id))
+		return true;
+
+	byte *copy = (byte *)malloc(MAX<uint32>(size, 1));
+	if (copy) {
+		memcpy(copy, data, size);
+		g_baseCache.set(saveFileMan, name, id, copy, size);
+	} else {
+		g_baseCache.clear();
+	}
+	return true;
+}
+
+/**
+ * The stream returned by openDeltaSavefileForSaving(). It collects the data
+ * in memory and stores it once finalized or deleted.
+ */
+class DeltaSaveFile : public WriteStream {
+public:
+	DeltaSaveFile(SaveFileManager *saveFileMan, const String &name)
+		: _saveFileMan(saveFileMan), _name(name), _buffer(DisposeAfterUse::YES), _finalized(false), _err(false) {}
+
+	virtual ~DeltaSaveFile() {
+		finalize();
+	}
+
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _err = false; }
+
+	virtual uint32 write(const void *dataPtr, uint32 dataSize) {
+		if (_finalized) {
+			_err = true;
+			return 0;
+		}
+		return _buffer.write(dataPtr, dataSize);
+	}
+
+	virtual void finalize() {
+		if (_finalized)
+			return;
+
+		_finalized = true;
+		if (!writeSave(_saveFileMan, _name, _buffer.getData(), _buffer.size()))
+			_err = true;
+	}
+
+private:
+	SaveFileManager *_saveFileMan;
+	String _name;
+	MemoryWriteStreamDynamic _buffer;
+	bool _finalized;
+	bool _err;
+};
+
+/**
+ * The stream returned by openDeltaSavefileForLoading() for deltas. It reads
+ * the changed blocks from the delta and the others from the snapshot, which
+ * is only opened once they are needed. Reading just the header of a delta,
+ * e.g. when listing the savefiles, thus does not touch the snapshot.
+ */
+class DeltaReadStream : public SeekableReadStream {
+public:
+	DeltaReadStream(SaveFileManager *saveFileMan, const String &name, InSaveFile *delta, uint32 size)
+		: _saveFileMan(saveFileMan), _name(name), _delta(delta), _base(0), _baseStart(0), _baseFailed(false),
+		  _size(size), _baseId(0), _baseSize(0), _blockSize(0), _pos(0), _eos(false), _err(false) {}
+
+	virtual ~DeltaReadStream() {
+		delete _delta;
+		delete _base;
+	}
+
+	/** Read the remaining header and locate the changed blocks in the delta. */
+	bool readIndex() {
+		_baseId = _delta->readUint32LE();
+		_baseSize = _delta->readUint32LE();
+		_blockSize = _delta->readUint32LE();
+		const uint32 numChanged = _delta->readUint32LE();
+		if (_delta->err() || _delta->eos() || !_blockSize)
+			return false;
+
+		const uint32 numBlocks = (_size + _blockSize - 1) / _blockSize;
+		_blocks.resize(numBlocks);
+		for (uint32 i = 0; i < numBlocks; ++i)
+			_blocks[i] = -1;
+
+		for (uint32 i = 0; i < numChanged; ++i) {
+			const uint32 index = _delta->readUint32LE();
+			if (_delta->err() || _delta->eos() || index >= numBlocks)
+				return false;
+			_blocks[index] = _delta->pos();
+			_delta->skip(MIN(_blockSize, _size - index * _blockSize));
+		}
+
+		// Unchanged blocks have to be part of the snapshot
+		for (uint32 i = 0; i < numBlocks; ++i) {
+			if (_blocks[i] < 0 && MIN(_size, (i + 1) * _blockSize) > _baseSize)
+				return false;
+		}
+
+		return !_delta->err() && !_delta->eos();
+	}
+
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _eos = false; _err = false; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+
+	virtual bool seek(int32 offset, int whence = SEEK_SET) {
+		if (whence == SEEK_CUR)
+			offset += _pos;
+		else if (whence == SEEK_END)
+			offset += _size;
+
+		if (offset < 0 || offset > (int32)_size)
+			return false;
+
+		_pos = offset;
+		_eos = false;
+		return true;
+	}
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		byte *dst = (byte *)dataPtr;
+		uint32 total = 0;
+
+		while (total < dataSize && !_err) {
+			if (_pos >= _size) {
+				_eos = true;
+				break;
+			}
+
+			const uint32 block = _pos / _blockSize;
+			const uint32 length = MIN(dataSize - total, MIN(_blockSize - _pos % _blockSize, _size - _pos));
+
+			SeekableReadStream *source;
+			int32 sourcePos;
+			if (_blocks[block] >= 0) {
+				source = _delta;
+				sourcePos = _blocks[block] + _pos % _blockSize;
+			} else {
+				source = openBase();
+				sourcePos = _baseStart + _pos;
+			}
+
+			if (!source || (source->pos() != sourcePos && !source->seek(sourcePos))
+			        || source->read(dst + total, length) != length) {
+				_err = true;
+				break;
+			}
+
+			_pos += length;
+			total += length;
+		}
+
+		return total;
+	}
+
+private:
+	SeekableReadStream *openBase() {
+		if (_base || _baseFailed)
+			return _base;
+
+		uint32 id = 0, size = 0;
+		_base = Common::openBase(_saveFileMan, _name, id, size);
+		if (!_base || id != _baseId || size != _baseSize) {
+			warning("The snapshot of savefile '%s' is missing or does not match", _name.c_str());
+			delete _base;
+			_base = 0;
+			_baseFailed = true;
+		} else {
+			_baseStart = _base->pos();
+		}
+
+		return _base;
+	}
+
+	SaveFileManager *_saveFileMan;
+	String _name;
+	InSaveFile *_delta;
+	InSaveFile *_base;
+	int32 _baseStart;
+	bool _baseFailed;
+
+	/** Offset of each block in the delta, or -1 if it is unchanged. */
+	Array<int32> _blocks;
+
+	uint32 _size;
+	uint32 _baseId;
+	uint32 _baseSize;
+	uint32 _blockSize;
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+};
+
+} // End of anonymous namespace
+
+OutSaveFile *openDeltaSavefileForSaving(SaveFileManager *saveFileMan, const String &name) {
+	return new DeltaSaveFile(saveFileMan, name);
+}
+
+InSaveFile *openDeltaSavefileForLoading(SaveFileManager *saveFileMan, const String &name) {
+	InSaveFile *in = saveFileMan->openForLoading(name);
+	if (!in)
+		return 0;
+
+	// Plain savefiles are passed through as they are
+	if (in->readUint32BE() != kSaveMagic || in->eos()) {
+		in->clearErr();
+		in->seek(0, SEEK_SET);
+		return in;
+	}
+
+	const byte version = in->readByte();
+	const byte type = in->readByte();
+	const uint32 size = in->readUint32LE();
+	if (version > kDeltaSaveVersion) {
+		warning("Savefile '%s' has unsupported version %d", name.c_str(), version);
+		delete in;
+		return 0;
+	}
+
+	if (type != kTypeDelta) {
+		warning("Savefile '%s' has unsupported type %d", name.c_str(), type);
+		delete in;
+		return 0;
+	}
+
+	DeltaReadStream *stream = new DeltaReadStream(saveFileMan, name, in, size);
+	if (!stream->readIndex()) {
+		warning("Failed to read savefile '%s'", name.c_str());
+		delete stream;
+		return 0;
+	}
+
+	return stream;
+}
+
+bool removeDeltaSavefile(SaveFileManager *saveFileMan, const String &name) {
+	if (g_baseCache.saveFileMan == saveFileMan && g_baseCache.name == name)
+		g_baseCache.clear();
+
+	const String baseName = getBaseName(name);
+	if (!saveFileMan->listSavefiles(baseName).empty())
+		saveFileMan->removeSavefile(baseName);
+
+	return saveFileMan->removeSavefile(name);
+}
+
+} // End of namespace Common
@@ -0,0 +1,93 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_DELTASAVE_H
+#define COMMON_DELTASAVE_H
+
+#include "common/savefile.h"
+
+namespace Common {
+
+/**
+ * @file
+ * Savefiles which are stored as the difference to a base snapshot.
+ *
+ * Engines which serialize large game states on every save can use these
+ * instead of plain savefiles, so that saving only writes the blocks which
+ * changed since the snapshot. The snapshot of savefile "name" is kept in a
+ * separate savefile ".name.base", and is renewed once too much of the state
+ * has changed. Whenever that happens the savefile itself is written as a
+ * plain savefile, and plain savefiles can always be loaded this way.
+ *
+ * Changes are detected by comparing fixed size blocks at the same offsets.
+ * Data which is inserted or removed shifts all the blocks after it, so
+ * they all count as changed; this works best for states whose layout
+ * stays the same between saves.
+ *
+ * A delta can not be loaded without its snapshot, so copying, renaming or
+ * backing up only the visible savefile breaks it. Deltas are thus only
+ * meant for savefiles the user does not manage, like autosaves.
+ *
+ * Both files are written through SaveFileManager::openForSavingAsync(),
+ * which keeps the previous files intact if writing fails. As with plain
+ * savefiles, only errors before the data is handed to the writer are
+ * reported by err() of the stream, and the outcome of writing the
+ * savefile has to be checked with SaveFileManager::getSaveStatus(). No
+ * delta is written against a snapshot before it is known to be on disk.
+ * If writing a savefile fails while its renewed snapshot is written, a
+ * previous delta it was meant to replace can not be loaded anymore.
+ */
+
+/**
+ * Open the savefile with the specified name for saving as a delta to its
+ * snapshot. The data is collected in memory and written when the stream
+ * is finalized or deleted.
+ *
+ * @param saveFileMan	the savefile manager to store the files with
+ * @param name			the name of the savefile
+ * @return pointer to an OutSaveFile, or NULL if an error occurred.
+ */
+OutSaveFile *openDeltaSavefileForSaving(SaveFileManager *saveFileMan, const String &name);
+
+/**
+ * Open the savefile with the specified name for loading, reconstructing
+ * its data from the snapshot if it was saved as a delta. The snapshot is
+ * only read once data which is not part of the delta is read.
+ *
+ * @param saveFileMan	the savefile manager to load the files with
+ * @param name			the name of the savefile
+ * @return pointer to an InSaveFile, or NULL if an error occurred.
+ */
+InSaveFile *openDeltaSavefileForLoading(SaveFileManager *saveFileMan, const String &name);
+
+/**
+ * Remove the savefile with the specified name along with its snapshot.
+ *
+ * @param saveFileMan	the savefile manager to remove the files with
+ * @param name			the name of the savefile
+ * @return true if the savefile was removed, false otherwise.
+ */
+bool removeDeltaSavefile(SaveFileManager *saveFileMan, const String &name);
+
+} // End of namespace Common
+
+#endif
@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/endian.h"
+#include "common/cpudetect.h"
+
+#if (defined(SCUMMVM_SSE2) || defined(SCUMMVM_AVX2)) && defined(_MSC_VER)
+// For the SSE2 and AVX2 intrinsics, see common/math.h on including intrin.h
+#include "common/math.h"
+#elif defined(SCUMMVM_SSE2) || defined(SCUMMVM_AVX2)
+#include <immintrin.h>
+#endif
+
+#ifdef SCUMMVM_SSE2
+
+SCUMMVM_TARGET_SSE2 static uint32 swapBytes16SSE2(uint16 *data, uint32 count) {
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128((__m128i *)(data + i), v);
+	}
+	return i;
+}
+
+SCUMMVM_TARGET_SSE2 static uint32 swapBytes32SSE2(uint32 *data, uint32 count) {
+	uint32 i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+		// Swap the 16 bit halves, then the bytes within them
+		v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128((__m128i *)(data + i), v);
+	}
+	return i;
+}
+
+#endif
+
+#ifdef SCUMMVM_AVX2
+
+SCUMMVM_TARGET_AVX2 static uint32 swapBytesAVX2(byte *data, uint32 size, const byte *pattern) {
+	const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)pattern));
+	uint32 i = 0;
+	for (; i + 32 <= size; i += 32) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+		_mm256_storeu_si256((__m256i *)(data + i), _mm256_shuffle_epi8(v, shuffle));
+	}
+	return i;
+}
+
+static const byte kSwap16Pattern[16] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+static const byte kSwap32Pattern[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+
+#endif
+
+void SWAP_BYTES_16_ARRAY(uint16 *data, uint32 count) {
+	uint32 i = 0;
+
+#ifdef SCUMMVM_AVX2
+	if (Common::hasCpuFeature(Common::kCpuFeatureAVX2))
+		i = swapBytesAVX2((byte *)data, count * 2, kSwap16Pattern) / 2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (i == 0 && Common::hasCpuFeature(Common::kCpuFeatureSSE2))
+		i = swapBytes16SSE2(data, count);
+#endif
+
+	for (; i < count; ++i)
+		data[i] = SWAP_BYTES_16(data[i]);
+}
+
+void SWAP_BYTES_32_ARRAY(uint32 *data, uint32 count) {
+	uint32 i = 0;
+
+#ifdef SCUMMVM_AVX2
+	if (Common::hasCpuFeature(Common::kCpuFeatureAVX2))
+		i = swapBytesAVX2((byte *)data, count * 4, kSwap32Pattern) / 4;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (i == 0 && Common::hasCpuFeature(Common::kCpuFeatureSSE2))
+		i = swapBytes32SSE2(data, count);
+#endif
+
+	for (; i < count; ++i)
+		data[i] = SWAP_BYTES_32(data[i]);
+}
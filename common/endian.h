@@ -30,6 +30,7 @@
  *  Endian conversion and byteswap conversion functions or macros
  *
  *  SWAP_BYTES_??(a)      - inverse byte order
+ *  SWAP_BYTES_??_ARRAY(a, n) - inverse byte order of n values at pointer a, in place
  *  SWAP_CONSTANT_??(a)   - inverse byte order, implemented as macro.
  *                              Use with compiletime-constants only, the result will be a compiletime-constant aswell.
  *                              Unlike most other functions these can be used for eg. switch-case labels
@@ -39,6 +40,7 @@
  *  WRITE_??_UINT??(a, v) - write native value v to pointer a with LE/BE encoding
  *  TO_??_??(a)           - convert native value v to LE/BE
  *  FROM_??_??(a)         - convert LE/BE value v to native
+ *  FROM_??_??_ARRAY(a, n) - convert n LE/BE values at pointer a to native, in place
  *  CONSTANT_??_??(a)     - convert LE/BE value v to native, implemented as macro.
  *                              Use with compiletime-constants only, the result will be a compiletime-constant aswell.
  *                              Unlike most other functions these can be used for eg. switch-case labels
@@ -134,6 +136,18 @@
 	}
 #endif
 
+/**
+ * Swap the bytes of all 16 bit words in an array in place, using SIMD
+ * instructions where available.
+ */
+void SWAP_BYTES_16_ARRAY(uint16 *data, uint32 count);
+
+/**
+ * Swap the bytes of all 32 bit words in an array in place, using SIMD
+ * instructions where available.
+ */
+void SWAP_BYTES_32_ARRAY(uint32 *data, uint32 count);
+
 
 /**
  * A wrapper macro used around four character constants, like 'DATA', to
@@ -283,6 +297,12 @@
 	#define CONSTANT_BE_32(a) SWAP_CONSTANT_32(a)
 	#define CONSTANT_BE_16(a) SWAP_CONSTANT_16(a)
 
+	#define FROM_LE_32_ARRAY(a, n) ((void)0)
+	#define FROM_LE_16_ARRAY(a, n) ((void)0)
+
+	#define FROM_BE_32_ARRAY(a, n) SWAP_BYTES_32_ARRAY(a, n)
+	#define FROM_BE_16_ARRAY(a, n) SWAP_BYTES_16_ARRAY(a, n)
+
 // if the unaligned load and the byteswap take alot instructions its better to directly read and invert
 #	if defined(SCUMM_NEED_ALIGNMENT) && !defined(__mips__)
 
@@ -349,6 +369,12 @@
 	#define CONSTANT_BE_32(a) ((uint32)(a))
 	#define CONSTANT_BE_16(a) ((uint16)(a))
 
+	#define FROM_LE_32_ARRAY(a, n) SWAP_BYTES_32_ARRAY(a, n)
+	#define FROM_LE_16_ARRAY(a, n) SWAP_BYTES_16_ARRAY(a, n)
+
+	#define FROM_BE_32_ARRAY(a, n) ((void)0)
+	#define FROM_BE_16_ARRAY(a, n) ((void)0)
+
 // if the unaligned load and the byteswap take alot instructions its better to directly read and invert
 #	if defined(SCUMM_NEED_ALIGNMENT) && !defined(__mips__)
 
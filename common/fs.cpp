@@ -125,6 +125,10 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+bool FSNode::getFileStats(uint32 &size, uint32 &modificationTime) const {
+	return _realNode && _realNode->getFileStats(size, modificationTime);
+}
+
 SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == 0)
 		return 0;
@@ -140,6 +144,17 @@ SeekableReadStream *FSNode::createReadStream() const {
 	return _realNode->createReadStream();
 }
 
+SeekableReadStream *FSNode::createGameDataReadStream() const {
+	if (_realNode == 0)
+		return 0;
+
+	// Let createReadStream() report files which can not be read
+	if (!_realNode->exists() || _realNode->isDirectory())
+		return createReadStream();
+
+	return _realNode->createGameDataReadStream();
+}
+
 WriteStream *FSNode::createWriteStream() const {
 	if (_realNode == 0)
 		return 0;
@@ -153,21 +168,21 @@ WriteStream *FSNode::createWriteStream() const {
 }
 
 FSDirectory::FSDirectory(const FSNode &node, int depth, bool flat)
-  : _node(node), _cached(false), _depth(depth), _flat(flat) {
+  : _node(node), _cached(false), _depth(depth), _flat(flat), _gameData(false) {
 }
 
 FSDirectory::FSDirectory(const String &prefix, const FSNode &node, int depth, bool flat)
-  : _node(node), _cached(false), _depth(depth), _flat(flat) {
+  : _node(node), _cached(false), _depth(depth), _flat(flat), _gameData(false) {
 
 	setPrefix(prefix);
 }
 
 FSDirectory::FSDirectory(const String &name, int depth, bool flat)
-  : _node(name), _cached(false), _depth(depth), _flat(flat) {
+  : _node(name), _cached(false), _depth(depth), _flat(flat), _gameData(false) {
 }
 
 FSDirectory::FSDirectory(const String &prefix, const String &name, int depth, bool flat)
-  : _node(name), _cached(false), _depth(depth), _flat(flat) {
+  : _node(name), _cached(false), _depth(depth), _flat(flat), _gameData(false) {
 
 	setPrefix(prefix);
 }
@@ -186,6 +201,10 @@ FSNode FSDirectory::getFSNode() const {
 	return _node;
 }
 
+void FSDirectory::setGameData(bool gameData) {
+	_gameData = gameData;
+}
+
 FSNode *FSDirectory::lookupCache(NodeCache &cache, const String &name) const {
 	// make caching as lazy as possible
 	if (!name.empty()) {
@@ -230,7 +249,7 @@ SeekableReadStream *FSDirectory::createReadStreamForMember(const String &name) c
 	FSNode *node = lookupCache(_fileCache, name);
 	if (!node)
 		return 0;
-	SeekableReadStream *stream = node->createReadStream();
+	SeekableReadStream *stream = _gameData ? node->createGameDataReadStream() : node->createReadStream();
 	if (!stream)
 		warning("FSDirectory::createReadStreamForMember: Can't create stream for file '%s'", name.c_str());
 
@@ -249,7 +268,9 @@ FSDirectory *FSDirectory::getSubDirectory(const String &prefix, const String &na
 	if (!node)
 		return 0;
 
-	return new FSDirectory(prefix, *node, depth, flat);
+	FSDirectory *dir = new FSDirectory(prefix, *node, depth, flat);
+	dir->setGameData(_gameData);
+	return dir;
 }
 
 void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const String& prefix) const {
@@ -206,6 +206,17 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Query the size and the time of the last modification of the file
+	 * referred by this node. Not all backends provide this information.
+	 *
+	 * @param size				set to the size of the file in bytes
+	 * @param modificationTime	set to the modification time, in an
+	 *							unspecified but monotonic unit
+	 * @return true if the information was retrieved, false otherwise
+	 */
+	bool getFileStats(uint32 &size, uint32 &modificationTime) const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -215,6 +226,16 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Creates a SeekableReadStream instance for the file referred by this
+	 * node, which holds game data on local fixed media and is not modified
+	 * while it is read. Backends may serve such files from memory. Use
+	 * createReadStream() for anything else, like savefiles.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	SeekableReadStream *createGameDataReadStream() const;
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -272,6 +293,7 @@ class FSDirectory : public Archive {
 	mutable bool _cached;
 	mutable int	_depth;
 	mutable bool _flat;
+	bool _gameData;
 
 	// look for a match
 	FSNode *lookupCache(NodeCache &cache, const String &name) const;
@@ -307,6 +329,15 @@ public:
 	 */
 	FSNode getFSNode() const;
 
+	/**
+	 * Marks the files in this directory as game data which is not modified
+	 * while it is read, so they are opened with
+	 * FSNode::createGameDataReadStream(). Only use this for directories
+	 * on local fixed media, as backends may map such files into memory.
+	 * Sub directories created by getSubDirectory() inherit the setting.
+	 */
+	void setGameData(bool gameData);
+
 	/**
 	 * Create a new FSDirectory pointing to a sub directory of the instance. See class comment
 	 * for an explanation of the prefix parameter.
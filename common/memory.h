@@ -39,6 +39,25 @@ Type *uninitialized_copy(In first, In last, Type *dst) {
 	return dst;
 }
 
+/**
+ * Moves data from the range [first, last) to [dst, dst + (last - first)).
+ * It requires the range [dst, dst + (last - first)) to be valid and
+ * uninitialized. The source objects are left in a valid but unspecified
+ * state and still need to be destroyed.
+ *
+ * Without C++11 this is the same as uninitialized_copy.
+ */
+template<class Type>
+Type *uninitialized_move(Type *first, Type *last, Type *dst) {
+	while (first != last)
+#if __cplusplus >= 201103L
+		new ((void *)dst++) Type(static_cast<Type &&>(*first++));
+#else
+		new ((void *)dst++) Type(*first++);
+#endif
+	return dst;
+}
+
 /**
  * Initializes the memory [first, first + (last - first)) with the value x.
  * It requires the range [first, first + (last - first)) to be valid and
@@ -34,13 +34,29 @@ namespace Common {
  */
 class MemoryReadStream : public SeekableReadStream {
 private:
+	/** An owned buffer shared by a stream and its slices. */
+	struct SharedBuffer {
+		volatile uint32 refCount;
+		byte *data;
+	};
+
 	const byte * const _ptrOrig;
 	const byte *_ptr;
 	const uint32 _size;
 	uint32 _pos;
 	DisposeAfterUse::Flag _disposeMemory;
+	SharedBuffer *_shared;
 	bool _eos;
 
+	MemoryReadStream(const byte *dataPtr, uint32 dataSize, SharedBuffer *shared) :
+		_ptrOrig(dataPtr),
+		_ptr(dataPtr),
+		_size(dataSize),
+		_pos(0),
+		_disposeMemory(DisposeAfterUse::NO),
+		_shared(shared),
+		_eos(false) {}
+
 public:
 
 	/**
@@ -54,12 +70,10 @@ public:
 		_size(dataSize),
 		_pos(0),
 		_disposeMemory(disposeMemory),
+		_shared(0),
 		_eos(false) {}
 
-	~MemoryReadStream() {
-		if (_disposeMemory)
-			free(const_cast<byte *>(_ptrOrig));
-	}
+	~MemoryReadStream();
 
 	uint32 read(void *dataPtr, uint32 dataSize);
 
@@ -70,6 +84,28 @@ public:
 	int32 size() const { return _size; }
 
 	bool seek(int32 offs, int whence = SEEK_SET);
+
+	const byte *getData() const { return _ptrOrig; }
+
+	/**
+	 * Get the data at the current position. There are size() - pos()
+	 * bytes available.
+	 */
+	const byte *getCurrentData() const { return _ptr; }
+
+	/**
+	 * Create a stream for the bytes [begin, end) of this stream, without
+	 * copying them. If this stream owns its buffer, the buffer is shared
+	 * with the slice, and only freed once all of them have been destroyed.
+	 * Otherwise the buffer has to outlive the slice, just like this stream.
+	 */
+	MemoryReadStream *slice(uint32 begin, uint32 end);
+
+	/**
+	 * Like ReadStream::readStream(), but avoids copying the data if this
+	 * stream owns its buffer, by returning a slice of it.
+	 */
+	SeekableReadStream *readStream(uint32 dataSize);
 };
 
 
@@ -169,8 +205,13 @@ private:
 			return;
 
 		byte *old_data = _data;
+		const uint32 old_capacity = _capacity;
 
+		// Grow geometrically, so that writing a large stream in small
+		// pieces does not copy the data over and over again
 		_capacity = new_len + 32;
+		if (_capacity < old_capacity * 2)
+			_capacity = old_capacity * 2;
 		_data = (byte *)malloc(_capacity);
 		_ptr = _data + _pos;
 
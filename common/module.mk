@@ -2,10 +2,15 @@ MODULE := common
 
 MODULE_OBJS := \
 	archive.o \
+	atom.o \
+	atomic.o \
 	config-manager.o \
+	cpudetect.o \
 	coroutines.o \
 	dcl.o \
 	debug.o \
+	deltasave.o \
+	endian.o \
 	error.o \
 	EventDispatcher.o \
 	EventMapper.o \
@@ -23,10 +28,13 @@ MODULE_OBJS := \
 	md5.o \
 	mutex.o \
 	platform.o \
+	prefetchstream.o \
 	quicktime.o \
 	random.o \
 	rational.o \
 	rendermode.o \
+	ringbuffer.o \
+	slaballocator.o \
 	str.o \
 	stream.o \
 	system.o \
@@ -40,6 +48,7 @@ MODULE_OBJS := \
 	winexe.o \
 	winexe_ne.o \
 	winexe_pe.o \
+	workerpool.o \
 	xmlparser.o \
 	zlib.o
 
@@ -0,0 +1,369 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Disable symbol overrides so that we can use the pthread API
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/bufferedstream.h"
+#include "common/list.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+#if defined(USE_PTHREADS)
+#include <pthread.h>
+#endif
+
+namespace Common {
+
+namespace {
+
+/**
+ * Wrapper class which reads ahead the data following the buffer being
+ * consumed. The reads from the parent stream happen on a background I/O
+ * thread shared by all prefetching streams, so the parent stream must not
+ * be accessed by anyone else while it is wrapped.
+ *
+ * Two buffers are used: while the consumer reads from one of them, the
+ * other one is filled with the data which follows.
+ */
+class PrefetchingReadStream : public SeekableReadStream {
+public:
+	PrefetchingReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream);
+	virtual ~PrefetchingReadStream();
+
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _eos = false; _err = false; }
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual int32 pos() const { return _bufStart + _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	/** Fill the prefetch buffer. Called by the I/O thread. */
+	void fill();
+
+private:
+	/** Start reading ahead from the given position. */
+	void prefetch(uint32 start);
+	/** Wait for the read ahead to finish, or cancel it if it has not started yet. */
+	bool finishPrefetch(bool cancel);
+	/** Make the prefetched data the current buffer and prefetch what follows. */
+	bool nextBuffer();
+
+	DisposablePtr<SeekableReadStream> _parentStream;
+	const uint32 _bufSize;
+	const int32 _size;
+
+	/** The buffer being consumed, starting at stream position _bufStart. */
+	byte *_buf;
+	uint32 _bufStart;
+	uint32 _bufFill;
+	uint32 _pos;
+
+	/**
+	 * The buffer being prefetched. Owned by the I/O thread while the
+	 * request is queued or active.
+	 */
+	byte *_nextBuf;
+	uint32 _nextStart;
+	uint32 _nextFill;
+	bool _nextErr;
+	bool _prefetching;
+
+	bool _eos;
+	bool _err;
+};
+
+#if defined(USE_PTHREADS)
+
+/**
+ * The I/O thread, working through the queued prefetch requests in order.
+ * It is started on first use and kept running until the program exits.
+ */
+class PrefetchThread {
+public:
+	static PrefetchThread &instance() {
+		pthread_once(&_once, create);
+		return *_instance;
+	}
+
+	void queue(PrefetchingReadStream *stream) {
+		pthread_mutex_lock(&_mutex);
+		_queue.push_back(stream);
+		pthread_cond_signal(&_requested);
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	/**
+	 * Wait until the request of the given stream has been handled. If it
+	 * has not been started yet, either handle it right away or cancel it.
+	 */
+	void finish(PrefetchingReadStream *stream, bool cancel) {
+		pthread_mutex_lock(&_mutex);
+		for (List<PrefetchingReadStream *>::iterator i = _queue.begin(); i != _queue.end(); ++i) {
+			if (*i == stream) {
+				_queue.erase(i);
+				pthread_mutex_unlock(&_mutex);
+				if (!cancel)
+					stream->fill();
+				return;
+			}
+		}
+		while (_active == stream)
+			pthread_cond_wait(&_done, &_mutex);
+		pthread_mutex_unlock(&_mutex);
+	}
+
+private:
+	PrefetchThread() : _active(0) {
+		pthread_mutex_init(&_mutex, 0);
+		pthread_cond_init(&_requested, 0);
+		pthread_cond_init(&_done, 0);
+	}
+
+	static void create() {
+		_instance = new PrefetchThread();
+
+		// Without the thread, all requests are handled by finish()
+		pthread_t handle;
+		if (pthread_create(&handle, 0, threadMain, _instance) == 0)
+			pthread_detach(handle);
+		else
+			warning("Could not create prefetch thread");
+	}
+
+	static void *threadMain(void *arg) {
+		PrefetchThread *thread = (PrefetchThread *)arg;
+
+		pthread_mutex_lock(&thread->_mutex);
+		for (;;) {
+			while (thread->_queue.empty())
+				pthread_cond_wait(&thread->_requested, &thread->_mutex);
+
+			thread->_active = thread->_queue.front();
+			thread->_queue.pop_front();
+			pthread_mutex_unlock(&thread->_mutex);
+
+			thread->_active->fill();
+
+			pthread_mutex_lock(&thread->_mutex);
+			thread->_active = 0;
+			pthread_cond_broadcast(&thread->_done);
+		}
+		return 0;
+	}
+
+	static pthread_once_t _once;
+	static PrefetchThread *_instance;
+
+	pthread_mutex_t _mutex;
+	pthread_cond_t _requested;
+	pthread_cond_t _done;
+	List<PrefetchingReadStream *> _queue;
+	PrefetchingReadStream *_active;
+};
+
+pthread_once_t PrefetchThread::_once = PTHREAD_ONCE_INIT;
+PrefetchThread *PrefetchThread::_instance = 0;
+
+#endif
+
+PrefetchingReadStream::PrefetchingReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream)
+	: _parentStream(parentStream, disposeParentStream),
+	_bufSize(bufSize),
+	_size(parentStream->size()),
+	_bufStart(parentStream->pos()),
+	_bufFill(0),
+	_pos(0),
+	_nextStart(0),
+	_nextFill(0),
+	_nextErr(false),
+	_prefetching(false),
+	_eos(false),
+	_err(false) {
+
+	assert(bufSize);
+	_buf = new byte[bufSize];
+	_nextBuf = new byte[bufSize];
+
+	prefetch(_bufStart);
+}
+
+PrefetchingReadStream::~PrefetchingReadStream() {
+	finishPrefetch(true);
+	delete[] _buf;
+	delete[] _nextBuf;
+}
+
+void PrefetchingReadStream::fill() {
+	_nextErr = false;
+	if ((uint32)_parentStream->pos() != _nextStart && !_parentStream->seek(_nextStart)) {
+		_nextFill = 0;
+		_nextErr = true;
+		return;
+	}
+
+	_nextFill = _parentStream->read(_nextBuf, _bufSize);
+	if (_parentStream->err()) {
+		_nextErr = true;
+		_parentStream->clearErr();
+	}
+}
+
+void PrefetchingReadStream::prefetch(uint32 start) {
+	assert(!_prefetching);
+	_nextStart = start;
+	_nextFill = 0;
+	_nextErr = false;
+	_prefetching = true;
+
+	// Nothing to read at the end of the stream
+	if ((int32)start >= _size)
+		return;
+
+#if defined(USE_PTHREADS)
+	PrefetchThread::instance().queue(this);
+#else
+	fill();
+#endif
+}
+
+bool PrefetchingReadStream::finishPrefetch(bool cancel) {
+	if (!_prefetching)
+		return false;
+	_prefetching = false;
+
+	if ((int32)_nextStart >= _size)
+		return true;
+
+#if defined(USE_PTHREADS)
+	PrefetchThread::instance().finish(this, cancel);
+#endif
+	return !cancel;
+}
+
+bool PrefetchingReadStream::nextBuffer() {
+	const uint32 start = _bufStart + _bufFill;
+
+	// After a seek, the prefetched data might not contain what follows
+	if (!finishPrefetch(false) || start < _nextStart || start >= _nextStart + _nextFill) {
+		prefetch(start);
+		finishPrefetch(false);
+	}
+
+	if (_nextErr)
+		_err = true;
+	if (start < _nextStart || start >= _nextStart + _nextFill)
+		return false;
+
+	SWAP(_buf, _nextBuf);
+	_bufStart = _nextStart;
+	_bufFill = _nextFill;
+	_pos = start - _nextStart;
+
+	prefetch(_bufStart + _bufFill);
+	return true;
+}
+
+uint32 PrefetchingReadStream::read(void *dataPtr, uint32 dataSize) {
+	uint32 alreadyRead = 0;
+
+	while (dataSize) {
+		if (_pos == _bufFill && !nextBuffer()) {
+			_eos = true;
+			break;
+		}
+
+		const uint32 n = MIN(dataSize, _bufFill - _pos);
+		memcpy(dataPtr, _buf + _pos, n);
+		_pos += n;
+		alreadyRead += n;
+		dataPtr = (byte *)dataPtr + n;
+		dataSize -= n;
+	}
+
+	return alreadyRead;
+}
+
+bool PrefetchingReadStream::seek(int32 offset, int whence) {
+	int32 newPos;
+	switch (whence) {
+	case SEEK_END:
+		newPos = _size + offset;
+		break;
+	case SEEK_CUR:
+		newPos = pos() + offset;
+		break;
+	case SEEK_SET:
+	default:
+		newPos = offset;
+		break;
+	}
+
+	if (newPos < 0 || newPos > _size)
+		return false;
+	_eos = false;
+
+	// Seek inside the current buffer
+	if ((uint32)newPos >= _bufStart && (uint32)newPos <= _bufStart + _bufFill) {
+		_pos = newPos - _bufStart;
+		return true;
+	}
+
+	// Otherwise start reading at the new position. If it lies within the
+	// data being prefetched, nextBuffer() picks that up.
+	_bufStart = newPos;
+	_bufFill = 0;
+	_pos = 0;
+	if (_prefetching && (uint32)newPos >= _nextStart && (uint32)newPos < _nextStart + _bufSize)
+		return true;
+
+	finishPrefetch(true);
+	prefetch(newPos);
+	return true;
+}
+
+} // End of anonymous namespace
+
+SeekableReadStream *wrapPrefetchingReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream) {
+	if (!parentStream)
+		return 0;
+
+	// Data which is in memory already does not need to be read ahead
+	if (parentStream->getData()) {
+		if (disposeParentStream == DisposeAfterUse::YES)
+			return parentStream;
+
+		const int32 pos = parentStream->pos();
+		SeekableReadStream *stream = new SeekableSubReadStream(parentStream, 0, parentStream->size());
+		stream->seek(pos);
+		return stream;
+	}
+
+	return new PrefetchingReadStream(parentStream, bufSize, disposeParentStream);
+}
+
+} // End of namespace Common
@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/ringbuffer.h"
+#include "common/atomic.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Common {
+
+RingBuffer::RingBuffer(uint32 size) : _writePos(0), _readPos(0) {
+	assert(size > 0 && size <= 0x80000000);
+
+	uint32 capacity = 1;
+	while (capacity < size)
+		capacity <<= 1;
+
+	_buffer = (byte *)malloc(capacity);
+	if (!_buffer)
+		error("RingBuffer: Cannot allocate %u bytes", capacity);
+	_mask = capacity - 1;
+}
+
+RingBuffer::~RingBuffer() {
+	free(_buffer);
+}
+
+uint32 RingBuffer::getAvailable() const {
+	return atomicLoad(_writePos) - atomicLoad(_readPos);
+}
+
+byte *RingBuffer::getWriteBuffer(uint32 &len) {
+	const uint32 writePos = _writePos;
+	const uint32 offset = writePos & _mask;
+
+	len = MIN(getCapacity() - (writePos - atomicLoad(_readPos)), getCapacity() - offset);
+	return _buffer + offset;
+}
+
+void RingBuffer::commitWrite(uint32 len) {
+	assert(len <= getFree());
+
+	// Publishing the new position also publishes the data written before
+	atomicStore(_writePos, _writePos + len);
+}
+
+uint32 RingBuffer::write(const void *data, uint32 len) {
+	const byte *src = (const byte *)data;
+	uint32 written = 0;
+
+	// The free space may wrap around the end of the buffer
+	while (written < len) {
+		uint32 chunk;
+		byte *dst = getWriteBuffer(chunk);
+		if (chunk == 0)
+			break;
+
+		chunk = MIN(chunk, len - written);
+		memcpy(dst, src + written, chunk);
+		commitWrite(chunk);
+		written += chunk;
+	}
+
+	return written;
+}
+
+uint32 RingBuffer::read(void *data, uint32 len) {
+	byte *dst = (byte *)data;
+	const uint32 readPos = _readPos;
+
+	len = MIN(len, atomicLoad(_writePos) - readPos);
+
+	const uint32 offset = readPos & _mask;
+	const uint32 first = MIN(len, getCapacity() - offset);
+	memcpy(dst, _buffer + offset, first);
+	memcpy(dst + first, _buffer, len - first);
+
+	// Only hand the space back to the producer after the data was copied
+	atomicStore(_readPos, readPos + len);
+	return len;
+}
+
+void RingBuffer::clear() {
+	_writePos = _readPos = 0;
+}
+
+} // End of namespace Common
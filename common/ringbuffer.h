@@ -0,0 +1,118 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_RINGBUFFER_H
+#define COMMON_RINGBUFFER_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * A fixed size FIFO of bytes, shared between exactly one producer and one
+ * consumer thread. Neither side ever blocks or locks a mutex, which makes
+ * it suitable for passing data to and from real-time callbacks. This
+ * relies on the operations from common/atomic.h, so it is only safe to use
+ * across threads if SCUMMVM_HAVE_ATOMICS is defined.
+ *
+ * The producer may either copy data in with write(), or fill the buffer in
+ * place using getWriteBuffer() and commitWrite().
+ */
+class RingBuffer : NonCopyable {
+public:
+	/**
+	 * Create a ring buffer.
+	 *
+	 * @param size the minimum capacity in bytes, which is rounded up to
+	 *             the next power of two
+	 */
+	explicit RingBuffer(uint32 size);
+	~RingBuffer();
+
+	/**
+	 * Returns the number of bytes the buffer can hold.
+	 */
+	uint32 getCapacity() const { return _mask + 1; }
+
+	/**
+	 * Returns the number of bytes which can currently be read.
+	 */
+	uint32 getAvailable() const;
+
+	/**
+	 * Returns the number of bytes which can currently be written.
+	 */
+	uint32 getFree() const { return getCapacity() - getAvailable(); }
+
+	/**
+	 * Returns the largest contiguous free area of the buffer. The producer
+	 * may fill (part of) it and then publish the data with commitWrite().
+	 *
+	 * @param len receives the size of the area in bytes
+	 * @return pointer to the area
+	 */
+	byte *getWriteBuffer(uint32 &len);
+
+	/**
+	 * Makes the given number of bytes, written to the area returned by
+	 * getWriteBuffer(), available to the consumer.
+	 */
+	void commitWrite(uint32 len);
+
+	/**
+	 * Copy data into the buffer. Only to be called by the producer.
+	 *
+	 * @return the number of bytes written, which is less than len if the
+	 *         buffer is full
+	 */
+	uint32 write(const void *data, uint32 len);
+
+	/**
+	 * Copy data out of the buffer. Only to be called by the consumer.
+	 *
+	 * @return the number of bytes read, which is less than len if the
+	 *         buffer ran empty
+	 */
+	uint32 read(void *data, uint32 len);
+
+	/**
+	 * Discard all data. Neither producer nor consumer may access the
+	 * buffer at the same time.
+	 */
+	void clear();
+
+private:
+	byte *_buffer;
+	uint32 _mask;
+
+	/**
+	 * Total number of bytes written and read so far, modulo 2^32. Each
+	 * is only modified by one side.
+	 */
+	volatile uint32 _writePos;
+	volatile uint32 _readPos;
+};
+
+} // End of namespace Common
+
+#endif
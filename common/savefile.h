@@ -122,6 +122,60 @@ public:
 	 */
 	virtual OutSaveFile *openForSaving(const String &name, bool compress = true) = 0;
 
+	/**
+	 * Open the savefile with the specified name in the given directory for
+	 * saving in the background.
+	 *
+	 * The data written to the returned stream is kept in memory. Once the
+	 * stream has been finalized or deleted, it is compressed and written to
+	 * disk without blocking the caller. The previous savefile of that name
+	 * is only replaced after the new one has been written completely. As a
+	 * consequence, errors while writing the file are not reported by the
+	 * stream. Callers which tell the user whether saving succeeded can
+	 * check getSaveStatus() later on, or wait for the result with
+	 * flushPendingSaves().
+	 *
+	 * The default implementation simply saves synchronously.
+	 *
+	 * @param name		the name of the savefile
+	 * @param compress	toggles whether to compress the resulting save file
+	 * 					(default) or not.
+	 * @return pointer to an OutSaveFile, or NULL if an error occurred.
+	 * @see openForSaving
+	 */
+	virtual OutSaveFile *openForSavingAsync(const String &name, bool compress = true) { return openForSaving(name, compress); }
+
+	/**
+	 * Wait until all savefiles opened by openForSavingAsync() have been
+	 * written to disk. Listing and removing savefiles implicitly waits for
+	 * them as well, and loading a savefile waits for it if it is pending.
+	 *
+	 * @return true if all of them were written successfully, false otherwise.
+	 */
+	virtual bool flushPendingSaves() { return true; }
+
+	/** The state of a savefile opened by openForSavingAsync(). */
+	enum SaveStatus {
+		kSavePending,	///< the savefile is still being written
+		kSaveSucceeded,	///< the savefile was written successfully
+		kSaveFailed		///< writing the savefile failed
+	};
+
+	/**
+	 * Check whether the savefile with the specified name, as last opened
+	 * by openForSavingAsync(), has been written, without waiting for it.
+	 * Errors are also reported through getError(), like by
+	 * flushPendingSaves(). The result is kept until the savefile is saved
+	 * again, so it can be checked at any later point.
+	 *
+	 * The default implementation saves synchronously, so it always
+	 * reports success.
+	 *
+	 * @param name	the name of the savefile
+	 * @return the state of the savefile
+	 */
+	virtual SaveStatus getSaveStatus(const String &name) { return kSaveSucceeded; }
+
 	/**
 	 * Open the file with the specified name in the given directory for loading.
 	 * @param name	the name of the savefile
@@ -0,0 +1,479 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Disable symbol overrides so that we can use the pthread API
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/slaballocator.h"
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+// Thread local caches are only used where a thread's cache can be handed
+// back when it exits. Since SDL creates its threads through pthreads on
+// POSIX systems, a pthread key destructor catches every thread there.
+#if defined(SCUMMVM_HAVE_ATOMICS) && defined(USE_PTHREADS) && defined(__GNUC__)
+#define SLAB_THREAD_LOCAL __thread
+#include <pthread.h>
+#endif
+
+namespace Common {
+
+DECLARE_SINGLETON(SlabAllocator);
+
+enum {
+	/** Number of pages allocated from the system at once. */
+	kPagesPerBlock = 16,
+	/** Space reserved for the page header at the start of each page. */
+	kPageHeaderSize = 64,
+	/** Number of allocations after which a thread updates the statistics. */
+	kStatsInterval = 256
+};
+
+static const uint32 s_chunkSizes[SlabAllocator::kNumSizeClasses] = {
+	8, 16, 24, 32, 48, 64, 80, 96, 128, 160, 192, 256
+};
+
+// Maps (size + 7) / 8 to the smallest fitting size class
+static const byte s_sizeClasses[SlabAllocator::kMaxChunkSize / 8 + 1] = {
+	0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 8,
+	8, 9, 9, 9, 9, 10, 10, 10, 10, 11, 11, 11, 11, 11, 11, 11,
+	11
+};
+
+struct SlabAllocator::Block {
+	Block *next;
+	void *memory;           ///< the memory obtained from malloc
+	uint32 numFreePages;
+};
+
+struct SlabAllocator::Page {
+	Block *block;
+	Page *prev;             ///< in the list of partial pages or free pages
+	Page *next;
+	void *freeList;         ///< chunks freed since the page was assigned
+	byte *unused;           ///< start of the chunks never used so far
+	uint32 sizeClass;
+	uint32 numUsed;         ///< chunks handed out
+};
+
+#ifdef SLAB_THREAD_LOCAL
+namespace {
+struct ThreadCache {
+	void *freeList[SlabAllocator::kNumSizeClasses];
+	uint32 numFree[SlabAllocator::kNumSizeClasses];
+	uint32 numAllocs[SlabAllocator::kNumSizeClasses];
+	uint32 numFrees[SlabAllocator::kNumSizeClasses];
+	bool registered;        ///< whether the thread exit hook is set up
+};
+}
+
+static SLAB_THREAD_LOCAL ThreadCache s_threadCache;
+static pthread_key_t s_threadCacheKey;
+
+/**
+ * Whether the allocator exists. Threads which exit after it has been
+ * destroyed check this so they neither touch the freed pages nor create
+ * a new allocator from within their exit hook.
+ */
+static volatile uint32 s_allocatorAlive = 0;
+#endif
+
+SlabAllocator::SlabAllocator() : _blocks(0), _freePages(0), _numFreePages(0), _numBlocks(0), _lastDumpTime(0) {
+	assert(sizeof(Page) <= kPageHeaderSize);
+
+	for (uint i = 0; i < kNumSizeClasses; ++i) {
+		SizeClass &sc = _classes[i];
+		sc.chunkSize = s_chunkSizes[i];
+		sc.chunksPerPage = (kPageSize - kPageHeaderSize) / sc.chunkSize;
+		sc.partialPages = 0;
+		sc.numPages = 0;
+		sc.numChunks = 0;
+		sc.numAllocs = 0;
+		sc.numFrees = 0;
+		sc.lastNumAllocs = 0;
+	}
+
+#ifdef SLAB_THREAD_LOCAL
+	if (pthread_key_create(&s_threadCacheKey, releaseThreadCache) != 0)
+		error("SlabAllocator: Could not create the thread cache key");
+	atomicStore(s_allocatorAlive, 1);
+#endif
+}
+
+SlabAllocator::~SlabAllocator() {
+	// All chunks must have been returned at this point, apart from those
+	// in thread caches. Forget about the ones cached by this thread, and
+	// stop threads which exit later from returning theirs. Chunks cached
+	// by other threads point into the pages freed below, which is why no
+	// thread may still allocate or free once the allocator is destroyed.
+#ifdef SLAB_THREAD_LOCAL
+	atomicStore(s_allocatorAlive, 0);
+	pthread_key_delete(s_threadCacheKey);
+	memset(&s_threadCache, 0, sizeof(s_threadCache));
+#endif
+
+	while (_blocks) {
+		Block *block = _blocks;
+		_blocks = block->next;
+		::free(block->memory);
+		::free(block);
+	}
+}
+
+uint SlabAllocator::getSizeClass(size_t size) {
+	return s_sizeClasses[(size + 7) >> 3];
+}
+
+SlabAllocator::Page *SlabAllocator::getPage(void *ptr) {
+	return (Page *)((size_t)ptr & ~(size_t)(kPageSize - 1));
+}
+
+void SlabAllocator::allocBlock() {
+	Block *block = (Block *)::malloc(sizeof(Block));
+	if (block)
+		block->memory = ::malloc((kPagesPerBlock + 1) * kPageSize);
+	if (!block || !block->memory)
+		error("SlabAllocator: Out of memory");
+
+	block->numFreePages = kPagesPerBlock;
+	block->next = _blocks;
+	_blocks = block;
+	_numBlocks++;
+
+	// Pages are aligned to their size, so that the page header of a
+	// chunk can be found by masking its address.
+	byte *start = (byte *)(((size_t)block->memory + kPageSize - 1) & ~(size_t)(kPageSize - 1));
+	for (uint i = 0; i < kPagesPerBlock; ++i) {
+		Page *page = (Page *)(start + i * kPageSize);
+		page->block = block;
+		page->prev = 0;
+		page->next = _freePages;
+		if (_freePages)
+			_freePages->prev = page;
+		_freePages = page;
+	}
+	_numFreePages += kPagesPerBlock;
+}
+
+SlabAllocator::Page *SlabAllocator::allocPage(uint sizeClass) {
+	if (!_freePages)
+		allocBlock();
+
+	Page *page = _freePages;
+	_freePages = page->next;
+	if (_freePages)
+		_freePages->prev = 0;
+	_numFreePages--;
+	page->block->numFreePages--;
+
+	page->freeList = 0;
+	page->unused = (byte *)page + kPageHeaderSize;
+	page->sizeClass = sizeClass;
+	page->numUsed = 0;
+
+	SizeClass &sc = _classes[sizeClass];
+	page->prev = 0;
+	page->next = sc.partialPages;
+	if (sc.partialPages)
+		sc.partialPages->prev = page;
+	sc.partialPages = page;
+	sc.numPages++;
+
+	return page;
+}
+
+void SlabAllocator::releasePage(Page *page) {
+	SizeClass &sc = _classes[page->sizeClass];
+	sc.numPages--;
+
+	page->prev = 0;
+	page->next = _freePages;
+	if (_freePages)
+		_freePages->prev = page;
+	_freePages = page;
+	_numFreePages++;
+	page->block->numFreePages++;
+}
+
+void *SlabAllocator::allocChunk(uint sizeClass) {
+	SizeClass &sc = _classes[sizeClass];
+	Page *page = sc.partialPages;
+	if (!page)
+		page = allocPage(sizeClass);
+
+	void *ptr;
+	if (page->freeList) {
+		ptr = page->freeList;
+		page->freeList = *(void **)ptr;
+	} else {
+		ptr = page->unused;
+		page->unused += sc.chunkSize;
+	}
+
+	// Full pages are dropped from the list of partial pages
+	if (++page->numUsed == sc.chunksPerPage) {
+		sc.partialPages = page->next;
+		if (page->next)
+			page->next->prev = 0;
+		page->next = 0;
+	}
+
+	sc.numChunks++;
+	return ptr;
+}
+
+void SlabAllocator::freeChunk(void *ptr) {
+	Page *page = getPage(ptr);
+	SizeClass &sc = _classes[page->sizeClass];
+
+	*(void **)ptr = page->freeList;
+	page->freeList = ptr;
+	sc.numChunks--;
+
+	if (page->numUsed-- == sc.chunksPerPage) {
+		// The page was full, so it is not in the list of partial pages
+		page->prev = 0;
+		page->next = sc.partialPages;
+		if (sc.partialPages)
+			sc.partialPages->prev = page;
+		sc.partialPages = page;
+	}
+
+	if (page->numUsed == 0) {
+		if (page->prev)
+			page->prev->next = page->next;
+		else
+			sc.partialPages = page->next;
+		if (page->next)
+			page->next->prev = page->prev;
+
+		releasePage(page);
+	}
+}
+
+uint SlabAllocator::fillCache(uint sizeClass, void **list) {
+	const uint count = kThreadCacheSize / 2;
+
+	_lock.lock();
+	for (uint i = 0; i < count; ++i) {
+		void *ptr = allocChunk(sizeClass);
+		*(void **)ptr = *list;
+		*list = ptr;
+	}
+	_lock.unlock();
+
+	return count;
+}
+
+void SlabAllocator::drainCache(uint sizeClass, void *list, uint count) {
+	_lock.lock();
+	while (count--) {
+		void *next = *(void **)list;
+		freeChunk(list);
+		list = next;
+	}
+	_lock.unlock();
+}
+
+void SlabAllocator::registerThreadCache() {
+#ifdef SLAB_THREAD_LOCAL
+	if (pthread_setspecific(s_threadCacheKey, &s_threadCache) != 0)
+		error("SlabAllocator: Could not register the thread cache");
+	s_threadCache.registered = true;
+#endif
+}
+
+void SlabAllocator::releaseThreadCache(void *arg) {
+#ifdef SLAB_THREAD_LOCAL
+	ThreadCache &cache = *(ThreadCache *)arg;
+	if (!atomicLoad(s_allocatorAlive)) {
+		memset(&cache, 0, sizeof(cache));
+		return;
+	}
+	SlabAllocator &allocator = instance();
+
+	for (uint i = 0; i < kNumSizeClasses; ++i) {
+		if (cache.numFree[i])
+			allocator.drainCache(i, cache.freeList[i], cache.numFree[i]);
+		atomicAdd(allocator._classes[i].numAllocs, cache.numAllocs[i]);
+		atomicAdd(allocator._classes[i].numFrees, cache.numFrees[i]);
+	}
+	memset(&cache, 0, sizeof(cache));
+#endif
+}
+
+void *SlabAllocator::allocate(size_t size) {
+	if (size > kMaxChunkSize) {
+		void *ptr = ::malloc(size);
+		if (!ptr)
+			error("SlabAllocator: Out of memory");
+		return ptr;
+	}
+
+	const uint sizeClass = getSizeClass(size);
+
+#ifdef SLAB_THREAD_LOCAL
+	ThreadCache &cache = s_threadCache;
+	if (!cache.registered)
+		registerThreadCache();
+	if (!cache.numFree[sizeClass])
+		cache.numFree[sizeClass] = fillCache(sizeClass, &cache.freeList[sizeClass]);
+
+	void *ptr = cache.freeList[sizeClass];
+	cache.freeList[sizeClass] = *(void **)ptr;
+	cache.numFree[sizeClass]--;
+
+	if (++cache.numAllocs[sizeClass] == kStatsInterval) {
+		atomicAdd(_classes[sizeClass].numAllocs, kStatsInterval);
+		cache.numAllocs[sizeClass] = 0;
+	}
+#else
+	_lock.lock();
+	void *ptr = allocChunk(sizeClass);
+	_classes[sizeClass].numAllocs++;
+	_lock.unlock();
+#endif
+
+	return ptr;
+}
+
+void SlabAllocator::deallocate(void *ptr, size_t size) {
+	if (!ptr)
+		return;
+
+	if (size > kMaxChunkSize) {
+		::free(ptr);
+		return;
+	}
+
+	const uint sizeClass = getSizeClass(size);
+
+#ifdef SLAB_THREAD_LOCAL
+	ThreadCache &cache = s_threadCache;
+	if (!cache.registered)
+		registerThreadCache();
+	*(void **)ptr = cache.freeList[sizeClass];
+	cache.freeList[sizeClass] = ptr;
+
+	// Return the most recently freed half of the cache
+	if (++cache.numFree[sizeClass] > kThreadCacheSize) {
+		const uint count = kThreadCacheSize / 2;
+		void *list = cache.freeList[sizeClass];
+		void *last = list;
+		for (uint i = 1; i < count; ++i)
+			last = *(void **)last;
+		cache.freeList[sizeClass] = *(void **)last;
+		cache.numFree[sizeClass] -= count;
+		drainCache(sizeClass, list, count);
+	}
+
+	if (++cache.numFrees[sizeClass] == kStatsInterval) {
+		atomicAdd(_classes[sizeClass].numFrees, kStatsInterval);
+		cache.numFrees[sizeClass] = 0;
+	}
+#else
+	_lock.lock();
+	freeChunk(ptr);
+	_classes[sizeClass].numFrees++;
+	_lock.unlock();
+#endif
+}
+
+void SlabAllocator::freeUnusedPages() {
+	_lock.lock();
+
+	Block **iter = &_blocks;
+	while (*iter) {
+		Block *block = *iter;
+		if (block->numFreePages != kPagesPerBlock) {
+			iter = &block->next;
+			continue;
+		}
+
+		// All pages of the block are in the list of free pages
+		for (Page *page = _freePages; page; ) {
+			Page *next = page->next;
+			if (page->block == block) {
+				if (page->prev)
+					page->prev->next = page->next;
+				else
+					_freePages = page->next;
+				if (page->next)
+					page->next->prev = page->prev;
+				_numFreePages--;
+			}
+			page = next;
+		}
+
+		*iter = block->next;
+		::free(block->memory);
+		::free(block);
+		_numBlocks--;
+	}
+
+	_lock.unlock();
+}
+
+void SlabAllocator::getStats(uint sizeClass, Stats &stats) const {
+	assert(sizeClass < kNumSizeClasses);
+	const SizeClass &sc = _classes[sizeClass];
+
+	_lock.lock();
+	stats.chunkSize = sc.chunkSize;
+	stats.numPages = sc.numPages;
+	stats.numChunks = sc.numChunks;
+	stats.numAllocs = atomicLoad(sc.numAllocs);
+	stats.numFrees = atomicLoad(sc.numFrees);
+	_lock.unlock();
+}
+
+uint32 SlabAllocator::getNumFreePages() const {
+	return _numFreePages;
+}
+
+uint32 SlabAllocator::getReservedBytes() const {
+	return _numBlocks * (kPagesPerBlock + 1) * kPageSize;
+}
+
+void SlabAllocator::dumpStats(int level) {
+	const uint32 time = g_system ? g_system->getMillis() : 0;
+	const uint32 elapsed = time - _lastDumpTime;
+	_lastDumpTime = time;
+
+	debug(level, "SlabAllocator: %u KB reserved, %u free pages", getReservedBytes() / 1024, getNumFreePages());
+
+	for (uint i = 0; i < kNumSizeClasses; ++i) {
+		Stats stats;
+		getStats(i, stats);
+
+		SizeClass &sc = _classes[i];
+		const uint32 allocs = stats.numAllocs - sc.lastNumAllocs;
+		sc.lastNumAllocs = stats.numAllocs;
+
+		debug(level, "  %3u bytes: %4u pages, %7u chunks, %9u allocations (%u/s)",
+		      stats.chunkSize, stats.numPages, stats.numChunks, allocs,
+		      elapsed ? (uint32)((uint64)allocs * 1000 / elapsed) : 0);
+	}
+}
+
+} // End of namespace Common
@@ -0,0 +1,191 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_SLABALLOCATOR_H
+#define COMMON_SLABALLOCATOR_H
+
+#include "common/scummsys.h"
+#include "common/atomic.h"
+#include "common/singleton.h"
+
+namespace Common {
+
+/**
+ * Allocator for many small, short-lived objects of varying size.
+ *
+ * Requests of up to kMaxChunkSize bytes are rounded up to one of a fixed
+ * set of size classes. Each size class carves its chunks out of aligned
+ * pages, which lets a chunk be returned to its page in constant time,
+ * unlike MemoryPool, which has to search all its pages when collecting
+ * unused ones. Larger requests are passed on to malloc.
+ *
+ * Where threads are created through pthreads, every thread keeps a small
+ * cache of free chunks per size class, so that allocating and freeing
+ * usually does not touch any shared state. A thread's cache is returned
+ * to the shared pages when it terminates. Otherwise, as well as when a
+ * thread cache runs empty or overflows, the shared pages are accessed
+ * under a spin lock. The allocator must outlive every thread which uses
+ * it: destroying it frees the pages behind the chunks still cached by
+ * running threads.
+ *
+ * The allocator is meant to be opted into by classes deriving from
+ * SlabAllocated, or by containers which know the size of their memory
+ * blocks when freeing them.
+ */
+class SlabAllocator : public Singleton<SlabAllocator> {
+public:
+	enum {
+		/** The largest request served from the slabs. */
+		kMaxChunkSize = 256,
+		/** The number of size classes. */
+		kNumSizeClasses = 12,
+		/** The size (and alignment) of the pages carved into chunks. */
+		kPageSize = 16384,
+		/** The number of free chunks a thread caches per size class. */
+		kThreadCacheSize = 64
+	};
+
+	/**
+	 * Usage statistics of a single size class.
+	 *
+	 * The allocation counters are updated lazily by the thread caches,
+	 * so they may lag behind by a few hundred operations per thread.
+	 */
+	struct Stats {
+		uint32 chunkSize;   ///< size of the chunks of the size class
+		uint32 numPages;    ///< pages currently owned by the size class
+		uint32 numChunks;   ///< chunks not in the shared free lists, i.e. used or in a thread cache
+		uint32 numAllocs;   ///< total number of allocations so far
+		uint32 numFrees;    ///< total number of deallocations so far
+	};
+
+	/**
+	 * Allocate a memory block of at least the given size. Blocks served
+	 * from the slabs are aligned to 8 bytes.
+	 */
+	void *allocate(size_t size);
+
+	/**
+	 * Return a memory block to the allocator. The size has to be the one
+	 * passed to allocate() when obtaining the block. Like free(), this
+	 * does nothing for a null pointer.
+	 */
+	void deallocate(void *ptr, size_t size);
+
+	/**
+	 * Release all pages which contain no used chunks back to the system.
+	 * Chunks held in thread caches keep their pages alive.
+	 */
+	void freeUnusedPages();
+
+	/**
+	 * Fill in the usage statistics of a size class.
+	 */
+	void getStats(uint sizeClass, Stats &stats) const;
+
+	/**
+	 * Return the number of pages which are not assigned to any size class.
+	 */
+	uint32 getNumFreePages() const;
+
+	/**
+	 * Return the number of bytes currently obtained from the system for pages.
+	 */
+	uint32 getReservedBytes() const;
+
+	/**
+	 * Print the usage statistics of all size classes at the given debug
+	 * level, including the allocation rate since the previous call.
+	 */
+	void dumpStats(int level);
+
+private:
+	friend class Singleton<SingletonBaseType>;
+	SlabAllocator();
+	~SlabAllocator();
+
+	struct Block;
+	struct Page;
+
+	struct SizeClass {
+		uint32 chunkSize;
+		uint32 chunksPerPage;
+		Page *partialPages;     ///< pages with free chunks
+		uint32 numPages;
+		uint32 numChunks;
+		volatile uint32 numAllocs;
+		volatile uint32 numFrees;
+		uint32 lastNumAllocs;   ///< numAllocs when stats were last dumped
+	};
+
+	SizeClass _classes[kNumSizeClasses];
+	Block *_blocks;
+	Page *_freePages;
+	uint32 _numFreePages;
+	uint32 _numBlocks;
+	uint32 _lastDumpTime;
+	mutable SpinLock _lock;
+
+	Page *allocPage(uint sizeClass);
+	void releasePage(Page *page);
+	void allocBlock();
+
+	void *allocChunk(uint sizeClass);
+	void freeChunk(void *ptr);
+
+	uint fillCache(uint sizeClass, void **list);
+	void drainCache(uint sizeClass, void *list, uint count);
+
+	/** Make sure the cache of the calling thread is released on exit. */
+	static void registerThreadCache();
+	/** Return the chunks of a terminating thread's cache. */
+	static void releaseThreadCache(void *cache);
+
+	static uint getSizeClass(size_t size);
+	static Page *getPage(void *ptr);
+};
+
+/**
+ * Base class for objects which shall be allocated from the SlabAllocator.
+ *
+ * Deriving from this class overrides operator new and delete for the
+ * derived class. Classes which get deleted through a pointer to a base
+ * class need a virtual destructor, as usual.
+ */
+class SlabAllocated {
+public:
+	static void *operator new(size_t size) {
+		return SlabAllocator::instance().allocate(size);
+	}
+
+	static void operator delete(void *ptr, size_t size) {
+		if (ptr)
+			SlabAllocator::instance().deallocate(ptr, size);
+	}
+};
+
+} // End of namespace Common
+
+/** Shortcut for accessing the slab allocator. */
+#define SlabMan		Common::SlabAllocator::instance()
+
+#endif
@@ -90,6 +90,26 @@ String::String(const String &str)
 	assert(_str != 0);
 }
 
+#if __cplusplus >= 201103L
+String::String(String &&str)
+    : _size(str._size) {
+	if (str.isStorageIntern()) {
+		// String in internal storage: just copy it
+		memcpy(_storage, str._storage, _builtinCapacity);
+		_str = _storage;
+	} else {
+		// String in external storage: take it over, including the refcount
+		_extern._refCount = str._extern._refCount;
+		_extern._capacity = str._extern._capacity;
+		_str = str._str;
+	}
+
+	str._size = 0;
+	str._str = str._storage;
+	str._storage[0] = 0;
+}
+#endif
+
 String::String(char c)
     : _size(0), _str(_storage) {
 
@@ -242,6 +262,31 @@ String &String::operator=(const String &str) {
 	return *this;
 }
 
+#if __cplusplus >= 201103L
+String &String::operator=(String &&str) {
+	if (&str == this)
+		return *this;
+
+	decRefCount(_extern._refCount);
+	_size = str._size;
+
+	if (str.isStorageIntern()) {
+		_str = _storage;
+		memcpy(_str, str._str, _size + 1);
+	} else {
+		_extern._refCount = str._extern._refCount;
+		_extern._capacity = str._extern._capacity;
+		_str = str._str;
+	}
+
+	str._size = 0;
+	str._str = str._storage;
+	str._storage[0] = 0;
+
+	return *this;
+}
+#endif
+
 String &String::operator=(char c) {
 	decRefCount(_extern._refCount);
 	_str = _storage;
@@ -254,31 +299,11 @@ String &String::operator=(char c) {
 }
 
 String &String::operator+=(const char *str) {
-	if (_str <= str && str <= _str + _size)
-		return operator+=(String(str));
-
-	int len = strlen(str);
-	if (len > 0) {
-		ensureCapacity(_size + len, true);
-
-		memcpy(_str + _size, str, len + 1);
-		_size += len;
-	}
-	return *this;
+	return append(str, strlen(str));
 }
 
 String &String::operator+=(const String &str) {
-	if (&str == this)
-		return operator+=(String(str));
-
-	int len = str._size;
-	if (len > 0) {
-		ensureCapacity(_size + len, true);
-
-		memcpy(_str + _size, str._str, len + 1);
-		_size += len;
-	}
-	return *this;
+	return append(str._str, str._size);
 }
 
 String &String::operator+=(char c) {
@@ -290,6 +315,24 @@ String &String::operator+=(char c) {
 	return *this;
 }
 
+String &String::append(const char *str, uint32 len) {
+	if (len == 0)
+		return *this;
+
+	// Growing the storage would invalidate a pointer into ourselves
+	if (_str <= str && str <= _str + _size) {
+		String tmp(str, len);
+		return append(tmp._str, len);
+	}
+
+	ensureCapacity(_size + len, true);
+
+	memcpy(_str + _size, str, len);
+	_size += len;
+	_str[_size] = 0;
+	return *this;
+}
+
 bool String::hasPrefix(const String &x) const {
 	return hasPrefix(x.c_str());
 }
@@ -389,6 +432,10 @@ void String::clear() {
 	_storage[0] = 0;
 }
 
+void String::reserve(uint32 capacity) {
+	ensureCapacity(MAX(capacity, _size), true);
+}
+
 void String::setChar(char c, uint32 p) {
 	assert(p < _size);
 
@@ -595,22 +642,31 @@ int String::compareToIgnoreCase(const char *x) const {
 
 #pragma mark -
 
-String operator+(const String &x, const String &y) {
-	String temp(x);
-	temp += y;
+// Build the result in storage of the final size right away, rather than
+// first copying (or sharing) x and then growing it.
+static String concat(const char *x, uint32 xLen, const char *y, uint32 yLen) {
+	String temp;
+	temp.reserve(xLen + yLen);
+	temp.append(x, xLen);
+	temp.append(y, yLen);
 	return temp;
 }
 
+String operator+(const String &x, const String &y) {
+	// Share the storage if there is nothing to append
+	if (y.empty())
+		return x;
+	return concat(x.c_str(), x.size(), y.c_str(), y.size());
+}
+
 String operator+(const char *x, const String &y) {
-	String temp(x);
-	temp += y;
-	return temp;
+	return concat(x, strlen(x), y.c_str(), y.size());
 }
 
 String operator+(const String &x, const char *y) {
-	String temp(x);
-	temp += y;
-	return temp;
+	if (!*y)
+		return x;
+	return concat(x.c_str(), x.size(), y, strlen(y));
 }
 
 String operator+(char x, const String &y) {
@@ -620,9 +676,7 @@ String operator+(char x, const String &y) {
 }
 
 String operator+(const String &x, char y) {
-	String temp(x);
-	temp += y;
-	return temp;
+	return concat(x.c_str(), x.size(), &y, 1);
 }
 
 char *ltrim(char *t) {
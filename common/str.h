@@ -109,6 +109,11 @@ public:
 	/** Construct a copy of the given string. */
 	String(const String &str);
 
+#if __cplusplus >= 201103L
+	/** Construct a string taking over the storage of the given string, which is left empty. */
+	String(String &&str);
+#endif
+
 	/** Construct a string consisting of the given character. */
 	explicit String(char c);
 
@@ -116,11 +121,20 @@ public:
 
 	String &operator=(const char *str);
 	String &operator=(const String &str);
+#if __cplusplus >= 201103L
+	String &operator=(String &&str);
+#endif
 	String &operator=(char c);
 	String &operator+=(const char *str);
 	String &operator+=(const String &str);
 	String &operator+=(char c);
 
+	/**
+	 * Append exactly len characters read from address str. Unlike
+	 * operator+=, this does not need to determine the length of str.
+	 */
+	String &append(const char *str, uint32 len);
+
 	bool operator==(const String &x) const;
 	bool operator==(const char *x) const;
 	bool operator!=(const String &x) const;
@@ -206,6 +220,15 @@ public:
 	/** Clears the string, making it empty. */
 	void clear();
 
+	/**
+	 * Make sure that the string can grow to the given number of characters
+	 * without reallocating its storage.
+	 */
+	void reserve(uint32 capacity);
+
+	/** Return the number of characters the string can hold without reallocating its storage. */
+	uint32 capacity() const { return (isStorageIntern() ? _builtinCapacity : _extern._capacity) - 1; }
+
 	/** Convert all characters in the string to lowercase. */
 	void toLowercase();
 
@@ -284,6 +307,63 @@ String operator+(const String &x, const char *y);
 String operator+(const String &x, char y);
 String operator+(char x, const String &y);
 
+/**
+ * Helper for assembling a string from many pieces, e.g. when generating
+ * text line by line. The storage for the expected length can be reserved
+ * up front, and appending never needs to determine the length of a piece
+ * of which it is already known. Whenever the storage runs out, it at least
+ * doubles, so building a long string piece by piece copies each character
+ * only a few times.
+ *
+ * Example:
+ *     StringBuilder builder(key.size() + value.size() + 2);
+ *     builder << key << '=' << value << '\n';
+ *     stream.writeString(builder.str());
+ */
+class StringBuilder {
+public:
+	/** Create an empty builder with room for at least the given number of characters. */
+	explicit StringBuilder(uint32 capacity = 0) { _str.reserve(capacity); }
+
+	StringBuilder &append(const char *str, uint32 len) {
+		// Growing here would invalidate a piece of the string itself,
+		// String::append() takes care of that case
+		if (str < _str.c_str() || str > _str.c_str() + _str.size())
+			grow(len);
+		_str.append(str, len);
+		return *this;
+	}
+
+	StringBuilder &operator<<(const char *str) { return append(str, strlen(str)); }
+	StringBuilder &operator<<(const String &str) { return append(str.c_str(), str.size()); }
+	StringBuilder &operator<<(char c) { grow(1); _str += c; return *this; }
+
+	uint32 size() const { return _str.size(); }
+
+	/** Return the number of characters the builder can hold before it has to grow. */
+	uint32 capacity() const { return _str.capacity(); }
+
+	/** Return the assembled string. */
+	const String &str() const { return _str; }
+
+	/** Discard the content, but keep the reserved storage for building the next string. */
+	void clear() {
+		if (!_str.empty())
+			_str.erase(0);
+	}
+
+private:
+	/** Make room for len more characters, growing the storage geometrically. */
+	void grow(uint32 len) {
+		const uint32 size = _str.size() + len;
+		const uint32 capacity = _str.capacity();
+		if (size > capacity)
+			_str.reserve(size > capacity * 2 ? size : capacity * 2);
+	}
+
+	String _str;
+};
+
 // Some useful additional comparison operators for Strings
 bool operator==(const char *x, const String &y);
 bool operator!=(const char *x, const String &y);
@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/atomic.h"
 #include "common/ptr.h"
 #include "common/stream.h"
 #include "common/memstream.h"
@@ -39,6 +40,76 @@ SeekableReadStream *ReadStream::readStream(uint32 dataSize) {
 	return new MemoryReadStream((byte *)buf, dataSize, DisposeAfterUse::YES);
 }
 
+uint32 ReadStream::readUint16LEArray(uint16 *data, uint32 count) {
+	count = read(data, count * 2) / 2;
+	FROM_LE_16_ARRAY(data, count);
+	return count;
+}
+
+uint32 ReadStream::readUint32LEArray(uint32 *data, uint32 count) {
+	count = read(data, count * 4) / 4;
+	FROM_LE_32_ARRAY(data, count);
+	return count;
+}
+
+uint32 ReadStream::readUint16BEArray(uint16 *data, uint32 count) {
+	count = read(data, count * 2) / 2;
+	FROM_BE_16_ARRAY(data, count);
+	return count;
+}
+
+uint32 ReadStream::readUint32BEArray(uint32 *data, uint32 count) {
+	count = read(data, count * 4) / 4;
+	FROM_BE_32_ARRAY(data, count);
+	return count;
+}
+
+
+MemoryReadStream::~MemoryReadStream() {
+	if (_shared) {
+		if (atomicAdd(_shared->refCount, (uint32)-1) == 0) {
+			free(_shared->data);
+			delete _shared;
+		}
+	} else if (_disposeMemory) {
+		free(const_cast<byte *>(_ptrOrig));
+	}
+}
+
+MemoryReadStream *MemoryReadStream::slice(uint32 begin, uint32 end) {
+	assert(begin <= end && end <= _size);
+
+	// Hand the ownership of the buffer over to a reference count, once it
+	// is shared for the first time
+	if (_disposeMemory && !_shared) {
+		_shared = new SharedBuffer();
+		_shared->refCount = 1;
+		_shared->data = const_cast<byte *>(_ptrOrig);
+		_disposeMemory = DisposeAfterUse::NO;
+	}
+
+	if (_shared)
+		atomicAdd(_shared->refCount, 1);
+	return new MemoryReadStream(_ptrOrig + begin, end - begin, _shared);
+}
+
+SeekableReadStream *MemoryReadStream::readStream(uint32 dataSize) {
+	// A buffer we do not own might be freed before the returned stream,
+	// so it has to be copied
+	if (!_disposeMemory && !_shared)
+		return ReadStream::readStream(dataSize);
+
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+	assert(dataSize > 0);
+
+	MemoryReadStream *stream = slice(_pos, _pos + dataSize);
+	_ptr += dataSize;
+	_pos += dataSize;
+	return stream;
+}
 
 uint32 MemoryReadStream::read(void *dataPtr, uint32 dataSize) {
 	// Read at most as many bytes as are still available...
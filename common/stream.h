@@ -311,6 +311,77 @@ public:
 		return (int32)readUint32BE();
 	}
 
+	/**
+	 * Read an array of unsigned 16-bit words stored in little endian order
+	 * from the stream. This reads all words at once, which is much faster
+	 * than reading them one by one.
+	 *
+	 * @param data	the array to read the words into
+	 * @param count	the number of words to read
+	 * @return the number of words which were actually read; less than
+	 *         count if a read error occurred or the end of the stream was
+	 *         reached (for which client code can check by calling err()
+	 *         and eos() ).
+	 */
+	uint32 readUint16LEArray(uint16 *data, uint32 count);
+
+	/**
+	 * Read an array of unsigned 32-bit words stored in little endian order
+	 * from the stream.
+	 * @see readUint16LEArray
+	 */
+	uint32 readUint32LEArray(uint32 *data, uint32 count);
+
+	/**
+	 * Read an array of unsigned 16-bit words stored in big endian order
+	 * from the stream.
+	 * @see readUint16LEArray
+	 */
+	uint32 readUint16BEArray(uint16 *data, uint32 count);
+
+	/**
+	 * Read an array of unsigned 32-bit words stored in big endian order
+	 * from the stream.
+	 * @see readUint16LEArray
+	 */
+	uint32 readUint32BEArray(uint32 *data, uint32 count);
+
+	/**
+	 * Read an array of signed 16-bit words stored in little endian order
+	 * from the stream.
+	 * @see readUint16LEArray
+	 */
+	FORCEINLINE uint32 readSint16LEArray(int16 *data, uint32 count) {
+		return readUint16LEArray((uint16 *)data, count);
+	}
+
+	/**
+	 * Read an array of signed 32-bit words stored in little endian order
+	 * from the stream.
+	 * @see readUint16LEArray
+	 */
+	FORCEINLINE uint32 readSint32LEArray(int32 *data, uint32 count) {
+		return readUint32LEArray((uint32 *)data, count);
+	}
+
+	/**
+	 * Read an array of signed 16-bit words stored in big endian order
+	 * from the stream.
+	 * @see readUint16LEArray
+	 */
+	FORCEINLINE uint32 readSint16BEArray(int16 *data, uint32 count) {
+		return readUint16BEArray((uint16 *)data, count);
+	}
+
+	/**
+	 * Read an array of signed 32-bit words stored in big endian order
+	 * from the stream.
+	 * @see readUint16LEArray
+	 */
+	FORCEINLINE uint32 readSint32BEArray(int32 *data, uint32 count) {
+		return readUint32BEArray((uint32 *)data, count);
+	}
+
 	/**
 	 * Read the specified amount of data into a malloc'ed buffer
 	 * which then is wrapped into a MemoryReadStream.
@@ -319,7 +390,7 @@ public:
 	 * the end of the stream was reached. Which can be determined by
 	 * calling err() and eos().
 	 */
-	SeekableReadStream *readStream(uint32 dataSize);
+	virtual SeekableReadStream *readStream(uint32 dataSize);
 
 };
 
@@ -371,6 +442,19 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Obtains a pointer to the complete contents of the stream, if they
+	 * are available in memory anyway, e.g. for a memory mapped file. This
+	 * allows accessing the data without copying it, independent of the
+	 * stream position.
+	 *
+	 * The data stays valid as long as the stream exists.
+	 *
+	 * @return a pointer to size() bytes, or 0 if the stream is not backed
+	 *         by memory
+	 */
+	virtual const byte *getData() const { return 0; }
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
@@ -442,6 +526,22 @@ public:
 	FORCEINLINE int32 readSint32() {
 		return (int32)readUint32();
 	}
+
+	uint32 readUint16Array(uint16 *data, uint32 count) {
+		return (_bigEndian) ? readUint16BEArray(data, count) : readUint16LEArray(data, count);
+	}
+
+	uint32 readUint32Array(uint32 *data, uint32 count) {
+		return (_bigEndian) ? readUint32BEArray(data, count) : readUint32LEArray(data, count);
+	}
+
+	FORCEINLINE uint32 readSint16Array(int16 *data, uint32 count) {
+		return readUint16Array((uint16 *)data, count);
+	}
+
+	FORCEINLINE uint32 readSint32Array(int32 *data, uint32 count) {
+		return readUint32Array((uint32 *)data, count);
+	}
 };
 
 /**
@@ -106,6 +106,8 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/substream.h"
+#include "common/zlib.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -273,6 +275,13 @@ int unzOpenCurrentFile(unzFile file);
   If there is no error, the return value is UNZ_OK.
 */
 
+int unzGetCurrentFileDataOffset(unzFile file, uLong *pos);
+/*
+  Get the position of the (possibly compressed) data of the current file
+  in the zipfile, without opening it for reading.
+  If there is no error, the return value is UNZ_OK.
+*/
+
 int unzCloseCurrentFile(unzFile file);
 /*
   Close the file in zip opened with unzOpenCurrentFile
@@ -1123,6 +1132,34 @@ int unzOpenCurrentFile (unzFile file) {
 }
 
 
+/*
+  Get the position of the data of the current file in the zipfile.
+*/
+int unzGetCurrentFileDataOffset(unzFile file, uLong *pos) {
+	uInt iSizeVar;
+	unz_s* s;
+	uLong offset_local_extrafield;
+	uInt  size_local_extrafield;
+
+	if (file==NULL)
+		return UNZ_PARAMERROR;
+	s=(unz_s*)file;
+	if (!s->current_file_ok)
+		return UNZ_PARAMERROR;
+
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s,&iSizeVar,
+				&offset_local_extrafield,&size_local_extrafield)!=UNZ_OK)
+		return UNZ_BADZIPFILE;
+
+	if ((s->cur_file_info.compression_method!=0) &&
+	    (s->cur_file_info.compression_method!=Z_DEFLATED))
+		return UNZ_BADZIPFILE;
+
+	*pos = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER +
+	       iSizeVar + s->byte_before_the_zipfile;
+	return UNZ_OK;
+}
+
 /*
   Read bytes from the current file.
   buf contain buffer where data must be copied
@@ -1418,11 +1455,70 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 namespace Common {
 
 
+#ifdef USE_ZLIB
+/**
+ * Stream over the data of a member which is decompressed on demand, which
+ * verifies the CRC-32 of the data once all of it has been read. Reading
+ * need not be sequential: the checksum is extended whenever a read covers
+ * the data following the part which has been checked so far. A mismatch
+ * is reported through err(), and stays set.
+ */
+class ZipCrcReadStream : public SeekableReadStream {
+	SeekableReadStream *_parentStream;
+	const uLong _expectedCrc;
+	uLong _crc;
+	uint32 _crcPos; ///< Size of the data the checksum covers so far
+	bool _crcError;
+
+public:
+	ZipCrcReadStream(SeekableReadStream *parentStream, uLong expectedCrc)
+		: _parentStream(parentStream), _expectedCrc(expectedCrc), _crc(crc32(0, Z_NULL, 0)),
+		  _crcPos(0), _crcError(false) {
+	}
+
+	~ZipCrcReadStream() {
+		delete _parentStream;
+	}
+
+	virtual bool eos() const { return _parentStream->eos(); }
+	virtual bool err() const { return _crcError || _parentStream->err(); }
+	virtual void clearErr() { _parentStream->clearErr(); }
+
+	virtual int32 pos() const { return _parentStream->pos(); }
+	virtual int32 size() const { return _parentStream->size(); }
+	virtual bool seek(int32 offset, int whence = SEEK_SET) { return _parentStream->seek(offset, whence); }
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		const int32 start = _parentStream->pos();
+		const uint32 len = _parentStream->read(dataPtr, dataSize);
+
+		if (start >= 0 && (uint32)start <= _crcPos && (uint32)start + len > _crcPos) {
+			const uint32 skip = _crcPos - start;
+			_crc = crc32(_crc, (const Bytef *)dataPtr + skip, len - skip);
+			_crcPos = start + len;
+
+			if (_crcPos == (uint32)size() && _crc != _expectedCrc) {
+				warning("ZipCrcReadStream: CRC mismatch in archive member");
+				_crcError = true;
+			}
+		}
+
+		return len;
+	}
+};
+#endif
+
+
 class ZipArchive : public Archive {
 	unzFile _zipFile;
 
+	// The file the archive stream came from, to open it once more for each
+	// member which is decompressed on demand. If it is not set, members
+	// are always decompressed into memory.
+	ArchiveMemberPtr _file;
+
 public:
-	ZipArchive(unzFile zipFile);
+	ZipArchive(unzFile zipFile, const ArchiveMemberPtr &file);
 
 
 	~ZipArchive();
@@ -1431,6 +1527,17 @@ public:
 	virtual int listMembers(ArchiveMemberList &list) const;
 	virtual const ArchiveMemberPtr getMember(const String &name) const;
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+private:
+	enum {
+		kMaxInflateToMemorySize = 64 * 1024
+	};
+
+	/** Open another stream on the archive file, or return 0 if that is not possible. */
+	SeekableReadStream *reopenArchiveStream() const;
+
+	/** Inflate the current file completely into a memory buffer. */
+	SeekableReadStream *inflateToMemory(uint32 size) const;
 };
 
 /*
@@ -1451,7 +1558,8 @@ public:
 };
 */
 
-ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
+ZipArchive::ZipArchive(unzFile zipFile, const ArchiveMemberPtr &file)
+	: _zipFile(zipFile), _file(file) {
 	assert(_zipFile);
 }
 
@@ -1484,46 +1592,69 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 }
 
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
-	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
+	unz_file_info fileInfo;
+	uLong dataPos;
+	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK ||
+	    unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
 		return 0;
 
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+	// Small compressed members are inflated right away: they are cheap
+	// to hold in memory, and can then be seeked freely.
+	if (fileInfo.compression_method != 0 && fileInfo.uncompressed_size <= kMaxInflateToMemorySize)
+		return inflateToMemory(fileInfo.uncompressed_size);
+
+	if (unzGetCurrentFileDataOffset(_zipFile, &dataPos) != UNZ_OK)
 		return 0;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
+	// Other members are read through a stream of their own, so that they
+	// do not share a file position with the archive or other members.
+	SeekableReadStream *archiveStream = reopenArchiveStream();
+	if (!archiveStream)
+		return inflateToMemory(fileInfo.uncompressed_size);
+
+	SeekableReadStream *data = new SeekableSubReadStream(archiveStream, dataPos,
+		dataPos + fileInfo.compressed_size, DisposeAfterUse::YES);
+
+	// Stored members are read straight from the archive
+	if (fileInfo.compression_method != 0)
+		data = wrapDeflateReadStream(data, fileInfo.uncompressed_size);
+
+#ifdef USE_ZLIB
+	data = new ZipCrcReadStream(data, fileInfo.crc);
+#endif
+
+	return data;
+}
+
+SeekableReadStream *ZipArchive::reopenArchiveStream() const {
+	if (!_file)
 		return 0;
+	return _file->createReadStream();
+}
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
+SeekableReadStream *ZipArchive::inflateToMemory(uint32 size) const {
+	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+		return 0;
+
+	byte *buffer = (byte *)malloc(size);
 	assert(buffer);
 
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
+	if (unzReadCurrentFile(_zipFile, buffer, size) != (int)size) {
+		unzCloseCurrentFile(_zipFile);
 		free(buffer);
 		return 0;
 	}
 
+	// This also verifies the CRC of the data
 	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
 		free(buffer);
 		return 0;
 	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
-}
-
-Archive *makeZipArchive(const String &name) {
-	return makeZipArchive(SearchMan.createReadStreamForMember(name));
+	return new MemoryReadStream(buffer, size, DisposeAfterUse::YES);
 }
 
-Archive *makeZipArchive(const FSNode &node) {
-	return makeZipArchive(node.createReadStream());
-}
-
-Archive *makeZipArchive(SeekableReadStream *stream) {
+static Archive *makeZipArchive(SeekableReadStream *stream, const ArchiveMemberPtr &file) {
 	if (!stream)
 		return 0;
 	unzFile zipFile = unzOpen(stream);
@@ -1532,7 +1663,27 @@ Archive *makeZipArchive(SeekableReadStream *stream) {
 		// goes wrong.
 		return 0;
 	}
-	return new ZipArchive(zipFile);
+	return new ZipArchive(zipFile, file);
+}
+
+Archive *makeZipArchive(const String &name) {
+	// Resolve the name only once, so that members are always read from
+	// the file the archive was opened from.
+	return makeZipArchive(SearchMan.getMember(name));
+}
+
+Archive *makeZipArchive(const FSNode &node) {
+	return makeZipArchive(node.createReadStream(), ArchiveMemberPtr(new FSNode(node)));
+}
+
+Archive *makeZipArchive(const ArchiveMemberPtr &file) {
+	if (!file)
+		return 0;
+	return makeZipArchive(file->createReadStream(), file);
+}
+
+Archive *makeZipArchive(SeekableReadStream *stream) {
+	return makeZipArchive(stream, ArchiveMemberPtr());
 }
 
 } // End of namespace Common
@@ -23,11 +23,13 @@
 #ifndef COMMON_UNZIP_H
 #define COMMON_UNZIP_H
 
+#include "common/ptr.h"
 #include "common/str.h"
 
 namespace Common {
 
 class Archive;
+class ArchiveMember;
 class FSNode;
 class SeekableReadStream;
 
@@ -47,6 +49,15 @@ Archive *makeZipArchive(const String &name);
  */
 Archive *makeZipArchive(const FSNode &node);
 
+/**
+ * This factory method creates an Archive instance corresponding to the content
+ * of the ZIP compressed file the given archive member refers to, e.g. a file
+ * or a member of another archive. That archive has to outlive the ZIP archive.
+ *
+ * May return 0 in case of a failure.
+ */
+Archive *makeZipArchive(const SharedPtr<ArchiveMember> &file);
+
 /**
  * This factory method creates an Archive instance corresponding to the content
  * of the given ZIP compressed datastream.
@@ -54,6 +65,13 @@ Archive *makeZipArchive(const FSNode &node);
  * ZipArchive is deleted.
  *
  * May return 0 in case of a failure. In this case stream will still be deleted.
+ *
+ * As the stream cannot be shared by several members, members are always
+ * decompressed into memory when they are opened. Archives created from a
+ * file name, node or archive member instead open the file they were created
+ * from once more for each large member, which is then decompressed on demand. A file name
+ * is resolved through SearchMan once; if it names a member of another
+ * archive, that archive has to outlive the ZIP archive.
  */
 Archive *makeZipArchive(SeekableReadStream *stream);
 
@@ -0,0 +1,203 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Disable symbol overrides so that we can use the pthread and unistd API
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/workerpool.h"
+#include "common/array.h"
+#include "common/atomic.h"
+#include "common/textconsole.h"
+
+#if defined(USE_PTHREADS)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+enum {
+	/** Upper limit for the number of threads picked automatically. */
+	kMaxAutoThreads = 16
+};
+
+#if defined(USE_PTHREADS)
+
+struct WorkerPool::State {
+	pthread_mutex_t mutex;
+	/** Signalled when a new batch is available, or the pool shuts down. */
+	pthread_cond_t start;
+	/** Signalled when the last worker finished the current batch. */
+	pthread_cond_t done;
+
+	Array<pthread_t> threads;
+	uint generation;
+	uint finished;
+	bool quit;
+
+	WorkerProc proc;
+	void *refCon;
+	uint count;
+	/** Index of the next job to be claimed. */
+	volatile uint32 next;
+};
+
+static void runJobs(WorkerPool::WorkerProc proc, void *refCon, uint count, volatile uint32 &next) {
+	for (;;) {
+		const uint32 index = atomicAdd(next, 1) - 1;
+		if (index >= count)
+			break;
+		proc(refCon, index);
+	}
+}
+
+void *WorkerPool::workerMain(void *arg) {
+	State *state = (State *)arg;
+	uint generation = 0;
+
+	pthread_mutex_lock(&state->mutex);
+	for (;;) {
+		while (!state->quit && state->generation == generation)
+			pthread_cond_wait(&state->start, &state->mutex);
+		if (state->quit)
+			break;
+
+		generation = state->generation;
+		WorkerProc proc = state->proc;
+		void *refCon = state->refCon;
+		const uint count = state->count;
+		pthread_mutex_unlock(&state->mutex);
+
+		runJobs(proc, refCon, count, state->next);
+
+		// Every worker reports back, so that none of them can still be
+		// working on this batch once run() has returned.
+		pthread_mutex_lock(&state->mutex);
+		if (++state->finished == state->threads.size())
+			pthread_cond_signal(&state->done);
+	}
+	pthread_mutex_unlock(&state->mutex);
+
+	return 0;
+}
+
+WorkerPool::WorkerPool(uint numThreads) : _state(0), _numThreads(1) {
+	if (!numThreads)
+		numThreads = MIN<uint>(getNumCPUs(), kMaxAutoThreads);
+	if (numThreads <= 1)
+		return;
+
+	_state = new State();
+	pthread_mutex_init(&_state->mutex, 0);
+	pthread_cond_init(&_state->start, 0);
+	pthread_cond_init(&_state->done, 0);
+	_state->generation = 0;
+	_state->finished = 0;
+	_state->quit = false;
+
+	// The calling thread takes part in each batch
+	for (uint i = 1; i < numThreads; ++i) {
+		pthread_t thread;
+		if (pthread_create(&thread, 0, workerMain, _state) != 0) {
+			warning("WorkerPool: Could not create more than %d threads", _state->threads.size());
+			break;
+		}
+		// Workers do not access the thread list until they are released
+		pthread_mutex_lock(&_state->mutex);
+		_state->threads.push_back(thread);
+		pthread_mutex_unlock(&_state->mutex);
+	}
+
+	_numThreads = _state->threads.size() + 1;
+}
+
+WorkerPool::~WorkerPool() {
+	if (!_state)
+		return;
+
+	pthread_mutex_lock(&_state->mutex);
+	_state->quit = true;
+	pthread_cond_broadcast(&_state->start);
+	pthread_mutex_unlock(&_state->mutex);
+
+	for (uint i = 0; i < _state->threads.size(); ++i)
+		pthread_join(_state->threads[i], 0);
+
+	pthread_cond_destroy(&_state->done);
+	pthread_cond_destroy(&_state->start);
+	pthread_mutex_destroy(&_state->mutex);
+	delete _state;
+}
+
+void WorkerPool::run(WorkerProc proc, void *refCon, uint count) {
+	if (!_state || _state->threads.empty() || count <= 1) {
+		for (uint i = 0; i < count; ++i)
+			proc(refCon, i);
+		return;
+	}
+
+	pthread_mutex_lock(&_state->mutex);
+	_state->proc = proc;
+	_state->refCon = refCon;
+	_state->count = count;
+	_state->next = 0;
+	_state->finished = 0;
+	_state->generation++;
+	pthread_cond_broadcast(&_state->start);
+	pthread_mutex_unlock(&_state->mutex);
+
+	runJobs(proc, refCon, count, _state->next);
+
+	pthread_mutex_lock(&_state->mutex);
+	while (_state->finished < _state->threads.size())
+		pthread_cond_wait(&_state->done, &_state->mutex);
+	pthread_mutex_unlock(&_state->mutex);
+}
+
+uint WorkerPool::getNumCPUs() {
+	const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	return cpus > 1 ? (uint)cpus : 1;
+}
+
+#else
+
+struct WorkerPool::State {
+};
+
+WorkerPool::WorkerPool(uint numThreads) : _state(0), _numThreads(1) {
+}
+
+WorkerPool::~WorkerPool() {
+}
+
+void WorkerPool::run(WorkerProc proc, void *refCon, uint count) {
+	for (uint i = 0; i < count; ++i)
+		proc(refCon, i);
+}
+
+uint WorkerPool::getNumCPUs() {
+	return 1;
+}
+
+#endif
+
+} // End of namespace Common
@@ -0,0 +1,90 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_WORKERPOOL_H
+#define COMMON_WORKERPOOL_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * A set of worker threads for spreading CPU or I/O bound batches of
+ * independent jobs over several cores.
+ *
+ * Jobs are identified by their index in the batch. The thread calling
+ * run() works on the batch as well, and run() only returns once all jobs
+ * are done, so the jobs may freely use data owned by the caller.
+ *
+ * Jobs run concurrently with each other, so they must not touch shared
+ * state without synchronisation, and must not call into code which is not
+ * thread safe (e.g. debug output, the config manager or SearchMan).
+ *
+ * On platforms without thread support, all jobs are run by the calling
+ * thread.
+ */
+class WorkerPool : NonCopyable {
+public:
+	typedef void (*WorkerProc)(void *refCon, uint index);
+
+	/**
+	 * Create a pool of worker threads.
+	 *
+	 * @param numThreads	the number of threads working on a batch,
+	 *						including the caller of run(); 0 selects the
+	 *						number of available CPU cores
+	 */
+	explicit WorkerPool(uint numThreads = 0);
+	~WorkerPool();
+
+	/**
+	 * Get the number of threads working on a batch, including the caller
+	 * of run().
+	 */
+	uint getNumThreads() const { return _numThreads; }
+
+	/**
+	 * Call proc(refCon, index) for every index in [0, count), spread
+	 * over the worker threads, and wait until all calls have returned.
+	 * Must not be called from multiple threads at the same time.
+	 */
+	void run(WorkerProc proc, void *refCon, uint count);
+
+	/**
+	 * Get the number of CPU cores available, or 1 if unknown.
+	 */
+	static uint getNumCPUs();
+
+private:
+	struct State;
+
+	/** Main loop of the worker threads. */
+	static void *workerMain(void *state);
+
+	State *_state;
+	uint _numThreads;
+};
+
+} // End of namespace Common
+
+#endif
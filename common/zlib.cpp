@@ -24,6 +24,7 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/zlib.h"
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -145,56 +146,96 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
 static bool _shownBackwardSeekingWarning = false;
 #endif
 
+// Resuming decompression in the middle of a stream requires retrieving
+// the sliding window from zlib, which was added in zlib 1.2.7.1.
+#if ZLIB_VERNUM >= 0x1271
+#define ZLIB_HAVE_CHECKPOINTS
+#endif
+
 /**
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
- * Assumes the compressed data to be in gzip format.
+ * Assumes the compressed data to be in gzip or zlib format, or, if headerless
+ * is set, to be raw deflate data (as used in ZIP archives).
+ *
+ * While decompressing, a checkpoint is recorded every CHECKPOINT_INTERVAL
+ * bytes of output, from which decompression can be resumed. This way
+ * seeking costs at most the decompression of one interval, once the data
+ * up to the target position has been decompressed before.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		WINDOWSIZE = 32768,
+		CHECKPOINT_INTERVAL = 256 * 1024
+	};
+
+	/**
+	 * A position in the compressed data at a deflate block boundary,
+	 * along with everything needed to resume decompression there.
+	 */
+	struct Checkpoint {
+		uint32 out;				///< position in the uncompressed data
+		uint32 in;				///< position of the next byte in the compressed data
+		int bits;				///< number of bits of the previous byte belonging to the block
+		uint windowSize;
+		byte window[WINDOWSIZE];	///< last uncompressed data before the checkpoint
 	};
 
 	byte	_buf[BUFSIZE];
 
 	ScopedPtr<SeekableReadStream> _wrapped;
 	z_stream _stream;
+	int _windowBits;
 	int _zlibErr;
 	uint32 _pos;
 	uint32 _origSize;
 	bool _eos;
 
+	Array<Checkpoint *> _checkpoints;
+
 public:
 
-	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream() {
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0, bool headerless = false) : _wrapped(w), _stream() {
 		assert(w != 0);
 
-		// Verify file header is correct
-		w->seek(0, SEEK_SET);
-		uint16 header = w->readUint16BE();
-		assert(header == 0x1F8B ||
-		       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
-
-		if (header == 0x1F8B) {
-			// Retrieve the original file size
-			w->seek(-4, SEEK_END);
-			_origSize = w->readUint32LE();
-		} else {
-			// Original size not available in zlib format
-			// use an otherwise known size if supplied.
+		_pos = 0;
+		_eos = false;
+
+		if (headerless) {
+			// Raw deflate data carries no size at all
 			_origSize = knownSize;
+
+			// Negative windowBits tell zlib not to expect any header
+			_windowBits = -MAX_WBITS;
+		} else {
+			// Verify file header is correct
+			w->seek(0, SEEK_SET);
+			uint16 header = w->readUint16BE();
+			assert(header == 0x1F8B ||
+			       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
+
+			if (header == 0x1F8B) {
+				// Retrieve the original file size
+				w->seek(-4, SEEK_END);
+				_origSize = w->readUint32LE();
+			} else {
+				// Original size not available in zlib format
+				// use an otherwise known size if supplied.
+				_origSize = knownSize;
+			}
+
+			// Adding 32 to windowBits indicates to zlib that it is supposed to
+			// automatically detect whether gzip or zlib headers are used for
+			// the compressed file. This feature was added in zlib 1.2.0.4,
+			// released 10 August 2003.
+			// Note: This is *crucial* for savegame compatibility, do *not* remove!
+			_windowBits = MAX_WBITS + 32;
 		}
-		_pos = 0;
 		w->seek(0, SEEK_SET);
-		_eos = false;
 
-		// Adding 32 to windowBits indicates to zlib that it is supposed to
-		// automatically detect whether gzip or zlib headers are used for
-		// the compressed file. This feature was added in zlib 1.2.0.4,
-		// released 10 August 2003.
-		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -205,6 +246,8 @@ public:
 
 	~GZipReadStream() {
 		inflateEnd(&_stream);
+		for (uint i = 0; i < _checkpoints.size(); ++i)
+			delete _checkpoints[i];
 	}
 
 	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
@@ -224,7 +267,15 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
+#ifdef ZLIB_HAVE_CHECKPOINTS
+			// Stop at the end of each block, to give us the chance to
+			// record a checkpoint there.
+			_zlibErr = inflate(&_stream, Z_BLOCK);
+			if (_zlibErr == Z_OK && (_stream.data_type & 128) && !(_stream.data_type & 64))
+				addCheckpoint(_pos + dataSize - _stream.avail_out);
+#else
 			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+#endif
 		}
 
 		// Update the position counter
@@ -262,10 +313,16 @@ public:
 
 		assert(newPos >= 0);
 
-		if ((uint32)newPos < _pos) {
-			// To search backward, we have to restart the whole decompression
-			// from the start of the file. A rather wasteful operation, best
-			// to avoid it. :/
+		// Resume from the closest checkpoint before the new position,
+		// unless decompressing from the current position is cheaper.
+		const Checkpoint *checkpoint = findCheckpoint(newPos);
+		if (checkpoint && (checkpoint->out > _pos || (uint32)newPos < _pos)) {
+			if (!resumeAt(*checkpoint))
+				return false;	// FIXME: STREAM REWRITE
+		} else if ((uint32)newPos < _pos) {
+			// To search backward without a checkpoint, we have to restart
+			// the whole decompression from the start of the file. This
+			// only happens for the first interval of the data.
 
 #ifndef RELEASE_BUILD
 			if (!_shownBackwardSeekingWarning) {
@@ -279,7 +336,12 @@ public:
 
 			_pos = 0;
 			_wrapped->seek(0, SEEK_SET);
+#ifdef ZLIB_HAVE_CHECKPOINTS
+			// Resuming at a checkpoint may have switched to raw data
+			_zlibErr = inflateReset2(&_stream, _windowBits);
+#else
 			_zlibErr = inflateReset(&_stream);
+#endif
 			if (_zlibErr != Z_OK)
 				return false;	// FIXME: STREAM REWRITE
 			_stream.next_in = _buf;
@@ -288,9 +350,9 @@ public:
 
 		offset = newPos - _pos;
 
-		// Skip the given amount of data (very inefficient if one tries to skip
-		// huge amounts of data, but usually client code will only skip a few
-		// bytes, so this should be fine.
+		// Skip the given amount of data. With checkpoints, this is at most
+		// one checkpoint interval, unless seeking into data which has not
+		// been decompressed before.
 		byte tmpBuf[1024];
 		while (!err() && offset > 0) {
 			offset -= read(tmpBuf, MIN((int32)sizeof(tmpBuf), offset));
@@ -299,6 +361,70 @@ public:
 		_eos = false;
 		return true;	// FIXME: STREAM REWRITE
 	}
+
+protected:
+	/** Find the last checkpoint at or before the given position. */
+	const Checkpoint *findCheckpoint(uint32 pos) const {
+		uint lo = 0, hi = _checkpoints.size();
+		while (lo < hi) {
+			const uint mid = (lo + hi) / 2;
+			if (_checkpoints[mid]->out <= pos)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo ? _checkpoints[lo - 1] : 0;
+	}
+
+#ifdef ZLIB_HAVE_CHECKPOINTS
+	void addCheckpoint(uint32 out) {
+		// Only data following the last checkpoint is new to us
+		const uint32 last = _checkpoints.empty() ? 0 : _checkpoints.back()->out;
+		if (out < last + CHECKPOINT_INTERVAL)
+			return;
+
+		Checkpoint *checkpoint = new Checkpoint;
+		checkpoint->out = out;
+		checkpoint->in = _wrapped->pos() - _stream.avail_in;
+		checkpoint->bits = _stream.data_type & 7;
+		checkpoint->windowSize = WINDOWSIZE;
+		if (inflateGetDictionary(&_stream, checkpoint->window, &checkpoint->windowSize) != Z_OK) {
+			delete checkpoint;
+			return;
+		}
+		_checkpoints.push_back(checkpoint);
+	}
+
+	bool resumeAt(const Checkpoint &checkpoint) {
+		// Past the header, the data is continued as raw deflate data
+		_zlibErr = inflateReset2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		// The block may start in the middle of a byte, feed the remaining
+		// bits of that byte to zlib.
+		_wrapped->seek(checkpoint.in - (checkpoint.bits ? 1 : 0), SEEK_SET);
+		if (checkpoint.bits) {
+			const byte partial = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, checkpoint.bits, partial >> (8 - checkpoint.bits));
+			if (_zlibErr != Z_OK)
+				return false;
+		}
+
+		_zlibErr = inflateSetDictionary(&_stream, checkpoint.window, checkpoint.windowSize);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		_pos = checkpoint.out;
+		return true;
+	}
+#else
+	bool resumeAt(const Checkpoint &) {
+		return false;
+	}
+#endif
 };
 
 /**
@@ -428,6 +554,18 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 	return toBeWrapped;
 }
 
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 uncompressedSize) {
+	if (!toBeWrapped)
+		return 0;
+
+#if defined(USE_ZLIB)
+	return new GZipReadStream(toBeWrapped, uncompressedSize, true);
+#else
+	delete toBeWrapped;
+	return 0;
+#endif
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped)
@@ -120,6 +120,31 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
  */
 SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0);
 
+/**
+ * Take an arbitrary SeekableReadStream containing raw deflate data, i.e.
+ * without a zlib or gzip header, and wrap it in a custom stream which
+ * provides transparent on-the-fly decompression. This is the format used
+ * for the members of ZIP archives.
+ *
+ * The wrapped stream is read incrementally. While decompressing, a
+ * checkpoint is recorded at a deflate block boundary about every 256 KB of
+ * output, keeping the last 32 KB of data before it. Seeking, backwards or
+ * forwards into data decompressed before, resumes at the closest checkpoint
+ * before the target, so it costs at most the decompression of one interval.
+ * Seeking forwards into data not decompressed yet decompresses everything
+ * up to the target. With zlib versions before 1.2.7.1, no checkpoints are
+ * recorded, and seeking backwards restarts decompression from the
+ * beginning.
+ *
+ * If there is no ZLIB support, NULL is returned and the stream is
+ * destroyed. It is safe to call this with a NULL parameter (in this case,
+ * NULL is returned).
+ *
+ * @param toBeWrapped		the stream containing the deflate data
+ * @param uncompressedSize	the size of the data after decompression
+ */
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 uncompressedSize);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which provides
  * transparent on-the-fly compression. The compressed data is written in the
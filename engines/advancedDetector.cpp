@@ -31,6 +31,7 @@
 #include "common/translation.h"
 #include "gui/EventRecorder.h"
 #include "engines/advancedDetector.h"
+#include "engines/detectioncache.h"
 #include "engines/obsolete.h"
 
 static GameDescriptor toGameDescriptor(const ADGameDescription &g, const PlainGameDescriptor *sg) {
@@ -386,13 +387,14 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	if (!allFiles.contains(fname))
 		return false;
 
-	Common::File testFile;
-
-	if (!testFile.open(allFiles[fname]))
+	Common::Array<DetectionCache::Request> request;
+	request.push_back(DetectionCache::Request(allFiles[fname]));
+	DetectionCache::instance().computeMD5s(request, _md5Bytes);
+	if (!request[0].valid)
 		return false;
 
-	fileProps.size = (int32)testFile.size();
-	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	fileProps.size = request[0].size;
+	fileProps.md5 = request[0].md5;
 	return true;
 }
 
@@ -406,7 +408,13 @@ ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, cons
 	debug(3, "Starting detection in dir '%s'", parent.getPath().c_str());
 
 	// Check which files are included in some ADGameDescription *and* are present.
-	// Compute MD5s and file sizes for these files.
+	// Compute MD5s and file sizes for these files. Resource forks are handled
+	// right away, while plain files are collected, so that they can be hashed
+	// in one batch using all cores.
+	Common::Array<DetectionCache::Request> requests;
+	Common::Array<Common::String> requestNames;
+	Common::HashMap<Common::String, bool, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> requested;
+
 	for (descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameid != 0; descPtr += _descItemSize) {
 		g = (const ADGameDescription *)descPtr;
 
@@ -414,8 +422,17 @@ ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, cons
 			Common::String fname = fileDesc->fileName;
 			ADFileProperties tmp;
 
-			if (filesProps.contains(fname))
+			if (filesProps.contains(fname) || requested.contains(fname))
+				continue;
+
+			if (!(g->flags & ADGF_MACRESFORK)) {
+				if (allFiles.contains(fname)) {
+					requests.push_back(DetectionCache::Request(allFiles[fname]));
+					requestNames.push_back(fname);
+					requested[fname] = true;
+				}
 				continue;
+			}
 
 			if (getFileProperties(parent, allFiles, *g, fname, tmp)) {
 				debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
@@ -424,6 +441,18 @@ ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, cons
 		}
 	}
 
+	DetectionCache::instance().computeMD5s(requests, _md5Bytes);
+	for (uint i = 0; i < requests.size(); ++i) {
+		if (!requests[i].valid || filesProps.contains(requestNames[i]))
+			continue;
+
+		ADFileProperties tmp;
+		tmp.size = requests[i].size;
+		tmp.md5 = requests[i].md5;
+		debug(3, "> '%s': '%s'", requestNames[i].c_str(), tmp.md5.c_str());
+		filesProps[requestNames[i]] = tmp;
+	}
+
 	ADGameDescList matched;
 	int maxFilesMatched = 0;
 	bool gotAnyMatchesWithAllFiles = false;
@@ -0,0 +1,252 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectioncache.h"
+
+#include "common/debug.h"
+#include "common/md5.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/workerpool.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+static const char *const kCacheFileName = "detection-md5.cache";
+
+enum {
+	kCacheVersion = 1,
+	/** Limit for the number of files opened at the same time. */
+	kMaxOpenFiles = 64,
+	/**
+	 * Limit for the number of entries, to keep stale ones from piling up.
+	 * Once it is reached, an existing entry is dropped for every new one.
+	 */
+	kMaxEntries = 65536
+};
+
+namespace {
+
+struct PendingFile {
+	/** Index of the request for the file. */
+	uint index;
+	bool hasStats;
+	uint32 size;
+	uint32 modificationTime;
+	Common::String key;
+};
+
+struct HashJob {
+	Common::SeekableReadStream *stream;
+	uint32 md5Bytes;
+	int32 size;
+	uint8 digest[16];
+};
+
+/**
+ * Hash a file on a worker thread. The stream was opened by the detecting
+ * thread, and the digest is only read by it after the whole batch is done.
+ * Creating or copying Strings is not thread safe, as their reference counts
+ * come from a global pool, so the digest is only formatted afterwards.
+ */
+void hashFile(void *refCon, uint index) {
+	HashJob &job = ((HashJob *)refCon)[index];
+	job.size = job.stream->size();
+	Common::computeStreamMD5(*job.stream, job.digest, job.md5Bytes);
+}
+
+Common::String formatDigest(const uint8 digest[16]) {
+	Common::String md5;
+	for (int i = 0; i < 16; i++)
+		md5 += Common::String::format("%02x", (int)digest[i]);
+	return md5;
+}
+
+Common::String readString(Common::ReadStream &stream) {
+	Common::String str;
+	uint16 len = stream.readUint16LE();
+	while (len-- && !stream.eos())
+		str += (char)stream.readByte();
+	return str;
+}
+
+void writeString(Common::WriteStream &stream, const Common::String &str) {
+	stream.writeUint16LE(str.size());
+	stream.write(str.c_str(), str.size());
+}
+
+} // End of anonymous namespace
+
+DetectionCache::DetectionCache() : _pool(0), _loaded(false), _dirty(false), _flushSuspended(0) {
+}
+
+DetectionCache::~DetectionCache() {
+	delete _pool;
+}
+
+void DetectionCache::computeMD5s(Common::Array<Request> &requests, uint32 md5Bytes) {
+	load();
+
+	Common::Array<PendingFile> pending;
+	for (uint i = 0; i < requests.size(); ++i) {
+		Request &request = requests[i];
+		PendingFile file;
+
+		file.index = i;
+		file.hasStats = request.node.getFileStats(file.size, file.modificationTime);
+		if (file.hasStats) {
+			file.key = Common::String::format("%u:%s", md5Bytes, request.node.getPath().c_str());
+
+			EntryMap::const_iterator entry = _entries.find(file.key);
+			if (entry != _entries.end() && entry->_value.size == file.size && entry->_value.modificationTime == file.modificationTime) {
+				request.valid = true;
+				request.size = (int32)file.size;
+				request.md5 = entry->_value.md5;
+				continue;
+			}
+		}
+
+		pending.push_back(file);
+	}
+
+	for (uint first = 0; first < pending.size(); first += kMaxOpenFiles) {
+		const uint count = MIN<uint>(pending.size() - first, kMaxOpenFiles);
+
+		// Streams are opened here rather than on the workers, as neither
+		// FSNode nor String copies are thread safe.
+		Common::Array<HashJob> jobs;
+		Common::Array<uint> jobFiles;
+		for (uint i = first; i < first + count; ++i) {
+			const Common::FSNode &node = requests[pending[i].index].node;
+			if (node.isDirectory())
+				continue;
+
+			HashJob job;
+			job.stream = node.createReadStream();
+			if (!job.stream)
+				continue;
+			job.md5Bytes = md5Bytes;
+			job.size = 0;
+			jobs.push_back(job);
+			jobFiles.push_back(i);
+		}
+
+		if (jobs.size() > 1 && !_pool)
+			_pool = new Common::WorkerPool();
+		if (_pool)
+			_pool->run(hashFile, jobs.begin(), jobs.size());
+		else if (!jobs.empty())
+			hashFile(jobs.begin(), 0);
+
+		for (uint i = 0; i < jobs.size(); ++i) {
+			const PendingFile &file = pending[jobFiles[i]];
+			Request &request = requests[file.index];
+
+			delete jobs[i].stream;
+			request.valid = true;
+			request.size = jobs[i].size;
+			request.md5 = formatDigest(jobs[i].digest);
+
+			if (!file.hasStats || (int32)file.size != jobs[i].size)
+				continue;
+
+			if (_entries.size() >= kMaxEntries && !_entries.contains(file.key))
+				_entries.erase(_entries.begin());
+
+			Entry &entry = _entries[file.key];
+			entry.size = file.size;
+			entry.modificationTime = file.modificationTime;
+			entry.md5 = request.md5;
+			_dirty = true;
+		}
+	}
+}
+
+void DetectionCache::load() {
+	if (_loaded)
+		return;
+	_loaded = true;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+
+	Common::InSaveFile *in = saveFileMan->openForLoading(kCacheFileName);
+	if (!in)
+		return;
+
+	if (in->readUint32BE() != MKTAG('D', 'M', 'D', '5') || in->readUint32LE() != kCacheVersion) {
+		delete in;
+		return;
+	}
+
+	uint32 count = in->readUint32LE();
+	while (count-- && !in->eos() && !in->err()) {
+		const Common::String key = readString(*in);
+		Entry entry;
+		entry.size = in->readUint32LE();
+		entry.modificationTime = in->readUint32LE();
+		entry.md5 = readString(*in);
+
+		if (!in->eos() && !in->err())
+			_entries[key] = entry;
+	}
+
+	debug(2, "DetectionCache: Loaded %d entries", _entries.size());
+	delete in;
+}
+
+void DetectionCache::flush() {
+	if (!_dirty || _flushSuspended)
+		return;
+	_dirty = false;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+
+	Common::OutSaveFile *out = saveFileMan->openForSaving(kCacheFileName, false);
+	if (!out)
+		return;
+
+	out->writeUint32BE(MKTAG('D', 'M', 'D', '5'));
+	out->writeUint32LE(kCacheVersion);
+	out->writeUint32LE(_entries.size());
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		writeString(*out, i->_key);
+		out->writeUint32LE(i->_value.size);
+		out->writeUint32LE(i->_value.modificationTime);
+		writeString(*out, i->_value.md5);
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("DetectionCache: Could not write '%s'", kCacheFileName);
+	delete out;
+}
+
+void DetectionCache::resumeFlush() {
+	assert(_flushSuspended > 0);
+	if (!--_flushSuspended)
+		flush();
+}
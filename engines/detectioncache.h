@@ -0,0 +1,102 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/array.h"
+#include "common/fs.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+class WorkerPool;
+}
+
+/**
+ * Persistent cache of the MD5 sums computed during game detection.
+ *
+ * Entries are keyed by the path of a file and the number of bytes hashed,
+ * and are only used as long as the size and modification time of the file
+ * are unchanged. Files for which the backend cannot report these are
+ * always hashed. Missing sums are computed on a pool of worker threads.
+ *
+ * The cache is stored in the savegame directory and written back by
+ * flush().
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	/** A file to compute the MD5 sum and size of. */
+	struct Request {
+		Common::FSNode node;
+		/** Set to true if the file could be read. */
+		bool valid;
+		int32 size;
+		Common::String md5;
+
+		Request() : valid(false), size(0) {}
+		explicit Request(const Common::FSNode &n) : node(n), valid(false), size(0) {}
+	};
+
+	~DetectionCache();
+
+	/**
+	 * Compute the MD5 sums of the first md5Bytes bytes (or of the whole
+	 * file, if md5Bytes is 0) and the sizes of the given files, taking
+	 * them from the cache if possible.
+	 */
+	void computeMD5s(Common::Array<Request> &requests, uint32 md5Bytes);
+
+	/** Write the cache back if it changed, unless flushing is suspended. */
+	void flush();
+
+	/**
+	 * Suspend writing the cache, e.g. while scanning many directories at
+	 * once. Calls nest; resumeFlush() flushes once the last one is undone.
+	 */
+	void suspendFlush() { _flushSuspended++; }
+	void resumeFlush();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DetectionCache();
+
+	struct Entry {
+		uint32 size;
+		uint32 modificationTime;
+		Common::String md5;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	void load();
+
+	EntryMap _entries;
+	Common::WorkerPool *_pool;
+	bool _loaded;
+	bool _dirty;
+	int _flushSuspended;
+};
+
+#endif
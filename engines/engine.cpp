@@ -156,7 +156,17 @@ Engine::~Engine() {
 }
 
 void Engine::initializePath(const Common::FSNode &gamePath) {
-	SearchMan.addDirectory(gamePath.getPath(), gamePath, 0, 4);
+	if (!gamePath.exists() || !gamePath.isDirectory())
+		return;
+
+	Common::FSDirectory *dir = new Common::FSDirectory(gamePath, 4);
+
+	// Only the user knows whether the game data is on local fixed media,
+	// which is safe to serve from memory
+	if (ConfMan.hasKey("mmap_game_data"))
+		dir->setGameData(ConfMan.getBool("mmap_game_data"));
+
+	SearchMan.add(gamePath.getPath(), dir, 0);
 }
 
 void initCommonGFX(bool defaultTo1XScaler) {
@@ -151,8 +151,7 @@ Common::String EoBCoreEngine::initLevelData(int sub) {
 		uint16 size = s->readUint16LE();
 		delete[] _vmpPtr;
 		_vmpPtr = new uint16[size];
-		for (int i = 0; i < size; i++)
-			_vmpPtr[i] = s->readUint16LE();
+		s->readUint16LEArray(_vmpPtr, size);
 		delete s;
 
 		const char *paletteFilePattern = (_flags.gameID == GI_EOB2 && _configRenderMode == Common::kRenderEGA) ? "%s.EGA" : "%s.PAL";
@@ -3491,8 +3491,9 @@ bool AMIGAFont::load(Common::SeekableReadStream &file) {
 
 	// Read the character definition offset table
 	uint16 offsets[ARRAYSIZE(_chars)];
+	file.readUint16BEArray(offsets, ARRAYSIZE(_chars));
 	for (int i = 0; i < ARRAYSIZE(_chars); ++i)
-		offsets[i] = file.readUint16BE() + 4;
+		offsets[i] += 4;
 
 	if (file.err())
 		return false;
@@ -3686,8 +3687,12 @@ void Palette::setCGAPalette(int palIndex, CGAIntensity intensity) {
 void Palette::loadAmigaPalette(Common::ReadStream &stream, int startIndex, int colors) {
 	assert(startIndex + colors <= _numColors);
 
+	uint16 cols[256];
+	assert(colors <= ARRAYSIZE(cols));
+	stream.readUint16BEArray(cols, colors);
+
 	for (int i = 0; i < colors; ++i) {
-		uint16 col = stream.readUint16BE();
+		uint16 col = cols[i];
 		_palData[(i + startIndex) * 3 + 2] = ((col & 0xF) * 0x3F) / 0xF; col >>= 4;
 		_palData[(i + startIndex) * 3 + 1] = ((col & 0xF) * 0x3F) / 0xF; col >>= 4;
 		_palData[(i + startIndex) * 3 + 0] = ((col & 0xF) * 0x3F) / 0xF; col >>= 4;
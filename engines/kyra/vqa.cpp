@@ -186,8 +186,9 @@ void VQADecoder::handleVQHD(Common::SeekableReadStream *stream) {
 }
 
 void VQADecoder::handleFINF(Common::SeekableReadStream *stream) {
+	stream->readUint32LEArray(_frameInfo, _header.numFrames);
 	for (int i = 0; i < _header.numFrames; i++) {
-		_frameInfo[i] = 2 * stream->readUint32LE();
+		_frameInfo[i] *= 2;
 	}
 
 	// HACK: This flag is set in jung2.vqa, and its purpose - if it has
@@ -530,7 +531,6 @@ void VQADecoder::VQAVideoTrack::handleVQFR(Common::SeekableReadStream *stream) {
 
 	while (stream->pos() < end) {
 		uint32 tag = readTag(stream);
-		uint32 i;
 		size = stream->readUint32BE();
 		
 		switch (tag) {
@@ -567,15 +567,13 @@ void VQADecoder::VQAVideoTrack::handleVQFR(Common::SeekableReadStream *stream) {
 			break;
 		case MKTAG('V','P','T','0'):	// Frame data
 			assert(size / 2 <= _numVectorPointers);
-			for (i = 0; i < size / 2; i++)
-				_vectorPointers[i] = stream->readUint16LE();
+			stream->readUint16LEArray(_vectorPointers, size / 2);
 			break;
 		case MKTAG('V','P','T','Z'):	// Frame data
 			inbuf = (byte *)malloc(size);
 			stream->read(inbuf, size);
 			size = Screen::decodeFrame4(inbuf, (uint8 *)_vectorPointers, 2 * _numVectorPointers);
-			for (i = 0; i < size / 2; i++)
-				_vectorPointers[i] = TO_LE_16(_vectorPointers[i]);
+			FROM_LE_16_ARRAY(_vectorPointers, size / 2);
 			free(inbuf);
 			break;
 		default:
@@ -44,6 +44,9 @@ reg_t kGetEvent(EngineState *s, int argc, reg_t *argv) {
 	SegManager *segMan = s->_segMan;
 	Common::Point mousePos;
 
+	// Report savegames which failed to be written in the background
+	g_sci->checkPendingSavegames();
+
 	// For Mac games with an icon bar, handle possible icon bar events first
 	if (g_sci->hasMacIconBar()) {
 		reg_t iconObj = g_sci->_gfxMacIconBar->handleEvents();
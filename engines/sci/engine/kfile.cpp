@@ -821,7 +821,10 @@ reg_t kSaveGame(EngineState *s, int argc, reg_t *argv) {
 	Common::SaveFileManager *saveFileMan = g_sci->getSaveFileManager();
 	Common::OutSaveFile *out;
 
-	out = saveFileMan->openForSaving(filename);
+	// Compress and write the savegame in the background, as large game
+	// states otherwise stall the game noticeably. Errors while writing it
+	// are reported by checkPendingSavegames() later on.
+	out = saveFileMan->openForSavingAsync(filename);
 	if (!out) {
 		warning("Error opening savegame \"%s\" for writing", filename.c_str());
 	} else {
@@ -837,6 +840,9 @@ reg_t kSaveGame(EngineState *s, int argc, reg_t *argv) {
 			s->r_acc = NULL_REG; // write failure
 		}
 		delete out;
+
+		if (!s->r_acc.isNull())
+			g_sci->addPendingSavegame(filename);
 	}
 
 	return s->r_acc;
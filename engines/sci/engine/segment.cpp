@@ -283,11 +283,11 @@ Common::String SciString::toString() const {
 	if (_type != 3)
 		error("SciString::toString(): Array is not a string");
 
-	Common::String string;
+	Common::StringBuilder string(_size);
 	for (uint32 i = 0; i < _size && _data[i] != 0; i++)
-		string += _data[i];
+		string << _data[i];
 
-	return string;
+	return string.str();
 }
 
 void SciString::fromString(const Common::String &string) {
@@ -1031,11 +1031,14 @@ void GfxPalette::loadMacIconBarPalette() {
 
 	_macClut = new byte[256 * 3];
 
+	// Each entry consists of the color index and the 16 bit RGB components
+	uint16 clut[256 * 4];
+	clutStream->readUint16BEArray(clut, colorCount * 4);
+
 	for (uint16 i = 0; i < colorCount; i++) {
-		clutStream->readUint16BE();
-		_macClut[i * 3    ] = clutStream->readUint16BE() >> 8;
-		_macClut[i * 3 + 1] = clutStream->readUint16BE() >> 8;
-		_macClut[i * 3 + 2] = clutStream->readUint16BE() >> 8;
+		_macClut[i * 3    ] = clut[i * 4 + 1] >> 8;
+		_macClut[i * 3 + 1] = clut[i * 4 + 2] >> 8;
+		_macClut[i * 3 + 2] = clut[i * 4 + 3] >> 8;
 	}
 
 	// Adjust bounds on the KQ6 palette
@@ -1656,17 +1656,27 @@ int ResourceManager::readResourceMapSCI1(ResourceSource *map) {
 		if (resMap[type].wOffset == 0) // this resource does not exist in map
 			continue;
 		fileStream->seek(resMap[type].wOffset);
+
+		// Read all entries of this type at once
+		Common::Array<byte> entries;
+		entries.resize(resMap[type].wSize * nEntrySize);
+		if (fileStream->read(entries.begin(), entries.size()) != entries.size() || fileStream->err()) {
+			delete fileStream;
+			warning("Error while reading %s", map->getLocationName().c_str());
+			return SCI_ERROR_RESMAP_NOT_FOUND;
+		}
+
 		for (int i = 0; i < resMap[type].wSize; i++) {
-			uint16 number = fileStream->readUint16LE();
+			const byte *entry = entries.begin() + i * nEntrySize;
+			uint16 number = READ_LE_UINT16(entry);
 			int volume_nr = 0;
 			if (_mapVersion == kResVersionSci11) {
 				// offset stored in 3 bytes
-				fileOffset = fileStream->readUint16LE();
-				fileOffset |= fileStream->readByte() << 16;
+				fileOffset = READ_LE_UINT24(entry + 2);
 				fileOffset <<= 1;
 			} else {
 				// offset/volume stored in 4 bytes
-				fileOffset = fileStream->readUint32LE();
+				fileOffset = READ_LE_UINT32(entry + 2);
 				if (_mapVersion < kResVersionSci11) {
 					volume_nr = fileOffset >> 28; // most significant 4 bits
 					fileOffset &= 0x0FFFFFFF;     // least significant 28 bits
@@ -1674,11 +1684,6 @@ int ResourceManager::readResourceMapSCI1(ResourceSource *map) {
 					// in SCI32 it's a plain offset
 				}
 			}
-			if (fileStream->eos() || fileStream->err()) {
-				delete fileStream;
-				warning("Error while reading %s", map->getLocationName().c_str());
-				return SCI_ERROR_RESMAP_NOT_FOUND;
-			}
 			resId = ResourceId(convertResType(type), number);
 			// NOTE: We add the map's volume number here to the specified volume number
 			// for SCI2.1 and SCI3 maps that are not resmap.000. The resmap.* files' numbers
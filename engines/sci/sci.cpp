@@ -23,6 +23,7 @@
 #include "common/system.h"
 #include "common/config-manager.h"
 #include "common/debug-channels.h"
+#include "common/savefile.h"
 
 #include "engines/advancedDetector.h"
 #include "engines/util.h"
@@ -830,6 +831,28 @@ Common::String SciEngine::getSavegamePattern() const {
 	return _targetName + ".???";
 }
 
+void SciEngine::addPendingSavegame(const Common::String &filename) {
+	for (uint i = 0; i < _pendingSavegames.size(); i++) {
+		if (_pendingSavegames[i] == filename)
+			return;
+	}
+	_pendingSavegames.push_back(filename);
+}
+
+void SciEngine::checkPendingSavegames() {
+	for (uint i = 0; i < _pendingSavegames.size();) {
+		Common::SaveFileManager::SaveStatus status = _saveFileMan->getSaveStatus(_pendingSavegames[i]);
+		if (status == Common::SaveFileManager::kSavePending) {
+			i++;
+			continue;
+		}
+		// The game already assumes the savegame was written
+		if (status == Common::SaveFileManager::kSaveFailed)
+			showScummVMDialog("Failed to save game state to file.");
+		_pendingSavegames.remove_at(i);
+	}
+}
+
 Common::String SciEngine::getFilePrefix() const {
 	return _targetName;
 }
@@ -27,6 +27,7 @@
 #include "common/macresman.h"
 #include "common/util.h"
 #include "common/random.h"
+#include "common/str-array.h"
 #include "sci/engine/vm_types.h"	// for Selector
 #include "sci/debug.h"	// for DebugState
 
@@ -282,6 +283,12 @@ public:
 	Common::String getSavegameName(int nr) const;
 	Common::String getSavegamePattern() const;
 
+	/** Remember a savegame which is written in the background. */
+	void addPendingSavegame(const Common::String &filename);
+
+	/** Tell the user about pending savegames which failed to be written. */
+	void checkPendingSavegames();
+
 	Common::String getFilePrefix() const;
 
 	/** Prepend 'TARGET-' to the given filename. */
@@ -412,6 +419,7 @@ private:
 	Console *_console;
 	Common::RandomSource _rng;
 	Common::MacResManager _macExecutable;
+	Common::StringArray _pendingSavegames; /**< Savegames still being written in the background */
 };
 
 
@@ -38,6 +38,7 @@
 #include "sword25/kernel/kernel.h"
 #include "sword25/kernel/inputpersistenceblock.h"
 #include "sword25/kernel/outputpersistenceblock.h"
+#include "sword25/kernel/persistenceservice.h"
 #include "sword25/input/inputengine.h"
 
 namespace Sword25 {
@@ -92,6 +93,9 @@ void InputEngine::update() {
 	_currentState ^= 1;
 	memcpy(_keyboardState[_currentState], _keyboardState[_currentState ^ 1], sizeof(_keyboardState[0]));
 
+	// Report savegames which failed to be written in the background
+	PersistenceService::getInstance().checkPendingSaves();
+
 	// Loop through processing any pending events
 	bool handleEvents = true;
 	while (handleEvents && g_system->getEventManager()->pollEvent(event)) {
@@ -30,8 +30,10 @@
  */
 
 #include "common/fs.h"
+#include "common/array.h"
 #include "common/savefile.h"
 #include "common/zlib.h"
+#include "gui/message.h"
 #include "sword25/kernel/kernel.h"
 #include "sword25/kernel/persistenceservice.h"
 #include "sword25/kernel/inputpersistenceblock.h"
@@ -122,6 +124,8 @@ struct SavegameInformation {
 
 struct PersistenceService::Impl {
 	SavegameInformation _savegameInformations[SLOT_COUNT];
+	// Slots whose savegames are still being written in the background
+	Common::Array<uint> _pendingSlots;
 
 	Impl() {
 		reloadSlots();
@@ -179,6 +183,20 @@ struct PersistenceService::Impl {
 			delete file;
 		}
 	}
+
+	void setSlotSavegameInformation(uint slotID, const Common::String &description, uint gamedataLength, uint gamedataOffset) {
+		// Reading the header back would wait for the savegame to be
+		// written, so fill in what is known about it instead.
+		SavegameInformation &curSavegameInfo = _savegameInformations[slotID];
+		curSavegameInfo.clear();
+		curSavegameInfo.isOccupied = true;
+		curSavegameInfo.isCompatible = true;
+		curSavegameInfo.version = VERSIONNUM;
+		curSavegameInfo.description = description;
+		curSavegameInfo.gamedataLength = gamedataLength;
+		curSavegameInfo.gamedataUncompressedLength = gamedataLength;
+		curSavegameInfo.gamedataOffset = gamedataOffset;
+	}
 };
 
 PersistenceService &PersistenceService::getInstance() {
@@ -271,8 +289,17 @@ bool PersistenceService::saveGame(uint slotID, const Common::String &screenshotF
 	Common::String filename = generateSavegameFilename(slotID);
 
 	// Spielstanddatei ffnen und die Headerdaten schreiben.
+	// The savegame is compressed and written in the background, errors
+	// while doing so are reported by checkPendingSaves(). All slots are
+	// chosen by the player and listed by the launcher, and there is no
+	// autosave, so they are plain savefiles rather than deltas to a
+	// snapshot (see common/deltasave.h).
 	Common::SaveFileManager *sfm = g_system->getSavefileManager();
-	Common::OutSaveFile *file = sfm->openForSaving(filename);
+	Common::OutSaveFile *file = sfm->openForSavingAsync(filename);
+	if (!file) {
+		warning("Unable to open savegame file \"%s\" for writing.", filename.c_str());
+		return false;
+	}
 
 	file->writeString(FILE_MARKER);
 	file->writeByte(0);
@@ -286,7 +313,8 @@ bool PersistenceService::saveGame(uint slotID, const Common::String &screenshotF
 
 	TimeDate dt;
 	g_system->getTimeAndDate(dt);
-	file->writeString(formatTimestamp(dt));
+	Common::String timestamp = formatTimestamp(dt);
+	file->writeString(timestamp);
 	file->writeByte(0);
 
 	if (file->err()) {
@@ -316,6 +344,8 @@ bool PersistenceService::saveGame(uint slotID, const Common::String &screenshotF
 	file->writeByte(0);
 	file->write(writer.getData(), writer.getDataSize());
 
+	const uint gamedataOffset = strlen(FILE_MARKER) + strlen(VERSIONID) + strlen(buf) + timestamp.size() + 2 * strlen(sBuffer) + 6;
+
 	// Get the screenshot
 	Common::SeekableReadStream *thumbnail = Kernel::getInstance()->getGfx()->getThumbnail();
 
@@ -333,10 +363,23 @@ bool PersistenceService::saveGame(uint slotID, const Common::String &screenshotF
 	}
 
 	file->finalize();
+	success = !file->err();
 	delete file;
+	if (!success) {
+		warning("Unable to write savegame file \"%s\".", filename.c_str());
+		_impl->readSlotSavegameInformation(slotID);
+		return false;
+	}
 
 	// Savegameinformationen fr diesen Slot aktualisieren.
-	_impl->readSlotSavegameInformation(slotID);
+	_impl->setSlotSavegameInformation(slotID, timestamp, writer.getDataSize(), gamedataOffset);
+	for (uint i = 0; i < _impl->_pendingSlots.size(); ++i) {
+		if (_impl->_pendingSlots[i] == slotID) {
+			_impl->_pendingSlots.remove_at(i);
+			break;
+		}
+	}
+	_impl->_pendingSlots.push_back(slotID);
 
 	// Empty the cache, to remove old thumbnails
 	Kernel::getInstance()->getResourceManager()->emptyThumbnailCache();
@@ -345,6 +388,27 @@ bool PersistenceService::saveGame(uint slotID, const Common::String &screenshotF
 	return true;
 }
 
+void PersistenceService::checkPendingSaves() {
+	Common::SaveFileManager *sfm = g_system->getSavefileManager();
+
+	for (uint i = 0; i < _impl->_pendingSlots.size();) {
+		uint slotID = _impl->_pendingSlots[i];
+		Common::SaveFileManager::SaveStatus status = sfm->getSaveStatus(generateSavegameFilename(slotID));
+		if (status == Common::SaveFileManager::kSavePending) {
+			++i;
+			continue;
+		}
+
+		if (status == Common::SaveFileManager::kSaveFailed) {
+			// The previous savegame in this slot, if any, is still there
+			_impl->readSlotSavegameInformation(slotID);
+			GUI::MessageDialog dialog("Failed to save game state to file.");
+			dialog.runModal();
+		}
+		_impl->_pendingSlots.remove_at(i);
+	}
+}
+
 bool PersistenceService::loadGame(uint slotID) {
 	Common::SaveFileManager *sfm = g_system->getSavefileManager();
 	Common::InSaveFile *file;
@@ -64,6 +64,12 @@ public:
 	bool            saveGame(uint slotID, const Common::String &screenshotFilename);
 	bool            loadGame(uint slotID);
 
+	/**
+	 * Savegames are written in the background. Check whether any of them
+	 * failed to be written, and tell the user if so.
+	 */
+	void            checkPendingSaves();
+
 private:
 	struct Impl;
 	Impl *_impl;
@@ -273,7 +273,9 @@ bool BaseFileManager::registerPackages() {
 }
 
 bool BaseFileManager::registerPackage(Common::FSNode file, const Common::String &filename, bool searchSignature) {
-	PackageSet *pack = new PackageSet(file, filename, searchSignature);
+	// Packages are read-only game data, so map them if the user allows it
+	bool gameData = ConfMan.hasKey("mmap_game_data") && ConfMan.getBool("mmap_game_data");
+	PackageSet *pack = new PackageSet(file, filename, searchSignature, gameData);
 	_packages.add(file.getName(), pack, pack->getPriority() , true);
 
 	return STATUS_OK;
@@ -2996,6 +2996,35 @@ bool BaseGame::saveGame(int32 slot, const char *desc, bool quickSave) {
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+void BaseGame::addPendingSave(const Common::String &filename) {
+	for (uint i = 0; i < _pendingSaves.size(); i++) {
+		if (_pendingSaves[i] == filename) {
+			return;
+		}
+	}
+	_pendingSaves.push_back(filename);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+void BaseGame::checkPendingSaves() {
+	Common::SaveFileManager *saveMan = ((WintermuteEngine *)g_engine)->getSaveFileMan();
+	for (uint i = 0; i < _pendingSaves.size();) {
+		Common::SaveFileManager::SaveStatus status = saveMan->getSaveStatus(_pendingSaves[i]);
+		if (status == Common::SaveFileManager::kSavePending) {
+			i++;
+			continue;
+		}
+		if (status == Common::SaveFileManager::kSaveFailed) {
+			LOG(0, "Error writing saved game '%s'", _pendingSaves[i].c_str());
+			quickMessage("Error saving game. View log for details.");
+		}
+		_pendingSaves.remove_at(i);
+	}
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 bool BaseGame::loadGame(uint32 slot) {
 	//_gameRef->LOG(0, "Load start %d", BaseUtils::GetUsedMemMB());
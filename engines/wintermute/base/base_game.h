@@ -35,6 +35,7 @@
 #include "engines/wintermute/coll_templ.h"
 #include "engines/wintermute/math/rect32.h"
 #include "common/events.h"
+#include "common/str-array.h"
 
 namespace Wintermute {
 
@@ -353,9 +354,16 @@ protected:
 	bool _autoSaveOnExit;
 	uint32 _autoSaveSlot;
 	bool _cursorHidden;
+	/** Savefiles still being written in the background */
+	Common::StringArray _pendingSaves;
 
 public:
 	void autoSaveOnExit();
+	uint32 getAutoSaveSlot() const { return _autoSaveSlot; }
+	/** Remember a savefile which is written in the background. */
+	void addPendingSave(const Common::String &filename);
+	/** Tell the user about pending savefiles which failed to be written. */
+	void checkPendingSaves();
 
 };
 
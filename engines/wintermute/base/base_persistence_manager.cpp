@@ -40,6 +40,7 @@
 #include "engines/wintermute/wintermute.h"
 #include "graphics/scaler.h"
 #include "image/bmp.h"
+#include "common/deltasave.h"
 #include "common/memstream.h"
 #include "common/str.h"
 #include "common/system.h"
@@ -190,7 +191,7 @@ void BasePersistenceManager::getSaveStateDesc(int slot, SaveStateDescriptor &des
 
 void BasePersistenceManager::deleteSaveSlot(int slot) {
 	Common::String filename = getFilenameForSlot(slot);
-	g_system->getSavefileManager()->removeSavefile(filename);
+	Common::removeDeltaSavefile(g_system->getSavefileManager(), filename);
 }
 
 uint32 BasePersistenceManager::getMaxUsedSlot() {
@@ -316,7 +317,7 @@ bool BasePersistenceManager::readHeader(const Common::String &filename) {
 
 	_saving = false;
 
-	_loadStream = g_system->getSavefileManager()->openForLoading(filename);
+	_loadStream = Common::openDeltaSavefileForLoading(g_system->getSavefileManager(), filename);
 
 	if (_loadStream) {
 		uint32 magic;
@@ -416,18 +417,25 @@ bool BasePersistenceManager::initLoad(const Common::String &filename) {
 
 
 //////////////////////////////////////////////////////////////////////////
-bool BasePersistenceManager::saveFile(const Common::String &filename) {
+bool BasePersistenceManager::saveFile(const Common::String &filename, bool delta) {
 	byte *prefixBuffer = _richBuffer;
 	uint32 prefixSize = _richBufferSize;
 	byte *buffer = ((Common::MemoryWriteStreamDynamic *)_saveStream)->getData();
 	uint32 bufferSize = ((Common::MemoryWriteStreamDynamic *)_saveStream)->size();
 
 	Common::SaveFileManager *saveMan = ((WintermuteEngine *)g_engine)->getSaveFileMan();
-	Common::OutSaveFile *file = saveMan->openForSaving(filename);
+	// The state is already serialized, so let compression happen on the
+	// writer thread. Deltas only store the parts of the state which
+	// changed since the last save, but depend on a hidden snapshot.
+	Common::OutSaveFile *file;
+	if (delta)
+		file = Common::openDeltaSavefileForSaving(saveMan, filename);
+	else
+		file = saveMan->openForSavingAsync(filename);
 	file->write(prefixBuffer, prefixSize);
 	file->write(buffer, bufferSize);
-	bool retVal = !file->err();
 	file->finalize();
+	bool retVal = !file->err();
 	delete file;
 	return retVal;
 }
@@ -41,10 +41,11 @@ BasePackage::BasePackage() {
 	_cd = 0;
 	_priority = 0;
 	_boundToExe = false;
+	_gameData = false;
 }
 
 Common::SeekableReadStream *BasePackage::getFilePointer() {
-	Common::SeekableReadStream *stream = _fsnode.createReadStream();
+	Common::SeekableReadStream *stream = _gameData ? _fsnode.createGameDataReadStream() : _fsnode.createReadStream();
 
 	return stream;
 }
@@ -57,6 +58,18 @@ static bool findPackageSignature(Common::SeekableReadStream *f, uint32 *offset)
 	WRITE_LE_UINT32(signature + 4, PACKAGE_MAGIC_2);
 
 	uint32 fileSize = (uint32)f->size();
+
+	// Scan a mapped executable in place instead of copying it chunk by chunk
+	const byte *data = f->getData();
+	if (data) {
+		for (uint32 i = 1024 * 1024; i + 8 <= fileSize; i++) {
+			if (!memcmp(data + i, signature, 8)) {
+				*offset = i;
+				return true;
+			}
+		}
+		return false;
+	}
 	uint32 startPos = 1024 * 1024;
 	uint32 bytesRead = startPos;
 
@@ -100,11 +113,11 @@ void TPackageHeader::readFromStream(Common::ReadStream *stream) {
 	_numDirs = stream->readUint32LE();
 }
 
-PackageSet::PackageSet(Common::FSNode file, const Common::String &filename, bool searchSignature) {
+PackageSet::PackageSet(Common::FSNode file, const Common::String &filename, bool searchSignature, bool gameData) {
 	uint32 absoluteOffset = 0;
 	_priority = 0;
 	bool boundToExe = false;
-	Common::SeekableReadStream *stream = file.createReadStream();
+	Common::SeekableReadStream *stream = gameData ? file.createGameDataReadStream() : file.createReadStream();
 	if (!stream) {
 		return;
 	}
@@ -148,6 +161,7 @@ PackageSet::PackageSet(Common::FSNode file, const Common::String &filename, bool
 		pkg->_fsnode = file;
 
 		pkg->_boundToExe = boundToExe;
+		pkg->_gameData = gameData;
 
 		// read package info
 		byte nameLength = stream->readByte();
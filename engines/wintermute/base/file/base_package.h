@@ -39,6 +39,8 @@ public:
 	Common::SeekableReadStream *getFilePointer();
 	Common::FSNode _fsnode;
 	bool _boundToExe;
+	// Whether the package may be mapped, see FSNode::createGameDataReadStream()
+	bool _gameData;
 	byte _priority;
 	Common::String _name;
 	int32 _cd;
@@ -49,7 +51,7 @@ class PackageSet : public Common::Archive {
 public:
 	virtual ~PackageSet();
 
-	PackageSet(Common::FSNode package, const Common::String &filename = "", bool searchSignature = false);
+	PackageSet(Common::FSNode package, const Common::String &filename = "", bool searchSignature = false, bool gameData = false);
 	/**
 	 * Check if a member with the given name is present in the Archive.
 	 * Patterns are not allowed, as this is meant to be a quick File::exists()
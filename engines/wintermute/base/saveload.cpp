@@ -38,6 +38,7 @@
 #include "engines/wintermute/base/gfx/base_renderer.h"
 #include "engines/wintermute/base/sound/base_sound.h"
 #include "engines/wintermute/base/scriptables/script.h"
+#include "common/deltasave.h"
 #include "common/savefile.h"
 #include "common/config-manager.h"
 
@@ -99,8 +100,19 @@ bool SaveLoad::saveGame(int slot, const char *desc, bool quickSave, BaseGame *ga
 		if (DID_SUCCEED(ret = SystemClassRegistry::getInstance()->saveTable(gameRef,  pm, quickSave))) {
 			if (DID_SUCCEED(ret = SystemClassRegistry::getInstance()->saveInstances(gameRef,  pm, quickSave))) {
 				pm->putDWORD(BaseEngine::instance().getRandomSource()->getSeed());
-				if (DID_SUCCEED(ret = pm->saveFile(filename))) {
+				// The autosave slot is overwritten often and not managed by
+				// the user, so only store what changed since the last time.
+				// Changes are detected in fixed blocks at fixed offsets, so
+				// this only pays off while the serialized state keeps its
+				// layout. Once a string or array early in the state changes
+				// its length, all following data shifts, no block matches
+				// anymore and a full snapshot gets written instead.
+				const bool delta = (slot == (int)gameRef->getAutoSaveSlot());
+				if (DID_SUCCEED(ret = pm->saveFile(filename, delta))) {
 					ConfMan.setInt("most_recent_saveslot", slot);
+					// The file is written in the background, so errors
+					// are only reported once it is done
+					gameRef->addPendingSave(filename);
 				}
 			}
 		}
@@ -196,7 +208,7 @@ bool SaveLoad::isSaveSlotUsed(int slot) {
 bool SaveLoad::emptySaveSlot(int slot) {
 	Common::String filename = getSaveSlotFilename(slot);
 	BasePersistenceManager *pm = new BasePersistenceManager();
-	((WintermuteEngine *)g_engine)->getSaveFileMan()->removeSavefile(pm->getFilenameForSlot(slot));
+	Common::removeDeltaSavefile(((WintermuteEngine *)g_engine)->getSaveFileMan(), pm->getFilenameForSlot(slot));
 	delete pm;
 	return true;
 }
@@ -230,6 +230,7 @@ int WintermuteEngine::messageLoop() {
 		}
 
 		if (_game && _game->_renderer->_active && _game->_renderer->isReady()) {
+			_game->checkPendingSaves();
 			_game->displayContent();
 			_game->displayQuickMsg();
 
@@ -20,17 +20,28 @@ MODULE_OBJS := \
 	transform_struct.o \
 	transform_tools.o \
 	transparent_surface.o \
+	transparent_surface_avx2.o \
+	transparent_surface_sse2.o \
 	thumbnail.o \
 	VectorRenderer.o \
 	VectorRendererSpec.o \
 	wincursor.o \
-	yuv_to_rgb.o
+	yuv_to_rgb.o \
+	yuv_to_rgb_avx2.o \
+	yuv_to_rgb_sse2.o
+
+ifdef USE_NEON
+MODULE_OBJS += \
+	transparent_surface_neon.o \
+	yuv_to_rgb_neon.o
+endif
 
 ifdef USE_SCALERS
 MODULE_OBJS += \
 	scaler/2xsai.o \
 	scaler/aspect.o \
 	scaler/downscaler.o \
+	scaler/normal_sse2.o \
 	scaler/scale2x.o \
 	scaler/scale3x.o \
 	scaler/scalebit.o
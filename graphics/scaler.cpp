@@ -20,11 +20,13 @@
  *
  */
 
+#include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/scalebit.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/workerpool.h"
 
 int gBitFormat = 565;
 
@@ -178,6 +180,22 @@ void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 	}
 }
 
+/**
+ * Trivial 'scaler' for 32 bit pixels.
+ */
+void Normal1x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	if ((srcPitch == sizeof(uint32) * (uint)width) && (dstPitch == sizeof(uint32) * (uint)width)) {
+		memcpy(dstPtr, srcPtr, sizeof(uint32) * width * height);
+		return;
+	}
+	while (height--) {
+		memcpy(dstPtr, srcPtr, sizeof(uint32) * width);
+		srcPtr += srcPitch;
+		dstPtr += dstPitch;
+	}
+}
+
 #ifdef USE_SCALERS
 
 
@@ -253,6 +271,60 @@ void Normal3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 	}
 }
 
+/**
+ * Trivial nearest-neighbor 2x scaler for 32 bit pixels.
+ */
+void Normal2x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	assert(IS_ALIGNED(srcPtr, 4) && IS_ALIGNED(dstPtr, 4));
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCpuFeature(Common::kCpuFeatureSSE2)) {
+		Normal2x_32_SSE2(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+#endif
+	while (height--) {
+		const uint32 *src = (const uint32 *)srcPtr;
+		uint32 *dst0 = (uint32 *)dstPtr;
+		uint32 *dst1 = (uint32 *)(dstPtr + dstPitch);
+		for (int i = 0; i < width; ++i) {
+			const uint32 color = src[i];
+			dst0[2 * i] = dst0[2 * i + 1] = color;
+			dst1[2 * i] = dst1[2 * i + 1] = color;
+		}
+		srcPtr += srcPitch;
+		dstPtr += dstPitch << 1;
+	}
+}
+
+/**
+ * Trivial nearest-neighbor 3x scaler for 32 bit pixels.
+ */
+void Normal3x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	assert(IS_ALIGNED(srcPtr, 4) && IS_ALIGNED(dstPtr, 4));
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCpuFeature(Common::kCpuFeatureSSE2)) {
+		Normal3x_32_SSE2(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+#endif
+	while (height--) {
+		const uint32 *src = (const uint32 *)srcPtr;
+		uint32 *dst0 = (uint32 *)dstPtr;
+		uint32 *dst1 = (uint32 *)(dstPtr + dstPitch);
+		uint32 *dst2 = (uint32 *)(dstPtr + dstPitch * 2);
+		for (int i = 0; i < width; ++i) {
+			const uint32 color = src[i];
+			dst0[3 * i] = dst0[3 * i + 1] = dst0[3 * i + 2] = color;
+			dst1[3 * i] = dst1[3 * i + 1] = dst1[3 * i + 2] = color;
+			dst2[3 * i] = dst2[3 * i + 1] = dst2[3 * i + 2] = color;
+		}
+		srcPtr += srcPitch;
+		dstPtr += dstPitch * 3;
+	}
+}
+
 #define interpolate_1_1		interpolate16_1_1<ColorMask>
 #define interpolate_1_1_1_1	interpolate16_1_1_1_1<ColorMask>
 
@@ -317,6 +389,22 @@ void AdvMame3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPi
 	scale(3, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 2, width, height);
 }
 
+/**
+ * The Scale2x filter for 32 bit pixels.
+ */
+void AdvMame2x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							 int width, int height) {
+	scale(2, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 4, width, height);
+}
+
+/**
+ * The Scale3x filter for 32 bit pixels.
+ */
+void AdvMame3x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							 int width, int height) {
+	scale(3, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 4, width, height);
+}
+
 template<typename ColorMask>
 void TV2xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 					int width, int height) {
@@ -387,3 +475,94 @@ void DotMatrix(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPi
 }
 
 #endif // #ifdef USE_SCALERS
+
+namespace {
+
+enum {
+	/**
+	 * Bands start at multiples of this many rows, so that scalers using
+	 * patterns depending on the row (like DotMatrix) give the same output.
+	 */
+	kBandAlignment = 4,
+
+	/** Bands are not made smaller than this. */
+	kMinBandHeight = 16,
+
+	/** Rectangles with fewer pixels are not worth splitting up. */
+	kMinBandedPixels = 64 * 64
+};
+
+struct ScalerBands {
+	ScalerProc *scaler;
+	int scaleFactor;
+	const uint8 *srcPtr;
+	uint32 srcPitch;
+	uint8 *dstPtr;
+	uint32 dstPitch;
+	int width;
+	int height;
+	int bandHeight;
+	uint numBands;
+};
+
+} // End of anonymous namespace
+
+/**
+ * Returns whether the scaler can be run by several threads at the same
+ * time. The assembly versions of the HQ scalers keep their state in
+ * global variables.
+ */
+static bool isScalerReentrant(ScalerProc *scaler) {
+#if defined(USE_HQ_SCALERS) && defined(USE_NASM)
+	if (scaler == HQ2x || scaler == HQ3x)
+		return false;
+#endif
+	return true;
+}
+
+static void scaleBand(void *refCon, uint index) {
+	const ScalerBands &bands = *(const ScalerBands *)refCon;
+
+	// The last band also takes the remaining rows
+	const int top = index * bands.bandHeight;
+	const int height = (index == bands.numBands - 1) ? bands.height - top : bands.bandHeight;
+
+	bands.scaler(bands.srcPtr + top * bands.srcPitch, bands.srcPitch,
+	             bands.dstPtr + top * bands.scaleFactor * bands.dstPitch, bands.dstPitch, bands.width, height);
+}
+
+void scaleInBands(Common::WorkerPool &pool, ScalerProc *scaler, int scaleFactor,
+				  const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	const int numThreads = pool.getNumThreads();
+	if (numThreads < 2 || width * height < kMinBandedPixels || height < 2 * kMinBandHeight || !isScalerReentrant(scaler)) {
+		scaler(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+	// One band per thread, rounded up to the band alignment
+	int bandHeight = MAX<int>((height + numThreads - 1) / numThreads, kMinBandHeight);
+	bandHeight = (bandHeight + kBandAlignment - 1) / kBandAlignment * kBandAlignment;
+
+	ScalerBands bands;
+	bands.scaler = scaler;
+	bands.scaleFactor = scaleFactor;
+	bands.srcPtr = srcPtr;
+	bands.srcPitch = srcPitch;
+	bands.dstPtr = dstPtr;
+	bands.dstPitch = dstPitch;
+	bands.width = width;
+	bands.height = height;
+	bands.bandHeight = bandHeight;
+	bands.numBands = (height + bandHeight - 1) / bandHeight;
+
+	// Merge a tiny last band into the one before it
+	if (height - (int)(bands.numBands - 1) * bandHeight < kBandAlignment)
+		bands.numBands--;
+
+	if (bands.numBands < 2) {
+		scaler(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+	pool.run(scaleBand, &bands, bands.numBands);
+}
@@ -62,6 +62,53 @@ DECLARE_SCALER(HQ3x);
 
 #endif // #ifdef USE_SCALERS
 
+/*
+ * Scalers for 32 bit pixels with 8 bits per channel, which do not need
+ * InitScalers(). The HQ scalers require green to be stored in bits 8-15,
+ * e.g. ARGB8888 or ABGR8888; the others work with any channel order.
+ */
+DECLARE_SCALER(Normal1x_32);
+
+#ifdef USE_SCALERS
+
+DECLARE_SCALER(Normal2x_32);
+DECLARE_SCALER(Normal3x_32);
+
+DECLARE_SCALER(AdvMame2x_32);
+DECLARE_SCALER(AdvMame3x_32);
+
+#ifdef USE_HQ_SCALERS
+DECLARE_SCALER(HQ2x_32);
+DECLARE_SCALER(HQ3x_32);
+#endif
+
+#endif // #ifdef USE_SCALERS
+
+namespace Common {
+class WorkerPool;
+}
+
+/**
+ * Scale a rectangle with the given scaler, splitting it into horizontal
+ * bands which are scaled in parallel by the threads of a worker pool. The
+ * output is identical to calling the scaler directly. Rectangles too small
+ * to benefit from this, and scalers which are not reentrant, are scaled on
+ * the calling thread in one go.
+ *
+ * Each band is scaled on its own, so the scaler must not carry state from
+ * one row to the next, and row dependent patterns must repeat within four
+ * rows. The bands read the source rows next to them, so the scaler must not
+ * modify its source either. All the scalers above fulfill this: they read at
+ * most one row above and two rows below each source row, and only
+ * DotMatrix depends on the row.
+ *
+ * @param pool			the worker pool to scale the bands with
+ * @param scaler		the scaler to use
+ * @param scaleFactor	the number of destination rows per source row
+ */
+extern void scaleInBands(Common::WorkerPool &pool, ScalerProc *scaler, int scaleFactor,
+							const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+
 // creates a 160x100 thumbnail for 320x200 games
 // and 160x120 thumbnail for 320x240 and 640x480 games
 // only 565 mode
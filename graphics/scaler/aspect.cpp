@@ -158,6 +158,25 @@ static inline void interpolate5Line(uint16 *dst, const uint16 *srcA, const uint1
 }
 #endif
 
+#if ASPECT_MODE != kSuperFastAndUglyAspectMode
+/**
+ * 32 bit pixels are blended with the weights of kVeryFastAndGoodAspectMode,
+ * whichever mode is selected for 16 bit pixels.
+ */
+template<typename ColorMask, int scale>
+static inline void interpolate5Line(uint32 *dst, const uint32 *srcA, const uint32 *srcB, int width) {
+	if (scale == 1) {
+		while (width--) {
+			*dst++ = interpolate8888<7, 1, 0, 0, 3>(*srcB++, *srcA++, 0, 0);
+		}
+	} else {
+		while (width--) {
+			*dst++ = interpolate8888<5, 3, 0, 0, 3>(*srcB++, *srcA++, 0, 0);
+		}
+	}
+}
+#endif
+
 void makeRectStretchable(int &x, int &y, int &w, int &h) {
 #if ASPECT_MODE != kSuperFastAndUglyAspectMode
 	int m = real2Aspect(y) % 6;
@@ -188,7 +207,7 @@ void makeRectStretchable(int &x, int &y, int &w, int &h) {
 }
 
 /**
- * Stretch a 16bpp image vertically by factor 1.2. Used to correct the
+ * Stretch a 16 or 32bpp image vertically by factor 1.2. Used to correct the
  * aspect-ratio in games using 320x200 pixel graphics with non-qudratic
  * pixels. Applying this method effectively turns that into 320x240, which
  * provides the correct aspect-ratio on modern displays.
@@ -203,12 +222,12 @@ void makeRectStretchable(int &x, int &y, int &w, int &h) {
  * srcY + height - 1, and it should be stretched to Y coordinates srcY
  * through real2Aspect(srcY + height - 1).
  */
-template<typename ColorMask>
+template<typename ColorMask, typename Pixel>
 int stretch200To240(uint8 *buf, uint32 pitch, int width, int height, int srcX, int srcY, int origSrcY) {
 	int maxDstY = real2Aspect(origSrcY + height - 1);
 	int y;
-	const uint8 *startSrcPtr = buf + srcX * 2 + (srcY - origSrcY) * pitch;
-	uint8 *dstPtr = buf + srcX * 2 + maxDstY * pitch;
+	const uint8 *startSrcPtr = buf + srcX * sizeof(Pixel) + (srcY - origSrcY) * pitch;
+	uint8 *dstPtr = buf + srcX * sizeof(Pixel) + maxDstY * pitch;
 
 	for (y = maxDstY; y >= srcY; y--) {
 		const uint8 *srcPtr = startSrcPtr + aspect2Real(y) * pitch;
@@ -216,26 +235,26 @@ int stretch200To240(uint8 *buf, uint32 pitch, int width, int height, int srcX, i
 #if ASPECT_MODE == kSuperFastAndUglyAspectMode
 		if (srcPtr == dstPtr)
 			break;
-		memcpy(dstPtr, srcPtr, sizeof(uint16) * width);
+		memcpy(dstPtr, srcPtr, sizeof(Pixel) * width);
 #else
 		// Bilinear filter
 		switch (y % 6) {
 		case 0:
 		case 5:
 			if (srcPtr != dstPtr)
-				memcpy(dstPtr, srcPtr, sizeof(uint16) * width);
+				memcpy(dstPtr, srcPtr, sizeof(Pixel) * width);
 			break;
 		case 1:
-			interpolate5Line<ColorMask, 1>((uint16 *)dstPtr, (const uint16 *)(srcPtr - pitch), (const uint16 *)srcPtr, width);
+			interpolate5Line<ColorMask, 1>((Pixel *)dstPtr, (const Pixel *)(srcPtr - pitch), (const Pixel *)srcPtr, width);
 			break;
 		case 2:
-			interpolate5Line<ColorMask, 2>((uint16 *)dstPtr, (const uint16 *)(srcPtr - pitch), (const uint16 *)srcPtr, width);
+			interpolate5Line<ColorMask, 2>((Pixel *)dstPtr, (const Pixel *)(srcPtr - pitch), (const Pixel *)srcPtr, width);
 			break;
 		case 3:
-			interpolate5Line<ColorMask, 2>((uint16 *)dstPtr, (const uint16 *)srcPtr, (const uint16 *)(srcPtr - pitch), width);
+			interpolate5Line<ColorMask, 2>((Pixel *)dstPtr, (const Pixel *)srcPtr, (const Pixel *)(srcPtr - pitch), width);
 			break;
 		case 4:
-			interpolate5Line<ColorMask, 1>((uint16 *)dstPtr, (const uint16 *)srcPtr, (const uint16 *)(srcPtr - pitch), width);
+			interpolate5Line<ColorMask, 1>((Pixel *)dstPtr, (const Pixel *)srcPtr, (const Pixel *)(srcPtr - pitch), width);
 			break;
 		}
 #endif
@@ -248,9 +267,13 @@ int stretch200To240(uint8 *buf, uint32 pitch, int width, int height, int srcX, i
 int stretch200To240(uint8 *buf, uint32 pitch, int width, int height, int srcX, int srcY, int origSrcY) {
 	extern int gBitFormat;
 	if (gBitFormat == 565)
-		return stretch200To240<Graphics::ColorMasks<565> >(buf, pitch, width, height, srcX, srcY, origSrcY);
+		return stretch200To240<Graphics::ColorMasks<565>, uint16>(buf, pitch, width, height, srcX, srcY, origSrcY);
 	else // gBitFormat == 555
-		return stretch200To240<Graphics::ColorMasks<555> >(buf, pitch, width, height, srcX, srcY, origSrcY);
+		return stretch200To240<Graphics::ColorMasks<555>, uint16>(buf, pitch, width, height, srcX, srcY, origSrcY);
+}
+
+int stretch200To240_32(uint8 *buf, uint32 pitch, int width, int height, int srcX, int srcY, int origSrcY) {
+	return stretch200To240<Graphics::ColorMasks<8888>, uint32>(buf, pitch, width, height, srcX, srcY, origSrcY);
 }
 
 
@@ -56,6 +56,17 @@ int stretch200To240(uint8 *buf,
                     int srcY,
                     int origSrcY);
 
+/**
+ * Same as stretch200To240(), for 32 bit pixels with 8 bits per channel.
+ */
+int stretch200To240_32(uint8 *buf,
+                       uint32 pitch,
+                       int width,
+                       int height,
+                       int srcX,
+                       int srcY,
+                       int origSrcY);
+
 
 /**
  * This filter (up)scales the source image vertically by a factor of 6/5.
@@ -24,6 +24,7 @@
 #define GRAPHICS_SCALER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/cpudetect.h"
 #include "graphics/colormasks.h"
 
 
@@ -179,6 +180,118 @@ static inline unsigned interpolate16_1_1_1_1(unsigned p1, unsigned p2, unsigned
 	return ((p1+p2+p3+p4) - lowbits) >> 2;
 }
 
+/**
+ * Interpolate four 32 bit pixels with 8 bits per channel, in any channel
+ * order, with weights w1 to w4, i.e., (w1*p1+w2*p2+w3*p3+w4*p4) >> shift.
+ * Like the 16 bit functions above, the channels are interpolated
+ * independently and rounded down. The weights must not add up to more
+ * than 256.
+ */
+template<int w1, int w2, int w3, int w4, int shift>
+static inline uint32 interpolate8888(uint32 p1, uint32 p2, uint32 p3, uint32 p4) {
+	// Two channels at a time, each with 16 bits of room
+	const uint32 rb = ((p1 & 0x00FF00FF) * w1 + (p2 & 0x00FF00FF) * w2
+	                +  (p3 & 0x00FF00FF) * w3 + (p4 & 0x00FF00FF) * w4) >> shift;
+	const uint32 ag = (((p1 >> 8) & 0x00FF00FF) * w1 + ((p2 >> 8) & 0x00FF00FF) * w2
+	                +  ((p3 >> 8) & 0x00FF00FF) * w3 + ((p4 >> 8) & 0x00FF00FF) * w4) >> shift;
+	return (rb & 0x00FF00FF) | ((ag & 0x00FF00FF) << 8);
+}
+
+/*
+ * Interpolation functions for the pixels of the format described by
+ * ColorMask, which the hq scalers use for both 16 and 32 bit pixels. Besides
+ * the 16 bit formats, ColorMasks<8888> is supported, with any channel order.
+ */
+template<typename ColorMask>
+static inline unsigned interpolate_1_1(unsigned p1, unsigned p2) {
+	return interpolate16_1_1<ColorMask>(p1, p2);
+}
+
+template<typename ColorMask>
+static inline unsigned interpolate_3_1(unsigned p1, unsigned p2) {
+	return interpolate16_3_1<ColorMask>(p1, p2);
+}
+
+template<typename ColorMask>
+static inline unsigned interpolate_7_1(unsigned p1, unsigned p2) {
+	return interpolate16_7_1<ColorMask>(p1, p2);
+}
+
+template<typename ColorMask>
+static inline unsigned interpolate_2_1_1(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate16_2_1_1<ColorMask>(p1, p2, p3);
+}
+
+template<typename ColorMask>
+static inline unsigned interpolate_5_2_1(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate16_5_2_1<ColorMask>(p1, p2, p3);
+}
+
+template<typename ColorMask>
+static inline unsigned interpolate_6_1_1(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate16_6_1_1<ColorMask>(p1, p2, p3);
+}
+
+template<typename ColorMask>
+static inline unsigned interpolate_2_3_3(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate16_2_3_3<ColorMask>(p1, p2, p3);
+}
+
+template<typename ColorMask>
+static inline unsigned interpolate_2_7_7(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate16_2_7_7<ColorMask>(p1, p2, p3);
+}
+
+template<typename ColorMask>
+static inline unsigned interpolate_14_1_1(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate16_14_1_1<ColorMask>(p1, p2, p3);
+}
+
+template<>
+inline unsigned interpolate_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate8888<1, 1, 0, 0, 1>(p1, p2, 0, 0);
+}
+
+template<>
+inline unsigned interpolate_3_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate8888<3, 1, 0, 0, 2>(p1, p2, 0, 0);
+}
+
+template<>
+inline unsigned interpolate_7_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate8888<7, 1, 0, 0, 3>(p1, p2, 0, 0);
+}
+
+template<>
+inline unsigned interpolate_2_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate8888<2, 1, 1, 0, 2>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate_5_2_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate8888<5, 2, 1, 0, 3>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate_6_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate8888<6, 1, 1, 0, 3>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate_2_3_3<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate8888<2, 3, 3, 0, 3>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate_2_7_7<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate8888<2, 7, 7, 0, 4>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate_14_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate8888<14, 1, 1, 0, 4>(p1, p2, p3, 0);
+}
+
 /**
  * Compare two YUV values (encoded 8-8-8) and check if they differ by more than
  * a certain hard coded threshold. Used by the hq scaler family.
@@ -218,4 +331,41 @@ static inline bool diffYUV(int yuv1, int yuv2) {
 */
 }
 
+/**
+ * 16bit RGB to YUV conversion table, set up by InitLUT().
+ */
+extern "C" uint32 *RGBtoYUV;
+
+/**
+ * Get the YUV value (encoded 8-8-8) of a pixel, as used by the hq scaler
+ * family. 16 bit pixels are looked up in the table set up by InitLUT().
+ */
+template<typename ColorMask>
+static inline int getYUV(unsigned color) {
+	return RGBtoYUV[color];
+}
+
+/**
+ * The YUV value of a 32 bit pixel is computed the way InitLUT() does, for
+ * pixels with red in bits 16-23 and green in bits 8-15. Pixels with red and
+ * blue swapped get u mirrored around 128, so diffYUV() gives the same
+ * result for them except where rounding differs.
+ */
+template<>
+inline int getYUV<Graphics::ColorMasks<8888> >(unsigned color) {
+	const int r = (color >> 16) & 0xFF;
+	const int g = (color >> 8) & 0xFF;
+	const int b = color & 0xFF;
+	const int Y = (r + g + b) >> 2;
+	const int u = 128 + ((r - b) >> 2);
+	const int v = 128 + ((-r + 2 * g - b) >> 3);
+	return (Y << 16) | (u << 8) | v;
+}
+
+#ifdef SCUMMVM_SSE2
+// SSE2 versions of the nearest-neighbor scalers for 32 bit pixels
+void Normal2x_32_SSE2(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+void Normal3x_32_SSE2(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+#endif
+
 #endif
@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/scaler/intern.h"
+
+#ifdef SCUMMVM_SSE2
+
+#include <emmintrin.h>
+
+/*
+ * The nearest-neighbor scalers for 32 bit pixels, replicating four source
+ * pixels at a time. The remaining pixels of each row, which do not fill a
+ * whole vector, are replicated one by one.
+ */
+
+SCUMMVM_TARGET_SSE2 void Normal2x_32_SSE2(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	const int vectorWidth = width & ~3;
+	while (height--) {
+		const uint32 *src = (const uint32 *)srcPtr;
+		uint32 *dst0 = (uint32 *)dstPtr;
+		uint32 *dst1 = (uint32 *)(dstPtr + dstPitch);
+		int i = 0;
+		for (; i < vectorWidth; i += 4) {
+			const __m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+			const __m128i lo = _mm_unpacklo_epi32(pixels, pixels);
+			const __m128i hi = _mm_unpackhi_epi32(pixels, pixels);
+			_mm_storeu_si128((__m128i *)(dst0 + 2 * i), lo);
+			_mm_storeu_si128((__m128i *)(dst0 + 2 * i + 4), hi);
+			_mm_storeu_si128((__m128i *)(dst1 + 2 * i), lo);
+			_mm_storeu_si128((__m128i *)(dst1 + 2 * i + 4), hi);
+		}
+		for (; i < width; ++i) {
+			const uint32 color = src[i];
+			dst0[2 * i] = dst0[2 * i + 1] = color;
+			dst1[2 * i] = dst1[2 * i + 1] = color;
+		}
+		srcPtr += srcPitch;
+		dstPtr += dstPitch << 1;
+	}
+}
+
+SCUMMVM_TARGET_SSE2 void Normal3x_32_SSE2(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	const int vectorWidth = width & ~3;
+	while (height--) {
+		const uint32 *src = (const uint32 *)srcPtr;
+		uint32 *dst0 = (uint32 *)dstPtr;
+		uint32 *dst1 = (uint32 *)(dstPtr + dstPitch);
+		uint32 *dst2 = (uint32 *)(dstPtr + dstPitch * 2);
+		int i = 0;
+		for (; i < vectorWidth; i += 4) {
+			const __m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+			const __m128i a = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(1, 0, 0, 0));
+			const __m128i b = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(2, 2, 1, 1));
+			const __m128i c = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 2));
+			_mm_storeu_si128((__m128i *)(dst0 + 3 * i), a);
+			_mm_storeu_si128((__m128i *)(dst0 + 3 * i + 4), b);
+			_mm_storeu_si128((__m128i *)(dst0 + 3 * i + 8), c);
+			_mm_storeu_si128((__m128i *)(dst1 + 3 * i), a);
+			_mm_storeu_si128((__m128i *)(dst1 + 3 * i + 4), b);
+			_mm_storeu_si128((__m128i *)(dst1 + 3 * i + 8), c);
+			_mm_storeu_si128((__m128i *)(dst2 + 3 * i), a);
+			_mm_storeu_si128((__m128i *)(dst2 + 3 * i + 4), b);
+			_mm_storeu_si128((__m128i *)(dst2 + 3 * i + 8), c);
+		}
+		for (; i < width; ++i) {
+			const uint32 color = src[i];
+			dst0[3 * i] = dst0[3 * i + 1] = dst0[3 * i + 2] = color;
+			dst1[3 * i] = dst1[3 * i + 1] = dst1[3 * i + 2] = color;
+			dst2[3 * i] = dst2[3 * i + 1] = dst2[3 * i + 2] = color;
+		}
+		srcPtr += srcPitch;
+		dstPtr += dstPitch * 3;
+	}
+}
+
+#endif
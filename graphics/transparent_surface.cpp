@@ -32,13 +32,13 @@
 #include "common/util.h"
 #include "common/rect.h"
 #include "common/math.h"
+#include "common/noncopyable.h"
 #include "common/textconsole.h"
 #include "graphics/primitives.h"
 #include "graphics/transparent_surface.h"
+#include "graphics/transparent_surface_intern.h"
 #include "graphics/transform_tools.h"
 
-//#define ENABLE_BILINEAR
-
 namespace Graphics {
 
 static const int kAShift = 0;//img->format.aShift;
@@ -95,10 +95,20 @@ void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		memcpy(out, in, width * 4);
-		for (uint32 j = 0; j < width; j++) {
-			out[kAIndex] = 0xFF;
-			out += 4;
+		if (inStep == 4) {
+			memcpy(out, in, width * 4);
+			for (uint32 j = 0; j < width; j++) {
+				out[kAIndex] = 0xFF;
+				out += 4;
+			}
+		} else {
+			// Flipped horizontally
+			for (uint32 j = 0; j < width; j++) {
+				*(uint32 *)out = *(uint32 *)in;
+				out[kAIndex] = 0xFF;
+				out += 4;
+				in += inStep;
+			}
 		}
 		outo += pitch;
 		ino += inoStep;
@@ -304,19 +314,19 @@ void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height,
 
 				out[kAIndex] = 255;
 				if (cb != 255) {
-					out[kBIndex] = MAX(out[kBIndex] - ((in[kBIndex] * cb  * (out[kBIndex]) * in[kAIndex]) >> 24), 0);
+					out[kBIndex] = MAX<int>(out[kBIndex] - (int)(((uint32)(in[kBIndex] * cb) * out[kBIndex] * in[kAIndex]) >> 24), 0);
 				} else {
 					out[kBIndex] = MAX(out[kBIndex] - (in[kBIndex] * (out[kBIndex]) * in[kAIndex] >> 16), 0);
 				}
 
 				if (cg != 255) {
-					out[kGIndex] = MAX(out[kGIndex] - ((in[kGIndex] * cg  * (out[kGIndex]) * in[kAIndex]) >> 24), 0);
+					out[kGIndex] = MAX<int>(out[kGIndex] - (int)(((uint32)(in[kGIndex] * cg) * out[kGIndex] * in[kAIndex]) >> 24), 0);
 				} else {
 					out[kGIndex] = MAX(out[kGIndex] - (in[kGIndex] * (out[kGIndex]) * in[kAIndex] >> 16), 0);
 				}
 
 				if (cr != 255) {
-					out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * cr * (out[kRIndex]) * in[kAIndex]) >> 24), 0);
+					out[kRIndex] = MAX<int>(out[kRIndex] - (int)(((uint32)(in[kRIndex] * cr) * out[kRIndex] * in[kAIndex]) >> 24), 0);
 				} else {
 					out[kRIndex] = MAX(out[kRIndex] - (in[kRIndex] * (out[kRIndex]) * in[kAIndex] >> 16), 0);
 				}
@@ -330,7 +340,101 @@ void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height,
 	}
 }
 
-Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height, TSpriteBlendMode blendMode) {
+const BlendKernels g_blendKernelsScalar = {
+	"scalar",
+	doBlitOpaqueFast,
+	doBlitBinaryFast,
+	doBlitAlphaBlend,
+	doBlitAdditiveBlend,
+	doBlitSubtractiveBlend
+};
+
+const BlendKernels &getBlendKernels() {
+#if defined(SCUMM_LITTLE_ENDIAN)
+#ifdef SCUMMVM_AVX2
+	if (Common::hasCpuFeature(Common::kCpuFeatureAVX2))
+		return g_blendKernelsAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCpuFeature(Common::kCpuFeatureSSE2))
+		return g_blendKernelsSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (Common::hasCpuFeature(Common::kCpuFeatureNEON))
+		return g_blendKernelsNEON;
+#endif
+#endif
+
+	return g_blendKernelsScalar;
+}
+
+static void blendPixels(const BlendKernels &kernels, TSpriteBlendMode blendMode, AlphaType alphaMode, uint32 color,
+                        byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && alphaMode == ALPHA_OPAQUE) {
+		kernels.blitOpaque(ino, outo, width, height, pitch, inStep, inoStep);
+	} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && alphaMode == ALPHA_BINARY) {
+		kernels.blitBinary(ino, outo, width, height, pitch, inStep, inoStep);
+	} else {
+		if (blendMode == BLEND_ADDITIVE) {
+			kernels.blitAdditiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+		} else if (blendMode == BLEND_SUBTRACTIVE) {
+			kernels.blitSubtractiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+		} else {
+			assert(blendMode == BLEND_NORMAL);
+			kernels.blitAlphaBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+		}
+	}
+}
+
+namespace {
+
+/**
+ * Samples a range of columns of a surface as if it was scaled with
+ * TransparentSurface::scale() without filtering, without creating the
+ * scaled surface. The results are identical.
+ */
+class ScaledSampler : public Common::NonCopyable {
+public:
+	/** Sample the columns x to x + count - 1 of the dstW x dstH scaled image. */
+	ScaledSampler(const Surface &src, int dstW, int dstH, int x, int count) : _src(src), _dstH(dstH), _count(count) {
+		_columns = new int[count];
+		for (int i = 0; i < count; i++)
+			_columns[i] = ((x + i) * _src.w) / dstW;
+	}
+
+	~ScaledSampler() {
+		delete[] _columns;
+	}
+
+	/**
+	 * Get the source row which row y of the scaled image is sampled from.
+	 * Rows with the same source row are identical.
+	 */
+	int getSourceRow(int y) const {
+		return (y * _src.h) / _dstH;
+	}
+
+	/** Sample the columns of row y of the scaled image. */
+	void sampleRow(uint32 *dst, int y) const {
+		// Keep the columns in locals, the stores to dst may alias the members
+		const int *columns = _columns;
+		const int count = _count;
+
+		const uint32 *srcP = (const uint32 *)_src.getBasePtr(0, getSourceRow(y));
+		for (int i = 0; i < count; i++)
+			dst[i] = srcP[columns[i]];
+	}
+
+private:
+	const Surface &_src;
+	int _dstH;
+	int *_columns;
+	int _count;
+};
+
+} // End of anonymous namespace
+
+Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height, TSpriteBlendMode blendMode, bool filtering) {
 
 	Common::Rect retSize;
 	retSize.top = 0;
@@ -390,78 +494,113 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 	height = height * 2 / 3;
 #endif
 
-	Graphics::Surface *img = nullptr;
-	Graphics::Surface *imgScaled = nullptr;
-	byte *savedPixels = nullptr;
 	if ((width != srcImage.w) || (height != srcImage.h)) {
-		// Scale the image
-		img = imgScaled = srcImage.scale(width, height);
-		savedPixels = (byte *)img->getPixels();
-	} else {
-		img = &srcImage;
+		blitScaled(srcImage, target, posX, posY, flipping, color, width, height, blendMode, filtering, retSize);
+		return retSize;
 	}
 
 	// Handle off-screen clipping
 	if (posY < 0) {
-		img->h = MAX(0, (int)img->h - -posY);
-		img->setPixels((byte *)img->getBasePtr(0, -posY));
+		srcImage.h = MAX(0, (int)srcImage.h - -posY);
+		srcImage.setPixels((byte *)srcImage.getBasePtr(0, -posY));
 		posY = 0;
 	}
 
 	if (posX < 0) {
-		img->w = MAX(0, (int)img->w - -posX);
-		img->setPixels((byte *)img->getBasePtr(-posX, 0));
+		srcImage.w = MAX(0, (int)srcImage.w - -posX);
+		srcImage.setPixels((byte *)srcImage.getBasePtr(-posX, 0));
 		posX = 0;
 	}
 
-	img->w = CLIP((int)img->w, 0, (int)MAX((int)target.w - posX, 0));
-	img->h = CLIP((int)img->h, 0, (int)MAX((int)target.h - posY, 0));
+	srcImage.w = CLIP((int)srcImage.w, 0, (int)MAX((int)target.w - posX, 0));
+	srcImage.h = CLIP((int)srcImage.h, 0, (int)MAX((int)target.h - posY, 0));
 
-	if ((img->w > 0) && (img->h > 0)) {
+	if ((srcImage.w > 0) && (srcImage.h > 0)) {
 		int xp = 0, yp = 0;
 
 		int inStep = 4;
-		int inoStep = img->pitch;
+		int inoStep = srcImage.pitch;
 		if (flipping & FLIP_H) {
 			inStep = -inStep;
-			xp = img->w - 1;
+			xp = srcImage.w - 1;
 		}
 
 		if (flipping & FLIP_V) {
 			inoStep = -inoStep;
-			yp = img->h - 1;
+			yp = srcImage.h - 1;
 		}
 
-		byte *ino = (byte *)img->getBasePtr(xp, yp);
+		byte *ino = (byte *)srcImage.getBasePtr(xp, yp);
 		byte *outo = (byte *)target.getBasePtr(posX, posY);
 
-		if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_OPAQUE) {
-			doBlitOpaqueFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_BINARY) {
-			doBlitBinaryFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else {
-			if (blendMode == BLEND_ADDITIVE) {
-				doBlitAdditiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else if (blendMode == BLEND_SUBTRACTIVE) {
-				doBlitSubtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else {
-				assert(blendMode == BLEND_NORMAL);
-				doBlitAlphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			}
-		}
+		blendPixels(getBlendKernels(), blendMode, _alphaMode, color, ino, outo, srcImage.w, srcImage.h, target.pitch, inStep, inoStep);
+	}
+
+	retSize.setWidth(srcImage.w);
+	retSize.setHeight(srcImage.h);
+
+	return retSize;
+}
 
+void TransparentSurface::blitScaled(const Surface &srcImage, Surface &target, int posX, int posY, int flipping, uint color,
+                                    int width, int height, TSpriteBlendMode blendMode, bool filtering, Common::Rect &retSize) const {
+	// Blending the scaled rows right away only pays off when rows scaled
+	// from the same source row share the sampling. Otherwise, sampling the
+	// whole image and then blending it is faster, so scale a copy first.
+	if (filtering || height <= srcImage.h) {
+		TransparentSurface unscaled(srcImage, false);
+		TransparentSurface *scaled = unscaled.scale(width, height, filtering);
+		scaled->setAlphaMode(_alphaMode);
+		retSize = scaled->blit(target, posX, posY, flipping, nullptr, color, -1, -1, blendMode);
+		scaled->free();
+		delete scaled;
+		return;
 	}
 
-	retSize.setWidth(img->w);
-	retSize.setHeight(img->h);
+	// Clip the scaled image like blit() clips an unscaled one
+	int clipX = 0, clipY = 0;
+	if (posY < 0) {
+		clipY = MIN(-posY, height);
+		posY = 0;
+	}
 
-	if (imgScaled) {
-		imgScaled->setPixels(savedPixels);
-		imgScaled->free();
-		delete imgScaled;
+	if (posX < 0) {
+		clipX = MIN(-posX, width);
+		posX = 0;
 	}
 
-	return retSize;
+	const int visibleW = CLIP(width - clipX, 0, MAX((int)target.w - posX, 0));
+	const int visibleH = CLIP(height - clipY, 0, MAX((int)target.h - posY, 0));
+
+	retSize.setWidth(visibleW);
+	retSize.setHeight(visibleH);
+
+	if (visibleW <= 0 || visibleH <= 0)
+		return;
+
+	// Sample and blend the visible part one row at a time. Consecutive
+	// rows scaled from the same source row are only sampled once.
+	ScaledSampler sampler(srcImage, width, height, clipX, visibleW);
+	const BlendKernels &kernels = getBlendKernels();
+	uint32 *buffer = new uint32[visibleW];
+
+	int sampledRow = -1;
+	for (int y = 0; y < visibleH; y++) {
+		const int srcY = clipY + ((flipping & FLIP_V) ? visibleH - 1 - y : y);
+		const int row = sampler.getSourceRow(srcY);
+		if (row != sampledRow) {
+			sampler.sampleRow(buffer, srcY);
+			sampledRow = row;
+		}
+
+		byte *outo = (byte *)target.getBasePtr(posX, posY + y);
+		if (flipping & FLIP_H)
+			blendPixels(kernels, blendMode, _alphaMode, color, (byte *)(buffer + visibleW - 1), outo, visibleW, 1, target.pitch, -4, 0);
+		else
+			blendPixels(kernels, blendMode, _alphaMode, color, (byte *)buffer, outo, visibleW, 1, target.pitch, 4, 0);
+	}
+
+	delete[] buffer;
 }
 
 /**
@@ -546,7 +685,7 @@ systems.
 
 
 
-TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transform) const {
+TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transform, bool filtering) const {
 
 	assert(transform._angle != 0); // This would not be ideal; rotoscale() should never be called in conditional branches where angle = 0 anyway.
 
@@ -608,50 +747,50 @@ TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transfo
 				dy = sh - dy;
 			}
 
-#ifdef ENABLE_BILINEAR
-			if ((dx > -1) && (dy > -1) && (dx < sw) && (dy < sh)) {
-				const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
-				tColorRGBA c00, c01, c10, c11, cswap;
-				c00 = *sp;
-				sp += 1;
-				c01 = *sp;
-				sp += (this->pitch / 4);
-				c11 = *sp;
-				sp -= 1;
-				c10 = *sp;
-				if (flipx) {
-					cswap = c00; c00=c01; c01=cswap;
-					cswap = c10; c10=c11; c11=cswap;
+			if (filtering) {
+				if ((dx > -1) && (dy > -1) && (dx < sw) && (dy < sh)) {
+					const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
+					tColorRGBA c00, c01, c10, c11, cswap;
+					c00 = *sp;
+					sp += 1;
+					c01 = *sp;
+					sp += (this->pitch / 4);
+					c11 = *sp;
+					sp -= 1;
+					c10 = *sp;
+					if (flipx) {
+						cswap = c00; c00=c01; c01=cswap;
+						cswap = c10; c10=c11; c11=cswap;
+					}
+					if (flipy) {
+						cswap = c00; c00=c10; c10=cswap;
+						cswap = c01; c01=c11; c11=cswap;
+					}
+					/*
+					* Interpolate colors
+					*/
+					int ex = (sdx & 0xffff);
+					int ey = (sdy & 0xffff);
+					int t1, t2;
+					t1 = ((((c01.r - c00.r) * ex) >> 16) + c00.r) & 0xff;
+					t2 = ((((c11.r - c10.r) * ex) >> 16) + c10.r) & 0xff;
+					pc->r = (((t2 - t1) * ey) >> 16) + t1;
+					t1 = ((((c01.g - c00.g) * ex) >> 16) + c00.g) & 0xff;
+					t2 = ((((c11.g - c10.g) * ex) >> 16) + c10.g) & 0xff;
+					pc->g = (((t2 - t1) * ey) >> 16) + t1;
+					t1 = ((((c01.b - c00.b) * ex) >> 16) + c00.b) & 0xff;
+					t2 = ((((c11.b - c10.b) * ex) >> 16) + c10.b) & 0xff;
+					pc->b = (((t2 - t1) * ey) >> 16) + t1;
+					t1 = ((((c01.a - c00.a) * ex) >> 16) + c00.a) & 0xff;
+					t2 = ((((c11.a - c10.a) * ex) >> 16) + c10.a) & 0xff;
+					pc->a = (((t2 - t1) * ey) >> 16) + t1;
 				}
-				if (flipy) {
-					cswap = c00; c00=c10; c10=cswap;
-					cswap = c01; c01=c11; c11=cswap;
+			} else {
+				if ((dx >= 0) && (dy >= 0) && (dx < srcW) && (dy < srcH)) {
+					const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
+					*pc = *sp;
 				}
-				/*
-				* Interpolate colors
-				*/
-				int ex = (sdx & 0xffff);
-				int ey = (sdy & 0xffff);
-				int t1, t2;
-				t1 = ((((c01.r - c00.r) * ex) >> 16) + c00.r) & 0xff;
-				t2 = ((((c11.r - c10.r) * ex) >> 16) + c10.r) & 0xff;
-				pc->r = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01.g - c00.g) * ex) >> 16) + c00.g) & 0xff;
-				t2 = ((((c11.g - c10.g) * ex) >> 16) + c10.g) & 0xff;
-				pc->g = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01.b - c00.b) * ex) >> 16) + c00.b) & 0xff;
-				t2 = ((((c11.b - c10.b) * ex) >> 16) + c10.b) & 0xff;
-				pc->b = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01.a - c00.a) * ex) >> 16) + c00.a) & 0xff;
-				t2 = ((((c11.a - c10.a) * ex) >> 16) + c10.a) & 0xff;
-				pc->a = (((t2 - t1) * ey) >> 16) + t1;
 			}
-#else
-			if ((dx >= 0) && (dy >= 0) && (dx < srcW) && (dy < srcH)) {
-				const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
-				*pc = *sp;
-			}
-#endif
 			sdx += icosx;
 			sdy += isiny;
 			pc++;
@@ -660,7 +799,7 @@ TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transfo
 	return target;
 }
 
-TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight) const {
+TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight, bool filtering) const {
 
 	Common::Rect srcRect(0, 0, (int16)w, (int16)h);
 	Common::Rect dstRect(0, 0, (int16)newWidth, (int16)newHeight);
@@ -676,173 +815,170 @@ TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight)
 
 	target->create((uint16)dstW, (uint16)dstH, this->format);
 
-#ifdef ENABLE_BILINEAR
+	if (filtering) {
+		// NB: The actual order of these bytes may not be correct, but
+		// since all values are treated equal, that does not matter.
+		struct tColorRGBA { byte r; byte g; byte b; byte a; };
 
-	// NB: The actual order of these bytes may not be correct, but
-	// since all values are treated equal, that does not matter.
-	struct tColorRGBA { byte r; byte g; byte b; byte a; };
+		bool flipx = false, flipy = false; // TODO: See mirroring comment in RenderTicket ctor
 
-	bool flipx = false, flipy = false; // TODO: See mirroring comment in RenderTicket ctor
 
+		int *sax = new int[dstW + 1];
+		int *say = new int[dstH + 1];
+		assert(sax && say);
 
-	int *sax = new int[dstW + 1];
-	int *say = new int[dstH + 1];
-	assert(sax && say);
-
-	/*
-	* Precalculate row increments
-	*/
-	int spixelw = (srcW - 1);
-	int spixelh = (srcH - 1);
-	int sx = (int) (65536.0f * (float) spixelw / (float) (dstW - 1));
-	int sy = (int) (65536.0f * (float) spixelh / (float) (dstH - 1));
-
-	/* Maximum scaled source size */
-	int ssx = (srcW << 16) - 1;
-	int ssy = (srcH << 16) - 1;
-
-	/* Precalculate horizontal row increments */
-	int csx = 0;
-	int *csax = sax;
-	for (int x = 0; x <= dstW; x++) {
-		*csax = csx;
-		csax++;
-		csx += sx;
-
-		/* Guard from overflows */
-		if (csx > ssx) {
-			csx = ssx;
+		/*
+		* Precalculate row increments
+		*/
+		int spixelw = (srcW - 1);
+		int spixelh = (srcH - 1);
+		int sx = (int) (65536.0f * (float) spixelw / (float) (dstW - 1));
+		int sy = (int) (65536.0f * (float) spixelh / (float) (dstH - 1));
+
+		/* Maximum scaled source size */
+		int ssx = (srcW << 16) - 1;
+		int ssy = (srcH << 16) - 1;
+
+		/* Precalculate horizontal row increments */
+		int csx = 0;
+		int *csax = sax;
+		for (int x = 0; x <= dstW; x++) {
+			*csax = csx;
+			csax++;
+			csx += sx;
+
+			/* Guard from overflows */
+			if (csx > ssx) {
+				csx = ssx;
+			}
 		}
-	}
 
-	/* Precalculate vertical row increments */
-	int csy = 0;
-	int *csay = say;
-	for (int y = 0; y <= dstH; y++) {
-		*csay = csy;
-		csay++;
-		csy += sy;
-
-		/* Guard from overflows */
-		if (csy > ssy) {
-			csy = ssy;
+		/* Precalculate vertical row increments */
+		int csy = 0;
+		int *csay = say;
+		for (int y = 0; y <= dstH; y++) {
+			*csay = csy;
+			csay++;
+			csy += sy;
+
+			/* Guard from overflows */
+			if (csy > ssy) {
+				csy = ssy;
+			}
 		}
-	}
 
-	const tColorRGBA *sp = (const tColorRGBA *) getBasePtr(0, 0);
-	tColorRGBA *dp = (tColorRGBA *) target->getBasePtr(0, 0);
-	int spixelgap = srcW;
+		const tColorRGBA *sp = (const tColorRGBA *) getBasePtr(0, 0);
+		tColorRGBA *dp = (tColorRGBA *) target->getBasePtr(0, 0);
+		int spixelgap = srcW;
 
-	if (flipx) {
-		sp += spixelw;
-	}
-	if (flipy) {
-		sp += spixelgap * spixelh;
-	}
+		if (flipx) {
+			sp += spixelw;
+		}
+		if (flipy) {
+			sp += spixelgap * spixelh;
+		}
 
-	csay = say;
-	for (int y = 0; y < dstH; y++) {
-		const tColorRGBA *csp = sp;
-		csax = sax;
-		for (int x = 0; x < dstW; x++) {
-			/*
-			* Setup color source pointers
-			*/
-			int ex = (*csax & 0xffff);
-			int ey = (*csay & 0xffff);
-			int cx = (*csax >> 16);
-			int cy = (*csay >> 16);
-
-			const tColorRGBA *c00, *c01, *c10, *c11;
-			c00 = sp;
-			c01 = sp;
-			c10 = sp;
-			if (cy < spixelh) {
-				if (flipy) {
-					c10 -= spixelgap;
-				} else {
-					c10 += spixelgap;
+		csay = say;
+		for (int y = 0; y < dstH; y++) {
+			const tColorRGBA *csp = sp;
+			csax = sax;
+			for (int x = 0; x < dstW; x++) {
+				/*
+				* Setup color source pointers
+				*/
+				int ex = (*csax & 0xffff);
+				int ey = (*csay & 0xffff);
+				int cx = (*csax >> 16);
+				int cy = (*csay >> 16);
+
+				const tColorRGBA *c00, *c01, *c10, *c11;
+				c00 = sp;
+				c01 = sp;
+				c10 = sp;
+				if (cy < spixelh) {
+					if (flipy) {
+						c10 -= spixelgap;
+					} else {
+						c10 += spixelgap;
+					}
 				}
-			}
-			c11 = c10;
-			if (cx < spixelw) {
+				c11 = c10;
+				if (cx < spixelw) {
+					if (flipx) {
+						c01--;
+						c11--;
+					} else {
+						c01++;
+						c11++;
+					}
+				}
+
+				/*
+				* Draw and interpolate colors
+				*/
+				int t1, t2;
+				t1 = ((((c01->r - c00->r) * ex) >> 16) + c00->r) & 0xff;
+				t2 = ((((c11->r - c10->r) * ex) >> 16) + c10->r) & 0xff;
+				dp->r = (((t2 - t1) * ey) >> 16) + t1;
+				t1 = ((((c01->g - c00->g) * ex) >> 16) + c00->g) & 0xff;
+				t2 = ((((c11->g - c10->g) * ex) >> 16) + c10->g) & 0xff;
+				dp->g = (((t2 - t1) * ey) >> 16) + t1;
+				t1 = ((((c01->b - c00->b) * ex) >> 16) + c00->b) & 0xff;
+				t2 = ((((c11->b - c10->b) * ex) >> 16) + c10->b) & 0xff;
+				dp->b = (((t2 - t1) * ey) >> 16) + t1;
+				t1 = ((((c01->a - c00->a) * ex) >> 16) + c00->a) & 0xff;
+				t2 = ((((c11->a - c10->a) * ex) >> 16) + c10->a) & 0xff;
+				dp->a = (((t2 - t1) * ey) >> 16) + t1;
+
+				/*
+				* Advance source pointer x
+				*/
+				int *salastx = csax;
+				csax++;
+				int sstepx = (*csax >> 16) - (*salastx >> 16);
 				if (flipx) {
-					c01--;
-					c11--;
+					sp -= sstepx;
 				} else {
-					c01++;
-					c11++;
+					sp += sstepx;
 				}
-			}
-
-			/*
-			* Draw and interpolate colors
-			*/
-			int t1, t2;
-			t1 = ((((c01->r - c00->r) * ex) >> 16) + c00->r) & 0xff;
-			t2 = ((((c11->r - c10->r) * ex) >> 16) + c10->r) & 0xff;
-			dp->r = (((t2 - t1) * ey) >> 16) + t1;
-			t1 = ((((c01->g - c00->g) * ex) >> 16) + c00->g) & 0xff;
-			t2 = ((((c11->g - c10->g) * ex) >> 16) + c10->g) & 0xff;
-			dp->g = (((t2 - t1) * ey) >> 16) + t1;
-			t1 = ((((c01->b - c00->b) * ex) >> 16) + c00->b) & 0xff;
-			t2 = ((((c11->b - c10->b) * ex) >> 16) + c10->b) & 0xff;
-			dp->b = (((t2 - t1) * ey) >> 16) + t1;
-			t1 = ((((c01->a - c00->a) * ex) >> 16) + c00->a) & 0xff;
-			t2 = ((((c11->a - c10->a) * ex) >> 16) + c10->a) & 0xff;
-			dp->a = (((t2 - t1) * ey) >> 16) + t1;
 
+				/*
+				* Advance destination pointer x
+				*/
+				dp++;
+			}
 			/*
-			* Advance source pointer x
+			* Advance source pointer y
 			*/
-			int *salastx = csax;
-			csax++;
-			int sstepx = (*csax >> 16) - (*salastx >> 16);
-			if (flipx) {
-				sp -= sstepx;
+			int *salasty = csay;
+			csay++;
+			int sstepy = (*csay >> 16) - (*salasty >> 16);
+			sstepy *= spixelgap;
+			if (flipy) {
+				sp = csp - sstepy;
 			} else {
-				sp += sstepx;
+				sp = csp + sstepy;
 			}
-
-			/*
-			* Advance destination pointer x
-			*/
-			dp++;
-		}
-		/*
-		* Advance source pointer y
-		*/
-		int *salasty = csay;
-		csay++;
-		int sstepy = (*csay >> 16) - (*salasty >> 16);
-		sstepy *= spixelgap;
-		if (flipy) {
-			sp = csp - sstepy;
-		} else {
-			sp = csp + sstepy;
 		}
-	}
-
-	delete[] sax;
-	delete[] say;
-
-#else
-
-	int *scaleCacheX = new int[dstW];
-	for (int x = 0; x < dstW; x++) {
-		scaleCacheX[x] = (x * srcW) / dstW;
-	}
 
-	for (int y = 0; y < dstH; y++) {
-		uint32 *destP = (uint32 *)target->getBasePtr(0, y);
-		const uint32 *srcP = (const uint32 *)getBasePtr(0, (y * srcH) / dstH);
+		delete[] sax;
+		delete[] say;
+	} else {
+		int *scaleCacheX = new int[dstW];
 		for (int x = 0; x < dstW; x++) {
-			*destP++ = srcP[scaleCacheX[x]];
+			scaleCacheX[x] = (x * srcW) / dstW;
 		}
-	}
-	delete[] scaleCacheX;
 
-#endif
+		for (int y = 0; y < dstH; y++) {
+			uint32 *destP = (uint32 *)target->getBasePtr(0, y);
+			const uint32 *srcP = (const uint32 *)getBasePtr(0, (y * srcH) / dstH);
+			for (int x = 0; x < dstW; x++) {
+				*destP++ = srcP[scaleCacheX[x]];
+			}
+		}
+		delete[] scaleCacheX;
+
+	}
 
 	return target;
 
@@ -103,6 +103,10 @@ struct TransparentSurface : public Graphics::Surface {
 	 The images will be scaled if the output width of the screen section differs from the image section.<br>
 	 The value -1 determines that the image should not be scaled.<br>
 	 The default value is -1.
+	 @param blend the blend mode.<br>
+	 The default value is BLEND_NORMAL.
+	 @param filtering whether to scale the image with bilinear filtering instead of nearest neighbour sampling.<br>
+	 The default value is false.
 	 @return returns false if the rendering failed.
 	 */
 	Common::Rect blit(Graphics::Surface &target, int posX = 0, int posY = 0,
@@ -110,7 +114,8 @@ struct TransparentSurface : public Graphics::Surface {
 	                  Common::Rect *pPartRect = nullptr,
 	                  uint color = TS_ARGB(255, 255, 255, 255),
 	                  int width = -1, int height = -1,
-	                  TSpriteBlendMode blend = BLEND_NORMAL);
+	                  TSpriteBlendMode blend = BLEND_NORMAL,
+	                  bool filtering = false);
 	void applyColorKey(uint8 r, uint8 g, uint8 b, bool overwriteAlpha = false);
 
 	/**
@@ -119,21 +124,31 @@ struct TransparentSurface : public Graphics::Surface {
 	 *
 	 * @param newWidth the resulting width.
 	 * @param newHeight the resulting height.
+	 * @param filtering whether to use bilinear filtering instead of nearest neighbour sampling.
 	 * @see TransformStruct
 	 */
-	TransparentSurface *scale(uint16 newWidth, uint16 newHeight) const;
+	TransparentSurface *scale(uint16 newWidth, uint16 newHeight, bool filtering = false) const;
 
 	/**
 	 * @brief Rotoscale function; this returns a transformed version of this surface after rotation and
 	 * scaling. Please do not use this if angle == 0, use plain old scaling function.
 	 *
 	 * @param transform a TransformStruct wrapping the required info. @see TransformStruct
+	 * @param filtering whether to use bilinear filtering instead of nearest neighbour sampling.
 	 *
 	 */
-	TransparentSurface *rotoscale(const TransformStruct &transform) const;
+	TransparentSurface *rotoscale(const TransformStruct &transform, bool filtering = false) const;
 	AlphaType getAlphaMode() const;
 	void setAlphaMode(AlphaType);
 private:
+	/**
+	 * Blit srcImage scaled to width x height pixels. Vertical upscales
+	 * without filtering are sampled and blended in one go instead of
+	 * creating a scaled copy with scale().
+	 */
+	void blitScaled(const Surface &srcImage, Surface &target, int posX, int posY, int flipping, uint color,
+	                int width, int height, TSpriteBlendMode blendMode, bool filtering, Common::Rect &retSize) const;
+
 	AlphaType _alphaMode;
 
 };
@@ -0,0 +1,238 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transparent_surface_intern.h"
+
+#if defined(SCUMMVM_AVX2) && defined(SCUMM_LITTLE_ENDIAN)
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+/*
+ * These work like the SSE2 kernels, on eight pixels at a time. Unpacking
+ * and packing happen within each 128-bit lane, so the pixels end up in
+ * their original order.
+ */
+
+/** Load eight source pixels, reversing their order when flipping horizontally. */
+SCUMMVM_TARGET_AVX2 static inline __m256i loadPixels(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return _mm256_loadu_si256((const __m256i *)in);
+	const __m256i reverse = _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	return _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(in - 28)), reverse);
+}
+
+/** Replicate the alpha channel of each widened pixel into all of its channels. */
+SCUMMVM_TARGET_AVX2 static inline __m256i broadcastAlpha(__m256i pixels) {
+	return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+/** A vector of four widened pixels with the given channel values. */
+SCUMMVM_TARGET_AVX2 static inline __m256i setChannels(uint16 a, uint16 r, uint16 g, uint16 b) {
+	return _mm256_set_epi16(r, g, b, a, r, g, b, a, r, g, b, a, r, g, b, a);
+}
+
+/** Get the number of pixels per row which are processed in vectors of the given size. */
+static inline uint32 getVectorWidth(uint32 width, int32 inStep, uint32 vectorSize) {
+	return (inStep == 4 || inStep == -4) ? width & ~(vectorSize - 1) : 0;
+}
+
+/** Apply op.blend16() to both halves of eight widened pixels. */
+template<class Op>
+SCUMMVM_TARGET_AVX2 static inline __m256i blendWidened(const Op &op, __m256i src, __m256i dst) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i lo = op.blend16(_mm256_unpacklo_epi8(src, zero), _mm256_unpacklo_epi8(dst, zero));
+	const __m256i hi = op.blend16(_mm256_unpackhi_epi8(src, zero), _mm256_unpackhi_epi8(dst, zero));
+	return _mm256_packus_epi16(lo, hi);
+}
+
+/** Combine each eight pixels of the source rectangle with the target using op.blend(). */
+template<class Op>
+SCUMMVM_TARGET_AVX2 static void blitVectors(const Op &op, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < width; j += 8) {
+			const __m256i dst = _mm256_loadu_si256((const __m256i *)out);
+			_mm256_storeu_si256((__m256i *)out, op.blend(loadPixels(in, inStep), dst));
+			in += inStep * 8;
+			out += 32;
+		}
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+namespace {
+
+struct OpaqueOp {
+	SCUMMVM_TARGET_AVX2 __m256i blend(__m256i src, __m256i dst) const {
+		return _mm256_or_si256(src, _mm256_set1_epi32(0xFF));
+	}
+};
+
+struct BinaryOp {
+	SCUMMVM_TARGET_AVX2 __m256i blend(__m256i src, __m256i dst) const {
+		const __m256i alphaMask = _mm256_set1_epi32(0xFF);
+		const __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(src, alphaMask), _mm256_setzero_si256());
+		return _mm256_or_si256(_mm256_and_si256(transparent, dst), _mm256_andnot_si256(transparent, _mm256_or_si256(src, alphaMask)));
+	}
+};
+
+/** out = (in * a + out * (255 - a)) >> 8, skipping fully transparent pixels */
+struct AlphaBlendOp {
+	SCUMMVM_TARGET_AVX2 __m256i blend16(__m256i src, __m256i dst) const {
+		const __m256i a = broadcastAlpha(src);
+		const __m256i invA = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+		return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, a), _mm256_mullo_epi16(dst, invA)), 8);
+	}
+
+	SCUMMVM_TARGET_AVX2 __m256i blend(__m256i src, __m256i dst) const {
+		const __m256i alphaMask = _mm256_set1_epi32(0xFF);
+		const __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(src, alphaMask), _mm256_setzero_si256());
+		const __m256i result = _mm256_or_si256(blendWidened(*this, src, dst), alphaMask);
+		return _mm256_or_si256(_mm256_and_si256(transparent, dst), _mm256_andnot_si256(transparent, result));
+	}
+};
+
+/** ina = a * ca >> 8; out = (out * (255 - ina) >> 8) + (in * ina * c >> 16) */
+struct AlphaBlendModOp {
+	__m256i _ca;
+	__m256i _color;
+
+	SCUMMVM_TARGET_AVX2 AlphaBlendModOp(uint32 color) {
+		_ca = _mm256_set1_epi16((color >> 24) & 0xFF);
+		_color = setChannels(0, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+	}
+
+	SCUMMVM_TARGET_AVX2 __m256i blend16(__m256i src, __m256i dst) const {
+		const __m256i ina = _mm256_srli_epi16(_mm256_mullo_epi16(broadcastAlpha(src), _ca), 8);
+		const __m256i invA = _mm256_sub_epi16(_mm256_set1_epi16(255), ina);
+		const __m256i faded = _mm256_srli_epi16(_mm256_mullo_epi16(dst, invA), 8);
+		return _mm256_add_epi16(faded, _mm256_mulhi_epu16(_mm256_mullo_epi16(src, ina), _color));
+	}
+
+	SCUMMVM_TARGET_AVX2 __m256i blend(__m256i src, __m256i dst) const {
+		return _mm256_or_si256(blendWidened(*this, src, dst), _mm256_set1_epi32(0xFF));
+	}
+};
+
+/**
+ * ina = a * ca >> 8; out = min(out + (in * ina * c >> 16), 255)
+ *
+ * Without modulation, or for color components of 255, ca and c are 256 so
+ * that they drop out. The alpha channel is left alone.
+ */
+struct AdditiveOp {
+	__m256i _ca;
+	__m256i _color;
+
+	SCUMMVM_TARGET_AVX2 AdditiveOp(uint32 color) {
+		_ca = _mm256_set1_epi16(color == 0xFFFFFFFF ? 256 : (color >> 24) & 0xFF);
+		_color = setChannels(0, getColorFactor(color, 16), getColorFactor(color, 8), getColorFactor(color, 0));
+	}
+
+	SCUMMVM_TARGET_AVX2 __m256i blend16(__m256i src, __m256i dst) const {
+		const __m256i ina = _mm256_srli_epi16(_mm256_mullo_epi16(broadcastAlpha(src), _ca), 8);
+		// The sum is saturated when packing
+		return _mm256_add_epi16(dst, _mm256_mulhi_epu16(_mm256_mullo_epi16(src, ina), _color));
+	}
+
+	SCUMMVM_TARGET_AVX2 __m256i blend(__m256i src, __m256i dst) const {
+		return blendWidened(*this, src, dst);
+	}
+};
+
+/**
+ * out = out - (in * out * a * c >> 24)
+ *
+ * Without modulation, or for color components of 255, c is 256. Only with
+ * modulation the alpha channel is made opaque.
+ */
+struct SubtractiveOp {
+	__m256i _color;
+	__m256i _alpha;
+
+	SCUMMVM_TARGET_AVX2 SubtractiveOp(uint32 color) {
+		_color = setChannels(0, getColorFactor(color, 16), getColorFactor(color, 8), getColorFactor(color, 0));
+		_alpha = _mm256_set1_epi32(color == 0xFFFFFFFF ? 0 : 0xFF);
+	}
+
+	SCUMMVM_TARGET_AVX2 __m256i blend16(__m256i src, __m256i dst) const {
+		const __m256i weight = _mm256_mullo_epi16(broadcastAlpha(src), _color);
+		const __m256i amount = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_mullo_epi16(src, dst), weight), 8);
+		return _mm256_sub_epi16(dst, amount);
+	}
+
+	SCUMMVM_TARGET_AVX2 __m256i blend(__m256i src, __m256i dst) const {
+		return _mm256_or_si256(blendWidened(*this, src, dst), _alpha);
+	}
+};
+
+} // End of anonymous namespace
+
+SCUMMVM_TARGET_AVX2 static void blitOpaqueAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 8);
+	blitVectors(OpaqueOp(), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitOpaque(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep);
+}
+
+SCUMMVM_TARGET_AVX2 static void blitBinaryAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 8);
+	blitVectors(BinaryOp(), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitBinary(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep);
+}
+
+SCUMMVM_TARGET_AVX2 static void blitAlphaBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 8);
+	if (color == 0xFFFFFFFF)
+		blitVectors(AlphaBlendOp(), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	else
+		blitVectors(AlphaBlendModOp(color), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitAlphaBlend(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep, color);
+}
+
+SCUMMVM_TARGET_AVX2 static void blitAdditiveBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 8);
+	blitVectors(AdditiveOp(color), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitAdditiveBlend(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep, color);
+}
+
+SCUMMVM_TARGET_AVX2 static void blitSubtractiveBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 8);
+	blitVectors(SubtractiveOp(color), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitSubtractiveBlend(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep, color);
+}
+
+const BlendKernels g_blendKernelsAVX2 = {
+	"avx2",
+	blitOpaqueAVX2,
+	blitBinaryAVX2,
+	blitAlphaBlendAVX2,
+	blitAdditiveBlendAVX2,
+	blitSubtractiveBlendAVX2
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,101 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TRANSPARENTSURFACE_INTERN_H
+#define GRAPHICS_TRANSPARENTSURFACE_INTERN_H
+
+#include "common/scummsys.h"
+#include "common/cpudetect.h"
+
+namespace Graphics {
+
+/**
+ * The inner loops of TransparentSurface::blit, one for each way of
+ * combining the source pixels with the target.
+ *
+ * All of them take the same parameters:
+ * @param ino      pointer to the first source pixel
+ * @param outo     pointer to the first target pixel
+ * @param width    number of pixels per row
+ * @param height   number of rows
+ * @param pitch    width in bytes of a row of the target surface
+ * @param inStep   bytes to advance to the next source pixel, negative
+ *                 for horizontal flipping
+ * @param inoStep  bytes to advance to the next source row, negative for
+ *                 vertical flipping
+ * @param color    color modulation in 0xAARRGGBB format, 0xFFFFFFFF for
+ *                 none (only used by the blending kernels)
+ *
+ * Besides the plain C++ implementation, there are SIMD implementations for
+ * the instruction set extensions supported by the compiler. All of them
+ * produce bit-identical output; getBlendKernels() selects the fastest one
+ * the CPU supports at run time.
+ */
+struct BlendKernels {
+	const char *name;
+
+	/** Copy the pixels, making them fully opaque. */
+	void (*blitOpaque)(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
+
+	/** Copy the pixels which are not fully transparent, making them fully opaque. */
+	void (*blitBinary)(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
+
+	/** Alpha blend the pixels onto the target. */
+	void (*blitAlphaBlend)(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+	/** Add the pixels, weighted by their alpha, to the target. */
+	void (*blitAdditiveBlend)(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+	/** Darken the target by the pixels, weighted by their alpha. */
+	void (*blitSubtractiveBlend)(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+};
+
+/**
+ * Get a component of the modulation color the way the additive and
+ * subtractive kernels apply it, as a factor with 8 fractional bits: a
+ * component of 255, as well as no modulation at all, leaves the source
+ * channel unchanged.
+ */
+inline uint16 getColorFactor(uint32 color, int shift) {
+	const uint16 component = (color >> shift) & 0xFF;
+	return (color == 0xFFFFFFFF || component == 255) ? 256 : component;
+}
+
+extern const BlendKernels g_blendKernelsScalar;
+#if defined(SCUMMVM_SSE2) && defined(SCUMM_LITTLE_ENDIAN)
+extern const BlendKernels g_blendKernelsSSE2;
+#endif
+#if defined(SCUMMVM_AVX2) && defined(SCUMM_LITTLE_ENDIAN)
+extern const BlendKernels g_blendKernelsAVX2;
+#endif
+#if defined(SCUMMVM_NEON) && defined(SCUMM_LITTLE_ENDIAN)
+extern const BlendKernels g_blendKernelsNEON;
+#endif
+
+/**
+ * Returns the fastest set of kernels supported by the CPU.
+ */
+const BlendKernels &getBlendKernels();
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,234 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transparent_surface_intern.h"
+
+#if defined(SCUMMVM_NEON) && defined(SCUMM_LITTLE_ENDIAN)
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+/*
+ * Four pixels are processed at a time, widened to 16 bits per channel for
+ * blending, with the alpha channel in the lowest byte of each pixel.
+ */
+
+/** Load four source pixels, reversing their order when flipping horizontally. */
+static inline uint8x16_t loadPixels(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return vld1q_u8(in);
+	const uint32x4_t pixels = vrev64q_u32(vreinterpretq_u32_u8(vld1q_u8(in - 12)));
+	return vreinterpretq_u8_u32(vcombine_u32(vget_high_u32(pixels), vget_low_u32(pixels)));
+}
+
+/** Replicate the alpha channel of each pixel into all of its channels. */
+static inline uint8x16_t broadcastAlpha(uint8x16_t pixels) {
+	const uint32x4_t alpha = vandq_u32(vreinterpretq_u32_u8(pixels), vdupq_n_u32(0xFF));
+	return vreinterpretq_u8_u32(vmulq_n_u32(alpha, 0x01010101));
+}
+
+/** A vector of two widened pixels with the given channel values. */
+static inline uint16x8_t setChannels(uint16 a, uint16 r, uint16 g, uint16 b) {
+	const uint16 channels[8] = { a, b, g, r, a, b, g, r };
+	return vld1q_u16(channels);
+}
+
+/** Multiply unsigned 16-bit values, keeping the high 16 bits of the products. */
+static inline uint16x8_t mulhi(uint16x8_t a, uint16x8_t b) {
+	const uint32x4_t lo = vmull_u16(vget_low_u16(a), vget_low_u16(b));
+	const uint32x4_t hi = vmull_u16(vget_high_u16(a), vget_high_u16(b));
+	return vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+}
+
+/** Mask of the pixels which are fully transparent. */
+static inline uint8x16_t getTransparent(uint8x16_t pixels) {
+	const uint32x4_t alpha = vandq_u32(vreinterpretq_u32_u8(pixels), vdupq_n_u32(0xFF));
+	return vreinterpretq_u8_u32(vceqq_u32(alpha, vdupq_n_u32(0)));
+}
+
+static inline uint8x16_t makeOpaque(uint8x16_t pixels) {
+	return vreinterpretq_u8_u32(vorrq_u32(vreinterpretq_u32_u8(pixels), vdupq_n_u32(0xFF)));
+}
+
+static inline uint32 getVectorWidth(uint32 width, int32 inStep) {
+	return (inStep == 4 || inStep == -4) ? width & ~3 : 0;
+}
+
+/** Apply op.blend16() to both halves of four widened pixels, saturating the results. */
+template<class Op>
+static inline uint8x16_t blendWidened(const Op &op, uint8x16_t src, uint8x16_t dst) {
+	const uint8x16_t alpha = broadcastAlpha(src);
+	const uint16x8_t lo = op.blend16(vmovl_u8(vget_low_u8(src)), vmovl_u8(vget_low_u8(dst)), vmovl_u8(vget_low_u8(alpha)));
+	const uint16x8_t hi = op.blend16(vmovl_u8(vget_high_u8(src)), vmovl_u8(vget_high_u8(dst)), vmovl_u8(vget_high_u8(alpha)));
+	return vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi));
+}
+
+template<class Op>
+static void blitVectors(const Op &op, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < width; j += 4) {
+			vst1q_u8(out, op.blend(loadPixels(in, inStep), vld1q_u8(out)));
+			in += inStep * 4;
+			out += 16;
+		}
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+namespace {
+
+struct OpaqueOp {
+	uint8x16_t blend(uint8x16_t src, uint8x16_t dst) const {
+		return makeOpaque(src);
+	}
+};
+
+struct BinaryOp {
+	uint8x16_t blend(uint8x16_t src, uint8x16_t dst) const {
+		return vbslq_u8(getTransparent(src), dst, makeOpaque(src));
+	}
+};
+
+/** out = (in * a + out * (255 - a)) >> 8, skipping fully transparent pixels */
+struct AlphaBlendOp {
+	uint16x8_t blend16(uint16x8_t src, uint16x8_t dst, uint16x8_t a) const {
+		const uint16x8_t invA = vsubq_u16(vdupq_n_u16(255), a);
+		return vshrq_n_u16(vmlaq_u16(vmulq_u16(src, a), dst, invA), 8);
+	}
+
+	uint8x16_t blend(uint8x16_t src, uint8x16_t dst) const {
+		return vbslq_u8(getTransparent(src), dst, makeOpaque(blendWidened(*this, src, dst)));
+	}
+};
+
+/** ina = a * ca >> 8; out = (out * (255 - ina) >> 8) + (in * ina * c >> 16) */
+struct AlphaBlendModOp {
+	uint16x8_t _ca;
+	uint16x8_t _color;
+
+	AlphaBlendModOp(uint32 color) {
+		_ca = vdupq_n_u16((color >> 24) & 0xFF);
+		_color = setChannels(0, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+	}
+
+	uint16x8_t blend16(uint16x8_t src, uint16x8_t dst, uint16x8_t a) const {
+		const uint16x8_t ina = vshrq_n_u16(vmulq_u16(a, _ca), 8);
+		const uint16x8_t faded = vshrq_n_u16(vmulq_u16(dst, vsubq_u16(vdupq_n_u16(255), ina)), 8);
+		return vaddq_u16(faded, mulhi(vmulq_u16(src, ina), _color));
+	}
+
+	uint8x16_t blend(uint8x16_t src, uint8x16_t dst) const {
+		return makeOpaque(blendWidened(*this, src, dst));
+	}
+};
+
+/** ina = a * ca >> 8; out = min(out + (in * ina * c >> 16), 255), see getColorFactor() */
+struct AdditiveOp {
+	uint16x8_t _ca;
+	uint16x8_t _color;
+
+	AdditiveOp(uint32 color) {
+		_ca = vdupq_n_u16(color == 0xFFFFFFFF ? 256 : (color >> 24) & 0xFF);
+		_color = setChannels(0, getColorFactor(color, 16), getColorFactor(color, 8), getColorFactor(color, 0));
+	}
+
+	uint16x8_t blend16(uint16x8_t src, uint16x8_t dst, uint16x8_t a) const {
+		const uint16x8_t ina = vshrq_n_u16(vmulq_u16(a, _ca), 8);
+		return vaddq_u16(dst, mulhi(vmulq_u16(src, ina), _color));
+	}
+
+	uint8x16_t blend(uint8x16_t src, uint8x16_t dst) const {
+		return blendWidened(*this, src, dst);
+	}
+};
+
+/** out = out - (in * out * a * c >> 24), see getColorFactor() */
+struct SubtractiveOp {
+	uint16x8_t _color;
+	uint32x4_t _alpha;
+
+	SubtractiveOp(uint32 color) {
+		_color = setChannels(0, getColorFactor(color, 16), getColorFactor(color, 8), getColorFactor(color, 0));
+		_alpha = vdupq_n_u32(color == 0xFFFFFFFF ? 0 : 0xFF);
+	}
+
+	uint16x8_t blend16(uint16x8_t src, uint16x8_t dst, uint16x8_t a) const {
+		const uint16x8_t amount = vshrq_n_u16(mulhi(vmulq_u16(src, dst), vmulq_u16(a, _color)), 8);
+		return vsubq_u16(dst, amount);
+	}
+
+	uint8x16_t blend(uint8x16_t src, uint8x16_t dst) const {
+		return vreinterpretq_u8_u32(vorrq_u32(vreinterpretq_u32_u8(blendWidened(*this, src, dst)), _alpha));
+	}
+};
+
+} // End of anonymous namespace
+
+static void blitOpaqueNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep);
+	blitVectors(OpaqueOp(), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitOpaque(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep);
+}
+
+static void blitBinaryNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep);
+	blitVectors(BinaryOp(), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitBinary(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep);
+}
+
+static void blitAlphaBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep);
+	if (color == 0xFFFFFFFF)
+		blitVectors(AlphaBlendOp(), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	else
+		blitVectors(AlphaBlendModOp(color), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitAlphaBlend(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep, color);
+}
+
+static void blitAdditiveBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep);
+	blitVectors(AdditiveOp(color), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitAdditiveBlend(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep, color);
+}
+
+static void blitSubtractiveBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep);
+	blitVectors(SubtractiveOp(color), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitSubtractiveBlend(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep, color);
+}
+
+const BlendKernels g_blendKernelsNEON = {
+	"neon",
+	blitOpaqueNEON,
+	blitBinaryNEON,
+	blitAlphaBlendNEON,
+	blitAdditiveBlendNEON,
+	blitSubtractiveBlendNEON
+};
+
+} // End of namespace Graphics
+
+#endif
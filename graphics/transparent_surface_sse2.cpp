@@ -0,0 +1,239 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transparent_surface_intern.h"
+
+#if defined(SCUMMVM_SSE2) && defined(SCUMM_LITTLE_ENDIAN)
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+/*
+ * The pixels are handled as 32-bit words holding alpha in the lowest byte,
+ * followed by blue, green and red. For blending, they are widened to 16 bits
+ * per channel, so that the product of two channels fits. The remaining
+ * pixels of each row, which do not fill a whole vector, are handed to the
+ * scalar kernels.
+ */
+
+/** Load four source pixels, reversing their order when flipping horizontally. */
+SCUMMVM_TARGET_SSE2 static inline __m128i loadPixels(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return _mm_loadu_si128((const __m128i *)in);
+	return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - 12)), _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+/** Replicate the alpha channel of each widened pixel into all of its channels. */
+SCUMMVM_TARGET_SSE2 static inline __m128i broadcastAlpha(__m128i pixels) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+/** A vector of two widened pixels with the given channel values. */
+SCUMMVM_TARGET_SSE2 static inline __m128i setChannels(uint16 a, uint16 r, uint16 g, uint16 b) {
+	return _mm_set_epi16(r, g, b, a, r, g, b, a);
+}
+
+/** Get the number of pixels per row which are processed in vectors of the given size. */
+static inline uint32 getVectorWidth(uint32 width, int32 inStep, uint32 vectorSize) {
+	return (inStep == 4 || inStep == -4) ? width & ~(vectorSize - 1) : 0;
+}
+
+/** Apply op.blend16() to both halves of four widened pixels. */
+template<class Op>
+SCUMMVM_TARGET_SSE2 static inline __m128i blendWidened(const Op &op, __m128i src, __m128i dst) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = op.blend16(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+	const __m128i hi = op.blend16(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+	return _mm_packus_epi16(lo, hi);
+}
+
+/** Combine each four pixels of the source rectangle with the target using op.blend(). */
+template<class Op>
+SCUMMVM_TARGET_SSE2 static void blitVectors(const Op &op, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < width; j += 4) {
+			const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+			_mm_storeu_si128((__m128i *)out, op.blend(loadPixels(in, inStep), dst));
+			in += inStep * 4;
+			out += 16;
+		}
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+namespace {
+
+struct OpaqueOp {
+	SCUMMVM_TARGET_SSE2 __m128i blend(__m128i src, __m128i dst) const {
+		return _mm_or_si128(src, _mm_set1_epi32(0xFF));
+	}
+};
+
+struct BinaryOp {
+	SCUMMVM_TARGET_SSE2 __m128i blend(__m128i src, __m128i dst) const {
+		const __m128i alphaMask = _mm_set1_epi32(0xFF);
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask), _mm_setzero_si128());
+		return _mm_or_si128(_mm_and_si128(transparent, dst), _mm_andnot_si128(transparent, _mm_or_si128(src, alphaMask)));
+	}
+};
+
+/** out = (in * a + out * (255 - a)) >> 8, skipping fully transparent pixels */
+struct AlphaBlendOp {
+	SCUMMVM_TARGET_SSE2 __m128i blend16(__m128i src, __m128i dst) const {
+		const __m128i a = broadcastAlpha(src);
+		const __m128i invA = _mm_sub_epi16(_mm_set1_epi16(255), a);
+		return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, a), _mm_mullo_epi16(dst, invA)), 8);
+	}
+
+	SCUMMVM_TARGET_SSE2 __m128i blend(__m128i src, __m128i dst) const {
+		const __m128i alphaMask = _mm_set1_epi32(0xFF);
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask), _mm_setzero_si128());
+		const __m128i result = _mm_or_si128(blendWidened(*this, src, dst), alphaMask);
+		return _mm_or_si128(_mm_and_si128(transparent, dst), _mm_andnot_si128(transparent, result));
+	}
+};
+
+/** ina = a * ca >> 8; out = (out * (255 - ina) >> 8) + (in * ina * c >> 16) */
+struct AlphaBlendModOp {
+	__m128i _ca;
+	__m128i _color;
+
+	SCUMMVM_TARGET_SSE2 AlphaBlendModOp(uint32 color) {
+		_ca = _mm_set1_epi16((color >> 24) & 0xFF);
+		_color = setChannels(0, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+	}
+
+	SCUMMVM_TARGET_SSE2 __m128i blend16(__m128i src, __m128i dst) const {
+		const __m128i ina = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlpha(src), _ca), 8);
+		const __m128i invA = _mm_sub_epi16(_mm_set1_epi16(255), ina);
+		const __m128i faded = _mm_srli_epi16(_mm_mullo_epi16(dst, invA), 8);
+		return _mm_add_epi16(faded, _mm_mulhi_epu16(_mm_mullo_epi16(src, ina), _color));
+	}
+
+	SCUMMVM_TARGET_SSE2 __m128i blend(__m128i src, __m128i dst) const {
+		return _mm_or_si128(blendWidened(*this, src, dst), _mm_set1_epi32(0xFF));
+	}
+};
+
+/**
+ * ina = a * ca >> 8; out = min(out + (in * ina * c >> 16), 255)
+ *
+ * Without modulation, or for color components of 255, ca and c are 256 so
+ * that they drop out. The alpha channel is left alone.
+ */
+struct AdditiveOp {
+	__m128i _ca;
+	__m128i _color;
+
+	SCUMMVM_TARGET_SSE2 AdditiveOp(uint32 color) {
+		_ca = _mm_set1_epi16(color == 0xFFFFFFFF ? 256 : (color >> 24) & 0xFF);
+		_color = setChannels(0, getColorFactor(color, 16), getColorFactor(color, 8), getColorFactor(color, 0));
+	}
+
+	SCUMMVM_TARGET_SSE2 __m128i blend16(__m128i src, __m128i dst) const {
+		const __m128i ina = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlpha(src), _ca), 8);
+		// The sum is saturated when packing
+		return _mm_add_epi16(dst, _mm_mulhi_epu16(_mm_mullo_epi16(src, ina), _color));
+	}
+
+	SCUMMVM_TARGET_SSE2 __m128i blend(__m128i src, __m128i dst) const {
+		return blendWidened(*this, src, dst);
+	}
+};
+
+/**
+ * out = out - (in * out * a * c >> 24)
+ *
+ * Without modulation, or for color components of 255, c is 256. Only with
+ * modulation the alpha channel is made opaque.
+ */
+struct SubtractiveOp {
+	__m128i _color;
+	__m128i _alpha;
+
+	SCUMMVM_TARGET_SSE2 SubtractiveOp(uint32 color) {
+		_color = setChannels(0, getColorFactor(color, 16), getColorFactor(color, 8), getColorFactor(color, 0));
+		_alpha = _mm_set1_epi32(color == 0xFFFFFFFF ? 0 : 0xFF);
+	}
+
+	SCUMMVM_TARGET_SSE2 __m128i blend16(__m128i src, __m128i dst) const {
+		const __m128i weight = _mm_mullo_epi16(broadcastAlpha(src), _color);
+		const __m128i amount = _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(src, dst), weight), 8);
+		return _mm_sub_epi16(dst, amount);
+	}
+
+	SCUMMVM_TARGET_SSE2 __m128i blend(__m128i src, __m128i dst) const {
+		return _mm_or_si128(blendWidened(*this, src, dst), _alpha);
+	}
+};
+
+} // End of anonymous namespace
+
+SCUMMVM_TARGET_SSE2 static void blitOpaqueSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 4);
+	blitVectors(OpaqueOp(), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitOpaque(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep);
+}
+
+SCUMMVM_TARGET_SSE2 static void blitBinarySSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 4);
+	blitVectors(BinaryOp(), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitBinary(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep);
+}
+
+SCUMMVM_TARGET_SSE2 static void blitAlphaBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 4);
+	if (color == 0xFFFFFFFF)
+		blitVectors(AlphaBlendOp(), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	else
+		blitVectors(AlphaBlendModOp(color), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitAlphaBlend(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep, color);
+}
+
+SCUMMVM_TARGET_SSE2 static void blitAdditiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 4);
+	blitVectors(AdditiveOp(color), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitAdditiveBlend(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep, color);
+}
+
+SCUMMVM_TARGET_SSE2 static void blitSubtractiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 vectorWidth = getVectorWidth(width, inStep, 4);
+	blitVectors(SubtractiveOp(color), ino, outo, vectorWidth, height, pitch, inStep, inoStep);
+	g_blendKernelsScalar.blitSubtractiveBlend(ino + (int32)vectorWidth * inStep, outo + vectorWidth * 4, width - vectorWidth, height, pitch, inStep, inoStep, color);
+}
+
+const BlendKernels g_blendKernelsSSE2 = {
+	"sse2",
+	blitOpaqueSSE2,
+	blitBinarySSE2,
+	blitAlphaBlendSSE2,
+	blitAdditiveBlendSSE2,
+	blitSubtractiveBlendSSE2
+};
+
+} // End of namespace Graphics
+
+#endif
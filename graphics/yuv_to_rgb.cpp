@@ -85,6 +85,7 @@
 
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -157,8 +158,44 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 	}
 }
 
+bool getYUVToRGBByteLayout(const PixelFormat &format, YUVToRGBByteChannel channels[4]) {
+	if (format.bytesPerPixel != 4 || format.rLoss || format.gLoss || format.bLoss || (format.aLoss && format.aLoss != 8))
+		return false;
+	if ((format.rShift | format.gShift | format.bShift) & 7 || (!format.aLoss && (format.aShift & 7)))
+		return false;
+
+	for (int i = 0; i < 4; i++)
+		channels[i] = kYUVToRGBByteNone;
+	channels[format.rShift / 8] = kYUVToRGBByteRed;
+	channels[format.gShift / 8] = kYUVToRGBByteGreen;
+	channels[format.bShift / 8] = kYUVToRGBByteBlue;
+	if (!format.aLoss)
+		channels[format.aShift / 8] = kYUVToRGBByteAlpha;
+	return true;
+}
+
+const YUVToRGBKernels *getYUVToRGBKernels() {
+#if defined(SCUMM_LITTLE_ENDIAN)
+#ifdef SCUMMVM_AVX2
+	if (Common::hasCpuFeature(Common::kCpuFeatureAVX2))
+		return &g_yuvToRGBKernelsAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCpuFeature(Common::kCpuFeatureSSE2))
+		return &g_yuvToRGBKernelsSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (Common::hasCpuFeature(Common::kCpuFeatureNEON))
+		return &g_yuvToRGBKernelsNEON;
+#endif
+#endif
+
+	return 0;
+}
+
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
+	_kernels = getYUVToRGBKernels();
 
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
@@ -183,6 +220,10 @@ YUVToRGBManager::~YUVToRGBManager() {
 	delete _lookup;
 }
 
+void YUVToRGBManager::setUseSIMD(bool enable) {
+	_kernels = enable ? getYUVToRGBKernels() : 0;
+}
+
 const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale) {
 	if (_lookup && _lookup->getFormat() == format && _lookup->getScale() == scale)
 		return _lookup;
@@ -197,7 +238,7 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
 
 template<typename PixelInt>
-void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, YUVToRGBRowProc convertRow, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
 	const int16 *Cr_r_tab = colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
@@ -206,7 +247,18 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
 	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
+		int w = 0;
+
+		// Convert as much of the row as possible with SIMD
+		if (convertRow) {
+			w = convertRow(dstPtr, ySrc, uSrc, vSrc, yWidth, lookup->getFormat(), lookup->getScale());
+			dstPtr += w * sizeof(PixelInt);
+			ySrc += w;
+			uSrc += w;
+			vSrc += w;
+		}
+
+		for (; w < yWidth; w++) {
 			register const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -237,13 +289,13 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, _kernels ? _kernels->convertRow444To16 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, _kernels ? _kernels->convertRow444To32 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 template<typename PixelInt>
-void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, YUVToRGBRowProc convertRow, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	int halfHeight = yHeight >> 1;
 	int halfWidth = yWidth >> 1;
 
@@ -255,7 +307,20 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		int w = 0;
+
+		// Convert as much of both rows as possible with SIMD
+		if (convertRow) {
+			const int converted = convertRow(dstPtr, ySrc, uSrc, vSrc, yWidth, lookup->getFormat(), lookup->getScale());
+			convertRow(dstPtr + dstPitch, ySrc + yPitch, uSrc, vSrc, yWidth, lookup->getFormat(), lookup->getScale());
+			w = converted >> 1;
+			dstPtr += converted * sizeof(PixelInt);
+			ySrc += converted;
+			uSrc += w;
+			vSrc += w;
+		}
+
+		for (; w < halfWidth; w++) {
 			register const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -293,9 +358,9 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, _kernels ? _kernels->convertRow420To16 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, _kernels ? _kernels->convertRow420To32 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -322,8 +387,28 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	ySrc++; \
 	xDiff++
 
+/**
+ * Interpolate a row of chroma values to the full resolution, like the
+ * lookup table based conversion below does for each pixel. The first
+ * values are left to the SIMD kernel, if there is one.
+ */
+static void interpolateChromaRow410(byte *dst, const byte *src, int quarterWidth, int uvPitch, int yDiff, YUVToRGBChromaProc interpolate) {
+	const int start = interpolate ? interpolate(dst, src, quarterWidth, uvPitch, yDiff) : 0;
+	dst += start * 4;
+
+	for (int index = start; index < quarterWidth; index++) {
+		READ_QUAD(src, c);
+
+		for (int xDiff = 0; xDiff < 4; xDiff++) {
+			byte c;
+			DO_INTERPOLATION(c);
+			*dst++ = c;
+		}
+	}
+}
+
 template<typename PixelInt>
-void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, YUVToRGBRowProc convertRow, YUVToRGBChromaProc interpolateChroma, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
 	const int16 *Cr_r_tab = colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
@@ -333,7 +418,37 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 
 	int quarterWidth = yWidth >> 2;
 
+	// With SIMD, the chroma values are interpolated a row at a time first.
+	// Like the scalar loop, only the pixels covered by a chroma quad are
+	// converted.
+	const int rowWidth = quarterWidth * 4;
+	byte *uRow = 0, *vRow = 0;
+	if (convertRow) {
+		uRow = new byte[rowWidth];
+		vRow = new byte[rowWidth];
+	}
+
 	for (int y = 0; y < yHeight; y++) {
+		if (convertRow) {
+			interpolateChromaRow410(uRow, uSrc + (y >> 2) * uvPitch, quarterWidth, uvPitch, y & 3, interpolateChroma);
+			interpolateChromaRow410(vRow, vSrc + (y >> 2) * uvPitch, quarterWidth, uvPitch, y & 3, interpolateChroma);
+
+			int w = convertRow(dstPtr, ySrc, uRow, vRow, rowWidth, lookup->getFormat(), lookup->getScale());
+			for (; w < rowWidth; w++) {
+				register const uint32 *L;
+
+				int16 cr_r  = Cr_r_tab[vRow[w]];
+				int16 crb_g = Cr_g_tab[vRow[w]] + Cb_g_tab[uRow[w]];
+				int16 cb_b  = Cb_b_tab[uRow[w]];
+
+				PUT_PIXEL(ySrc[w], dstPtr + w * sizeof(PixelInt));
+			}
+
+			dstPtr += dstPitch;
+			ySrc += yPitch;
+			continue;
+		}
+
 		for (int x = 0; x < quarterWidth; x++) {
 			// Perform bilinear interpolation on the the chroma values
 			// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
@@ -360,6 +475,9 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 		dstPtr += dstPitch - yWidth * sizeof(PixelInt);
 		ySrc += yPitch - yWidth;
 	}
+
+	delete[] uRow;
+	delete[] vRow;
 }
 
 #undef READ_QUAD
@@ -378,9 +496,9 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, _kernels ? _kernels->convertRow444To16 : 0, _kernels ? _kernels->interpolateChroma410 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, _kernels ? _kernels->convertRow444To32 : 0, _kernels ? _kernels->interpolateChroma410 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 } // End of namespace Graphics
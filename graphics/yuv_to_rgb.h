@@ -45,6 +45,7 @@
 namespace Graphics {
 
 class YUVToRGBLookup;
+struct YUVToRGBKernels;
 
 class YUVToRGBManager : public Common::Singleton<YUVToRGBManager> {
 public:
@@ -105,6 +106,13 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Enable or disable the SIMD implementations of the conversions. They
+	 * are used by default if the CPU supports them, and produce the same
+	 * output as the lookup table based implementations.
+	 */
+	void setUseSIMD(bool enable);
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
@@ -113,6 +121,7 @@ private:
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale);
 
 	YUVToRGBLookup *_lookup;
+	const YUVToRGBKernels *_kernels;
 	int16 _colorTab[4 * 256]; // 2048 bytes
 };
 
@@ -0,0 +1,263 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#if defined(SCUMMVM_AVX2) && defined(SCUMM_LITTLE_ENDIAN)
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+/*
+ * These work like the SSE2 kernels, on 32 pixels at a time. Widening the
+ * values crosses the 128-bit lanes, so the pixels stay in order until the
+ * 32 bit pixels are packed, which is done within each lane.
+ */
+
+namespace {
+
+/** How to assemble the destination pixels from the channels. */
+struct PixelLayout {
+	// 16 bit pixels
+	__m128i rLoss, gLoss, bLoss;
+	__m128i rShift, gShift, bShift;
+	uint16 alpha;
+
+	// 32 bit pixels
+	YUVToRGBByteChannel bytes[4];
+};
+
+} // End of anonymous namespace
+
+/** Get the chroma contributions to each channel of sixteen pixels. */
+template<bool itu>
+SCUMMVM_TARGET_AVX2 static inline void getChromaOffsets(__m256i u, __m256i v, __m256i &rOffset, __m256i &gOffset, __m256i &bOffset) {
+	const __m256i cb = _mm256_sub_epi16(u, _mm256_set1_epi16(128));
+	const __m256i cr = _mm256_sub_epi16(v, _mm256_set1_epi16(128));
+	const __m256i cbSign = _mm256_srai_epi16(cb, 15);
+	const __m256i crSign = _mm256_srai_epi16(cr, 15);
+
+	rOffset = _mm256_sub_epi16(_mm256_mulhi_epi16(_mm256_slli_epi16(cr, 2), _mm256_set1_epi16(kYUVCrRFactor)), crSign);
+	gOffset = _mm256_sub_epi16(_mm256_add_epi16(crSign, cbSign),
+	                           _mm256_add_epi16(_mm256_mulhi_epi16(_mm256_add_epi16(cr, cr), _mm256_set1_epi16(kYUVCrGFactor)),
+	                                            _mm256_mulhi_epi16(cb, _mm256_set1_epi16(kYUVCbGFactor))));
+	bOffset = _mm256_sub_epi16(_mm256_mulhi_epi16(_mm256_slli_epi16(cb, 2), _mm256_set1_epi16(kYUVCbBFactor)), cbSign);
+
+	if (itu) {
+		rOffset = _mm256_add_epi16(rOffset, rOffset);
+		gOffset = _mm256_add_epi16(gOffset, gOffset);
+		bOffset = _mm256_add_epi16(bOffset, bOffset);
+	}
+}
+
+/** Load sixteen luminance values, widened and prepared for the ITU scale. */
+template<bool itu>
+SCUMMVM_TARGET_AVX2 static inline __m256i loadLuma(const byte *src) {
+	const __m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)src));
+	if (!itu)
+		return y;
+	return _mm256_sub_epi16(_mm256_add_epi16(y, y), _mm256_set1_epi16(32));
+}
+
+/** Load sixteen chroma values, widened to 16 bits. */
+SCUMMVM_TARGET_AVX2 static inline __m256i loadChroma(const byte *src) {
+	return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)src));
+}
+
+/**
+ * Add up the luminance and chroma contributions of a channel. With the
+ * full scale, the result still has to be clamped to [0, 255].
+ */
+template<bool itu>
+SCUMMVM_TARGET_AVX2 static inline __m256i getChannel(__m256i y, __m256i offset) {
+	const __m256i c = _mm256_add_epi16(y, offset);
+	if (!itu)
+		return c;
+	const __m256i clamped = _mm256_min_epi16(_mm256_max_epi16(c, _mm256_setzero_si256()), _mm256_set1_epi16(2 * 219));
+	return _mm256_mulhi_epu16(clamped, _mm256_set1_epi16((int16)kYUVITUFactor));
+}
+
+/** Duplicate each of sixteen values, giving the first and the second half of the result. */
+SCUMMVM_TARGET_AVX2 static inline void duplicate(__m256i values, __m256i &lo, __m256i &hi) {
+	values = _mm256_permute4x64_epi64(values, _MM_SHUFFLE(3, 1, 2, 0));
+	lo = _mm256_unpacklo_epi16(values, values);
+	hi = _mm256_unpackhi_epi16(values, values);
+}
+
+/** Assemble sixteen 16 bit pixels. */
+template<bool itu>
+SCUMMVM_TARGET_AVX2 static inline __m256i makePixels16(__m256i r, __m256i g, __m256i b, const PixelLayout &layout) {
+	if (!itu) {
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i max = _mm256_set1_epi16(255);
+		r = _mm256_min_epi16(_mm256_max_epi16(r, zero), max);
+		g = _mm256_min_epi16(_mm256_max_epi16(g, zero), max);
+		b = _mm256_min_epi16(_mm256_max_epi16(b, zero), max);
+	}
+
+	__m256i pixels = _mm256_set1_epi16(layout.alpha);
+	pixels = _mm256_or_si256(pixels, _mm256_sll_epi16(_mm256_srl_epi16(r, layout.rLoss), layout.rShift));
+	pixels = _mm256_or_si256(pixels, _mm256_sll_epi16(_mm256_srl_epi16(g, layout.gLoss), layout.gShift));
+	pixels = _mm256_or_si256(pixels, _mm256_sll_epi16(_mm256_srl_epi16(b, layout.bLoss), layout.bShift));
+	return pixels;
+}
+
+/**
+ * Assemble 32 32 bit pixels from their channels and store them. The
+ * channels hold pixels 0-7 and 16-23 in their low lane, and pixels 8-15
+ * and 24-31 in their high lane, as left by packing.
+ */
+SCUMMVM_TARGET_AVX2 static inline void storePixels32(byte *dst, __m256i r, __m256i g, __m256i b, const PixelLayout &layout) {
+	const __m256i channels[] = { r, g, b, _mm256_set1_epi8((char)0xFF), _mm256_setzero_si256() };
+	const __m256i c0 = channels[layout.bytes[0]];
+	const __m256i c1 = channels[layout.bytes[1]];
+	const __m256i c2 = channels[layout.bytes[2]];
+	const __m256i c3 = channels[layout.bytes[3]];
+
+	const __m256i lo01 = _mm256_unpacklo_epi8(c0, c1);
+	const __m256i lo23 = _mm256_unpacklo_epi8(c2, c3);
+	const __m256i hi01 = _mm256_unpackhi_epi8(c0, c1);
+	const __m256i hi23 = _mm256_unpackhi_epi8(c2, c3);
+	const __m256i p0 = _mm256_unpacklo_epi16(lo01, lo23);
+	const __m256i p1 = _mm256_unpackhi_epi16(lo01, lo23);
+	const __m256i p2 = _mm256_unpacklo_epi16(hi01, hi23);
+	const __m256i p3 = _mm256_unpackhi_epi16(hi01, hi23);
+	_mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(p0, p1, 0x20));
+	_mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(p0, p1, 0x31));
+	_mm256_storeu_si256((__m256i *)(dst + 64), _mm256_permute2x128_si256(p2, p3, 0x20));
+	_mm256_storeu_si256((__m256i *)(dst + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+template<typename PixelInt, bool halfChroma, bool itu>
+SCUMMVM_TARGET_AVX2 static int convertPixelsAVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const PixelLayout &layout) {
+	const int vectorWidth = width & ~31;
+
+	for (int x = 0; x < vectorWidth; x += 32) {
+		const __m256i yLo = loadLuma<itu>(ySrc + x);
+		const __m256i yHi = loadLuma<itu>(ySrc + x + 16);
+
+		__m256i rLo, gLo, bLo, rHi, gHi, bHi;
+		if (halfChroma) {
+			// Each chroma value is shared by two pixels
+			__m256i rOffset, gOffset, bOffset;
+			getChromaOffsets<itu>(loadChroma(uSrc + x / 2), loadChroma(vSrc + x / 2), rOffset, gOffset, bOffset);
+			__m256i rOffsetLo, rOffsetHi, gOffsetLo, gOffsetHi, bOffsetLo, bOffsetHi;
+			duplicate(rOffset, rOffsetLo, rOffsetHi);
+			duplicate(gOffset, gOffsetLo, gOffsetHi);
+			duplicate(bOffset, bOffsetLo, bOffsetHi);
+			rLo = getChannel<itu>(yLo, rOffsetLo);
+			gLo = getChannel<itu>(yLo, gOffsetLo);
+			bLo = getChannel<itu>(yLo, bOffsetLo);
+			rHi = getChannel<itu>(yHi, rOffsetHi);
+			gHi = getChannel<itu>(yHi, gOffsetHi);
+			bHi = getChannel<itu>(yHi, bOffsetHi);
+		} else {
+			__m256i rOffset, gOffset, bOffset;
+			getChromaOffsets<itu>(loadChroma(uSrc + x), loadChroma(vSrc + x), rOffset, gOffset, bOffset);
+			rLo = getChannel<itu>(yLo, rOffset);
+			gLo = getChannel<itu>(yLo, gOffset);
+			bLo = getChannel<itu>(yLo, bOffset);
+			getChromaOffsets<itu>(loadChroma(uSrc + x + 16), loadChroma(vSrc + x + 16), rOffset, gOffset, bOffset);
+			rHi = getChannel<itu>(yHi, rOffset);
+			gHi = getChannel<itu>(yHi, gOffset);
+			bHi = getChannel<itu>(yHi, bOffset);
+		}
+
+		if (sizeof(PixelInt) == 2) {
+			_mm256_storeu_si256((__m256i *)(dst + x * 2), makePixels16<itu>(rLo, gLo, bLo, layout));
+			_mm256_storeu_si256((__m256i *)(dst + x * 2 + 32), makePixels16<itu>(rHi, gHi, bHi, layout));
+		} else {
+			// Packing clamps the channels to [0, 255]
+			storePixels32(dst + x * 4, _mm256_packus_epi16(rLo, rHi), _mm256_packus_epi16(gLo, gHi), _mm256_packus_epi16(bLo, bHi), layout);
+		}
+	}
+
+	return vectorWidth;
+}
+
+template<typename PixelInt, bool halfChroma>
+SCUMMVM_TARGET_AVX2 static int convertRowAVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width,
+                                              const PixelFormat &format, YUVToRGBManager::LuminanceScale scale) {
+	PixelLayout layout;
+	if (sizeof(PixelInt) == 2) {
+		layout.rLoss = _mm_cvtsi32_si128(format.rLoss);
+		layout.gLoss = _mm_cvtsi32_si128(format.gLoss);
+		layout.bLoss = _mm_cvtsi32_si128(format.bLoss);
+		layout.rShift = _mm_cvtsi32_si128(format.rShift);
+		layout.gShift = _mm_cvtsi32_si128(format.gShift);
+		layout.bShift = _mm_cvtsi32_si128(format.bShift);
+		layout.alpha = (0xFF >> format.aLoss) << format.aShift;
+	} else if (!getYUVToRGBByteLayout(format, layout.bytes)) {
+		return 0;
+	}
+
+	if (scale == YUVToRGBManager::kScaleITU)
+		return convertPixelsAVX2<PixelInt, halfChroma, true>(dst, ySrc, uSrc, vSrc, width, layout);
+	return convertPixelsAVX2<PixelInt, halfChroma, false>(dst, ySrc, uSrc, vSrc, width, layout);
+}
+
+/** Works like interpolateChroma410SSE2(), on sixteen chroma values at a time. */
+SCUMMVM_TARGET_AVX2 static int interpolateChroma410AVX2(byte *dst, const byte *src, int quarterWidth, int uvPitch, int yDiff) {
+	const int vectorWidth = quarterWidth & ~15;
+	const __m256i topWeight = _mm256_set1_epi16(4 - yDiff);
+	const __m256i bottomWeight = _mm256_set1_epi16(yDiff);
+
+	for (int index = 0; index < vectorWidth; index += 16) {
+		const byte *top = src + index;
+		const byte *bottom = top + uvPitch;
+		const __m256i left = _mm256_add_epi16(_mm256_mullo_epi16(loadChroma(top), topWeight),
+		                                      _mm256_mullo_epi16(loadChroma(bottom), bottomWeight));
+		const __m256i right = _mm256_add_epi16(_mm256_mullo_epi16(loadChroma(top + 1), topWeight),
+		                                       _mm256_mullo_epi16(loadChroma(bottom + 1), bottomWeight));
+
+		const __m256i diff = _mm256_sub_epi16(right, left);
+		const __m256i x0 = _mm256_slli_epi16(left, 2);
+		const __m256i x1 = _mm256_add_epi16(x0, diff);
+		const __m256i x2 = _mm256_add_epi16(x1, diff);
+		const __m256i x3 = _mm256_add_epi16(x2, diff);
+
+		// The unpacks work within the 128 bit lanes, so the halves of the
+		// results hold chroma values 0-3 and 8-11 resp. 4-7 and 12-15
+		const __m256i x01 = _mm256_or_si256(_mm256_srli_epi16(x0, 4), _mm256_slli_epi16(_mm256_srli_epi16(x1, 4), 8));
+		const __m256i x23 = _mm256_or_si256(_mm256_srli_epi16(x2, 4), _mm256_slli_epi16(_mm256_srli_epi16(x3, 4), 8));
+		const __m256i lo = _mm256_unpacklo_epi16(x01, x23);
+		const __m256i hi = _mm256_unpackhi_epi16(x01, x23);
+		_mm256_storeu_si256((__m256i *)(dst + index * 4), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst + index * 4 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+
+	return vectorWidth;
+}
+
+const YUVToRGBKernels g_yuvToRGBKernelsAVX2 = {
+	"avx2",
+	convertRowAVX2<uint16, false>,
+	convertRowAVX2<uint32, false>,
+	convertRowAVX2<uint16, true>,
+	convertRowAVX2<uint32, true>,
+	interpolateChroma410AVX2
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,146 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_INTERN_H
+#define GRAPHICS_YUV_TO_RGB_INTERN_H
+
+#include "common/scummsys.h"
+#include "common/cpudetect.h"
+#include "graphics/pixelformat.h"
+#include "graphics/yuv_to_rgb.h"
+
+namespace Graphics {
+
+/**
+ * Convert the beginning of a row of YUV pixels to RGB.
+ *
+ * @param dst     pointer to the first destination pixel
+ * @param ySrc    pointer to the first luminance value
+ * @param uSrc    pointer to the first u value
+ * @param vSrc    pointer to the first v value
+ * @param width   number of pixels in the row
+ * @param format  the format of the destination pixels
+ * @param scale   the scale of the luminance values
+ * @return the number of pixels converted, which is width rounded down to
+ *         a multiple of the vector size, or 0 if the format is not
+ *         supported. The rest of the row is left to the lookup table
+ *         based conversion.
+ */
+typedef int (*YUVToRGBRowProc)(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width,
+                               const PixelFormat &format, YUVToRGBManager::LuminanceScale scale);
+
+/**
+ * Bilinearly interpolate the beginning of a row of chroma values, which
+ * are subsampled by four in both directions, to the full resolution.
+ *
+ * @param dst           pointer to the first interpolated value
+ * @param src           pointer to the first chroma value of the quads. The
+ *                      value right of each one and the row below are read
+ *                      as well.
+ * @param quarterWidth  number of chroma values to interpolate
+ * @param uvPitch       pitch of the chroma rows
+ * @param yDiff         row of the interpolated values within the quads, 0 to 3
+ * @return the number of chroma values interpolated, which is quarterWidth
+ *         rounded down to a multiple of the vector size. The rest of the
+ *         row is left to the scalar interpolation.
+ */
+typedef int (*YUVToRGBChromaProc)(byte *dst, const byte *src, int quarterWidth, int uvPitch, int yDiff);
+
+/**
+ * SIMD implementations of the YUV to RGB conversion, for the instruction
+ * set extensions supported by the compiler. They compute the colors
+ * arithmetically instead of using lookup tables, but produce output
+ * identical to the lookup table based conversion.
+ */
+struct YUVToRGBKernels {
+	const char *name;
+
+	/** Convert a row with one u and v value per pixel to 16 bit pixels. */
+	YUVToRGBRowProc convertRow444To16;
+
+	/** Convert a row with one u and v value per pixel to 32 bit pixels. */
+	YUVToRGBRowProc convertRow444To32;
+
+	/** Convert a row with one u and v value per two pixels to 16 bit pixels. */
+	YUVToRGBRowProc convertRow420To16;
+
+	/** Convert a row with one u and v value per two pixels to 32 bit pixels. */
+	YUVToRGBRowProc convertRow420To32;
+
+	/** Interpolate the chroma values of a row for convert410(). */
+	YUVToRGBChromaProc interpolateChroma410;
+};
+
+/*
+ * The chroma contributions are the lookup table entries trunc(k * c) for
+ * c = u - 128 resp. v - 128. For all c, they equal the high 16 bits of the
+ * signed product (c << shift) * factor, plus one if c is negative.
+ */
+enum {
+	kYUVCrRFactor = 22960, ///< 0.419 / 0.299, with a shift of 2
+	kYUVCrGFactor = 23383, ///< 0.299 / 0.419, with a shift of 1
+	kYUVCbGFactor = 22571, ///< 0.114 / 0.331, with a shift of 0
+	kYUVCbBFactor = 29056, ///< 0.587 / 0.331, with a shift of 2
+
+	/**
+	 * For the ITU scale, a clamped channel value x from [16, 235] becomes
+	 * (x - 16) * 255 / 219, i.e., the high 16 bits of the unsigned product
+	 * ((x - 16) << 1) * kYUVITUFactor.
+	 */
+	kYUVITUFactor = 38155
+};
+
+/** The channels stored in the bytes of 32 bit pixels by getYUVToRGBByteLayout(). */
+enum YUVToRGBByteChannel {
+	kYUVToRGBByteRed,
+	kYUVToRGBByteGreen,
+	kYUVToRGBByteBlue,
+	kYUVToRGBByteAlpha, ///< always 0xFF
+	kYUVToRGBByteNone   ///< always 0
+};
+
+/**
+ * Get the channel stored in each byte of the 32 bit pixels of a format,
+ * in little endian memory order. The kernels only handle formats with 8
+ * bits per channel; for others, false is returned.
+ */
+bool getYUVToRGBByteLayout(const PixelFormat &format, YUVToRGBByteChannel channels[4]);
+
+#if defined(SCUMMVM_SSE2) && defined(SCUMM_LITTLE_ENDIAN)
+extern const YUVToRGBKernels g_yuvToRGBKernelsSSE2;
+#endif
+#if defined(SCUMMVM_AVX2) && defined(SCUMM_LITTLE_ENDIAN)
+extern const YUVToRGBKernels g_yuvToRGBKernelsAVX2;
+#endif
+#if defined(SCUMMVM_NEON) && defined(SCUMM_LITTLE_ENDIAN)
+extern const YUVToRGBKernels g_yuvToRGBKernelsNEON;
+#endif
+
+/**
+ * Returns the fastest set of kernels supported by the CPU, or 0 if there
+ * is none.
+ */
+const YUVToRGBKernels *getYUVToRGBKernels();
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,232 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#if defined(SCUMMVM_NEON) && defined(SCUMM_LITTLE_ENDIAN)
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+/*
+ * These work like the SSE2 kernels, on sixteen pixels at a time. The
+ * doubling multiply-high instruction returns the high 16 bits of twice
+ * the product, so the chroma values are shifted by one bit less.
+ */
+
+namespace {
+
+/** How to assemble the destination pixels from the channels. */
+struct PixelLayout {
+	// 16 bit pixels, negative shift counts shift to the right
+	int16x8_t rLoss, gLoss, bLoss;
+	int16x8_t rShift, gShift, bShift;
+	uint16 alpha;
+
+	// 32 bit pixels
+	YUVToRGBByteChannel bytes[4];
+};
+
+} // End of anonymous namespace
+
+/** Get the chroma contributions to each channel of eight pixels. */
+template<bool itu>
+static inline void getChromaOffsets(uint8x8_t u, uint8x8_t v, int16x8_t &rOffset, int16x8_t &gOffset, int16x8_t &bOffset) {
+	const int16x8_t cb = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+	const int16x8_t cr = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+	const int16x8_t cbSign = vshrq_n_s16(cb, 15);
+	const int16x8_t crSign = vshrq_n_s16(cr, 15);
+
+	rOffset = vsubq_s16(vqdmulhq_n_s16(vshlq_n_s16(cr, 1), kYUVCrRFactor), crSign);
+	gOffset = vsubq_s16(vaddq_s16(crSign, cbSign),
+	                    vaddq_s16(vqdmulhq_n_s16(cr, kYUVCrGFactor), vshrq_n_s16(vqdmulhq_n_s16(cb, kYUVCbGFactor), 1)));
+	bOffset = vsubq_s16(vqdmulhq_n_s16(vshlq_n_s16(cb, 1), kYUVCbBFactor), cbSign);
+
+	if (itu) {
+		rOffset = vaddq_s16(rOffset, rOffset);
+		gOffset = vaddq_s16(gOffset, gOffset);
+		bOffset = vaddq_s16(bOffset, bOffset);
+	}
+}
+
+/** Widen eight luminance values, and prepare them for the ITU scale. */
+template<bool itu>
+static inline int16x8_t getLuma(uint8x8_t y) {
+	if (!itu)
+		return vreinterpretq_s16_u16(vmovl_u8(y));
+	return vsubq_s16(vreinterpretq_s16_u16(vshll_n_u8(y, 1)), vdupq_n_s16(32));
+}
+
+/**
+ * Add up the luminance and chroma contributions of a channel. With the
+ * full scale, the result still has to be clamped to [0, 255].
+ */
+template<bool itu>
+static inline int16x8_t getChannel(int16x8_t y, int16x8_t offset) {
+	const int16x8_t c = vaddq_s16(y, offset);
+	if (!itu)
+		return c;
+	const uint16x8_t clamped = vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(c, vdupq_n_s16(0)), vdupq_n_s16(2 * 219)));
+	const uint32x4_t lo = vmull_n_u16(vget_low_u16(clamped), kYUVITUFactor);
+	const uint32x4_t hi = vmull_n_u16(vget_high_u16(clamped), kYUVITUFactor);
+	return vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)));
+}
+
+/** Assemble eight 16 bit pixels. */
+template<bool itu>
+static inline uint16x8_t makePixels16(int16x8_t r, int16x8_t g, int16x8_t b, const PixelLayout &layout) {
+	if (!itu) {
+		const int16x8_t zero = vdupq_n_s16(0);
+		const int16x8_t max = vdupq_n_s16(255);
+		r = vminq_s16(vmaxq_s16(r, zero), max);
+		g = vminq_s16(vmaxq_s16(g, zero), max);
+		b = vminq_s16(vmaxq_s16(b, zero), max);
+	}
+
+	uint16x8_t pixels = vdupq_n_u16(layout.alpha);
+	pixels = vorrq_u16(pixels, vshlq_u16(vshlq_u16(vreinterpretq_u16_s16(r), layout.rLoss), layout.rShift));
+	pixels = vorrq_u16(pixels, vshlq_u16(vshlq_u16(vreinterpretq_u16_s16(g), layout.gLoss), layout.gShift));
+	pixels = vorrq_u16(pixels, vshlq_u16(vshlq_u16(vreinterpretq_u16_s16(b), layout.bLoss), layout.bShift));
+	return pixels;
+}
+
+/** Assemble eight 32 bit pixels from their channels and store them. */
+static inline void storePixels32(byte *dst, int16x8_t r, int16x8_t g, int16x8_t b, const PixelLayout &layout) {
+	// Narrowing clamps the channels to [0, 255]
+	const uint8x8_t channels[] = { vqmovun_s16(r), vqmovun_s16(g), vqmovun_s16(b), vdup_n_u8(0xFF), vdup_n_u8(0) };
+	uint8x8x4_t pixels;
+	pixels.val[0] = channels[layout.bytes[0]];
+	pixels.val[1] = channels[layout.bytes[1]];
+	pixels.val[2] = channels[layout.bytes[2]];
+	pixels.val[3] = channels[layout.bytes[3]];
+	vst4_u8(dst, pixels);
+}
+
+/** Convert eight pixels and store them. */
+template<typename PixelInt, bool itu>
+static inline void storePixels(byte *dst, int16x8_t y, int16x8_t rOffset, int16x8_t gOffset, int16x8_t bOffset, const PixelLayout &layout) {
+	const int16x8_t r = getChannel<itu>(y, rOffset);
+	const int16x8_t g = getChannel<itu>(y, gOffset);
+	const int16x8_t b = getChannel<itu>(y, bOffset);
+
+	if (sizeof(PixelInt) == 2)
+		vst1q_u16((uint16 *)dst, makePixels16<itu>(r, g, b, layout));
+	else
+		storePixels32(dst, r, g, b, layout);
+}
+
+template<typename PixelInt, bool halfChroma, bool itu>
+static int convertPixelsNEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const PixelLayout &layout) {
+	const int vectorWidth = width & ~15;
+
+	for (int x = 0; x < vectorWidth; x += 16) {
+		const uint8x16_t y = vld1q_u8(ySrc + x);
+		const int16x8_t yLo = getLuma<itu>(vget_low_u8(y));
+		const int16x8_t yHi = getLuma<itu>(vget_high_u8(y));
+		byte *out = dst + x * sizeof(PixelInt);
+		int16x8_t rOffset, gOffset, bOffset;
+
+		if (halfChroma) {
+			// Each chroma value is shared by two pixels
+			getChromaOffsets<itu>(vld1_u8(uSrc + x / 2), vld1_u8(vSrc + x / 2), rOffset, gOffset, bOffset);
+			const int16x8x2_t r = vzipq_s16(rOffset, rOffset);
+			const int16x8x2_t g = vzipq_s16(gOffset, gOffset);
+			const int16x8x2_t b = vzipq_s16(bOffset, bOffset);
+			storePixels<PixelInt, itu>(out, yLo, r.val[0], g.val[0], b.val[0], layout);
+			storePixels<PixelInt, itu>(out + 8 * sizeof(PixelInt), yHi, r.val[1], g.val[1], b.val[1], layout);
+		} else {
+			const uint8x16_t u = vld1q_u8(uSrc + x);
+			const uint8x16_t v = vld1q_u8(vSrc + x);
+			getChromaOffsets<itu>(vget_low_u8(u), vget_low_u8(v), rOffset, gOffset, bOffset);
+			storePixels<PixelInt, itu>(out, yLo, rOffset, gOffset, bOffset, layout);
+			getChromaOffsets<itu>(vget_high_u8(u), vget_high_u8(v), rOffset, gOffset, bOffset);
+			storePixels<PixelInt, itu>(out + 8 * sizeof(PixelInt), yHi, rOffset, gOffset, bOffset, layout);
+		}
+	}
+
+	return vectorWidth;
+}
+
+template<typename PixelInt, bool halfChroma>
+static int convertRowNEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width,
+                          const PixelFormat &format, YUVToRGBManager::LuminanceScale scale) {
+	PixelLayout layout;
+	if (sizeof(PixelInt) == 2) {
+		layout.rLoss = vdupq_n_s16(-format.rLoss);
+		layout.gLoss = vdupq_n_s16(-format.gLoss);
+		layout.bLoss = vdupq_n_s16(-format.bLoss);
+		layout.rShift = vdupq_n_s16(format.rShift);
+		layout.gShift = vdupq_n_s16(format.gShift);
+		layout.bShift = vdupq_n_s16(format.bShift);
+		layout.alpha = (0xFF >> format.aLoss) << format.aShift;
+	} else if (!getYUVToRGBByteLayout(format, layout.bytes)) {
+		return 0;
+	}
+
+	if (scale == YUVToRGBManager::kScaleITU)
+		return convertPixelsNEON<PixelInt, halfChroma, true>(dst, ySrc, uSrc, vSrc, width, layout);
+	return convertPixelsNEON<PixelInt, halfChroma, false>(dst, ySrc, uSrc, vSrc, width, layout);
+}
+
+/** Works like interpolateChroma410SSE2(), on eight chroma values at a time. */
+static int interpolateChroma410NEON(byte *dst, const byte *src, int quarterWidth, int uvPitch, int yDiff) {
+	const int vectorWidth = quarterWidth & ~7;
+	const uint16x8_t topWeight = vdupq_n_u16(4 - yDiff);
+	const uint16x8_t bottomWeight = vdupq_n_u16(yDiff);
+
+	for (int index = 0; index < vectorWidth; index += 8) {
+		const byte *top = src + index;
+		const byte *bottom = top + uvPitch;
+		const uint16x8_t left = vmlaq_u16(vmulq_u16(vmovl_u8(vld1_u8(top)), topWeight), vmovl_u8(vld1_u8(bottom)), bottomWeight);
+		const uint16x8_t right = vmlaq_u16(vmulq_u16(vmovl_u8(vld1_u8(top + 1)), topWeight), vmovl_u8(vld1_u8(bottom + 1)), bottomWeight);
+
+		const uint16x8_t diff = vsubq_u16(right, left);
+		const uint16x8_t x0 = vshlq_n_u16(left, 2);
+		const uint16x8_t x1 = vaddq_u16(x0, diff);
+		const uint16x8_t x2 = vaddq_u16(x1, diff);
+		const uint16x8_t x3 = vaddq_u16(x2, diff);
+
+		// The interleaving store puts the four values of each chroma value next to each other
+		uint8x8x4_t values;
+		values.val[0] = vshrn_n_u16(x0, 4);
+		values.val[1] = vshrn_n_u16(x1, 4);
+		values.val[2] = vshrn_n_u16(x2, 4);
+		values.val[3] = vshrn_n_u16(x3, 4);
+		vst4_u8(dst + index * 4, values);
+	}
+
+	return vectorWidth;
+}
+
+const YUVToRGBKernels g_yuvToRGBKernelsNEON = {
+	"neon",
+	convertRowNEON<uint16, false>,
+	convertRowNEON<uint32, false>,
+	convertRowNEON<uint16, true>,
+	convertRowNEON<uint32, true>,
+	interpolateChroma410NEON
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,252 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#if defined(SCUMMVM_SSE2) && defined(SCUMM_LITTLE_ENDIAN)
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+/*
+ * Sixteen pixels are converted at a time, with the Y, U and V values and
+ * the resulting channels widened to signed 16 bits. For the ITU scale,
+ * the channels are computed at twice their value, offset by -32, so that
+ * mapping them to [0, 255] takes a single multiplication.
+ */
+
+namespace {
+
+/** How to assemble the destination pixels from the channels. */
+struct PixelLayout {
+	// 16 bit pixels
+	__m128i rLoss, gLoss, bLoss;
+	__m128i rShift, gShift, bShift;
+	uint16 alpha;
+
+	// 32 bit pixels
+	YUVToRGBByteChannel bytes[4];
+};
+
+} // End of anonymous namespace
+
+/** Get the chroma contributions to each channel of eight pixels. */
+template<bool itu>
+SCUMMVM_TARGET_SSE2 static inline void getChromaOffsets(__m128i u, __m128i v, __m128i &rOffset, __m128i &gOffset, __m128i &bOffset) {
+	const __m128i cb = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	const __m128i cr = _mm_sub_epi16(v, _mm_set1_epi16(128));
+	// Subtracting the sign masks rounds the products of negative values towards zero
+	const __m128i cbSign = _mm_srai_epi16(cb, 15);
+	const __m128i crSign = _mm_srai_epi16(cr, 15);
+
+	rOffset = _mm_sub_epi16(_mm_mulhi_epi16(_mm_slli_epi16(cr, 2), _mm_set1_epi16(kYUVCrRFactor)), crSign);
+	gOffset = _mm_sub_epi16(_mm_add_epi16(crSign, cbSign),
+	                        _mm_add_epi16(_mm_mulhi_epi16(_mm_add_epi16(cr, cr), _mm_set1_epi16(kYUVCrGFactor)),
+	                                      _mm_mulhi_epi16(cb, _mm_set1_epi16(kYUVCbGFactor))));
+	bOffset = _mm_sub_epi16(_mm_mulhi_epi16(_mm_slli_epi16(cb, 2), _mm_set1_epi16(kYUVCbBFactor)), cbSign);
+
+	if (itu) {
+		rOffset = _mm_add_epi16(rOffset, rOffset);
+		gOffset = _mm_add_epi16(gOffset, gOffset);
+		bOffset = _mm_add_epi16(bOffset, bOffset);
+	}
+}
+
+/** Widen eight luminance values, and prepare them for the ITU scale. */
+template<bool itu>
+SCUMMVM_TARGET_SSE2 static inline __m128i getLuma(__m128i y) {
+	if (!itu)
+		return y;
+	return _mm_sub_epi16(_mm_add_epi16(y, y), _mm_set1_epi16(32));
+}
+
+/**
+ * Add up the luminance and chroma contributions of a channel. With the
+ * full scale, the result still has to be clamped to [0, 255].
+ */
+template<bool itu>
+SCUMMVM_TARGET_SSE2 static inline __m128i getChannel(__m128i y, __m128i offset) {
+	const __m128i c = _mm_add_epi16(y, offset);
+	if (!itu)
+		return c;
+	const __m128i clamped = _mm_min_epi16(_mm_max_epi16(c, _mm_setzero_si128()), _mm_set1_epi16(2 * 219));
+	return _mm_mulhi_epu16(clamped, _mm_set1_epi16((int16)kYUVITUFactor));
+}
+
+/** Assemble eight 16 bit pixels. */
+template<bool itu>
+SCUMMVM_TARGET_SSE2 static inline __m128i makePixels16(__m128i r, __m128i g, __m128i b, const PixelLayout &layout) {
+	if (!itu) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i max = _mm_set1_epi16(255);
+		r = _mm_min_epi16(_mm_max_epi16(r, zero), max);
+		g = _mm_min_epi16(_mm_max_epi16(g, zero), max);
+		b = _mm_min_epi16(_mm_max_epi16(b, zero), max);
+	}
+
+	__m128i pixels = _mm_set1_epi16(layout.alpha);
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(r, layout.rLoss), layout.rShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(g, layout.gLoss), layout.gShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(b, layout.bLoss), layout.bShift));
+	return pixels;
+}
+
+/** Assemble sixteen 32 bit pixels from their channels and store them. */
+SCUMMVM_TARGET_SSE2 static inline void storePixels32(byte *dst, __m128i r, __m128i g, __m128i b, const PixelLayout &layout) {
+	const __m128i channels[] = { r, g, b, _mm_set1_epi8((char)0xFF), _mm_setzero_si128() };
+	const __m128i c0 = channels[layout.bytes[0]];
+	const __m128i c1 = channels[layout.bytes[1]];
+	const __m128i c2 = channels[layout.bytes[2]];
+	const __m128i c3 = channels[layout.bytes[3]];
+
+	const __m128i lo01 = _mm_unpacklo_epi8(c0, c1);
+	const __m128i lo23 = _mm_unpacklo_epi8(c2, c3);
+	const __m128i hi01 = _mm_unpackhi_epi8(c0, c1);
+	const __m128i hi23 = _mm_unpackhi_epi8(c2, c3);
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(lo01, lo23));
+	_mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(lo01, lo23));
+	_mm_storeu_si128((__m128i *)(dst + 32), _mm_unpacklo_epi16(hi01, hi23));
+	_mm_storeu_si128((__m128i *)(dst + 48), _mm_unpackhi_epi16(hi01, hi23));
+}
+
+template<typename PixelInt, bool halfChroma, bool itu>
+SCUMMVM_TARGET_SSE2 static int convertPixelsSSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const PixelLayout &layout) {
+	const int vectorWidth = width & ~15;
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int x = 0; x < vectorWidth; x += 16) {
+		const __m128i y = _mm_loadu_si128((const __m128i *)(ySrc + x));
+		const __m128i yLo = getLuma<itu>(_mm_unpacklo_epi8(y, zero));
+		const __m128i yHi = getLuma<itu>(_mm_unpackhi_epi8(y, zero));
+
+		__m128i rLo, gLo, bLo, rHi, gHi, bHi;
+		if (halfChroma) {
+			// Each chroma value is shared by two pixels
+			const __m128i u = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(uSrc + x / 2)), zero);
+			const __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(vSrc + x / 2)), zero);
+			__m128i rOffset, gOffset, bOffset;
+			getChromaOffsets<itu>(u, v, rOffset, gOffset, bOffset);
+			rLo = getChannel<itu>(yLo, _mm_unpacklo_epi16(rOffset, rOffset));
+			gLo = getChannel<itu>(yLo, _mm_unpacklo_epi16(gOffset, gOffset));
+			bLo = getChannel<itu>(yLo, _mm_unpacklo_epi16(bOffset, bOffset));
+			rHi = getChannel<itu>(yHi, _mm_unpackhi_epi16(rOffset, rOffset));
+			gHi = getChannel<itu>(yHi, _mm_unpackhi_epi16(gOffset, gOffset));
+			bHi = getChannel<itu>(yHi, _mm_unpackhi_epi16(bOffset, bOffset));
+		} else {
+			const __m128i u = _mm_loadu_si128((const __m128i *)(uSrc + x));
+			const __m128i v = _mm_loadu_si128((const __m128i *)(vSrc + x));
+			__m128i rOffset, gOffset, bOffset;
+			getChromaOffsets<itu>(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(v, zero), rOffset, gOffset, bOffset);
+			rLo = getChannel<itu>(yLo, rOffset);
+			gLo = getChannel<itu>(yLo, gOffset);
+			bLo = getChannel<itu>(yLo, bOffset);
+			getChromaOffsets<itu>(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(v, zero), rOffset, gOffset, bOffset);
+			rHi = getChannel<itu>(yHi, rOffset);
+			gHi = getChannel<itu>(yHi, gOffset);
+			bHi = getChannel<itu>(yHi, bOffset);
+		}
+
+		if (sizeof(PixelInt) == 2) {
+			_mm_storeu_si128((__m128i *)(dst + x * 2), makePixels16<itu>(rLo, gLo, bLo, layout));
+			_mm_storeu_si128((__m128i *)(dst + x * 2 + 16), makePixels16<itu>(rHi, gHi, bHi, layout));
+		} else {
+			// Packing clamps the channels to [0, 255]
+			storePixels32(dst + x * 4, _mm_packus_epi16(rLo, rHi), _mm_packus_epi16(gLo, gHi), _mm_packus_epi16(bLo, bHi), layout);
+		}
+	}
+
+	return vectorWidth;
+}
+
+template<typename PixelInt, bool halfChroma>
+SCUMMVM_TARGET_SSE2 static int convertRowSSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width,
+                                              const PixelFormat &format, YUVToRGBManager::LuminanceScale scale) {
+	PixelLayout layout;
+	if (sizeof(PixelInt) == 2) {
+		layout.rLoss = _mm_cvtsi32_si128(format.rLoss);
+		layout.gLoss = _mm_cvtsi32_si128(format.gLoss);
+		layout.bLoss = _mm_cvtsi32_si128(format.bLoss);
+		layout.rShift = _mm_cvtsi32_si128(format.rShift);
+		layout.gShift = _mm_cvtsi32_si128(format.gShift);
+		layout.bShift = _mm_cvtsi32_si128(format.bShift);
+		layout.alpha = (0xFF >> format.aLoss) << format.aShift;
+	} else if (!getYUVToRGBByteLayout(format, layout.bytes)) {
+		return 0;
+	}
+
+	if (scale == YUVToRGBManager::kScaleITU)
+		return convertPixelsSSE2<PixelInt, halfChroma, true>(dst, ySrc, uSrc, vSrc, width, layout);
+	return convertPixelsSSE2<PixelInt, halfChroma, false>(dst, ySrc, uSrc, vSrc, width, layout);
+}
+
+/*
+ * The bilinear interpolation is separable: each value is
+ * (left * (4 - xDiff) + right * xDiff) >> 4, where left and right are the
+ * vertically interpolated columns, e.g. left = A * (4 - yDiff) + C * yDiff.
+ */
+SCUMMVM_TARGET_SSE2 static int interpolateChroma410SSE2(byte *dst, const byte *src, int quarterWidth, int uvPitch, int yDiff) {
+	// Eight chroma values are interpolated to 32 at a time. Their right
+	// neighbors are loaded from one further, so the last vector reads up to
+	// src[quarterWidth], like the scalar interpolation does.
+	const int vectorWidth = quarterWidth & ~7;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i topWeight = _mm_set1_epi16(4 - yDiff);
+	const __m128i bottomWeight = _mm_set1_epi16(yDiff);
+
+	for (int index = 0; index < vectorWidth; index += 8) {
+		const byte *top = src + index;
+		const byte *bottom = top + uvPitch;
+		const __m128i left = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)top), zero), topWeight),
+		                                   _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)bottom), zero), bottomWeight));
+		const __m128i right = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(top + 1)), zero), topWeight),
+		                                    _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(bottom + 1)), zero), bottomWeight));
+
+		// left * (4 - xDiff) + right * xDiff for xDiff = 0 to 3
+		const __m128i diff = _mm_sub_epi16(right, left);
+		const __m128i x0 = _mm_slli_epi16(left, 2);
+		const __m128i x1 = _mm_add_epi16(x0, diff);
+		const __m128i x2 = _mm_add_epi16(x1, diff);
+		const __m128i x3 = _mm_add_epi16(x2, diff);
+
+		// Interleave the four values of each chroma value into 32 bits
+		const __m128i x01 = _mm_or_si128(_mm_srli_epi16(x0, 4), _mm_slli_epi16(_mm_srli_epi16(x1, 4), 8));
+		const __m128i x23 = _mm_or_si128(_mm_srli_epi16(x2, 4), _mm_slli_epi16(_mm_srli_epi16(x3, 4), 8));
+		_mm_storeu_si128((__m128i *)(dst + index * 4), _mm_unpacklo_epi16(x01, x23));
+		_mm_storeu_si128((__m128i *)(dst + index * 4 + 16), _mm_unpackhi_epi16(x01, x23));
+	}
+
+	return vectorWidth;
+}
+
+const YUVToRGBKernels g_yuvToRGBKernelsSSE2 = {
+	"sse2",
+	convertRowSSE2<uint16, false>,
+	convertRowSSE2<uint32, false>,
+	convertRowSSE2<uint16, true>,
+	convertRowSSE2<uint32, true>,
+	interpolateChroma410SSE2
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -24,6 +24,7 @@
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/ptr.h"
 #include "common/unzip.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
@@ -1571,17 +1572,18 @@ bool ThemeEngine::themeConfigParseHeader(Common::String header, Common::String &
 }
 
 bool ThemeEngine::themeConfigUsable(const Common::ArchiveMember &member, Common::String &themeName) {
+	// The archive is declared first, so that it outlives the stream
+	// reading from it.
+	Common::ScopedPtr<Common::Archive> zipArchive;
 	Common::File stream;
 	bool foundHeader = false;
 
 	if (member.getName().matchString("*.zip", true)) {
-		Common::Archive *zipArchive = Common::makeZipArchive(member.createReadStream());
+		zipArchive.reset(Common::makeZipArchive(member.createReadStream()));
 
 		if (zipArchive && zipArchive->hasFile("THEMERC")) {
 			stream.open("THEMERC", *zipArchive);
 		}
-
-		delete zipArchive;
 	}
 
 	if (stream.isOpen()) {
@@ -1593,22 +1595,18 @@ bool ThemeEngine::themeConfigUsable(const Common::ArchiveMember &member, Common:
 }
 
 bool ThemeEngine::themeConfigUsable(const Common::FSNode &node, Common::String &themeName) {
+	// The archive is declared first, so that it outlives the stream
+	// reading from it.
+	Common::ScopedPtr<Common::Archive> zipArchive;
 	Common::File stream;
 	bool foundHeader = false;
 
 	if (node.getName().matchString("*.zip", true) && !node.isDirectory()) {
-		Common::Archive *zipArchive = Common::makeZipArchive(node);
+		zipArchive.reset(Common::makeZipArchive(node));
 		if (zipArchive && zipArchive->hasFile("THEMERC")) {
 			// Open THEMERC from the ZIP file.
 			stream.open("THEMERC", *zipArchive);
 		}
-		// Delete the ZIP archive again. Note: This only works because
-		// stream.open() only uses ZipArchive::createReadStreamForMember,
-		// and that in turn happens to read all the data for a given
-		// archive member into a memory block. So there will be no dangling
-		// reference to zipArchive anywhere. This could change if we
-		// ever modify ZipArchive::createReadStreamForMember.
-		delete zipArchive;
 	} else if (node.isDirectory()) {
 		Common::FSNode headerfile = node.getChild("THEMERC");
 		if (!headerfile.exists() || !headerfile.isReadable() || headerfile.isDirectory())
@@ -59,10 +59,11 @@ bool ThemeEval::getWidgetData(const Common::String &widget, int16 &x, int16 &y,
 	Common::String dialogName = "Dialog." + tokenizer.nextToken();
 	Common::String widgetName = tokenizer.nextToken();
 
-	if (!_layouts.contains(dialogName))
+	ThemeLayout *layout = findLayout(dialogName);
+	if (!layout)
 		return false;
 
-	return _layouts[dialogName]->getWidgetData(widgetName, x, y, w, h);
+	return layout->getWidgetData(widgetName, x, y, w, h);
 }
 
 Graphics::TextAlign ThemeEval::getWidgetTextHAlign(const Common::String &widget) {
@@ -74,10 +75,11 @@ Graphics::TextAlign ThemeEval::getWidgetTextHAlign(const Common::String &widget)
 	Common::String dialogName = "Dialog." + tokenizer.nextToken();
 	Common::String widgetName = tokenizer.nextToken();
 
-	if (!_layouts.contains(dialogName))
+	ThemeLayout *layout = findLayout(dialogName);
+	if (!layout)
 		return Graphics::kTextAlignInvalid;
 
-	return _layouts[dialogName]->getWidgetTextHAlign(widgetName);
+	return layout->getWidgetTextHAlign(widgetName);
 }
 
 void ThemeEval::addWidget(const Common::String &name, int w, int h, const Common::String &type, bool enabled, Graphics::TextAlign align) {
@@ -161,11 +163,37 @@ void ThemeEval::addSpace(int size) {
 }
 
 bool ThemeEval::addImportedLayout(const Common::String &name) {
-	if (!_layouts.contains(name))
+	ThemeLayout *layout = findLayout(name);
+	if (!layout)
 		return false;
 
-	_curLayout.top()->importLayout(_layouts[name]);
+	_curLayout.top()->importLayout(layout);
 	return true;
 }
 
+const int *ThemeEval::findVar(const Common::String &name) const {
+	Common::Atom atom;
+	if (!Common::Atom::find(name, atom))
+		return 0;
+
+	VariablesMap::const_iterator i = _vars.find(atom);
+	if (i != _vars.end())
+		return &i->_value;
+
+	i = _builtin.find(atom);
+	if (i != _builtin.end())
+		return &i->_value;
+
+	return 0;
+}
+
+ThemeLayout *ThemeEval::findLayout(const Common::String &name) const {
+	Common::Atom atom;
+	if (!Common::Atom::find(name, atom))
+		return 0;
+
+	LayoutsMap::const_iterator i = _layouts.find(atom);
+	return (i != _layouts.end()) ? i->_value : 0;
+}
+
 } // End of namespace GUI
@@ -24,6 +24,7 @@
 #define GUI_THEME_EVAL_H
 
 #include "common/scummsys.h"
+#include "common/atom.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
 #include "common/stack.h"
@@ -37,8 +38,10 @@ namespace GUI {
 
 class ThemeEval {
 
-	typedef Common::HashMap<Common::String, int> VariablesMap;
-	typedef Common::HashMap<Common::String, ThemeLayout *> LayoutsMap;
+	// Variables and layouts are looked up by name whenever dialogs get
+	// reflowed, so they are keyed by atoms instead of strings.
+	typedef Common::HashMap<Common::Atom, int> VariablesMap;
+	typedef Common::HashMap<Common::Atom, ThemeLayout *> LayoutsMap;
 
 public:
 	ThemeEval() {
@@ -49,30 +52,26 @@ public:
 
 	void buildBuiltinVars();
 
-	int getVar(const Common::String &s) {
-		if (_vars.contains(s))
-			return _vars[s];
+	// Lookups do not intern the names, since names which were never
+	// interned can not be variables.
 
-		if (_builtin.contains(s))
-			return _builtin[s];
+	int getVar(const Common::String &s) {
+		const int *val = findVar(s);
+		if (val)
+			return *val;
 
 		error("CRITICAL: Missing variable: '%s'", s.c_str());
 		return -13375; //EVAL_UNDEF_VAR
 	}
 
 	int getVar(const Common::String &s, int def) {
-		if (_vars.contains(s))
-			return _vars[s];
-
-		if (_builtin.contains(s))
-			return _builtin[s];
-
-		return def;
+		const int *val = findVar(s);
+		return val ? *val : def;
 	}
 
-	void setVar(const Common::String &name, int val) { _vars[name] = val; }
+	void setVar(const Common::Atom &name, int val) { _vars[name] = val; }
 
-	bool hasVar(const Common::String &name) { return _vars.contains(name) || _builtin.contains(name); }
+	bool hasVar(const Common::String &name) { return findVar(name) != 0; }
 
 	void addDialog(const Common::String &name, const Common::String &overlays, bool enabled = true, int inset = 0);
 	void addLayout(ThemeLayout::LayoutType type, int spacing, bool center = false);
@@ -98,6 +97,9 @@ public:
 	void reset();
 
 private:
+	const int *findVar(const Common::String &name) const;
+	ThemeLayout *findLayout(const Common::String &name) const;
+
 	VariablesMap _vars;
 	VariablesMap _builtin;
 
@@ -20,6 +20,7 @@
  *
  */
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 #include "common/algorithm.h"
 #include "common/config-manager.h"
@@ -117,6 +118,13 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 		if (!path.empty())
 			_pathToTargets[path].push_back(iter->_key);
 	}
+
+	// Write the detection cache once at the end instead of after each directory
+	DetectionCache::instance().suspendFlush();
+}
+
+MassAddDialog::~MassAddDialog() {
+	DetectionCache::instance().resumeFlush();
 }
 
 struct GameTargetLess {
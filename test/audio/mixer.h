@@ -0,0 +1,273 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+#include "common/atomic.h"
+#include "common/system.h"
+#include "common/workerpool.h"
+#include "graphics/pixelformat.h"
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kRate = 22050,
+		kNumChannels = 8,
+		kNumRounds = 2000,
+		kNumFrames = 256,
+		// More than fit in the command queue of the mixer
+		kNumCommands = 2000,
+		kNumBatches = 128
+	};
+
+	/**
+	 * Just enough of a system for the mixer, which needs mutexes and waits
+	 * for callbacks in progress. The mixer mutex is only locked by the
+	 * thread sending commands, the callback never locks it in lock-free
+	 * mode, so the mutexes do nothing.
+	 */
+	class TestSystem : public OSystem {
+	public:
+		const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+		int getDefaultGraphicsMode() const { return 0; }
+		bool setGraphicsMode(int mode) { return false; }
+		int getGraphicsMode() const { return 0; }
+#ifdef USE_RGB_COLOR
+		Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+		Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+#endif
+		void initSize(uint width, uint height, const Graphics::PixelFormat *format) {}
+		int16 getHeight() { return 0; }
+		int16 getWidth() { return 0; }
+		PaletteManager *getPaletteManager() { return 0; }
+		void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+		Graphics::Surface *lockScreen() { return 0; }
+		void unlockScreen() {}
+		void fillScreen(uint32 col) {}
+		void updateScreen() {}
+		void setShakePos(int shakeOffset) {}
+		void showOverlay() {}
+		void hideOverlay() {}
+		Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+		void clearOverlay() {}
+		void grabOverlay(void *buf, int pitch) {}
+		void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+		int16 getOverlayHeight() { return 0; }
+		int16 getOverlayWidth() { return 0; }
+		bool showMouse(bool visible) { return false; }
+		void warpMouse(int x, int y) {}
+		void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale, const Graphics::PixelFormat *format) {}
+
+		uint32 getMillis(bool skipRecord) { return 0; }
+		// Only used to wait for a callback in progress, which is short
+		void delayMillis(uint msecs) {}
+		void getTimeAndDate(TimeDate &t) const { memset(&t, 0, sizeof(t)); }
+
+		MutexRef createMutex() { return 0; }
+		void lockMutex(MutexRef mutex) {}
+		void unlockMutex(MutexRef mutex) {}
+		void deleteMutex(MutexRef mutex) {}
+
+		Audio::Mixer *getMixer() { return 0; }
+		void quit() {}
+		void displayMessageOnOSD(const char *msg) {}
+		void logMessage(LogMessageType::Type type, const char *message) {}
+	};
+
+	/** Endless mono stream of a constant sample value */
+	class ConstantStream : public Audio::AudioStream {
+	public:
+		ConstantStream(int16 value) : _value(value) {}
+
+		int readBuffer(int16 *buffer, const int numSamples) {
+			for (int i = 0; i < numSamples; ++i)
+				buffer[i] = _value;
+			return numSamples;
+		}
+
+		bool isStereo() const { return false; }
+		int getRate() const { return kRate; }
+		bool endOfData() const { return false; }
+
+	private:
+		const int16 _value;
+	};
+
+	struct ChannelState {
+		bool playing;
+		bool paused;
+		byte volume;
+	};
+
+	struct Commands {
+		Audio::MixerImpl *mixer;
+		bool concurrent;
+		ChannelState state[kNumChannels];
+		volatile uint32 callbacks;
+		volatile uint32 done;
+	};
+
+	TestSystem *_system;
+	OSystem *_oldSystem;
+
+	static Audio::MixerImpl *createMixer() {
+		Audio::MixerImpl *mixer = new Audio::MixerImpl(g_system, kRate);
+		mixer->setLockFree(true);
+		mixer->setReady(true);
+		return mixer;
+	}
+
+	static void play(Audio::Mixer *mixer, Audio::SoundHandle *handle, int channel, byte volume) {
+		mixer->playStream(Audio::Mixer::kPlainSoundType, handle, new ConstantStream(1000 * (channel + 1)), -1, volume);
+	}
+
+	// Get the output of a mixer whose channels have been set up in the
+	// given state from scratch, without any concurrent callbacks
+	static void mixState(int16 *samples, const ChannelState *state) {
+		Audio::MixerImpl *mixer = createMixer();
+		for (int i = 0; i < kNumChannels; ++i) {
+			if (!state[i].playing)
+				continue;
+
+			Audio::SoundHandle handle;
+			play(mixer, &handle, i, state[i].volume);
+			if (state[i].paused)
+				mixer->pauseHandle(handle, true);
+		}
+		mixer->mixCallback((byte *)samples, kNumFrames * 2 * sizeof(int16));
+		delete mixer;
+	}
+
+	// Sends play, volume, pause and stop commands for all channels,
+	// recording the state they end up in
+	static void sendCommands(Commands &commands) {
+		Audio::SoundHandle handles[kNumChannels];
+		for (int i = 0; i < kNumChannels; ++i)
+			commands.state[i].playing = false;
+
+		for (int round = 0; round < kNumRounds; ++round) {
+			for (int i = 0; i < kNumChannels; ++i) {
+				ChannelState &state = commands.state[i];
+				const byte volume = (round * 7 + i * 13) % 64;
+
+				if (!state.playing) {
+					play(commands.mixer, &handles[i], i, volume / 2);
+					state.playing = true;
+					state.paused = false;
+				}
+
+				commands.mixer->setChannelVolume(handles[i], volume);
+				state.volume = volume;
+
+				if ((round + i) % 3 == 0) {
+					state.paused = !state.paused;
+					commands.mixer->pauseHandle(handles[i], state.paused);
+				}
+
+				if ((round + i) % 5 == 0) {
+					commands.mixer->stopHandle(handles[i]);
+					state.playing = false;
+				}
+			}
+		}
+	}
+
+	static void commandsJob(void *refCon, uint index) {
+		Commands &commands = *(Commands *)refCon;
+
+		if (index == 0) {
+			// Make sure the callback is running meanwhile. Without threads,
+			// the jobs run one after the other, the commands first.
+			while (commands.concurrent && !Common::atomicLoad(commands.callbacks))
+				;
+			sendCommands(commands);
+			Common::atomicStore(commands.done, 1);
+		} else {
+			int16 samples[kNumFrames * 2];
+			do {
+				commands.mixer->mixCallback((byte *)samples, sizeof(samples));
+				Common::atomicAdd(commands.callbacks, 1);
+			} while (!Common::atomicLoad(commands.done));
+		}
+	}
+
+public:
+	void setUp() {
+		_oldSystem = g_system;
+		_system = new TestSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = _oldSystem;
+		delete _system;
+	}
+
+	void test_concurrent_commands() {
+		Common::WorkerPool pool(2);
+
+		Commands commands;
+		commands.mixer = createMixer();
+		commands.concurrent = pool.getNumThreads() > 1;
+		commands.callbacks = 0;
+		commands.done = 0;
+		pool.run(commandsJob, &commands, 2);
+
+		// The commands which have not been processed by the callback yet
+		// are processed now, so the output reflects the last state of all
+		// channels
+		int16 samples[kNumFrames * 2];
+		int16 expected[kNumFrames * 2];
+		commands.mixer->mixCallback((byte *)samples, sizeof(samples));
+		mixState(expected, commands.state);
+		TS_ASSERT_EQUALS(memcmp(samples, expected, sizeof(samples)), 0);
+
+		// The final state mixes some channels, but not all of them
+		int playing = 0;
+		for (int i = 0; i < kNumChannels; ++i)
+			playing += (commands.state[i].playing && !commands.state[i].paused) ? 1 : 0;
+		TS_ASSERT_LESS_THAN(0, playing);
+		TS_ASSERT_LESS_THAN(playing, (int)kNumChannels);
+
+		delete commands.mixer;
+	}
+
+	void test_full_queue() {
+		// Without callbacks, the command queue fills up and is drained
+		// when sending commands. None of them may get lost.
+		Audio::MixerImpl *mixer = createMixer();
+
+		Audio::SoundHandle handles[2];
+		play(mixer, &handles[0], 0, 0);
+		play(mixer, &handles[1], 1, 0);
+
+		ChannelState state[kNumChannels];
+		for (int i = 0; i < kNumChannels; ++i)
+			state[i].playing = false;
+		state[0].playing = true;
+		state[0].paused = false;
+		state[1].playing = true;
+		state[1].paused = false;
+
+		// Commands only carry the latest settings of a channel, so only the
+		// last ones for each channel show up in the output. Each batch moves
+		// the last ones to the next position in the queue.
+		int16 samples[kNumFrames * 2];
+		int16 expected[kNumFrames * 2];
+		for (int batch = 0; batch < kNumBatches; ++batch) {
+			for (int i = 0; i < kNumCommands; ++i) {
+				state[i % 2].volume = (i + batch) % 100;
+				mixer->setChannelVolume(handles[i % 2], state[i % 2].volume);
+			}
+
+			state[1].paused = !state[1].paused;
+			mixer->pauseHandle(handles[1], state[1].paused);
+
+			mixer->mixCallback((byte *)samples, sizeof(samples));
+			mixState(expected, state);
+			TS_ASSERT_EQUALS(memcmp(samples, expected, sizeof(samples)), 0);
+		}
+
+		delete mixer;
+	}
+};
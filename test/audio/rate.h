@@ -0,0 +1,220 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/decoders/raw.h"
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "audio/rate_intern.h"
+
+#include "common/memstream.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	uint16 nextRandom() {
+		// xorshift32, we do not want to depend on g_system for RandomSource
+		_seed ^= _seed << 13;
+		_seed ^= _seed >> 17;
+		_seed ^= _seed << 5;
+		return (uint16)(_seed >> 8);
+	}
+
+	Audio::AudioStream *createNoiseStream(int rate, bool stereo, int samples) {
+		int16 *data = (int16 *)malloc(samples * sizeof(int16));
+		for (int i = 0; i < samples; ++i) {
+			// Mix in full scale samples to trigger saturation and overflows
+			// in the interpolation.
+			const uint16 r = nextRandom();
+			if ((r & 7) == 0)
+				data[i] = (r & 8) ? 32767 : -32768;
+			else
+				data[i] = (int16)nextRandom();
+		}
+
+		Common::SeekableReadStream *stream = new Common::MemoryReadStream((const byte *)data, samples * sizeof(int16), DisposeAfterUse::YES);
+		return Audio::makeRawStream(stream, rate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (stereo ? Audio::FLAG_STEREO : 0));
+	}
+
+#ifndef USE_ARM_SOUND_ASM
+	// The ARM assembler converters do not use the rate kernels
+	template<typename T>
+	void compareKernels(const Audio::RateKernels &kernels, Audio::RateConverterQuality quality, int inRate, int outRate,
+	                    bool stereo, bool reverseStereo, Audio::st_volume_t volL, Audio::st_volume_t volR) {
+		const int inSamples = 20000;
+		const int outFrames = 20000 * 2;
+		const uint32 seed = 0xC0FFEE + inRate + outRate + volL * 3 + volR * 7;
+
+		Audio::AudioStream *streams[2];
+		Audio::RateConverter *converters[2];
+		T *outputs[2];
+
+		for (int i = 0; i < 2; ++i) {
+			_seed = seed;
+			streams[i] = createNoiseStream(inRate, stereo, inSamples);
+			converters[i] = Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo, quality,
+			                                         i ? kernels : Audio::g_rateKernelsScalar);
+			outputs[i] = new T[outFrames * 2];
+
+			// Prefill the output buffer like other channels would
+			for (int j = 0; j < outFrames * 2; ++j)
+				outputs[i][j] = (T)(int16)nextRandom();
+
+			// Use odd chunk sizes to exercise the non-SIMD tails
+			T *out = outputs[i];
+			int left = outFrames;
+			while (left > 0) {
+				const int chunk = MIN(left, 997);
+				const int written = converters[i]->flow(*streams[i], out, chunk, volL, volR);
+				if (written < chunk)
+					left = 0;
+				out += chunk * 2;
+				left -= chunk;
+			}
+		}
+
+		TSM_ASSERT_EQUALS(kernels.name, memcmp(outputs[0], outputs[1], outFrames * 2 * sizeof(T)), 0);
+
+		for (int i = 0; i < 2; ++i) {
+			delete converters[i];
+			delete streams[i];
+			delete[] outputs[i];
+		}
+	}
+
+	void compareAllModes(const Audio::RateKernels &kernels) {
+		static const int rates[][2] = {
+			{ 22050, 22050 }, // CopyRateConverter
+			{ 44100, 22050 }, // SimpleRateConverter, or SincRateConverter
+			{ 11025, 48000 }, // LinearRateConverter, or SincRateConverter
+			{ 22050, 44100 },
+			{ 48000, 44100 }
+		};
+		static const Audio::st_volume_t volumes[][2] = {
+			{ Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume },
+			{ 255, 17 },
+			{ 0, 128 }
+		};
+
+		for (int q = 0; q < 2; ++q) {
+			const Audio::RateConverterQuality quality = q ? Audio::kRateConverterHighQuality : Audio::kRateConverterFast;
+
+			for (int r = 0; r < ARRAYSIZE(rates); ++r) {
+				for (int v = 0; v < ARRAYSIZE(volumes); ++v) {
+					compareKernels<int16>(kernels, quality, rates[r][0], rates[r][1], false, false, volumes[v][0], volumes[v][1]);
+					compareKernels<int16>(kernels, quality, rates[r][0], rates[r][1], true, false, volumes[v][0], volumes[v][1]);
+					compareKernels<int16>(kernels, quality, rates[r][0], rates[r][1], true, true, volumes[v][0], volumes[v][1]);
+					compareKernels<int32>(kernels, quality, rates[r][0], rates[r][1], false, false, volumes[v][0], volumes[v][1]);
+					compareKernels<int32>(kernels, quality, rates[r][0], rates[r][1], true, false, volumes[v][0], volumes[v][1]);
+					compareKernels<int32>(kernels, quality, rates[r][0], rates[r][1], true, true, volumes[v][0], volumes[v][1]);
+				}
+			}
+		}
+	}
+#endif
+
+public:
+	void test_sinc_dc_gain() {
+#ifndef USE_ARM_SOUND_ASM
+		// A constant signal has to pass the filter unchanged
+		const int frames = 4096;
+		int16 *data = (int16 *)malloc(frames * sizeof(int16));
+		for (int i = 0; i < frames; ++i)
+			data[i] = 12345;
+
+		Common::SeekableReadStream *stream = new Common::MemoryReadStream((const byte *)data, frames * sizeof(int16), DisposeAfterUse::YES);
+		Audio::AudioStream *input = Audio::makeRawStream(stream, 11025, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+		Audio::RateConverter *converter = Audio::makeRateConverter(11025, 48000, false, false, Audio::kRateConverterHighQuality);
+
+		int16 output[2048 * 2];
+		memset(output, 0, sizeof(output));
+		TS_ASSERT_EQUALS(converter->flow(*input, output, 2048, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), 2048);
+
+		// Skip the filter delay of SINC_TAPS input samples (~140 output frames)
+		for (int i = 2 * 160; i < 2048 * 2; ++i)
+			TS_ASSERT_EQUALS(output[i], 12345);
+
+		delete converter;
+		delete input;
+#endif
+	}
+
+	void test_sinc_flush() {
+#ifndef USE_ARM_SOUND_ASM
+		// The last input samples have to leave the filter delay line once
+		// the stream ends, instead of being dropped
+		const int frames = 1000;
+		int16 *data = (int16 *)malloc(frames * sizeof(int16));
+		for (int i = 0; i < frames; ++i)
+			data[i] = 12345;
+
+		Common::SeekableReadStream *stream = new Common::MemoryReadStream((const byte *)data, frames * sizeof(int16), DisposeAfterUse::YES);
+		Audio::AudioStream *input = Audio::makeRawStream(stream, 11025, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+		Audio::RateConverter *converter = Audio::makeRateConverter(11025, 22050, false, false, Audio::kRateConverterHighQuality);
+
+		// Every input sample, plus the SINC_TAPS / 2 silent ones flushing
+		// the filter, gives two output frames
+		int16 output[4096 * 2];
+		memset(output, 0, sizeof(output));
+		TS_ASSERT_EQUALS(converter->flow(*input, output, 4096, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), (frames + 16) * 2);
+
+		// The signal lasts until the last input sample reaches the center
+		// of the filter, where it fades out
+		for (int i = 2 * 64; i < 2 * frames * 2; ++i)
+			TS_ASSERT_EQUALS(output[i], 12345);
+		TS_ASSERT_LESS_THAN(output[(frames + 15) * 2 * 2], 12345);
+		TS_ASSERT_LESS_THAN(5000, output[(frames + 15) * 2 * 2]);
+
+		delete converter;
+		delete input;
+#endif
+	}
+
+	void test_wide_output() {
+		// Wide output must match 16-bit output scaled up, without any
+		// saturation of the sum.
+		const int frames = 1024;
+		int16 *data = (int16 *)malloc(frames * 2 * sizeof(int16));
+		for (int i = 0; i < frames * 2; ++i)
+			data[i] = (i & 1) ? -30000 : 30000;
+
+		Common::SeekableReadStream *stream = new Common::MemoryReadStream((const byte *)data, frames * 2 * sizeof(int16), DisposeAfterUse::YES);
+		Audio::AudioStream *input = Audio::makeRawStream(stream, 22050, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | Audio::FLAG_STEREO);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 22050, true);
+
+		Audio::st_wide_sample_t output[frames * 2];
+		for (int i = 0; i < frames * 2; ++i)
+			output[i] = (i & 1) ? -20000 * 256 : 20000 * 256;
+
+		TS_ASSERT_EQUALS(converter->flow(*input, output, frames, Audio::Mixer::kMaxMixerVolume, 128), frames);
+		for (int i = 0; i < frames * 2; i += 2) {
+			TS_ASSERT_EQUALS(output[i], 50000 * 256);
+			TS_ASSERT_EQUALS(output[i + 1], -35000 * 256);
+		}
+
+		delete converter;
+		delete input;
+	}
+
+	void test_sse2_bit_exact() {
+#if defined(SCUMMVM_SSE2) && !defined(OUTPUT_UNSIGNED_AUDIO) && !defined(USE_ARM_SOUND_ASM)
+		if (Common::hasCpuFeature(Common::kCpuFeatureSSE2))
+			compareAllModes(Audio::g_rateKernelsSSE2);
+#endif
+	}
+
+	void test_avx2_bit_exact() {
+#if defined(SCUMMVM_AVX2) && !defined(OUTPUT_UNSIGNED_AUDIO) && !defined(USE_ARM_SOUND_ASM)
+		if (Common::hasCpuFeature(Common::kCpuFeatureAVX2))
+			compareAllModes(Audio::g_rateKernelsAVX2);
+#endif
+	}
+
+	void test_neon_bit_exact() {
+#if defined(SCUMMVM_NEON) && !defined(OUTPUT_UNSIGNED_AUDIO) && !defined(USE_ARM_SOUND_ASM)
+		if (Common::hasCpuFeature(Common::kCpuFeatureNEON))
+			compareAllModes(Audio::g_rateKernelsNEON);
+#endif
+	}
+};
@@ -0,0 +1,153 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/str.h"
+
+#include "graphics/transparent_surface.h"
+#include "graphics/transparent_surface_intern.h"
+
+#include "timer.h"
+
+class BlitBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 640,
+		kHeight = 480,
+		kRepeats = 20,
+		kRounds = 5
+	};
+
+	Graphics::Surface _src, _dst;
+
+	void benchmarkKernels(const Graphics::BlendKernels &kernels, uint32 color) {
+		static const char *const modes[] = { "opaque", "binary", "alpha", "additive", "subtractive" };
+
+		byte *ino = (byte *)_src.getPixels();
+		byte *outo = (byte *)_dst.getPixels();
+		for (int mode = 0; mode < 5; ++mode) {
+			const uint64 start = getBenchmarkTicks();
+			for (int i = 0; i < kRepeats; ++i) {
+				switch (mode) {
+				case 0:
+					kernels.blitOpaque(ino, outo, kWidth, kHeight, _dst.pitch, 4, _src.pitch);
+					break;
+				case 1:
+					kernels.blitBinary(ino, outo, kWidth, kHeight, _dst.pitch, 4, _src.pitch);
+					break;
+				case 2:
+					kernels.blitAlphaBlend(ino, outo, kWidth, kHeight, _dst.pitch, 4, _src.pitch, color);
+					break;
+				case 3:
+					kernels.blitAdditiveBlend(ino, outo, kWidth, kHeight, _dst.pitch, 4, _src.pitch, color);
+					break;
+				default:
+					kernels.blitSubtractiveBlend(ino, outo, kWidth, kHeight, _dst.pitch, 4, _src.pitch, color);
+					break;
+				}
+			}
+			const uint64 ticks = getBenchmarkTicks() - start;
+
+			TS_TRACE(Common::String::format("%-6s %-12s %s: %.2f %s/pixel", kernels.name, modes[mode],
+			                                color == 0xFFFFFFFF ? "plain    " : "modulated",
+			                                (double)ticks / ((uint64)kWidth * kHeight * kRepeats), getBenchmarkTickUnit()).c_str());
+		}
+	}
+
+	void benchmarkBlit(const char *name, Graphics::AlphaType alphaType, Graphics::TSpriteBlendMode blend, uint color) {
+		Graphics::TransparentSurface surface(_src);
+		surface.setAlphaMode(alphaType);
+
+		const uint64 start = getBenchmarkTicks();
+		for (int i = 0; i < kRepeats; ++i)
+			surface.blit(_dst, 0, 0, Graphics::FLIP_NONE, nullptr, color, -1, -1, blend);
+		const uint64 ticks = getBenchmarkTicks() - start;
+
+		TS_TRACE(Common::String::format("blit %-22s: %.2f %s/pixel", name,
+		                                (double)ticks / ((uint64)kWidth * kHeight * kRepeats), getBenchmarkTickUnit()).c_str());
+	}
+
+	void benchmarkScaledBlit(const char *name, const Graphics::Surface &sprite, int width, int height, bool filtering) {
+		Graphics::TransparentSurface surface(sprite);
+		surface.setAlphaMode(Graphics::ALPHA_FULL);
+
+		// Scaling a copy first, as blit() used to do. Take the best of a few
+		// rounds, as whichever runs first pays for warming up the caches.
+		uint64 copyTicks = 0, blitTicks = 0;
+		for (int round = 0; round < kRounds; ++round) {
+			uint64 start = getBenchmarkTicks();
+			for (int i = 0; i < kRepeats; ++i) {
+				Graphics::TransparentSurface *scaled = surface.scale(width, height, filtering);
+				scaled->blit(_dst);
+				scaled->free();
+				delete scaled;
+			}
+			const uint64 copyRound = getBenchmarkTicks() - start;
+
+			start = getBenchmarkTicks();
+			for (int i = 0; i < kRepeats; ++i)
+				surface.blit(_dst, 0, 0, Graphics::FLIP_NONE, nullptr, TS_ARGB(255, 255, 255, 255), width, height, Graphics::BLEND_NORMAL, filtering);
+			const uint64 blitRound = getBenchmarkTicks() - start;
+
+			if (round == 0 || copyRound < copyTicks)
+				copyTicks = copyRound;
+			if (round == 0 || blitRound < blitTicks)
+				blitTicks = blitRound;
+		}
+
+		const double pixels = (double)width * height * kRepeats;
+		TS_TRACE(Common::String::format("scaled blit %-19s: scale+blit %.2f, blit %.2f %s/pixel", name,
+		                                copyTicks / pixels, blitTicks / pixels, getBenchmarkTickUnit()).c_str());
+	}
+
+public:
+	void setUp() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		_src.create(kWidth, kHeight, format);
+		_dst.create(kWidth, kHeight, format);
+
+		// A sprite with a mix of transparent, translucent and opaque pixels
+		uint32 seed = 1;
+		byte *src = (byte *)_src.getPixels();
+		byte *dst = (byte *)_dst.getPixels();
+		for (int i = 0; i < kWidth * kHeight * 4; ++i) {
+			seed = seed * 1664525 + 1013904223;
+			src[i] = seed >> 24;
+			dst[i] = seed >> 16;
+		}
+	}
+
+	void tearDown() {
+		_src.free();
+		_dst.free();
+	}
+
+	void test_kernels() {
+		const Graphics::BlendKernels &best = Graphics::getBlendKernels();
+		benchmarkKernels(Graphics::g_blendKernelsScalar, 0xFFFFFFFF);
+		benchmarkKernels(Graphics::g_blendKernelsScalar, 0xC0FF8040);
+		if (&best != &Graphics::g_blendKernelsScalar) {
+			benchmarkKernels(best, 0xFFFFFFFF);
+			benchmarkKernels(best, 0xC0FF8040);
+		}
+	}
+
+	void test_blit() {
+		const uint modulated = TS_ARGB(192, 255, 128, 64);
+		benchmarkBlit("opaque", Graphics::ALPHA_OPAQUE, Graphics::BLEND_NORMAL, TS_ARGB(255, 255, 255, 255));
+		benchmarkBlit("binary", Graphics::ALPHA_BINARY, Graphics::BLEND_NORMAL, TS_ARGB(255, 255, 255, 255));
+		benchmarkBlit("alpha", Graphics::ALPHA_FULL, Graphics::BLEND_NORMAL, TS_ARGB(255, 255, 255, 255));
+		benchmarkBlit("alpha modulated", Graphics::ALPHA_FULL, Graphics::BLEND_NORMAL, modulated);
+		benchmarkBlit("additive", Graphics::ALPHA_FULL, Graphics::BLEND_ADDITIVE, TS_ARGB(255, 255, 255, 255));
+		benchmarkBlit("additive modulated", Graphics::ALPHA_FULL, Graphics::BLEND_ADDITIVE, modulated);
+		benchmarkBlit("subtractive", Graphics::ALPHA_FULL, Graphics::BLEND_SUBTRACTIVE, TS_ARGB(255, 255, 255, 255));
+		benchmarkBlit("subtractive modulated", Graphics::ALPHA_FULL, Graphics::BLEND_SUBTRACTIVE, modulated);
+	}
+
+	void test_scaled_blit() {
+		const Graphics::Surface quarter = _src.getSubArea(Common::Rect(kWidth / 4, kHeight / 4));
+		benchmarkScaledBlit("upscale", quarter, kWidth, kHeight, false);
+		benchmarkScaledBlit("downscale", _src, kWidth / 2, kHeight / 2, false);
+		benchmarkScaledBlit("upscale filtered", quarter, kWidth, kHeight, true);
+		benchmarkScaledBlit("downscale filtered", _src, kWidth / 2, kHeight / 2, true);
+	}
+};
@@ -0,0 +1,70 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/decoders/raw.h"
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "timer.h"
+
+#include <math.h>
+
+class RateConverterBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	void benchmark(const char *name, int inRate, int outRate, bool stereo, Audio::RateConverterQuality quality) {
+		const int inFrames = inRate * 4;
+		const int channels = stereo ? 2 : 1;
+		int16 *data = (int16 *)malloc(inFrames * channels * sizeof(int16));
+		for (int i = 0; i < inFrames * channels; ++i)
+			data[i] = (int16)(sin(i * 0.05) * 20000);
+
+		Common::SeekableReadStream *stream = new Common::MemoryReadStream((const byte *)data, inFrames * channels * sizeof(int16), DisposeAfterUse::YES);
+		Audio::AudioStream *input = Audio::makeRawStream(stream, inRate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (stereo ? Audio::FLAG_STEREO : 0));
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, false, quality);
+
+		// Convert in chunks of a typical audio callback size
+		const int chunk = 1024;
+		int16 output[chunk * 2];
+		uint64 frames = 0;
+
+		const uint64 start = getBenchmarkTicks();
+		for (;;) {
+			memset(output, 0, sizeof(output));
+			const int written = converter->flow(*input, output, chunk, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			frames += written;
+			if (written < chunk)
+				break;
+		}
+		const uint64 ticks = getBenchmarkTicks() - start;
+
+		TS_TRACE(Common::String::format("%-8s %5d -> %5d Hz %s: %.1f %s/sample", name, inRate, outRate,
+		                                stereo ? "stereo" : "mono  ", (double)ticks / frames, getBenchmarkTickUnit()).c_str());
+
+		delete converter;
+		delete input;
+	}
+
+	void benchmarkRates(int inRate, int outRate, bool stereo) {
+		benchmark("linear", inRate, outRate, stereo, Audio::kRateConverterFast);
+		benchmark("sinc", inRate, outRate, stereo, Audio::kRateConverterHighQuality);
+	}
+
+public:
+	void test_upsample_11025() {
+		benchmarkRates(11025, 48000, false);
+		benchmarkRates(11025, 48000, true);
+	}
+
+	void test_upsample_22050() {
+		benchmarkRates(22050, 48000, false);
+		benchmarkRates(22050, 48000, true);
+	}
+
+	void test_downsample_48000() {
+		benchmarkRates(48000, 44100, true);
+	}
+};
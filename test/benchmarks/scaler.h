@@ -0,0 +1,105 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/str.h"
+#include "common/util.h"
+#include "common/workerpool.h"
+
+#include "graphics/pixelformat.h"
+#include "graphics/scaler.h"
+
+#include "timer.h"
+
+class ScalerBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 320,
+		kHeight = 200,
+		kSrcPitch = (kWidth + 4) * 2,
+		kDstPitch = kWidth * 3 * 2,
+		kFrames = 50
+	};
+
+	uint16 *_src;
+	uint32 *_src32;
+	uint32 *_dst;
+
+	void benchmark(const char *name, ScalerProc *scaler, int scaleFactor, int bytesPerPixel = 2) {
+		const uint32 srcPitch = kSrcPitch / 2 * bytesPerPixel;
+		const uint32 dstPitch = kDstPitch / 2 * bytesPerPixel;
+		const uint8 *src = (bytesPerPixel == 4 ? (const uint8 *)_src32 : (const uint8 *)_src) + srcPitch + 2 * bytesPerPixel;
+
+		uint64 start = getBenchmarkTicks();
+		for (int i = 0; i < kFrames; ++i)
+			scaler(src, srcPitch, (uint8 *)_dst, dstPitch, kWidth, kHeight);
+		const uint64 directTicks = getBenchmarkTicks() - start;
+
+		Common::WorkerPool pool;
+		start = getBenchmarkTicks();
+		for (int i = 0; i < kFrames; ++i)
+			scaleInBands(pool, scaler, scaleFactor, src, srcPitch, (uint8 *)_dst, dstPitch, kWidth, kHeight);
+		const uint64 bandedTicks = getBenchmarkTicks() - start;
+
+		const double pixels = (double)kWidth * kHeight * kFrames;
+		TS_TRACE(Common::String::format("%-12s 320x200: %.2f %s/pixel, in bands with %d threads %.2f %s/pixel", name,
+		                                directTicks / pixels, getBenchmarkTickUnit(), pool.getNumThreads(),
+		                                bandedTicks / pixels, getBenchmarkTickUnit()).c_str());
+	}
+
+public:
+	void setUp() {
+		InitScalers(565);
+
+		// A frame with a border of two pixels, which the scalers look at
+		_src = new uint16[(kWidth + 4) * (kHeight + 4)];
+		_src32 = new uint32[(kWidth + 4) * (kHeight + 4)];
+		_dst = new uint32[kDstPitch / 2 * kHeight * 3];
+		const Graphics::PixelFormat format16(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const Graphics::PixelFormat format32(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		uint32 seed = 1;
+		for (int i = 0; i < (kWidth + 4) * (kHeight + 4); ++i) {
+			seed = seed * 1664525 + 1013904223;
+			_src[i] = (seed & 0x30000) ? _src[MAX(i - 1, 0)] : (uint16)(seed >> 16);
+
+			uint8 r, g, b;
+			format16.colorToRGB(_src[i], r, g, b);
+			_src32[i] = format32.RGBToColor(r, g, b);
+		}
+	}
+
+	void tearDown() {
+		delete[] _src;
+		delete[] _src32;
+		delete[] _dst;
+		DestroyScalers();
+	}
+
+	void test_scalers() {
+		benchmark("Normal1x", Normal1x, 1);
+#ifdef USE_SCALERS
+		benchmark("Normal2x", Normal2x, 2);
+		benchmark("Normal3x", Normal3x, 3);
+		benchmark("2xSaI", _2xSaI, 2);
+		benchmark("AdvMame2x", AdvMame2x, 2);
+		benchmark("AdvMame3x", AdvMame3x, 3);
+#ifdef USE_HQ_SCALERS
+		benchmark("HQ2x", HQ2x, 2);
+		benchmark("HQ3x", HQ3x, 3);
+#endif
+#endif
+	}
+
+	void test_scalers_32() {
+		benchmark("Normal1x_32", Normal1x_32, 1, 4);
+#ifdef USE_SCALERS
+		benchmark("Normal2x_32", Normal2x_32, 2, 4);
+		benchmark("Normal3x_32", Normal3x_32, 3, 4);
+		benchmark("AdvMame2x_32", AdvMame2x_32, 2, 4);
+		benchmark("AdvMame3x_32", AdvMame3x_32, 3, 4);
+#ifdef USE_HQ_SCALERS
+		benchmark("HQ2x_32", HQ2x_32, 2, 4);
+		benchmark("HQ3x_32", HQ3x_32, 3, 4);
+#endif
+#endif
+	}
+};
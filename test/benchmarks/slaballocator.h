@@ -0,0 +1,72 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/slaballocator.h"
+#include "common/str.h"
+
+#include "timer.h"
+
+class SlabAllocatorBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kNumBlocks = 4096,
+		kNumRounds = 64
+	};
+
+	struct Malloc {
+		static void *allocate(size_t size) { return malloc(size); }
+		static void deallocate(void *ptr, size_t) { free(ptr); }
+	};
+
+	struct Slab {
+		static void *allocate(size_t size) { return SlabMan.allocate(size); }
+		static void deallocate(void *ptr, size_t size) { SlabMan.deallocate(ptr, size); }
+	};
+
+	// Keeps a working set of blocks alive and replaces them in a
+	// pseudo random order, like objects of an engine come and go.
+	template<class Allocator>
+	void benchmark(const char *name, uint minSize, uint maxSize) {
+		void *blocks[kNumBlocks];
+		uint sizes[kNumBlocks];
+		uint32 seed = 1;
+
+		const uint64 start = getBenchmarkTicks();
+		for (uint i = 0; i < kNumBlocks; ++i) {
+			seed = seed * 1103515245 + 12345;
+			sizes[i] = minSize + (seed >> 16) % (maxSize - minSize + 1);
+			blocks[i] = Allocator::allocate(sizes[i]);
+		}
+		for (uint round = 0; round < kNumRounds; ++round) {
+			for (uint i = 0; i < kNumBlocks; ++i) {
+				seed = seed * 1103515245 + 12345;
+				const uint idx = (seed >> 8) % kNumBlocks;
+				Allocator::deallocate(blocks[idx], sizes[idx]);
+				sizes[idx] = minSize + (seed >> 16) % (maxSize - minSize + 1);
+				blocks[idx] = Allocator::allocate(sizes[idx]);
+			}
+		}
+		for (uint i = 0; i < kNumBlocks; ++i)
+			Allocator::deallocate(blocks[i], sizes[i]);
+		const uint64 ticks = getBenchmarkTicks() - start;
+
+		TS_TRACE(Common::String::format("%-6s %3u-%3u bytes: %.1f %s/allocation", name, minSize, maxSize,
+		                                (double)ticks / (kNumBlocks * (kNumRounds + 1)), getBenchmarkTickUnit()).c_str());
+	}
+
+	void benchmarkSizes(uint minSize, uint maxSize) {
+		benchmark<Malloc>("malloc", minSize, maxSize);
+		benchmark<Slab>("slab", minSize, maxSize);
+	}
+
+public:
+	void test_fixed_size() {
+		benchmarkSizes(16, 16);
+		benchmarkSizes(48, 48);
+	}
+
+	void test_mixed_sizes() {
+		benchmarkSizes(8, 64);
+		benchmarkSizes(8, 256);
+	}
+};
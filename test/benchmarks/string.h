@@ -0,0 +1,117 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/config-manager.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#ifdef POSIX
+#include "backends/fs/stdiostream.h"
+#endif
+
+#include "timer.h"
+
+class StringBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kNumLines = 20000,
+		kNumDomains = 200,
+		kConfigRepeats = 50
+	};
+
+	static void trace(const char *name, uint64 ticks, uint count) {
+		TS_TRACE(Common::String::format("%-32s: %.1f %s/op", name, (double)ticks / count, getBenchmarkTickUnit()).c_str());
+	}
+
+	static Common::String makeValue(uint i) {
+		// Long enough to not fit into the internal storage
+		return Common::String::format("C:\\Games\\Adventure\\Number%u\\Data", i);
+	}
+
+	/** Generate a configuration file like the one of a user with many games. */
+	static Common::String makeConfig() {
+		static const char *const keys[] = {
+			"description", "path", "savepath", "extrapath", "language", "platform",
+			"music_volume", "sfx_volume", "speech_volume", "subtitles", "talkspeed", "gfx_mode"
+		};
+
+		Common::String text = "# Written by the configuration benchmark\n[scummvm]\nversioninfo=1.8.0\n\n";
+		for (uint i = 0; i < kNumDomains; ++i) {
+			text += Common::String::format("[game%u]\ngameid=game%u\n", i, i);
+			for (uint k = 0; k < ARRAYSIZE(keys); ++k) {
+				if (k == 0)
+					text += "# Set by the launcher\n";
+				text += Common::String::format("%s=", keys[k]);
+				text += makeValue(i * ARRAYSIZE(keys) + k);
+				text += "\n";
+			}
+			text += "\n";
+		}
+		return text;
+	}
+
+public:
+	// ConfigManager writing the configuration file, which writes the
+	// keys, values and comments to the stream one by one
+	void test_config_save() {
+		const Common::String text = makeConfig();
+		Common::MemoryReadStream input((const byte *)text.c_str(), text.size());
+		ConfMan.loadFromStream(input);
+
+		uint32 total = 0;
+		uint64 start = getBenchmarkTicks();
+		for (uint i = 0; i < kConfigRepeats; ++i) {
+			Common::MemoryWriteStreamDynamic output(DisposeAfterUse::YES);
+			ConfMan.saveToStream(output);
+			total += output.size();
+		}
+		trace("ConfigManager::saveToStream", getBenchmarkTicks() - start, kConfigRepeats * kNumDomains);
+		TS_ASSERT_EQUALS(total, kConfigRepeats * text.size());
+
+#ifdef POSIX
+		// Like flushToDisk(), which writes to a file
+		start = getBenchmarkTicks();
+		for (uint i = 0; i < kConfigRepeats; ++i) {
+			Common::WriteStream *output = StdioStream::makeFromPath("test/config.tmp", true);
+			TS_ASSERT(output);
+			if (!output)
+				return;
+			ConfMan.saveToStream(*output);
+			delete output;
+		}
+		trace("ConfigManager::saveToStream, file", getBenchmarkTicks() - start, kConfigRepeats * kNumDomains);
+#endif
+	}
+
+	// ConfigManager reading the configuration file, which accumulates the
+	// comments and splits the lines into keys and values
+	void test_config_load() {
+		const Common::String text = makeConfig();
+
+		const uint64 start = getBenchmarkTicks();
+		for (uint i = 0; i < kConfigRepeats; ++i) {
+			Common::MemoryReadStream input((const byte *)text.c_str(), text.size());
+			ConfMan.loadFromStream(input);
+		}
+		trace("ConfigManager::loadFromStream", getBenchmarkTicks() - start, kConfigRepeats * kNumDomains);
+
+		TS_ASSERT(ConfMan.hasGameDomain("game0"));
+	}
+
+	// Returning strings by value and storing them, which benefits from
+	// move semantics when built as C++11.
+	void test_return_by_value() {
+		Common::Array<Common::String> values;
+		values.reserve(kNumLines);
+
+		const uint64 start = getBenchmarkTicks();
+		for (uint i = 0; i < kNumLines; ++i) {
+			Common::String value = makeValue(i);
+			values.push_back(value);
+		}
+		trace("return and store", getBenchmarkTicks() - start, kNumLines);
+
+		TS_ASSERT_EQUALS(values.size(), (uint)kNumLines);
+	}
+};
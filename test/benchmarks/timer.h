@@ -0,0 +1,39 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef TEST_BENCHMARKS_TIMER_H
+#define TEST_BENCHMARKS_TIMER_H
+
+#include "common/scummsys.h"
+
+/**
+ * Returns a time stamp for measuring the run time of benchmarks. On x86
+ * this is the CPU time stamp counter, elsewhere a nanosecond clock.
+ */
+uint64 getBenchmarkTicks();
+
+/**
+ * Returns the unit of the values returned by getBenchmarkTicks().
+ */
+const char *getBenchmarkTickUnit();
+
+#endif
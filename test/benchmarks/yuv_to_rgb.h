@@ -0,0 +1,83 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/str.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "timer.h"
+
+class YUVToRGBBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kMaxWidth = 1280,
+		kMaxHeight = 720,
+		kFrames = 20
+	};
+
+	byte *_y, *_u, *_v;
+
+	uint64 convert(Graphics::Surface &dst, const char *subsampling, int width, int height) {
+		const uint64 start = getBenchmarkTicks();
+		for (int i = 0; i < kFrames; ++i) {
+			if (!strcmp(subsampling, "444"))
+				YUVToRGBMan.convert444(&dst, Graphics::YUVToRGBManager::kScaleITU, _y, _u, _v, width, height, kMaxWidth, kMaxWidth);
+			else if (!strcmp(subsampling, "420"))
+				YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU, _y, _u, _v, width, height, kMaxWidth, kMaxWidth / 2);
+			else
+				YUVToRGBMan.convert410(&dst, Graphics::YUVToRGBManager::kScaleITU, _y, _u, _v, width, height, kMaxWidth, kMaxWidth / 4 + 1);
+		}
+		return getBenchmarkTicks() - start;
+	}
+
+	void benchmark(const char *subsampling, int bytesPerPixel, int width, int height) {
+		const Graphics::PixelFormat format = bytesPerPixel == 2 ? Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)
+		                                                        : Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::Surface dst;
+		dst.create(width, height, format);
+
+		YUVToRGBMan.setUseSIMD(false);
+		const uint64 lookupTicks = convert(dst, subsampling, width, height);
+		YUVToRGBMan.setUseSIMD(true);
+		const uint64 simdTicks = convert(dst, subsampling, width, height);
+
+		const double pixels = (double)width * height * kFrames;
+		TS_TRACE(Common::String::format("%s to %d bit %4dx%d: lookup tables %.2f, SIMD %.2f %s/pixel", subsampling,
+		                                bytesPerPixel * 8, width, height, lookupTicks / pixels, simdTicks / pixels,
+		                                getBenchmarkTickUnit()).c_str());
+		dst.free();
+	}
+
+public:
+	void setUp() {
+		// The chroma planes are as large as the luminance plane, which
+		// leaves room for the extra row and column convert410() reads
+		_y = new byte[kMaxWidth * kMaxHeight];
+		_u = new byte[kMaxWidth * kMaxHeight];
+		_v = new byte[kMaxWidth * kMaxHeight];
+		uint32 seed = 1;
+		for (int i = 0; i < kMaxWidth * kMaxHeight; ++i) {
+			seed = seed * 1664525 + 1013904223;
+			_y[i] = seed >> 24;
+			_u[i] = seed >> 16;
+			_v[i] = seed >> 8;
+		}
+	}
+
+	void tearDown() {
+		delete[] _y;
+		delete[] _u;
+		delete[] _v;
+	}
+
+	void test_convert() {
+		const char *const subsamplings[] = { "420", "444", "410" };
+		for (int i = 0; i < 3; ++i) {
+			for (int bytesPerPixel = 2; bytesPerPixel <= 4; bytesPerPixel += 2) {
+				benchmark(subsamplings[i], bytesPerPixel, 640, 480);
+				benchmark(subsamplings[i], bytesPerPixel, 1280, 720);
+			}
+		}
+	}
+};
@@ -3,6 +3,29 @@
 #include "common/array.h"
 #include "common/str.h"
 
+struct ArrayTestCounted {
+	static int _alive;
+	static int _assigned;
+
+	int _a, _b;
+
+	ArrayTestCounted() : _a(0), _b(0) { _alive++; }
+	ArrayTestCounted(int a) : _a(a), _b(0) { _alive++; }
+	ArrayTestCounted(int a, int b) : _a(a), _b(b) { _alive++; }
+	ArrayTestCounted(const ArrayTestCounted &o) : _a(o._a), _b(o._b) { _alive++; }
+	~ArrayTestCounted() { _alive--; }
+
+	ArrayTestCounted &operator=(const ArrayTestCounted &o) {
+		_a = o._a;
+		_b = o._b;
+		_assigned++;
+		return *this;
+	}
+};
+
+int ArrayTestCounted::_alive = 0;
+int ArrayTestCounted::_assigned = 0;
+
 class ArrayTestSuite : public CxxTest::TestSuite
 {
 	public:
@@ -311,4 +334,131 @@ class ArrayTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(array[1], 163);
 	}
 
+	void test_resize_destroys() {
+		{
+			Common::Array<ArrayTestCounted> array;
+			array.resize(10);
+			TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 10);
+
+			array.resize(4);
+			TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 4);
+		}
+		TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 0);
+	}
+
+	void test_emplace_back() {
+		{
+			Common::Array<ArrayTestCounted> array;
+			array.emplace_back();
+			array.emplace_back(7);
+			array.emplace_back(3, 4);
+
+			TS_ASSERT_EQUALS(array.size(), (unsigned int)3);
+			TS_ASSERT_EQUALS(array[0]._a, 0);
+			TS_ASSERT_EQUALS(array[1]._a, 7);
+			TS_ASSERT_EQUALS(array[2]._a, 3);
+			TS_ASSERT_EQUALS(array[2]._b, 4);
+			TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 3);
+		}
+		TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 0);
+	}
+
+	void test_push_back_self_while_growing() {
+		Common::Array<Common::String> array;
+		array.push_back("first");
+
+		// Each of these may reallocate while referencing an element
+		for (int i = 0; i < 100; ++i)
+			array.push_back(array[0]);
+		for (int i = 0; i < 100; ++i)
+			array.emplace_back(array.back());
+
+		TS_ASSERT_EQUALS(array.size(), (unsigned int)201);
+		for (unsigned int i = 0; i < array.size(); ++i)
+			TS_ASSERT_EQUALS(array[i], "first");
+	}
+
+	void test_insert_keeps_reserve() {
+		Common::Array<int> array;
+		array.reserve(128);
+		for (int i = 0; i < 16; ++i)
+			array.push_back(i);
+
+		// Inserting a copy of itself must not shrink the reserved space
+		array.insert_at(4, array);
+		TS_ASSERT_EQUALS(array.size(), (unsigned int)32);
+
+		const int *storage = array.begin();
+		array.insert_at(0, 42);
+		for (int i = 0; i < 64; ++i)
+			array.push_back(i);
+		TS_ASSERT_EQUALS(array.begin(), storage);
+
+		TS_ASSERT_EQUALS(array[0], 42);
+		TS_ASSERT_EQUALS(array[5], 0);
+		TS_ASSERT_EQUALS(array[20], 15);
+		TS_ASSERT_EQUALS(array[21], 4);
+	}
+
+	void test_move() {
+#if __cplusplus >= 201103L
+		Common::Array<Common::String> array;
+		array.push_back("abc");
+		array.push_back("def");
+		const Common::String *storage = array.begin();
+
+		Common::Array<Common::String> moved(static_cast<Common::Array<Common::String> &&>(array));
+		TS_ASSERT(array.empty());
+		TS_ASSERT_EQUALS(moved.size(), (unsigned int)2);
+		TS_ASSERT_EQUALS(moved.begin(), storage);
+
+		array = static_cast<Common::Array<Common::String> &&>(moved);
+		TS_ASSERT(moved.empty());
+		TS_ASSERT_EQUALS(array[1], "def");
+#endif
+	}
+
+	void test_small_array() {
+		{
+			Common::SmallArray<ArrayTestCounted, 4> array;
+			TS_ASSERT(array.isInline());
+
+			for (int i = 0; i < 4; ++i)
+				array.emplace_back(i, -i);
+			TS_ASSERT(array.isInline());
+			TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 4);
+
+			array.push_back(array[0]);
+			TS_ASSERT(!array.isInline());
+			TS_ASSERT_EQUALS(array.size(), (unsigned int)5);
+			TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 5);
+			TS_ASSERT_EQUALS(array[3]._b, -3);
+			TS_ASSERT_EQUALS(array.back()._a, 0);
+
+			Common::SmallArray<ArrayTestCounted, 4> copy(array);
+			TS_ASSERT_EQUALS(copy.size(), (unsigned int)5);
+			TS_ASSERT_EQUALS(copy[2]._a, 2);
+
+			// Shifting elements in place assigns instead of reconstructing
+			ArrayTestCounted::_assigned = 0;
+			TS_ASSERT_EQUALS(array.remove_at(1)._a, 1);
+			array.insert_at(0, array[2]);
+			TS_ASSERT(ArrayTestCounted::_assigned > 0);
+			TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 10);
+			TS_ASSERT_EQUALS(array.size(), (unsigned int)5);
+			TS_ASSERT_EQUALS(array.front()._a, 3);
+			TS_ASSERT_EQUALS(array[1]._a, 0);
+			TS_ASSERT_EQUALS(array[2]._a, 2);
+
+			array.clear();
+			TS_ASSERT(array.isInline());
+			TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 5);
+
+			array = copy;
+			TS_ASSERT_EQUALS(array.size(), (unsigned int)5);
+			array.resize(2);
+			TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 7);
+		}
+		TS_ASSERT_EQUALS(ArrayTestCounted::_alive, 0);
+	}
 };
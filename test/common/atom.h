@@ -0,0 +1,138 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atom.h"
+#include "common/config-manager.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+
+class AtomTestSuite : public CxxTest::TestSuite {
+public:
+	void test_interning() {
+		Common::Atom a("music_volume");
+		Common::Atom b(Common::String("music_") + "volume");
+		Common::Atom c("sfx_volume");
+
+		TS_ASSERT(a == b);
+		TS_ASSERT(a != c);
+		TS_ASSERT_EQUALS(a.c_str(), b.c_str());
+		TS_ASSERT_EQUALS(a.str(), "music_volume");
+		TS_ASSERT_EQUALS(a.size(), 12u);
+		TS_ASSERT_EQUALS(a.hash(), Common::hashit("music_volume"));
+
+		// Comparing with plain strings
+		TS_ASSERT(a == "music_volume");
+		TS_ASSERT(a != "sfx_volume");
+		TS_ASSERT(a == Common::String("music_volume"));
+	}
+
+	void test_own_storage() {
+		// Too long for the builtin storage of String, so copies share the
+		// reference counted buffer
+		Common::String key("a_configuration_key_longer_than_the_builtin_storage");
+		Common::Atom a(key);
+		TS_ASSERT_EQUALS(a.str(), key);
+		TS_ASSERT((const void *)a.c_str() != (const void *)key.c_str());
+	}
+
+	void test_empty() {
+		Common::Atom a;
+		Common::Atom b("");
+		TS_ASSERT(a.empty());
+		TS_ASSERT(a == b);
+		TS_ASSERT_EQUALS(a.str(), "");
+		TS_ASSERT_EQUALS(a.size(), 0u);
+		TS_ASSERT(!Common::Atom("x").empty());
+	}
+
+	void test_ignore_case() {
+		Common::Atom a("Music_Volume");
+		Common::Atom b("music_volume");
+		Common::Atom c("MUSIC_VOLUME");
+
+		TS_ASSERT(a != b);
+		TS_ASSERT(a.equalsIgnoreCase(b));
+		TS_ASSERT(c.equalsIgnoreCase(a));
+		TS_ASSERT(!a.equalsIgnoreCase(Common::Atom("sfx_volume")));
+		TS_ASSERT(a.toLowercase() == b);
+		TS_ASSERT(b.toLowercase() == b);
+		TS_ASSERT_EQUALS(a.hashIgnoreCase(), Common::hashit_lower("Music_Volume"));
+		TS_ASSERT_EQUALS(a.str(), "Music_Volume");
+	}
+
+	void test_hashmap() {
+		Common::HashMap<Common::Atom, int> map;
+		map["foo"] = 1;
+		map[Common::String("bar")] = 2;
+		TS_ASSERT_EQUALS(map["foo"], 1);
+		TS_ASSERT_EQUALS(map[Common::Atom("bar")], 2);
+		TS_ASSERT(!map.contains("Foo"));
+
+		Common::HashMap<Common::Atom, int, Common::Atom_IgnoreCase_Hash, Common::Atom_IgnoreCase_EqualTo> map2;
+		map2["Foo"] = 1;
+		TS_ASSERT(map2.contains("foo"));
+		TS_ASSERT(map2.contains("FOO"));
+		map2["FOO"] = 2;
+		TS_ASSERT_EQUALS(map2.size(), 1u);
+		// The key keeps the case it was inserted with
+		TS_ASSERT_EQUALS(map2.begin()->_key.str(), "Foo");
+		TS_ASSERT_EQUALS(map2["foo"], 2);
+	}
+
+	void test_find() {
+		Common::Atom a("Find_Me");
+		const uint numAtoms = Common::Atom::getNumAtoms();
+
+		Common::Atom b;
+		TS_ASSERT(Common::Atom::findIgnoreCase("Find_Me", b));
+		TS_ASSERT(b.equalsIgnoreCase(a));
+		TS_ASSERT(Common::Atom::findIgnoreCase("FIND_ME", b));
+		TS_ASSERT(b.equalsIgnoreCase(a));
+		TS_ASSERT(!Common::Atom::findIgnoreCase("not_interned_anywhere", b));
+		TS_ASSERT(Common::Atom::findIgnoreCase("", b));
+		TS_ASSERT(b.empty());
+
+		TS_ASSERT(Common::Atom::find("Find_Me", b));
+		TS_ASSERT(b == a);
+		TS_ASSERT(!Common::Atom::find("FIND_ME", b));
+		TS_ASSERT(!Common::Atom::find("not_interned_anywhere", b));
+
+		// Looking up strings does not intern them
+		TS_ASSERT_EQUALS(Common::Atom::getNumAtoms(), numAtoms);
+	}
+
+	void test_many_atoms() {
+		// Enough atoms to make the atom table grow several times
+		for (int i = 0; i < 2000; i++)
+			Common::Atom(Common::String::format("Atom_Test_%d", i));
+
+		for (int i = 0; i < 2000; i++) {
+			const Common::String str = Common::String::format("Atom_Test_%d", i);
+			Common::Atom a;
+			TS_ASSERT(Common::Atom::find(str, a));
+			TS_ASSERT_EQUALS(a.str(), str);
+		}
+
+		Common::Atom b;
+		TS_ASSERT(Common::Atom::findIgnoreCase("ATOM_TEST_1999", b));
+		TS_ASSERT(Common::Atom::find("atom_test_1999", b));
+		TS_ASSERT(!Common::Atom::find("Atom_Test_2000", b));
+	}
+
+	void test_config_lookup() {
+		ConfMan.registerDefault("atom_test_key", 5);
+		const uint numAtoms = Common::Atom::getNumAtoms();
+
+		// Probing for keys which are not set does not intern them
+		TS_ASSERT(!ConfMan.hasKey("atom_test_missing_key"));
+		TS_ASSERT_EQUALS(ConfMan.get("atom_test_missing_key"), "");
+		TS_ASSERT_EQUALS(ConfMan.getInt("ATOM_TEST_KEY"), 5);
+		TS_ASSERT_EQUALS(Common::Atom::getNumAtoms(), numAtoms);
+	}
+
+	void test_string_conversion() {
+		Common::Atom a("savepath");
+		const Common::String &str = a;
+		TS_ASSERT_EQUALS(str, "savepath");
+		TS_ASSERT_EQUALS(a + "=", "savepath=");
+	}
+};
@@ -0,0 +1,48 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/config-manager.h"
+#include "common/memstream.h"
+
+class ConfigManagerTestSuite : public CxxTest::TestSuite {
+	static Common::String save() {
+		Common::MemoryWriteStreamDynamic stream(DisposeAfterUse::YES);
+		ConfMan.saveToStream(stream);
+		return Common::String((const char *)stream.getData(), stream.size());
+	}
+
+	static void load(const char *text) {
+		Common::MemoryReadStream stream((const byte *)text, strlen(text));
+		ConfMan.loadFromStream(stream);
+	}
+
+public:
+	void test_round_trip() {
+		// One key per domain, so that the order of the keys is known
+		static const char text[] =
+			"# Global comment\n"
+			"[scummvm]\n"
+			"# Key comment\n"
+			"savepath=/home/user/a/path/longer/than/the/builtin/storage\n"
+			"\n"
+			"[monkey]\n"
+			"gameid=monkey\n"
+			"\n";
+
+		load(text);
+		TS_ASSERT_EQUALS(ConfMan.get("savepath", "scummvm"), "/home/user/a/path/longer/than/the/builtin/storage");
+		TS_ASSERT_EQUALS(ConfMan.get("gameid", "monkey"), "monkey");
+		TS_ASSERT_EQUALS(save(), text);
+
+		load("");
+	}
+
+	void test_empty_values() {
+		load("[scummvm]\nempty=\nvalue=1\n");
+
+		// Empty values and empty domains are not written
+		ConfMan.addMiscDomain("empty_domain");
+		TS_ASSERT_EQUALS(save(), "[scummvm]\nvalue=1\n\n");
+
+		load("");
+	}
+};
@@ -0,0 +1,231 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/deltasave.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+
+class DeltaSaveTestSuite : public CxxTest::TestSuite
+{
+private:
+	typedef Common::HashMap<Common::String, Common::Array<byte> > FileMap;
+
+	/** Stream adding its data to the files of a MemorySaveFileManager when deleted. */
+	class MemoryOutSaveFile : public Common::MemoryWriteStreamDynamic {
+	public:
+		MemoryOutSaveFile(FileMap &files, const Common::String &name)
+			: Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES), _files(files), _name(name) {}
+
+		~MemoryOutSaveFile() {
+			_files[_name] = Common::Array<byte>(getData(), size());
+		}
+
+	private:
+		FileMap &_files;
+		Common::String _name;
+	};
+
+	/** Savefile manager keeping the savefiles in memory. */
+	class MemorySaveFileManager : public Common::SaveFileManager {
+	public:
+		FileMap _files;
+		SaveStatus _status;
+
+		MemorySaveFileManager() : _status(kSaveSucceeded) {}
+
+		SaveStatus getSaveStatus(const Common::String &name) {
+			return _status;
+		}
+
+		Common::OutSaveFile *openForSaving(const Common::String &name, bool compress) {
+			return new MemoryOutSaveFile(_files, name);
+		}
+
+		Common::InSaveFile *openForLoading(const Common::String &name) {
+			if (!_files.contains(name))
+				return 0;
+			const Common::Array<byte> &data = _files[name];
+			return new Common::MemoryReadStream(data.begin(), data.size());
+		}
+
+		bool removeSavefile(const Common::String &name) {
+			if (!_files.contains(name))
+				return false;
+			_files.erase(name);
+			return true;
+		}
+
+		Common::StringArray listSavefiles(const Common::String &pattern) {
+			Common::StringArray list;
+			for (FileMap::const_iterator i = _files.begin(); i != _files.end(); ++i) {
+				if (i->_key.matchString(pattern))
+					list.push_back(i->_key);
+			}
+			return list;
+		}
+
+		uint32 fileSize(const Common::String &name) {
+			return _files.contains(name) ? _files[name].size() : 0;
+		}
+	};
+
+	static void save(MemorySaveFileManager &saveFileMan, const char *name, const byte *data, uint32 size) {
+		Common::OutSaveFile *out = Common::openDeltaSavefileForSaving(&saveFileMan, name);
+		out->write(data, size);
+		out->finalize();
+		TS_ASSERT(!out->err());
+		delete out;
+	}
+
+	static bool load(MemorySaveFileManager &saveFileMan, const char *name, const byte *data, uint32 size) {
+		Common::ScopedPtr<Common::InSaveFile> in(Common::openDeltaSavefileForLoading(&saveFileMan, name));
+		if (!in || in->size() != (int32)size)
+			return false;
+		byte *buffer = new byte[size];
+		const bool result = in->read(buffer, size) == size && !memcmp(buffer, data, size);
+		delete[] buffer;
+		return result;
+	}
+
+public:
+	void test_deltas() {
+		enum {
+			kSize = 100000
+		};
+
+		byte *data = new byte[kSize + 10000];
+		for (uint32 i = 0; i < kSize + 10000; ++i)
+			data[i] = (i * 13 + i / 777) & 0xFF;
+
+		MemorySaveFileManager saveFileMan;
+
+		// The first save is written as a plain savefile, along with its snapshot
+		save(saveFileMan, "game.001", data, kSize);
+		TS_ASSERT_EQUALS(saveFileMan.fileSize("game.001"), (uint32)kSize);
+		TS_ASSERT(!memcmp(saveFileMan._files["game.001"].begin(), data, kSize));
+		TS_ASSERT(saveFileMan.fileSize(".game.001.base") > kSize);
+		TS_ASSERT(load(saveFileMan, "game.001", data, kSize));
+		TS_ASSERT_EQUALS(saveFileMan.listSavefiles("game.*").size(), 1u);
+
+		// Small changes only store the changed blocks
+		data[10] ^= 0xFF;
+		data[50000] ^= 0xFF;
+		save(saveFileMan, "game.001", data, kSize);
+		TS_ASSERT(saveFileMan.fileSize("game.001") < 10000);
+		TS_ASSERT(load(saveFileMan, "game.001", data, kSize));
+
+		// The snapshot is only needed once unchanged data is read
+		Common::Array<byte> base = saveFileMan._files[".game.001.base"];
+		saveFileMan._files.erase(".game.001.base");
+		Common::ScopedPtr<Common::InSaveFile> in(Common::openDeltaSavefileForLoading(&saveFileMan, "game.001"));
+		TS_ASSERT(in);
+		byte header[64];
+		TS_ASSERT_EQUALS(in->read(header, sizeof(header)), sizeof(header));
+		TS_ASSERT(!memcmp(header, data, sizeof(header)));
+		TS_ASSERT(in->seek(5000));
+		TS_ASSERT_DIFFERS(in->read(header, sizeof(header)), sizeof(header));
+		TS_ASSERT(in->err());
+		in.reset();
+		saveFileMan._files[".game.001.base"] = base;
+
+		// Growing and shrinking the data
+		save(saveFileMan, "game.001", data, kSize + 10000);
+		TS_ASSERT(saveFileMan.fileSize("game.001") < 20000);
+		TS_ASSERT(load(saveFileMan, "game.001", data, kSize + 10000));
+		save(saveFileMan, "game.001", data, kSize - 1234);
+		TS_ASSERT(load(saveFileMan, "game.001", data, kSize - 1234));
+
+		// Once most of the data changed, the snapshot is renewed
+		for (uint32 i = 0; i < kSize; i += 2)
+			data[i]++;
+		save(saveFileMan, "game.001", data, kSize);
+		TS_ASSERT_EQUALS(saveFileMan.fileSize("game.001"), (uint32)kSize);
+		TS_ASSERT(load(saveFileMan, "game.001", data, kSize));
+		data[20000]++;
+		save(saveFileMan, "game.001", data, kSize);
+		TS_ASSERT(saveFileMan.fileSize("game.001") < 10000);
+		TS_ASSERT(load(saveFileMan, "game.001", data, kSize));
+
+		// A delta does not load with a different snapshot
+		save(saveFileMan, "game.002", data, kSize / 2);
+		saveFileMan._files[".game.001.base"] = saveFileMan._files[".game.002.base"];
+		TS_ASSERT(!load(saveFileMan, "game.001", data, kSize));
+
+		// Removing a savefile also removes its snapshot
+		TS_ASSERT(Common::removeDeltaSavefile(&saveFileMan, "game.002"));
+		TS_ASSERT(!saveFileMan._files.contains(".game.002.base"));
+		TS_ASSERT(!saveFileMan._files.contains("game.002"));
+
+		delete[] data;
+	}
+
+	void test_pending_snapshot() {
+		enum {
+			kSize = 50000
+		};
+
+		byte *data = new byte[kSize];
+		for (uint32 i = 0; i < kSize; ++i)
+			data[i] = (i * 7 + i / 333) & 0xFF;
+
+		MemorySaveFileManager saveFileMan;
+		save(saveFileMan, "game.001", data, kSize);
+		const Common::Array<byte> base = saveFileMan._files[".game.001.base"];
+
+		// No delta refers to a snapshot which is still being written
+		saveFileMan._status = Common::SaveFileManager::kSavePending;
+		data[100]++;
+		save(saveFileMan, "game.001", data, kSize);
+		TS_ASSERT_EQUALS(saveFileMan.fileSize("game.001"), (uint32)kSize);
+		TS_ASSERT(saveFileMan._files[".game.001.base"] == base);
+		TS_ASSERT(load(saveFileMan, "game.001", data, kSize));
+
+		saveFileMan._status = Common::SaveFileManager::kSaveSucceeded;
+		data[200]++;
+		save(saveFileMan, "game.001", data, kSize);
+		TS_ASSERT(saveFileMan.fileSize("game.001") < 10000);
+		TS_ASSERT(load(saveFileMan, "game.001", data, kSize));
+
+		delete[] data;
+	}
+
+	void test_failed_snapshot() {
+		enum {
+			kSize = 50000
+		};
+
+		byte *data = new byte[kSize];
+		for (uint32 i = 0; i < kSize; ++i)
+			data[i] = (i * 11 + i / 555) & 0xFF;
+
+		MemorySaveFileManager saveFileMan;
+		save(saveFileMan, "game.001", data, kSize);
+		const Common::Array<byte> base = saveFileMan._files[".game.001.base"];
+
+		// Renew the snapshot, but keep the old one on disk, as if writing
+		// the new one failed. The next delta must not refer to it.
+		for (uint32 i = 0; i < kSize; i += 2)
+			data[i]++;
+		save(saveFileMan, "game.001", data, kSize);
+		saveFileMan._files[".game.001.base"] = base;
+
+		data[300]++;
+		save(saveFileMan, "game.001", data, kSize);
+		TS_ASSERT(load(saveFileMan, "game.001", data, kSize));
+
+		delete[] data;
+	}
+
+	void test_plain() {
+		const char text[] = "A savefile written without using deltas";
+
+		MemorySaveFileManager saveFileMan;
+		Common::OutSaveFile *out = saveFileMan.openForSaving("plain.sav", true);
+		out->write(text, sizeof(text));
+		delete out;
+
+		TS_ASSERT(load(saveFileMan, "plain.sav", (const byte *)text, sizeof(text)));
+		TS_ASSERT(!Common::openDeltaSavefileForLoading(&saveFileMan, "missing.sav"));
+	}
+};
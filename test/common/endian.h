@@ -1,5 +1,6 @@
 #include <cxxtest/TestSuite.h>
 #include "common/endian.h"
+#include "common/util.h"
 
 class EndianTestSuite : public CxxTest::TestSuite
 {
@@ -33,4 +34,29 @@ class EndianTestSuite : public CxxTest::TestSuite
 		uint32 value = READ_LE_UINT16(data);
 		TS_ASSERT_EQUALS(value, 0x3412UL);
 	}
+
+	void test_SWAP_BYTES_ARRAY() {
+		// Odd counts to also cover the tails of the vectorized loops
+		uint16 words[67];
+		uint32 dwords[67];
+		for (uint i = 0; i < ARRAYSIZE(words); ++i) {
+			words[i] = i * 0x0103;
+			dwords[i] = i * 0x01020305;
+		}
+
+		SWAP_BYTES_16_ARRAY(words, 37);
+		SWAP_BYTES_32_ARRAY(dwords, 37);
+		for (uint i = 0; i < ARRAYSIZE(words); ++i) {
+			TS_ASSERT_EQUALS(words[i], i < 37 ? SWAP_BYTES_16(i * 0x0103) : i * 0x0103);
+			TS_ASSERT_EQUALS(dwords[i], i < 37 ? SWAP_BYTES_32(i * 0x01020305) : i * 0x01020305);
+		}
+
+		// Unaligned start
+		SWAP_BYTES_16_ARRAY(words + 37, 30);
+		SWAP_BYTES_32_ARRAY(dwords + 37, 30);
+		for (uint i = 37; i < ARRAYSIZE(words); ++i) {
+			TS_ASSERT_EQUALS(words[i], SWAP_BYTES_16(i * 0x0103));
+			TS_ASSERT_EQUALS(dwords[i], SWAP_BYTES_32(i * 0x01020305));
+		}
+	}
 };
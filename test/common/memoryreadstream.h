@@ -100,4 +100,84 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_read_arrays() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		uint16 words[3];
+		uint32 dwords[2];
+		TS_ASSERT_EQUALS(ms.readUint16LEArray(words, 2), 2u);
+		TS_ASSERT_EQUALS(words[0], 0x0201);
+		TS_ASSERT_EQUALS(words[1], 0x0403);
+		TS_ASSERT_EQUALS(ms.readUint32BEArray(dwords, 1), 1u);
+		TS_ASSERT_EQUALS(dwords[0], 0x05060708UL);
+		TS_ASSERT_EQUALS(ms.readUint16BEArray(words, 1), 1u);
+		TS_ASSERT_EQUALS(words[0], 0x090A);
+		TS_ASSERT_EQUALS(ms.pos(), 10);
+		TS_ASSERT(!ms.eos());
+
+		// Only complete words are counted at the end of the stream
+		TS_ASSERT_EQUALS(ms.readUint16LEArray(words, 3), 1u);
+		TS_ASSERT_EQUALS(words[0], 0x0C0B);
+		TS_ASSERT(ms.eos());
+
+		ms.seek(0);
+		int32 sdwords[2];
+		TS_ASSERT_EQUALS(ms.readSint32LEArray(sdwords, 2), 2u);
+		TS_ASSERT_EQUALS(sdwords[0], 0x04030201);
+		TS_ASSERT_EQUALS(sdwords[1], 0x08070605);
+	}
+
+	void test_slice() {
+		byte *contents = (byte *)malloc(10);
+		for (int i = 0; i < 10; ++i)
+			contents[i] = i;
+		Common::MemoryReadStream *ms = new Common::MemoryReadStream(contents, 10, DisposeAfterUse::YES);
+		TS_ASSERT_EQUALS(ms->getData(), contents);
+
+		Common::MemoryReadStream *slice = ms->slice(2, 8);
+		TS_ASSERT_EQUALS(slice->getData(), contents + 2);
+		TS_ASSERT_EQUALS(slice->size(), 6);
+		TS_ASSERT_EQUALS(slice->readByte(), 2);
+		TS_ASSERT_EQUALS(slice->getCurrentData(), contents + 3);
+
+		// Slices of slices share the same buffer, which stays alive until
+		// the last stream using it is gone
+		Common::MemoryReadStream *inner = slice->slice(5, 6);
+		delete ms;
+		delete slice;
+		TS_ASSERT_EQUALS(inner->readByte(), 7);
+		TS_ASSERT(!inner->eos());
+		inner->readByte();
+		TS_ASSERT(inner->eos());
+		delete inner;
+	}
+
+	void test_readStream() {
+		byte *contents = (byte *)malloc(10);
+		for (int i = 0; i < 10; ++i)
+			contents[i] = i;
+
+		// Streams owning their buffer hand out slices of it
+		Common::MemoryReadStream *ms = new Common::MemoryReadStream(contents, 10, DisposeAfterUse::YES);
+		ms->seek(3);
+		Common::SeekableReadStream *sub = ms->readStream(4);
+		TS_ASSERT_EQUALS(ms->pos(), 7);
+		TS_ASSERT_EQUALS(sub->getData(), contents + 3);
+		delete ms;
+		TS_ASSERT_EQUALS(sub->size(), 4);
+		TS_ASSERT_EQUALS(sub->readUint32BE(), 0x03040506UL);
+		delete sub;
+
+		// Other streams copy the data
+		byte buffer[4] = { 1, 2, 3, 4 };
+		Common::MemoryReadStream borrowed(buffer, sizeof(buffer));
+		sub = borrowed.readStream(8);
+		TS_ASSERT(borrowed.eos());
+		TS_ASSERT_EQUALS(sub->size(), 4);
+		TS_ASSERT_DIFFERS(sub->getData(), buffer);
+		TS_ASSERT_EQUALS(sub->readUint32BE(), 0x01020304UL);
+		delete sub;
+	}
 };
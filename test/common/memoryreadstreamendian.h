@@ -110,4 +110,16 @@ class MemoryReadStreamEndianTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT_EQUALS(ms.pos(), 7);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_read_arrays() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6 };
+		Common::MemoryReadStreamEndian le(contents, sizeof(contents), false);
+		Common::MemoryReadStreamEndian be(contents, sizeof(contents), true);
+
+		uint16 words[3];
+		TS_ASSERT_EQUALS(le.readUint16Array(words, 3), 3u);
+		TS_ASSERT_EQUALS(words[2], 0x0605);
+		TS_ASSERT_EQUALS(be.readUint16Array(words, 3), 3u);
+		TS_ASSERT_EQUALS(words[2], 0x0506);
+	}
 };
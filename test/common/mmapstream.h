@@ -0,0 +1,167 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+
+#if defined(POSIX) && !defined(__OS2__) && !defined(DISABLE_MMAP_FILESTREAM)
+#include "backends/fs/posix/posix-mmapstream.h"
+#include "backends/fs/stdiostream.h"
+
+#include <sys/mman.h>
+#define HAVE_MMAP_STREAM
+#endif
+
+class MmapStreamTestSuite : public CxxTest::TestSuite {
+#ifdef HAVE_MMAP_STREAM
+	/** Create a stream over an anonymous mapping, which the stream unmaps. */
+	static PosixMmapStream *makeStream(uint32 size) {
+		void *data = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data == MAP_FAILED)
+			return 0;
+		for (uint32 i = 0; i < size; ++i)
+			((byte *)data)[i] = i & 0xFF;
+		return new PosixMmapStream((const byte *)data, size);
+	}
+
+	/** Write a file in the test directory, with the same contents. */
+	static bool writeFile(const Common::String &path, uint32 size) {
+		Common::WriteStream *file = StdioStream::makeFromPath(path, true);
+		if (!file)
+			return false;
+		for (uint32 i = 0; i < size; ++i)
+			file->writeByte(i & 0xFF);
+		bool ok = file->flush() && !file->err();
+		delete file;
+		return ok;
+	}
+#endif
+
+	public:
+	void test_seek() {
+#ifdef HAVE_MMAP_STREAM
+		PosixMmapStream *ms = makeStream(1000);
+		TS_ASSERT(ms);
+		if (!ms)
+			return;
+
+		TS_ASSERT_EQUALS(ms->size(), 1000);
+		TS_ASSERT(ms->seek(300, SEEK_SET));
+		TS_ASSERT_EQUALS(ms->pos(), 300);
+		TS_ASSERT(ms->seek(-100, SEEK_CUR));
+		TS_ASSERT_EQUALS(ms->pos(), 200);
+		TS_ASSERT_EQUALS(ms->readByte(), 200);
+		TS_ASSERT(ms->seek(-1, SEEK_END));
+		TS_ASSERT_EQUALS(ms->pos(), 999);
+		TS_ASSERT_EQUALS(ms->readByte(), 999 & 0xFF);
+		TS_ASSERT(!ms->eos());
+
+		// Seeking before the start fails and keeps the position
+		TS_ASSERT(!ms->seek(-1, SEEK_SET));
+		TS_ASSERT_EQUALS(ms->pos(), 1000);
+
+		delete ms;
+#endif
+	}
+
+	void test_eos() {
+#ifdef HAVE_MMAP_STREAM
+		PosixMmapStream *ms = makeStream(100);
+		TS_ASSERT(ms);
+		if (!ms)
+			return;
+
+		byte buffer[64];
+		TS_ASSERT(ms->seek(50));
+		TS_ASSERT_EQUALS(ms->read(buffer, sizeof(buffer)), 50u);
+		TS_ASSERT_EQUALS(buffer[0], 50);
+		TS_ASSERT_EQUALS(buffer[49], 99);
+		TS_ASSERT(ms->eos());
+
+		// Like fseek(), seeking clears eos and may go past the end
+		TS_ASSERT(ms->seek(200));
+		TS_ASSERT(!ms->eos());
+		TS_ASSERT_EQUALS(ms->read(buffer, 1), 0u);
+		TS_ASSERT(ms->eos());
+		TS_ASSERT(!ms->err());
+
+		delete ms;
+#endif
+	}
+
+	void test_get_data() {
+#ifdef HAVE_MMAP_STREAM
+		PosixMmapStream *ms = makeStream(4096);
+		TS_ASSERT(ms);
+		if (!ms)
+			return;
+
+		const byte *data = ms->getData();
+		TS_ASSERT(data);
+		TS_ASSERT_EQUALS(data[0], 0);
+		TS_ASSERT_EQUALS(data[4095], 4095 & 0xFF);
+
+		// Reading does not affect the data
+		ms->skip(10);
+		TS_ASSERT_EQUALS(ms->getData(), data);
+
+		delete ms;
+#endif
+	}
+
+	void test_make_from_path() {
+#ifdef HAVE_MMAP_STREAM
+		// Only regular files are mapped
+		TS_ASSERT(!PosixMmapStream::makeFromPath("."));
+		TS_ASSERT(!PosixMmapStream::makeFromPath("mmapstream-test-missing-file"));
+#endif
+	}
+
+	void test_map_file() {
+#ifdef HAVE_MMAP_STREAM
+		const Common::String path = "test/mmapstream.tmp";
+		const uint32 size = PosixMmapStream::kMinMappedSize + 1000;
+		TS_ASSERT(writeFile(path, size));
+
+		PosixMmapStream *ms = PosixMmapStream::makeFromPath(path);
+		TS_ASSERT(ms);
+		if (!ms)
+			return;
+
+		TS_ASSERT_EQUALS(ms->size(), (int32)size);
+		const byte *data = ms->getData();
+		TS_ASSERT(data);
+		TS_ASSERT_EQUALS(data[0], 0);
+		TS_ASSERT_EQUALS(data[size - 1], (size - 1) & 0xFF);
+
+		byte buffer[16];
+		TS_ASSERT(ms->seek(-8, SEEK_END));
+		TS_ASSERT_EQUALS(ms->read(buffer, sizeof(buffer)), 8u);
+		TS_ASSERT_EQUALS(buffer[7], (size - 1) & 0xFF);
+		TS_ASSERT(ms->eos());
+		TS_ASSERT(!ms->err());
+
+		delete ms;
+#endif
+	}
+
+	void test_small_file_not_mapped() {
+#ifdef HAVE_MMAP_STREAM
+		const Common::String path = "test/mmapstream-small.tmp";
+		TS_ASSERT(writeFile(path, PosixMmapStream::kMinMappedSize - 1));
+		TS_ASSERT(!PosixMmapStream::makeFromPath(path));
+#endif
+	}
+
+	void test_written_file_not_mapped() {
+#ifdef HAVE_MMAP_STREAM
+		// Use a file of its own, the exclusion lasts for the whole session
+		const Common::String path = "test/mmapstream-written.tmp";
+		PosixMmapStream::excludeWrittenFile(path);
+		TS_ASSERT(writeFile(path, PosixMmapStream::kMinMappedSize * 2));
+		TS_ASSERT(!PosixMmapStream::makeFromPath(path));
+
+		// Rewriting the file keeps it excluded
+		TS_ASSERT(writeFile(path, PosixMmapStream::kMinMappedSize * 3));
+		TS_ASSERT(!PosixMmapStream::makeFromPath(path));
+#endif
+	}
+};
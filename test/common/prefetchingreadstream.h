@@ -0,0 +1,102 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bufferedstream.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+
+class PrefetchingReadStreamTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kDataSize = 100000
+	};
+
+	/** Stream which does not expose its data, so it is not bypassed. */
+	class OpaqueStream : public Common::SeekableReadStream {
+	public:
+		Common::MemoryReadStream _stream;
+
+		OpaqueStream(const byte *data, uint32 size) : _stream(data, size) {}
+
+		bool eos() const { return _stream.eos(); }
+		uint32 read(void *dataPtr, uint32 dataSize) { return _stream.read(dataPtr, dataSize); }
+		int32 pos() const { return _stream.pos(); }
+		int32 size() const { return _stream.size(); }
+		bool seek(int32 offset, int whence = SEEK_SET) { return _stream.seek(offset, whence); }
+	};
+
+	byte *_data;
+
+	bool verify(Common::SeekableReadStream &stream, uint32 pos, uint32 size) {
+		byte buffer[5000];
+		assert(size <= sizeof(buffer));
+		if ((uint32)stream.pos() != pos)
+			return false;
+		return stream.read(buffer, size) == size && !memcmp(buffer, _data + pos, size);
+	}
+
+public:
+	void setUp() {
+		_data = new byte[kDataSize];
+		for (uint32 i = 0; i < kDataSize; ++i)
+			_data[i] = (i * 31 + i / 256) & 0xFF;
+	}
+
+	void tearDown() {
+		delete[] _data;
+	}
+
+	void test_traverse() {
+		OpaqueStream *parent = new OpaqueStream(_data, kDataSize);
+		parent->seek(10);
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapPrefetchingReadStream(parent, 1024, DisposeAfterUse::YES));
+
+		// Reads of all sizes, within and across buffers
+		TS_ASSERT_EQUALS(stream->size(), (int32)kDataSize);
+		uint32 pos = 10;
+		for (uint32 size = 1; pos + size <= kDataSize; size = (size * 3) % 4999 + 1) {
+			TS_ASSERT(verify(*stream, pos, size));
+			pos += size;
+		}
+
+		TS_ASSERT(verify(*stream, pos, kDataSize - pos));
+		TS_ASSERT(!stream->eos());
+		byte b;
+		TS_ASSERT_EQUALS(stream->read(&b, 1), 0u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+	}
+
+	void test_seek() {
+		OpaqueStream parent(_data, kDataSize);
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapPrefetchingReadStream(&parent, 4096, DisposeAfterUse::NO));
+
+		// Seeks within the current buffer, into the prefetched one and
+		// far away
+		TS_ASSERT(verify(*stream, 0, 100));
+		TS_ASSERT(stream->seek(50, SEEK_CUR));
+		TS_ASSERT(verify(*stream, 150, 100));
+		TS_ASSERT(stream->seek(5000));
+		TS_ASSERT(verify(*stream, 5000, 100));
+		TS_ASSERT(stream->seek(-100, SEEK_END));
+		TS_ASSERT(verify(*stream, kDataSize - 100, 100));
+		TS_ASSERT(stream->seek(0, SEEK_END));
+		TS_ASSERT(!stream->seek(1, SEEK_END));
+		TS_ASSERT(!stream->seek(-1));
+
+		uint32 pos = 12345;
+		for (int i = 0; i < 200; ++i) {
+			pos = (pos * 1103515245 + 12345) % (kDataSize - 5000);
+			TS_ASSERT(stream->seek(pos));
+			TS_ASSERT(verify(*stream, pos, (pos % 4999) + 1));
+		}
+
+		// Seeking clears the end of stream flag
+		TS_ASSERT(stream->seek(kDataSize - 1));
+		TS_ASSERT(verify(*stream, kDataSize - 1, 1));
+		stream->readByte();
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(stream->seek(0));
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT(verify(*stream, 0, 10));
+	}
+};
@@ -0,0 +1,65 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/ringbuffer.h"
+
+class RingBufferTestSuite : public CxxTest::TestSuite {
+public:
+	void test_capacity() {
+		Common::RingBuffer ring(100);
+		TS_ASSERT_EQUALS(ring.getCapacity(), 128u);
+		TS_ASSERT_EQUALS(ring.getAvailable(), 0u);
+		TS_ASSERT_EQUALS(ring.getFree(), 128u);
+	}
+
+	void test_fifo() {
+		Common::RingBuffer ring(16);
+		byte data[20], out[20];
+		for (int i = 0; i < 20; ++i)
+			data[i] = i;
+
+		TS_ASSERT_EQUALS(ring.write(data, 10), 10u);
+		TS_ASSERT_EQUALS(ring.getAvailable(), 10u);
+
+		// Only as much as is available can be read
+		TS_ASSERT_EQUALS(ring.read(out, 4), 4u);
+		TS_ASSERT_EQUALS(memcmp(out, data, 4), 0);
+
+		// Only as much as fits can be written, wrapping around the end
+		TS_ASSERT_EQUALS(ring.write(data + 10, 10), 10u);
+		TS_ASSERT_EQUALS(ring.getFree(), 0u);
+		TS_ASSERT_EQUALS(ring.write(data, 1), 0u);
+
+		TS_ASSERT_EQUALS(ring.read(out, 20), 16u);
+		TS_ASSERT_EQUALS(memcmp(out, data + 4, 16), 0);
+		TS_ASSERT_EQUALS(ring.read(out, 1), 0u);
+	}
+
+	void test_write_buffer() {
+		Common::RingBuffer ring(8);
+		byte data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		byte out[8];
+		uint32 len;
+
+		ring.write(data, 6);
+		ring.read(out, 4);
+
+		// The free area is split by the end of the buffer
+		byte *buf = ring.getWriteBuffer(len);
+		TS_ASSERT_EQUALS(len, 2u);
+		buf[0] = 9;
+		buf[1] = 10;
+		ring.commitWrite(2);
+
+		buf = ring.getWriteBuffer(len);
+		TS_ASSERT_EQUALS(len, 4u);
+		buf[0] = 11;
+		ring.commitWrite(1);
+
+		TS_ASSERT_EQUALS(ring.read(out, 8), 5u);
+		const byte expected[5] = { 5, 6, 9, 10, 11 };
+		TS_ASSERT_EQUALS(memcmp(out, expected, 5), 0);
+
+		ring.clear();
+		TS_ASSERT_EQUALS(ring.getAvailable(), 0u);
+	}
+};
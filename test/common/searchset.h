@@ -0,0 +1,140 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+
+class SearchSetTestSuite : public CxxTest::TestSuite
+{
+private:
+	/** Archive containing members with the given names, counting queries. */
+	class TestArchive : public Common::Archive {
+	public:
+		Common::String _members;
+		mutable int _queries;
+		byte _id;
+
+		TestArchive(const char *members, byte id) : _members(members), _queries(0), _id(id) {}
+
+		bool hasFile(const Common::String &name) const {
+			_queries++;
+			return _members.contains(name);
+		}
+
+		int listMembers(Common::ArchiveMemberList &list) const {
+			return 0;
+		}
+
+		const Common::ArchiveMemberPtr getMember(const Common::String &name) const {
+			return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+		}
+
+		Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+			if (!hasFile(name))
+				return 0;
+			return new Common::MemoryReadStream(&_id, 1);
+		}
+	};
+
+	static int readId(Common::SeekableReadStream *stream) {
+		if (!stream)
+			return -1;
+		const int id = stream->readByte();
+		delete stream;
+		return id;
+	}
+
+public:
+	void test_lookup() {
+		Common::SearchSet set;
+		TestArchive *low = new TestArchive("a b", 1);
+		TestArchive *high = new TestArchive("b c", 2);
+		set.add("low", low, 0);
+		set.add("high", high, 10);
+
+		// Higher priority archives are preferred
+		TS_ASSERT_EQUALS(readId(set.createReadStreamForMember("a")), 1);
+		TS_ASSERT_EQUALS(readId(set.createReadStreamForMember("b")), 2);
+		TS_ASSERT_EQUALS(readId(set.createReadStreamForMember("c")), 2);
+		TS_ASSERT_EQUALS(readId(set.createReadStreamForMember("d")), -1);
+
+		// Repeated lookups, including of missing names, are answered
+		// without asking all archives again
+		const int lowQueries = low->_queries;
+		const int highQueries = high->_queries;
+		TS_ASSERT(set.hasFile("a"));
+		TS_ASSERT(!set.hasFile("d"));
+		TS_ASSERT(set.getMember("b"));
+		TS_ASSERT(!set.getMember("d"));
+		TS_ASSERT_EQUALS(low->_queries, lowQueries);
+		TS_ASSERT_EQUALS(high->_queries, highQueries);
+
+		uint32 lookups, misses;
+		set.getLookupStats(lookups, misses);
+		TS_ASSERT_EQUALS(lookups, 8u);
+		TS_ASSERT_EQUALS(misses, 4u);
+
+		// Changing the priorities changes the resolution
+		set.setPriority("low", 20);
+		TS_ASSERT_EQUALS(readId(set.createReadStreamForMember("b")), 1);
+
+		// Added and removed archives are taken into account
+		set.add("other", new TestArchive("d", 3), 30);
+		TS_ASSERT_EQUALS(readId(set.createReadStreamForMember("d")), 3);
+		set.remove("low");
+		TS_ASSERT_EQUALS(readId(set.createReadStreamForMember("a")), -1);
+		TS_ASSERT_EQUALS(readId(set.createReadStreamForMember("b")), 2);
+
+		// Changes to the archives themselves need an explicit invalidation
+		high->_members += " a";
+		TS_ASSERT(!set.hasFile("a"));
+		set.invalidateIndex();
+		TS_ASSERT(set.hasFile("a"));
+	}
+
+	void test_nested() {
+		// Engines keep archives they load and unload in a set which is part
+		// of another set
+		Common::SearchSet outer;
+		Common::SearchSet *inner = new Common::SearchSet();
+		outer.add("inner", inner, 0);
+		outer.add("other", new TestArchive("a", 1), 10);
+
+		TS_ASSERT(!outer.hasFile("b"));
+		TS_ASSERT(!outer.hasFile("c"));
+
+		inner->add("pak", new TestArchive("b", 2));
+		TS_ASSERT_EQUALS(readId(outer.createReadStreamForMember("b")), 2);
+		TS_ASSERT(!outer.hasFile("c"));
+
+		inner->remove("pak");
+		TS_ASSERT(!outer.hasFile("b"));
+		TS_ASSERT_EQUALS(readId(outer.createReadStreamForMember("a")), 1);
+
+		// Changes to sets nested deeper are noticed as well
+		Common::SearchSet *innermost = new Common::SearchSet();
+		inner->add("innermost", innermost);
+		TS_ASSERT(!outer.hasFile("c"));
+		innermost->add("pak", new TestArchive("c", 3));
+		TS_ASSERT_EQUALS(readId(outer.createReadStreamForMember("c")), 3);
+	}
+
+	void test_unrelated_sets() {
+		Common::SearchSet set;
+		TestArchive *archive = new TestArchive("a", 1);
+		set.add("archive", archive);
+		TS_ASSERT(set.hasFile("a"));
+		TS_ASSERT(!set.hasFile("b"));
+
+		// Other sets changing, like temporary ones being filled and
+		// destroyed, keep the index of the set
+		const int queries = archive->_queries;
+		{
+			Common::SearchSet temporary;
+			temporary.add("other", new TestArchive("b", 2));
+			temporary.clear();
+		}
+		TS_ASSERT(set.hasFile("a"));
+		TS_ASSERT(!set.hasFile("b"));
+		TS_ASSERT_EQUALS(archive->_queries, queries);
+	}
+};
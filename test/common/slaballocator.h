@@ -0,0 +1,146 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/slaballocator.h"
+
+#if defined(USE_PTHREADS)
+#include <pthread.h>
+#endif
+
+class SlabAllocatorTestSuite : public CxxTest::TestSuite {
+	struct Base : public Common::SlabAllocated {
+		int _a;
+		Base() : _a(1) {}
+		virtual ~Base() {}
+	};
+
+	struct Derived : public Base {
+		byte _data[300];
+		Derived() { memset(_data, 0xAA, sizeof(_data)); }
+	};
+
+public:
+	void test_sizes() {
+		void *blocks[301];
+		for (uint size = 0; size <= 300; ++size) {
+			blocks[size] = SlabMan.allocate(size);
+			TS_ASSERT(blocks[size] != 0);
+			TS_ASSERT_EQUALS((size_t)blocks[size] & 7, 0u);
+			memset(blocks[size], size & 0xFF, size);
+		}
+
+		for (uint size = 0; size <= 300; ++size) {
+			const byte *data = (const byte *)blocks[size];
+			uint i;
+			for (i = 0; i < size; ++i) {
+				if (data[i] != (size & 0xFF))
+					break;
+			}
+			TS_ASSERT_EQUALS(i, size);
+		}
+
+		for (uint size = 0; size <= 300; ++size)
+			SlabMan.deallocate(blocks[size], size);
+	}
+
+	void test_stats() {
+		const uint count = 2000;
+		void **blocks = new void *[count];
+
+		Common::SlabAllocator::Stats before, stats;
+		// 40 bytes are rounded up to the 48 byte size class
+		SlabMan.getStats(4, before);
+		TS_ASSERT_EQUALS(before.chunkSize, 48u);
+		const uint32 reserved = SlabMan.getReservedBytes();
+
+		for (uint i = 0; i < count; ++i)
+			blocks[i] = SlabMan.allocate(40);
+
+		SlabMan.getStats(4, stats);
+		// Some allocations may have been served by the thread cache
+		TS_ASSERT_LESS_THAN_EQUALS(before.numChunks + count, stats.numChunks + Common::SlabAllocator::kThreadCacheSize);
+		TS_ASSERT_LESS_THAN_EQUALS(before.numPages + count * 48 / Common::SlabAllocator::kPageSize, stats.numPages);
+
+		for (uint i = 0; i < count; ++i)
+			SlabMan.deallocate(blocks[i], 40);
+		delete[] blocks;
+
+		// All but the chunks kept in the thread cache are back in the pages
+		SlabMan.getStats(4, stats);
+		TS_ASSERT_LESS_THAN_EQUALS(stats.numChunks, before.numChunks + Common::SlabAllocator::kThreadCacheSize);
+		TS_ASSERT_LESS_THAN_EQUALS(stats.numPages, before.numPages + 2);
+
+		// At most the pages holding cached chunks can keep a new block alive
+		SlabMan.freeUnusedPages();
+		TS_ASSERT_LESS_THAN_EQUALS(SlabMan.getReservedBytes(), reserved + 17 * Common::SlabAllocator::kPageSize);
+	}
+
+	void test_interleaved() {
+		// Free chunks in a different order than they were allocated
+		const uint count = 1000;
+		void *blocks[count];
+		for (uint i = 0; i < count; ++i) {
+			blocks[i] = SlabMan.allocate(24);
+			*(uint32 *)blocks[i] = i;
+		}
+		for (uint i = 0; i < count; i += 2)
+			SlabMan.deallocate(blocks[i], 24);
+		for (uint i = 0; i < count; i += 2) {
+			blocks[i] = SlabMan.allocate(24);
+			*(uint32 *)blocks[i] = i;
+		}
+
+		uint i;
+		for (i = 0; i < count; ++i) {
+			if (*(uint32 *)blocks[i] != i)
+				break;
+		}
+		TS_ASSERT_EQUALS(i, count);
+
+		for (i = 0; i < count; ++i)
+			SlabMan.deallocate(blocks[i], 24);
+	}
+
+	void test_null() {
+		SlabMan.deallocate(0, 40);
+		SlabMan.deallocate(0, 1000);
+	}
+
+#if defined(USE_PTHREADS)
+	static void *allocThread(void *) {
+		void *blocks[10];
+		for (uint i = 0; i < ARRAYSIZE(blocks); ++i)
+			blocks[i] = SlabMan.allocate(150);
+		for (uint i = 0; i < ARRAYSIZE(blocks); ++i)
+			SlabMan.deallocate(blocks[i], 150);
+		return 0;
+	}
+#endif
+
+	void test_thread_exit() {
+#if defined(USE_PTHREADS)
+		// 150 bytes are rounded up to the 160 byte size class, which no
+		// other test uses
+		Common::SlabAllocator::Stats before, stats;
+		SlabMan.getStats(9, before);
+
+		pthread_t thread;
+		TS_ASSERT_EQUALS(pthread_create(&thread, 0, allocThread, 0), 0);
+		pthread_join(thread, 0);
+
+		// The cache of the thread was returned when it exited
+		SlabMan.getStats(9, stats);
+		TS_ASSERT_EQUALS(stats.numChunks, before.numChunks);
+		TS_ASSERT_EQUALS(stats.numAllocs, before.numAllocs + 10);
+		TS_ASSERT_EQUALS(stats.numFrees, before.numFrees + 10);
+#endif
+	}
+
+	void test_slab_allocated() {
+		Base *small = new Base();
+		Base *large = new Derived();
+		TS_ASSERT_EQUALS(small->_a, 1);
+		TS_ASSERT_EQUALS(((Derived *)large)->_data[299], 0xAA);
+		delete small;
+		delete large;
+	}
+};
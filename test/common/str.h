@@ -60,6 +60,116 @@ class StringTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(str, "fooX");
 	}
 
+	void test_concat_operators() {
+		Common::String shortStr("foo");
+		Common::String longStr("12345678901234567890123456789012");
+		TS_ASSERT_EQUALS(shortStr + longStr, "foo12345678901234567890123456789012");
+		TS_ASSERT_EQUALS(longStr + shortStr, "12345678901234567890123456789012foo");
+		TS_ASSERT_EQUALS("bar" + longStr, "bar12345678901234567890123456789012");
+		TS_ASSERT_EQUALS(longStr + "bar", "12345678901234567890123456789012bar");
+		TS_ASSERT_EQUALS(longStr + 'X', "12345678901234567890123456789012X");
+		TS_ASSERT_EQUALS(longStr + Common::String(), longStr);
+		TS_ASSERT_EQUALS(Common::String() + longStr, longStr);
+		TS_ASSERT_EQUALS(shortStr + "", "foo");
+	}
+
+	void test_append() {
+		Common::String str("foo");
+		str.append("barbaz", 3);
+		TS_ASSERT_EQUALS(str, "foobar");
+		TS_ASSERT_EQUALS(str.size(), 6u);
+		str.append("x", 0);
+		TS_ASSERT_EQUALS(str, "foobar");
+
+		// Appending part of itself, while switching to external storage
+		Common::String str2("12345678901234567890");
+		str2.append(str2.c_str() + 10, 10);
+		TS_ASSERT_EQUALS(str2, "123456789012345678901234567890");
+		str2.append(str2.c_str(), 30);
+		TS_ASSERT_EQUALS(str2, "123456789012345678901234567890123456789012345678901234567890");
+	}
+
+	void test_reserve() {
+		Common::String str("foo");
+		str.reserve(100);
+		TS_ASSERT_EQUALS(str, "foo");
+		const char *storage = str.c_str();
+		for (int i = 0; i < 97; ++i)
+			str += 'x';
+		TS_ASSERT_EQUALS(str.c_str(), storage);
+		TS_ASSERT_EQUALS(str.size(), 100u);
+
+		// Reserving unshares the storage
+		Common::String str2(str);
+		str2.reserve(10);
+		TS_ASSERT_DIFFERS(str.c_str(), str2.c_str());
+		TS_ASSERT_EQUALS(str, str2);
+	}
+
+	void test_string_builder() {
+		Common::StringBuilder builder(64);
+		builder << "key" << '=' << Common::String("value");
+		builder.append("\njunk", 1);
+		TS_ASSERT_EQUALS(builder.str(), "key=value\n");
+		TS_ASSERT_EQUALS(builder.size(), 10u);
+
+		Common::String line = builder.str();
+		builder.clear();
+		TS_ASSERT_EQUALS(builder.size(), 0u);
+		builder << "other";
+		TS_ASSERT_EQUALS(builder.str(), "other");
+		TS_ASSERT_EQUALS(line, "key=value\n");
+	}
+
+	void test_string_builder_growth() {
+		Common::StringBuilder builder;
+		const char *storage = builder.str().c_str();
+		int reallocations = 0;
+		for (int i = 0; i < 100000; ++i) {
+			builder << (char)('a' + i % 26);
+			if (builder.str().c_str() != storage) {
+				storage = builder.str().c_str();
+				++reallocations;
+			}
+		}
+		TS_ASSERT_EQUALS(builder.size(), 100000u);
+		TS_ASSERT(builder.capacity() >= builder.size());
+
+		// Doubling the storage takes 13 steps from the internal storage
+		TS_ASSERT_LESS_THAN(reallocations, 20);
+
+		// Appending a piece of the string itself
+		Common::StringBuilder self;
+		self << "0123456789";
+		for (int i = 0; i < 5; ++i)
+			self.append(self.str().c_str(), self.size());
+		TS_ASSERT_EQUALS(self.size(), 320u);
+		TS_ASSERT_EQUALS(self.str()[319], '9');
+	}
+
+	void test_move() {
+#if __cplusplus >= 201103L
+		Common::String longStr("12345678901234567890123456789012");
+		const char *storage = longStr.c_str();
+		Common::String moved(static_cast<Common::String &&>(longStr));
+		TS_ASSERT_EQUALS(moved.c_str(), storage);
+		TS_ASSERT(longStr.empty());
+
+		Common::String shortStr("foo");
+		Common::String moved2(static_cast<Common::String &&>(shortStr));
+		TS_ASSERT_EQUALS(moved2, "foo");
+		TS_ASSERT(shortStr.empty());
+
+		moved2 = static_cast<Common::String &&>(moved);
+		TS_ASSERT_EQUALS(moved2.c_str(), storage);
+		TS_ASSERT(moved.empty());
+
+		moved = static_cast<Common::String &&>(moved2);
+		moved = static_cast<Common::String &&>(moved);
+		TS_ASSERT_EQUALS(moved, "12345678901234567890123456789012");
+#endif
+	}
+
 	void test_refCount() {
 		// using internal storage
 		Common::String foo1("foo");
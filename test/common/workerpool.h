@@ -0,0 +1,60 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+#include "common/util.h"
+#include "common/workerpool.h"
+
+class WorkerPoolTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kNumJobs = 1000
+	};
+
+	struct Jobs {
+		volatile uint32 calls[kNumJobs];
+		volatile uint32 total;
+	};
+
+	static void countJob(void *refCon, uint index) {
+		Jobs *jobs = (Jobs *)refCon;
+		Common::atomicAdd(jobs->calls[index], 1);
+		Common::atomicAdd(jobs->total, 1);
+	}
+
+	static bool ranOnce(Jobs &jobs, uint count) {
+		for (uint i = 0; i < kNumJobs; ++i) {
+			if (jobs.calls[i] != (i < count ? 1u : 0u))
+				return false;
+		}
+		return jobs.total == count;
+	}
+
+public:
+	void test_run() {
+		Common::WorkerPool pool(4);
+		TS_ASSERT_LESS_THAN_EQUALS(1u, pool.getNumThreads());
+		TS_ASSERT_LESS_THAN_EQUALS(pool.getNumThreads(), 4u);
+
+		// Each job runs exactly once per batch, also for repeated batches
+		// of different sizes
+		static const uint counts[] = { kNumJobs, 0, 1, 2, 17, kNumJobs };
+		for (uint i = 0; i < ARRAYSIZE(counts); ++i) {
+			Jobs jobs;
+			memset((void *)&jobs, 0, sizeof(jobs));
+			pool.run(countJob, &jobs, counts[i]);
+			TS_ASSERT(ranOnce(jobs, counts[i]));
+		}
+	}
+
+	void test_default_threads() {
+		Common::WorkerPool pool;
+		TS_ASSERT_LESS_THAN_EQUALS(1u, pool.getNumThreads());
+		TS_ASSERT_LESS_THAN_EQUALS(pool.getNumThreads(), Common::WorkerPool::getNumCPUs());
+
+		Jobs jobs;
+		memset((void *)&jobs, 0, sizeof(jobs));
+		pool.run(countJob, &jobs, kNumJobs);
+		TS_ASSERT(ranOnce(jobs, kNumJobs));
+	}
+};
@@ -0,0 +1,296 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+#ifdef POSIX
+#include "backends/fs/stdiostream.h"
+#endif
+
+class ZipTestSuite : public CxxTest::TestSuite
+{
+private:
+	struct Member {
+		const char *name;
+		const byte *data;
+		uint32 size;
+		bool compress;
+		bool badCrc;
+
+		Common::Array<byte> stored;
+		uint32 crc;
+		uint32 offset;
+	};
+
+	static void writeHeader(Common::WriteStream &out, const Member &member, bool central) {
+		out.writeUint32LE(central ? 0x02014b50 : 0x04034b50);
+		if (central)
+			out.writeUint16LE(20);	// version made by
+		out.writeUint16LE(20);		// version needed
+		out.writeUint16LE(0);		// flags
+		out.writeUint16LE(member.compress ? 8 : 0);
+		out.writeUint32LE(0);		// time and date
+		out.writeUint32LE(member.badCrc ? ~member.crc : member.crc);
+		out.writeUint32LE(member.stored.size());
+		out.writeUint32LE(member.size);
+		out.writeUint16LE(strlen(member.name));
+		out.writeUint16LE(0);		// extra field
+		if (central) {
+			out.writeUint16LE(0);	// comment
+			out.writeUint16LE(0);	// disk number
+			out.writeUint16LE(0);	// internal attributes
+			out.writeUint32LE(0);	// external attributes
+			out.writeUint32LE(member.offset);
+		}
+		out.write(member.name, strlen(member.name));
+	}
+
+	/**
+	 * Build a ZIP archive in memory. The deflate data and CRCs are taken
+	 * from gzip streams, which consist of a 10 byte header, the raw deflate
+	 * data and an 8 byte trailer holding CRC and size.
+	 */
+	static void buildArchive(Common::MemoryWriteStreamDynamic &out, Member *members, int count) {
+		for (int i = 0; i < count; ++i) {
+			// The compressing stream takes ownership of the memory stream,
+			// but not of its data.
+			Common::MemoryWriteStreamDynamic *gzip = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+			Common::WriteStream *compressed = Common::wrapCompressedWriteStream(gzip);
+			compressed->write(members[i].data, members[i].size);
+			compressed->finalize();
+
+			byte *gzipData = gzip->getData();
+			const uint32 gzipSize = gzip->size();
+			delete compressed;
+
+			members[i].crc = READ_LE_UINT32(gzipData + gzipSize - 8);
+			if (members[i].compress)
+				members[i].stored = Common::Array<byte>(gzipData + 10, gzipSize - 18);
+			else
+				members[i].stored = Common::Array<byte>(members[i].data, members[i].size);
+			free(gzipData);
+		}
+
+		for (int i = 0; i < count; ++i) {
+			members[i].offset = out.pos();
+			writeHeader(out, members[i], false);
+			out.write(members[i].stored.begin(), members[i].stored.size());
+		}
+
+		const uint32 centralDir = out.pos();
+		for (int i = 0; i < count; ++i)
+			writeHeader(out, members[i], true);
+		const uint32 centralDirSize = out.pos() - centralDir;
+
+		out.writeUint32LE(0x06054b50);
+		out.writeUint16LE(0);		// disk number
+		out.writeUint16LE(0);		// disk with central directory
+		out.writeUint16LE(count);
+		out.writeUint16LE(count);
+		out.writeUint32LE(centralDirSize);
+		out.writeUint32LE(centralDir);
+		out.writeUint16LE(0);		// comment
+	}
+
+	/** Open the archive from a memory stream, which inflates all members into memory. */
+	static Common::Archive *makeArchive(Member *members, int count) {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::NO);
+		buildArchive(out, members, count);
+		return Common::makeZipArchive(new Common::MemoryReadStream(out.getData(), out.size(), DisposeAfterUse::YES));
+	}
+
+#ifdef POSIX
+	/** A file on disk, which is opened anew for every stream on it. */
+	class FileMember : public Common::ArchiveMember {
+		const Common::String _path;
+
+	public:
+		FileMember(const Common::String &path) : _path(path) {}
+
+		Common::SeekableReadStream *createReadStream() const { return StdioStream::makeFromPath(_path, false); }
+		Common::String getName() const { return _path; }
+	};
+
+	/**
+	 * Open the archive from a file in the test directory, so that large
+	 * and stored members are streamed from it.
+	 */
+	static Common::Archive *makeFileArchive(Member *members, int count) {
+		const Common::String path = "test/zip.tmp";
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		buildArchive(out, members, count);
+
+		Common::WriteStream *file = StdioStream::makeFromPath(path, true);
+		if (!file)
+			return 0;
+		file->write(out.getData(), out.size());
+		file->finalize();
+		const bool written = !file->err();
+		delete file;
+
+		if (!written)
+			return 0;
+		return Common::makeZipArchive(Common::ArchiveMemberPtr(new FileMember(path)));
+	}
+#endif
+
+	static bool equals(Common::SeekableReadStream &stream, const byte *data, uint32 size) {
+		byte *buffer = new byte[size];
+		const bool result = stream.read(buffer, size) == size && !memcmp(buffer, data, size);
+		delete[] buffer;
+		return result;
+	}
+
+	enum {
+		kLargeSize = 300 * 1024
+	};
+
+	byte *_large;
+
+	static const char *smallData() { return "A small compressed member, which is inflated into memory"; }
+	static const char *storedData() { return "This member is stored without compression"; }
+
+	/** A large and a small deflated member, and a stored one. */
+	void setUpMembers(Member *members) {
+		const char *small = smallData();
+		const char *stored = storedData();
+
+		members[0].name = "large.bin";
+		members[0].data = _large;
+		members[0].size = kLargeSize;
+		members[0].compress = true;
+		members[0].badCrc = false;
+		members[1].name = "small.txt";
+		members[1].data = (const byte *)small;
+		members[1].size = strlen(small) + 1;
+		members[1].compress = true;
+		members[1].badCrc = false;
+		members[2].name = "stored.txt";
+		members[2].data = (const byte *)stored;
+		members[2].size = strlen(stored) + 1;
+		members[2].compress = false;
+		members[2].badCrc = false;
+	}
+
+	void checkMembers(Common::Archive *archive) {
+		const char *small = smallData();
+		const char *stored = storedData();
+		const uint32 smallSize = strlen(small) + 1;
+		const uint32 storedSize = strlen(stored) + 1;
+
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		TS_ASSERT(!archive->createReadStreamForMember("missing.txt"));
+
+		Common::ScopedPtr<Common::SeekableReadStream> smallStream(archive->createReadStreamForMember("small.txt"));
+		TS_ASSERT(smallStream);
+		TS_ASSERT_EQUALS(smallStream->size(), (int32)smallSize);
+		TS_ASSERT(equals(*smallStream, (const byte *)small, smallSize));
+
+		// Read a deflated and a stored member in an interleaved manner
+		Common::ScopedPtr<Common::SeekableReadStream> largeStream(archive->createReadStreamForMember("LARGE.BIN"));
+		Common::ScopedPtr<Common::SeekableReadStream> storedStream(archive->createReadStreamForMember("stored.txt"));
+		TS_ASSERT(largeStream);
+		TS_ASSERT(storedStream);
+		TS_ASSERT_EQUALS(largeStream->size(), (int32)kLargeSize);
+		TS_ASSERT_EQUALS(storedStream->size(), (int32)storedSize);
+
+		for (uint32 i = 0; i < storedSize; ++i) {
+			TS_ASSERT(equals(*largeStream, _large + i * 1000, 1000));
+			TS_ASSERT_EQUALS(storedStream->readByte(), (byte)stored[i]);
+		}
+		TS_ASSERT(!storedStream->err());
+
+		// The stored member ends where its data ends, not at the next header
+		byte buffer[16];
+		TS_ASSERT_EQUALS(storedStream->read(buffer, sizeof(buffer)), 0u);
+		TS_ASSERT(storedStream->eos());
+
+		// Opening a member does not disturb the members already open
+		Common::ScopedPtr<Common::SeekableReadStream> otherStream(archive->createReadStreamForMember("large.bin"));
+		TS_ASSERT(equals(*otherStream, _large, 5000));
+		TS_ASSERT(equals(*largeStream, _large + storedSize * 1000, 1000));
+
+		// Seeking forward and backward
+		TS_ASSERT(largeStream->seek(-1000, SEEK_END));
+		TS_ASSERT(equals(*largeStream, _large + kLargeSize - 1000, 1000));
+		largeStream->readByte();
+		TS_ASSERT(largeStream->eos());
+		TS_ASSERT(!largeStream->err());
+
+		TS_ASSERT(largeStream->seek(12345, SEEK_SET));
+		TS_ASSERT(equals(*largeStream, _large + 12345, 100));
+
+		storedStream->clearErr();
+		TS_ASSERT(storedStream->seek(5, SEEK_SET));
+		TS_ASSERT(equals(*storedStream, (const byte *)stored + 5, 6));
+		TS_ASSERT(equals(*otherStream, _large + 5000, 1000));
+	}
+
+public:
+	void setUp() {
+		_large = new byte[kLargeSize];
+		for (uint32 i = 0; i < kLargeSize; ++i)
+			_large[i] = (i * 7 + i / 1000) & 0xFF;
+	}
+
+	void tearDown() {
+		delete[] _large;
+	}
+
+	void test_members() {
+		Member members[3];
+		setUpMembers(members);
+		Common::ScopedPtr<Common::Archive> archive(makeArchive(members, 3));
+		checkMembers(archive.get());
+	}
+
+	void test_streamed_members() {
+#ifdef POSIX
+		Member members[3];
+		setUpMembers(members);
+		Common::ScopedPtr<Common::Archive> archive(makeFileArchive(members, 3));
+		checkMembers(archive.get());
+#endif
+	}
+
+	void test_crc_mismatch() {
+#if defined(POSIX) && defined(USE_ZLIB)
+		Member members[3];
+		setUpMembers(members);
+		members[0].badCrc = true;
+		members[1].badCrc = true;
+		members[2].badCrc = true;
+		Common::ScopedPtr<Common::Archive> archive(makeFileArchive(members, 3));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		// Members inflated into memory are checked right away
+		TS_ASSERT(!archive->createReadStreamForMember("small.txt"));
+
+		// Streamed members report the mismatch once all data was read
+		Common::ScopedPtr<Common::SeekableReadStream> largeStream(archive->createReadStreamForMember("large.bin"));
+		TS_ASSERT(largeStream);
+		TS_ASSERT(equals(*largeStream, _large, kLargeSize / 2));
+		TS_ASSERT(!largeStream->err());
+		TS_ASSERT(equals(*largeStream, _large + kLargeSize / 2, kLargeSize - kLargeSize / 2));
+		TS_ASSERT(largeStream->err());
+
+		Common::ScopedPtr<Common::SeekableReadStream> storedStream(archive->createReadStreamForMember("stored.txt"));
+		TS_ASSERT(storedStream);
+		TS_ASSERT(equals(*storedStream, members[2].data, members[2].size));
+		TS_ASSERT(storedStream->err());
+
+		// The error stays set
+		storedStream->clearErr();
+		TS_ASSERT(storedStream->err());
+#endif
+	}
+};
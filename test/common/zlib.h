@@ -0,0 +1,89 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/zlib.h"
+
+class ZlibTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kDataSize = 2 * 1024 * 1024 + 123
+	};
+
+	byte *_data;
+	byte *_gzip;
+	uint32 _gzipSize;
+
+	bool verify(Common::SeekableReadStream &stream, uint32 pos, uint32 size) {
+		byte buffer[256];
+		assert(size <= sizeof(buffer));
+		if (!stream.seek(pos, SEEK_SET) || (uint32)stream.pos() != pos)
+			return false;
+		return stream.read(buffer, size) == size && !memcmp(buffer, _data + pos, size);
+	}
+
+	void seekAround(Common::SeekableReadStream &stream) {
+		TS_ASSERT_EQUALS(stream.size(), (int32)kDataSize);
+
+		// Seek into data which has never been decompressed
+		TS_ASSERT(verify(stream, 1500000, 100));
+		TS_ASSERT(verify(stream, 1000, 100));
+
+		// Jump back and forth over the whole data
+		uint32 pos = 12345;
+		for (int i = 0; i < 64; ++i) {
+			pos = (pos * 1103515245 + 12345) % (kDataSize - 256);
+			TS_ASSERT(verify(stream, pos, 256));
+		}
+
+		TS_ASSERT(stream.seek(-10, SEEK_END));
+		TS_ASSERT(verify(stream, kDataSize - 10, 10));
+		stream.readByte();
+		TS_ASSERT(stream.eos());
+
+		TS_ASSERT(verify(stream, 0, 256));
+		TS_ASSERT(!stream.err());
+	}
+
+public:
+	void setUp() {
+		// Compressible, but not trivially so
+		_data = new byte[kDataSize];
+		uint32 seed = 1;
+		for (uint32 i = 0; i < kDataSize; ++i) {
+			seed = seed * 1664525 + 1013904223;
+			_data[i] = 'a' + ((seed >> 24) & 15);
+		}
+
+		// The compressing stream takes ownership of the memory stream,
+		// but not of its data.
+		Common::MemoryWriteStreamDynamic *out = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *compressed = Common::wrapCompressedWriteStream(out);
+		compressed->write(_data, kDataSize);
+		compressed->finalize();
+		_gzip = out->getData();
+		_gzipSize = out->size();
+		delete compressed;
+	}
+
+	void tearDown() {
+		delete[] _data;
+		free(_gzip);
+	}
+
+	void test_gzip_seek() {
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(_gzip, _gzipSize)));
+		TS_ASSERT(stream);
+		seekAround(*stream);
+	}
+
+	void test_deflate_seek() {
+		// A gzip stream is raw deflate data with a 10 byte header and an 8 byte trailer
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapDeflateReadStream(
+			new Common::MemoryReadStream(_gzip + 10, _gzipSize - 18), kDataSize));
+		TS_ASSERT(stream);
+		seekAround(*stream);
+	}
+};
@@ -0,0 +1,192 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/util.h"
+#include "common/workerpool.h"
+
+#include "graphics/pixelformat.h"
+#include "graphics/scaler.h"
+#include "graphics/scaler/aspect.h"
+
+class ScalerTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kMaxWidth = 123,
+		kMaxHeight = 81,
+		kBorder = 2,
+		kSrcPitch = (kMaxWidth + 2 * kBorder) * 2,
+		kDstPitch = (kMaxWidth * 3 + 1) * 2,
+		kSrcPitch32 = kSrcPitch * 2,
+		kDstPitch32 = kDstPitch * 2
+	};
+
+	uint16 _src[(kMaxWidth + 2 * kBorder) * (kMaxHeight + 2 * kBorder)];
+	// The same pixels, converted to ARGB8888
+	uint32 _src32[(kMaxWidth + 2 * kBorder) * (kMaxHeight + 2 * kBorder)];
+	// Some scalers want the output to be 4 byte aligned
+	uint32 _expected[kDstPitch32 / 4 * kMaxHeight * 3];
+	uint32 _actual[kDstPitch32 / 4 * kMaxHeight * 3];
+
+	bool compare(Common::WorkerPool &pool, ScalerProc *scaler, int scaleFactor, int bytesPerPixel, int width, int height) {
+		const uint32 srcPitch = bytesPerPixel == 4 ? kSrcPitch32 : kSrcPitch;
+		const uint32 dstPitch = bytesPerPixel == 4 ? kDstPitch32 : kDstPitch;
+		const uint8 *src = (bytesPerPixel == 4 ? (const uint8 *)_src32 : (const uint8 *)_src) + kBorder * srcPitch + kBorder * bytesPerPixel;
+		memset(_expected, 0, sizeof(_expected));
+		memset(_actual, 0, sizeof(_actual));
+
+		scaler(src, srcPitch, (uint8 *)_expected, dstPitch, width, height);
+		scaleInBands(pool, scaler, scaleFactor, src, srcPitch, (uint8 *)_actual, dstPitch, width, height);
+		return !memcmp(_expected, _actual, sizeof(_actual));
+	}
+
+	void compareScaler(const char *name, ScalerProc *scaler, int scaleFactor, int bytesPerPixel = 2) {
+		const int sizes[][2] = { { kMaxWidth, kMaxHeight }, { 100, 77 }, { 64, 64 }, { 40, 10 } };
+		const int threads[] = { 2, 3, 4 };
+
+		for (uint t = 0; t < ARRAYSIZE(threads); ++t) {
+			Common::WorkerPool pool(threads[t]);
+			for (uint s = 0; s < ARRAYSIZE(sizes); ++s) {
+				TSM_ASSERT(Common::String::format("%s %dx%d with %d threads", name, sizes[s][0], sizes[s][1], threads[t]).c_str(),
+				           compare(pool, scaler, scaleFactor, bytesPerPixel, sizes[s][0], sizes[s][1]));
+			}
+		}
+	}
+
+	/**
+	 * Get the largest difference of a channel between the 16 bit pixels in
+	 * _expected and the 32 bit pixels in _actual, or 256 if a 32 bit pixel
+	 * is not opaque.
+	 */
+	int maxChannelDiff(int width, int height) {
+		const Graphics::PixelFormat format16(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const Graphics::PixelFormat format32(4, 8, 8, 8, 8, 16, 8, 0, 24);
+
+		int maxDiff = 0;
+		for (int y = 0; y < height; ++y) {
+			const uint16 *expected = (const uint16 *)((const uint8 *)_expected + y * kDstPitch);
+			const uint32 *actual = (const uint32 *)((const uint8 *)_actual + y * kDstPitch32);
+			for (int x = 0; x < width; ++x) {
+				uint8 a, r1, g1, b1, r2, g2, b2;
+				format16.colorToRGB(expected[x], r1, g1, b1);
+				format32.colorToARGB(actual[x], a, r2, g2, b2);
+				maxDiff = MAX(maxDiff, ABS(r1 - r2));
+				maxDiff = MAX(maxDiff, ABS(g1 - g2));
+				maxDiff = MAX(maxDiff, ABS(b1 - b2));
+				if (a != 0xFF)
+					maxDiff = 256;
+			}
+		}
+		return maxDiff;
+	}
+
+	/**
+	 * Check that a 32 bit scaler gives the same output as its 16 bit
+	 * counterpart. Interpolated pixels may differ by the given amount per
+	 * channel, as the 32 bit scalers interpolate with more precision.
+	 */
+	void compareWith16Bit(const char *name, ScalerProc *scaler16, ScalerProc *scaler32, int scaleFactor, int tolerance) {
+		const int sizes[][2] = { { kMaxWidth, kMaxHeight }, { 64, 64 }, { 5, 3 } };
+
+		for (uint s = 0; s < ARRAYSIZE(sizes); ++s) {
+			const int width = sizes[s][0];
+			const int height = sizes[s][1];
+			memset(_expected, 0, sizeof(_expected));
+			memset(_actual, 0, sizeof(_actual));
+			scaler16((const uint8 *)_src + kBorder * kSrcPitch + kBorder * 2, kSrcPitch, (uint8 *)_expected, kDstPitch, width, height);
+			scaler32((const uint8 *)_src32 + kBorder * kSrcPitch32 + kBorder * 4, kSrcPitch32, (uint8 *)_actual, kDstPitch32, width, height);
+
+			TSM_ASSERT_LESS_THAN_EQUALS(Common::String::format("%s %dx%d", name, width, height).c_str(),
+			                            maxChannelDiff(width * scaleFactor, height * scaleFactor), tolerance);
+		}
+	}
+
+public:
+	void setUp() {
+		InitScalers(565);
+
+		// Random noise with some flat areas, so that the scalers
+		// interpolating between similar pixels take all paths
+		uint32 seed = 1;
+		for (uint i = 0; i < ARRAYSIZE(_src); ++i) {
+			seed = seed * 1664525 + 1013904223;
+			_src[i] = (seed & 0x10000) ? (uint16)(seed >> 16) : 0x7BEF;
+		}
+
+		const Graphics::PixelFormat format16(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const Graphics::PixelFormat format32(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		for (uint i = 0; i < ARRAYSIZE(_src); ++i) {
+			uint8 r, g, b;
+			format16.colorToRGB(_src[i], r, g, b);
+			_src32[i] = format32.RGBToColor(r, g, b);
+		}
+	}
+
+	void tearDown() {
+		DestroyScalers();
+	}
+
+	void test_banded_output() {
+		compareScaler("Normal1x", Normal1x, 1);
+#ifdef USE_SCALERS
+		compareScaler("Normal2x", Normal2x, 2);
+		compareScaler("Normal3x", Normal3x, 3);
+		compareScaler("2xSaI", _2xSaI, 2);
+		compareScaler("Super2xSaI", Super2xSaI, 2);
+		compareScaler("SuperEagle", SuperEagle, 2);
+		compareScaler("AdvMame2x", AdvMame2x, 2);
+		compareScaler("AdvMame3x", AdvMame3x, 3);
+		compareScaler("TV2x", TV2x, 2);
+		compareScaler("DotMatrix", DotMatrix, 2);
+#ifdef USE_HQ_SCALERS
+		compareScaler("HQ2x", HQ2x, 2);
+		compareScaler("HQ3x", HQ3x, 3);
+#endif
+#endif
+
+		compareScaler("Normal1x_32", Normal1x_32, 1, 4);
+#ifdef USE_SCALERS
+		compareScaler("Normal2x_32", Normal2x_32, 2, 4);
+		compareScaler("Normal3x_32", Normal3x_32, 3, 4);
+		compareScaler("AdvMame2x_32", AdvMame2x_32, 2, 4);
+		compareScaler("AdvMame3x_32", AdvMame3x_32, 3, 4);
+#ifdef USE_HQ_SCALERS
+		compareScaler("HQ2x_32", HQ2x_32, 2, 4);
+		compareScaler("HQ3x_32", HQ3x_32, 3, 4);
+#endif
+#endif
+	}
+
+	void test_32bpp_output() {
+		compareWith16Bit("Normal1x_32", Normal1x, Normal1x_32, 1, 0);
+#ifdef USE_SCALERS
+		compareWith16Bit("Normal2x_32", Normal2x, Normal2x_32, 2, 0);
+		compareWith16Bit("Normal3x_32", Normal3x, Normal3x_32, 3, 0);
+		compareWith16Bit("AdvMame2x_32", AdvMame2x, AdvMame2x_32, 2, 0);
+		compareWith16Bit("AdvMame3x_32", AdvMame3x, AdvMame3x_32, 3, 0);
+#ifdef USE_HQ_SCALERS
+		// The 16 bit scalers drop up to three bits of each interpolated channel
+		compareWith16Bit("HQ2x_32", HQ2x, HQ2x_32, 2, 8);
+		compareWith16Bit("HQ3x_32", HQ3x, HQ3x_32, 3, 8);
+#endif
+#endif
+	}
+
+	void test_32bpp_aspect() {
+#ifdef USE_SCALERS
+		// Stretch 50 rows to 60 in place, like the SDL backend does
+		const int width = kMaxWidth;
+		const int height = 50;
+		memset(_expected, 0, sizeof(_expected));
+		memset(_actual, 0, sizeof(_actual));
+		for (int y = 0; y < height; ++y) {
+			memcpy((uint8 *)_expected + y * kDstPitch, (const uint8 *)_src + y * kSrcPitch, width * 2);
+			memcpy((uint8 *)_actual + y * kDstPitch32, (const uint8 *)_src32 + y * kSrcPitch32, width * 4);
+		}
+
+		TS_ASSERT_EQUALS(stretch200To240((uint8 *)_expected, kDstPitch, width, height, 0, 0, 0), 60);
+		TS_ASSERT_EQUALS(stretch200To240_32((uint8 *)_actual, kDstPitch32, width, height, 0, 0, 0), 60);
+		// The 16 bit version drops up to three bits of each interpolated channel
+		TS_ASSERT_LESS_THAN_EQUALS(maxChannelDiff(width, 60), 8);
+#endif
+	}
+};
@@ -0,0 +1,195 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/str.h"
+#include "common/util.h"
+
+#include "graphics/transparent_surface.h"
+#include "graphics/transparent_surface_intern.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kMaxWidth = 37,
+		kHeight = 3,
+		kPitch = kMaxWidth * 4
+	};
+
+	uint32 _seed;
+
+	byte nextRandom() {
+		// xorshift32, we do not want to depend on g_system for RandomSource
+		_seed ^= _seed << 13;
+		_seed ^= _seed >> 17;
+		_seed ^= _seed << 5;
+		return (byte)(_seed >> 8);
+	}
+
+	void fill(byte *pixels, uint32 size) {
+		for (uint32 i = 0; i < size; ++i)
+			pixels[i] = nextRandom();
+		// Make sure there are fully transparent and fully opaque pixels
+		for (uint32 i = 0; i < size; i += 12)
+			pixels[i] = 0;
+		for (uint32 i = 4; i < size; i += 20)
+			pixels[i] = 255;
+	}
+
+	void compareKernel(const Graphics::BlendKernels &kernels, int mode, uint32 width, bool flipH, bool flipV, uint32 color) {
+		byte src[kPitch * kHeight];
+		byte expected[kPitch * kHeight];
+		byte actual[kPitch * kHeight];
+		fill(src, sizeof(src));
+		fill(expected, sizeof(expected));
+		memcpy(actual, expected, sizeof(actual));
+
+		// Set up the pointers like TransparentSurface::blit does
+		const int32 inStep = flipH ? -4 : 4;
+		const int32 inoStep = flipV ? -kPitch : kPitch;
+		byte *ino = src + (flipH ? (width - 1) * 4 : 0) + (flipV ? (kHeight - 1) * kPitch : 0);
+
+		const Graphics::BlendKernels *sets[2] = { &Graphics::g_blendKernelsScalar, &kernels };
+		byte *outputs[2] = { expected, actual };
+		for (int i = 0; i < 2; ++i) {
+			switch (mode) {
+			case 0:
+				sets[i]->blitOpaque(ino, outputs[i], width, kHeight, kPitch, inStep, inoStep);
+				break;
+			case 1:
+				sets[i]->blitBinary(ino, outputs[i], width, kHeight, kPitch, inStep, inoStep);
+				break;
+			case 2:
+				sets[i]->blitAlphaBlend(ino, outputs[i], width, kHeight, kPitch, inStep, inoStep, color);
+				break;
+			case 3:
+				sets[i]->blitAdditiveBlend(ino, outputs[i], width, kHeight, kPitch, inStep, inoStep, color);
+				break;
+			default:
+				sets[i]->blitSubtractiveBlend(ino, outputs[i], width, kHeight, kPitch, inStep, inoStep, color);
+				break;
+			}
+		}
+
+		TSM_ASSERT(Common::String::format("%s mode %d width %d flip %d%d color %08x", kernels.name, mode, width, flipH, flipV, color).c_str(),
+		           !memcmp(expected, actual, sizeof(actual)));
+	}
+
+	void compareKernels(const Graphics::BlendKernels &kernels) {
+		const uint32 widths[] = { 1, 3, 4, 8, 13, 16, kMaxWidth };
+		const uint32 colors[] = { 0xFFFFFFFF, 0xFF808080, 0x80FF40C0, 0xC0FFFF00, 0x7FFFFFFF, 0x00FFFFFF };
+
+		_seed = 1;
+		for (int mode = 0; mode < 5; ++mode) {
+			for (uint w = 0; w < ARRAYSIZE(widths); ++w) {
+				for (int flip = 0; flip < 4; ++flip) {
+					for (uint c = 0; c < ARRAYSIZE(colors); ++c)
+						compareKernel(kernels, mode, widths[w], flip & 1, flip & 2, colors[c]);
+				}
+			}
+		}
+	}
+
+	bool compareScaledBlit(Graphics::TransparentSurface &sprite, int posX, int posY, int flipping, uint color, int width, int height, Graphics::TSpriteBlendMode blend, bool filtering) {
+		enum {
+			kTargetWidth = 600,
+			kTargetHeight = 24
+		};
+
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		uint32 expected[kTargetWidth * kTargetHeight];
+		uint32 actual[kTargetWidth * kTargetHeight];
+		fill((byte *)expected, sizeof(expected));
+		memcpy(actual, expected, sizeof(actual));
+
+		Graphics::Surface expectedTarget, actualTarget;
+		expectedTarget.init(kTargetWidth, kTargetHeight, kTargetWidth * 4, expected, format);
+		actualTarget.init(kTargetWidth, kTargetHeight, kTargetWidth * 4, actual, format);
+
+		// Scaling the sprite first has to give the same result
+		Graphics::TransparentSurface *scaled = sprite.scale(width, height, filtering);
+		scaled->setAlphaMode(sprite.getAlphaMode());
+		const Common::Rect expectedRect = scaled->blit(expectedTarget, posX, posY, flipping, nullptr, color, -1, -1, blend);
+		scaled->free();
+		delete scaled;
+
+		const Common::Rect actualRect = sprite.blit(actualTarget, posX, posY, flipping, nullptr, color, width, height, blend, filtering);
+
+		return expectedRect == actualRect && !memcmp(expected, actual, sizeof(actual));
+	}
+
+public:
+	void test_flipped_opaque_blit() {
+		// Alpha is in the lowest byte
+		uint32 srcPixels[3] = { 0x010203FF, 0x040506FF, 0x070809FF };
+		uint32 dstPixels[3] = { 0, 0, 0 };
+
+		Graphics::Surface src, dst;
+		src.init(3, 1, 12, srcPixels, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		dst.init(3, 1, 12, dstPixels, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+
+		Graphics::TransparentSurface surface(src);
+		surface.setAlphaMode(Graphics::ALPHA_OPAQUE);
+		surface.blit(dst, 0, 0, Graphics::FLIP_H);
+
+		TS_ASSERT_EQUALS(dstPixels[0], srcPixels[2]);
+		TS_ASSERT_EQUALS(dstPixels[1], srcPixels[1]);
+		TS_ASSERT_EQUALS(dstPixels[2], srcPixels[0]);
+	}
+
+	void test_scaled_blit() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		uint32 pixels[7 * 5];
+		_seed = 1;
+		fill((byte *)pixels, sizeof(pixels));
+
+		Graphics::Surface src;
+		src.init(7, 5, 7 * 4, pixels, format);
+		Graphics::TransparentSurface sprite(src);
+
+		const int sizes[][2] = { { 14, 10 }, { 3, 2 }, { 20, 4 }, { 1, 1 }, { 550, 3 }, { 3, 9 }, { 550, 12 } };
+		const int positions[][2] = { { 0, 0 }, { 5, 3 }, { -4, -2 }, { 20, 22 }, { -30, 0 } };
+		const Graphics::AlphaType alphaTypes[] = { Graphics::ALPHA_OPAQUE, Graphics::ALPHA_BINARY, Graphics::ALPHA_FULL };
+		const Graphics::TSpriteBlendMode blendModes[] = { Graphics::BLEND_NORMAL, Graphics::BLEND_ADDITIVE, Graphics::BLEND_SUBTRACTIVE };
+
+		for (uint s = 0; s < ARRAYSIZE(sizes); ++s) {
+			// scale() divides by zero when filtering to a single row or column
+			const int filterModes = (sizes[s][0] > 1 && sizes[s][1] > 1) ? 2 : 1;
+			for (int filter = 0; filter < filterModes; ++filter) {
+				for (uint p = 0; p < ARRAYSIZE(positions); ++p) {
+					for (int flip = 0; flip < 4; ++flip) {
+						for (uint a = 0; a < ARRAYSIZE(alphaTypes); ++a) {
+							sprite.setAlphaMode(alphaTypes[a]);
+							TSM_ASSERT(Common::String::format("size %dx%d at %d,%d flip %d alpha %d filter %d", sizes[s][0], sizes[s][1], positions[p][0], positions[p][1], flip, a, filter).c_str(),
+							           compareScaledBlit(sprite, positions[p][0], positions[p][1], flip, 0xFFFFFFFF, sizes[s][0], sizes[s][1], Graphics::BLEND_NORMAL, filter != 0));
+						}
+						for (uint b = 0; b < ARRAYSIZE(blendModes); ++b) {
+							TSM_ASSERT(Common::String::format("size %dx%d at %d,%d flip %d blend %d filter %d", sizes[s][0], sizes[s][1], positions[p][0], positions[p][1], flip, b, filter).c_str(),
+							           compareScaledBlit(sprite, positions[p][0], positions[p][1], flip, 0xC0FF8040, sizes[s][0], sizes[s][1], blendModes[b], filter != 0));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void test_sse2_bit_exact() {
+#if defined(SCUMMVM_SSE2) && defined(SCUMM_LITTLE_ENDIAN)
+		if (Common::hasCpuFeature(Common::kCpuFeatureSSE2))
+			compareKernels(Graphics::g_blendKernelsSSE2);
+#endif
+	}
+
+	void test_avx2_bit_exact() {
+#if defined(SCUMMVM_AVX2) && defined(SCUMM_LITTLE_ENDIAN)
+		if (Common::hasCpuFeature(Common::kCpuFeatureAVX2))
+			compareKernels(Graphics::g_blendKernelsAVX2);
+#endif
+	}
+
+	void test_neon_bit_exact() {
+#if defined(SCUMMVM_NEON) && defined(SCUMM_LITTLE_ENDIAN)
+		if (Common::hasCpuFeature(Common::kCpuFeatureNEON))
+			compareKernels(Graphics::g_blendKernelsNEON);
+#endif
+	}
+};
@@ -0,0 +1,109 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/str.h"
+#include "common/util.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kSize = 256,
+		kPitch = kSize + 3
+	};
+
+	byte _y[kPitch * kSize];
+	byte _u[kPitch * kSize];
+	byte _v[kPitch * kSize];
+
+	enum Subsampling {
+		k444,
+		k420,
+		k410
+	};
+
+	void convert(Graphics::Surface &dst, Subsampling subsampling, Graphics::YUVToRGBManager::LuminanceScale scale, int width, int height) {
+		switch (subsampling) {
+		case k444:
+			YUVToRGBMan.convert444(&dst, scale, _y, _u, _v, width, height, kPitch, kPitch);
+			break;
+		case k420:
+			YUVToRGBMan.convert420(&dst, scale, _y, _u, _v, width, height, kPitch, kPitch);
+			break;
+		default:
+			YUVToRGBMan.convert410(&dst, scale, _y, _u, _v, width, height, kPitch, kPitch);
+			break;
+		}
+	}
+
+	/** Check that the SIMD conversion gives the same output as the lookup tables. */
+	void compare(const char *name, Subsampling subsampling, int width, int height) {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0),
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 8, 4, 0, 12),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0)
+		};
+		const Graphics::YUVToRGBManager::LuminanceScale scales[] = {
+			Graphics::YUVToRGBManager::kScaleFull,
+			Graphics::YUVToRGBManager::kScaleITU
+		};
+
+		for (uint f = 0; f < ARRAYSIZE(formats); ++f) {
+			for (uint s = 0; s < ARRAYSIZE(scales); ++s) {
+				Graphics::Surface expected, actual;
+				expected.create(width, height, formats[f]);
+				actual.create(width, height, formats[f]);
+
+				YUVToRGBMan.setUseSIMD(false);
+				convert(expected, subsampling, scales[s], width, height);
+				YUVToRGBMan.setUseSIMD(true);
+				convert(actual, subsampling, scales[s], width, height);
+
+				bool equal = true;
+				for (int y = 0; y < height; ++y)
+					equal = equal && !memcmp(expected.getBasePtr(0, y), actual.getBasePtr(0, y), width * formats[f].bytesPerPixel);
+				TSM_ASSERT(Common::String::format("%s %dx%d, format %d, scale %d", name, width, height, f, s).c_str(), equal);
+
+				expected.free();
+				actual.free();
+			}
+		}
+	}
+
+public:
+	void test_all_colors() {
+		// Every combination of u and v, with varying luminance
+		for (int offset = 0; offset < 256; offset += 85) {
+			for (int y = 0; y < kSize; ++y) {
+				for (int x = 0; x < kSize; ++x) {
+					_y[y * kPitch + x] = (x * 7 + y * 13 + offset) & 0xFF;
+					_u[y * kPitch + x] = x;
+					_v[y * kPitch + x] = y;
+				}
+			}
+			compare("444", k444, kSize, kSize);
+		}
+	}
+
+	void test_subsampling() {
+		uint32 seed = 1;
+		for (int i = 0; i < kPitch * kSize; ++i) {
+			seed = seed * 1664525 + 1013904223;
+			_y[i] = seed >> 24;
+			_u[i] = seed >> 16;
+			_v[i] = seed >> 8;
+		}
+
+		// Widths which leave some pixels for the lookup tables
+		compare("444", k444, 123, 37);
+		compare("420", k420, 250, 38);
+		compare("420", k420, 6, 4);
+		compare("410", k410, 252, 36);
+		compare("410", k410, 4, 4);
+	}
+};
@@ -5,8 +5,8 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h
+TEST_LIBS    := audio/libaudio.a graphics/libgraphics.a backends/libbackends.a common/libcommon.a
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
@@ -35,8 +35,26 @@ test/runner.cpp: $(TESTS)
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
 
+######################################################################
+# Benchmarks, also based on CxxTest. They report their results via
+# TS_TRACE, so you will want an optimized build to get useful numbers.
+# Use the 'benchmark' target to run them.
+######################################################################
+
+BENCHMARKS      := $(srcdir)/test/benchmarks/*.h
+BENCHMARK_LIBS  := $(TEST_LIBS)
+
+benchmark: test/benchmark_runner
+	./test/benchmark_runner
+test/benchmark_runner: test/benchmark_runner.cpp $(srcdir)/test/benchmarks/timer.cpp $(BENCHMARK_LIBS)
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+test/benchmark_runner.cpp: $(BENCHMARKS)
+	@mkdir -p test
+	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
+
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/benchmark_runner.cpp test/benchmark_runner test/*.tmp
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test
@@ -128,9 +128,13 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 	}
 
 	// Reading video frame properties
+	Common::Array<uint32> frameOffsets;
+	frameOffsets.resize(frameCount);
+	_bink->readUint32LEArray(frameOffsets.begin(), frameCount);
+
 	_frames.resize(frameCount);
 	for (uint32 i = 0; i < frameCount; i++) {
-		_frames[i].offset   = _bink->readUint32LE();
+		_frames[i].offset   = frameOffsets[i];
 		_frames[i].keyFrame = _frames[i].offset & 1;
 
 		_frames[i].offset &= ~1;
@@ -25,6 +25,7 @@
 #include "audio/audiostream.h"
 #include "audio/mixer.h" // for kMaxChannelVolume
 
+#include "common/bufferedstream.h"
 #include "common/rational.h"
 #include "common/file.h"
 #include "common/system.h"
@@ -87,7 +88,9 @@ bool VideoDecoder::loadFile(const Common::String &filename) {
 		return false;
 	}
 
-	return loadStream(file);
+	// Read the file ahead on the I/O thread, so that decoding the frames
+	// does not stall on disk access
+	return loadStream(Common::wrapPrefetchingReadStream(file, 64 * 1024, DisposeAfterUse::YES));
 }
 
 bool VideoDecoder::needsUpdate() const {